@@ -0,0 +1,90 @@
+﻿#include "pch.h"
+#include "AllocCounter.h"
+#include <new>
+
+using namespace std;
+
+// 전역 operator new/delete를 모두 교체해 스레드별로 힙 할당 횟수를 셈 (측정 스레드끼리 카운터를 공유하지 않음)
+// 호출하는 쪽에 인라인되면 GCC가 new와 free의 짝을 잘못 판단하므로 별도 파일에 둠
+static thread_local uint64_t LAllocCount = 0;
+
+static void* CountedAlloc(size_t size) noexcept
+{
+    LAllocCount++;
+    return malloc(size == 0 ? 1 : size);
+}
+
+static void* CountedAlignedAlloc(size_t size, align_val_t align) noexcept
+{
+    LAllocCount++;
+    size_t alignment = static_cast<size_t>(align);
+#ifdef _WIN32
+    return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+    // aligned_alloc은 크기가 정렬의 배수여야 함
+    size_t rounded = ((size == 0 ? 1 : size) + alignment - 1) & ~(alignment - 1);
+    return aligned_alloc(alignment, rounded);
+#endif
+}
+
+static void AlignedFree(void* ptr) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    if (void* ptr = CountedAlloc(size))
+        return ptr;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* ptr = CountedAlloc(size))
+        return ptr;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept { return CountedAlloc(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return CountedAlloc(size); }
+
+void* operator new(size_t size, align_val_t align)
+{
+    if (void* ptr = CountedAlignedAlloc(size, align))
+        return ptr;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size, align_val_t align)
+{
+    if (void* ptr = CountedAlignedAlloc(size, align))
+        return ptr;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept { return CountedAlignedAlloc(size, align); }
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept { return CountedAlignedAlloc(size, align); }
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const nothrow_t&) noexcept { free(ptr); }
+
+void operator delete(void* ptr, align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete[](void* ptr, align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete(void* ptr, size_t, align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete[](void* ptr, size_t, align_val_t) noexcept { AlignedFree(ptr); }
+void operator delete(void* ptr, align_val_t, const nothrow_t&) noexcept { AlignedFree(ptr); }
+void operator delete[](void* ptr, align_val_t, const nothrow_t&) noexcept { AlignedFree(ptr); }
+
+uint64_t ThreadAllocCount()
+{
+    return LAllocCount;
+}
@@ -0,0 +1,4 @@
+﻿#pragma once
+
+// 현재 스레드가 전역 operator new로 할당한 누적 횟수 (MemoryPool이 직접 호출하는 malloc은 포함되지 않음)
+uint64_t ThreadAllocCount();
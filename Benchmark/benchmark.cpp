@@ -0,0 +1,964 @@
+﻿#include "pch.h"
+#include "Session.h"
+#include "Service.h"
+#include "CorePch.h"
+#include "ThreadManager.h"
+#include "MemoryPool.h"
+#include "SendBuffer.h"
+#include "RecvBuffer.h"
+#include "Tracer.h"
+#include "PubSub.h"
+#include "AoiGrid.h"
+#include "Snapshot.h"
+#include "AllocCounter.h"
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+CoreGlobal Core;
+
+using namespace std;
+
+/*----------------
+    할당 횟수 측정
+-----------------*/
+// operator new를 거친 할당은 AllocCounter.cpp가 스레드별로 셈
+// MemoryPool이 직접 malloc한 횟수는 풀 통계에서 가져와 더함 (풀이 비어 새로 만든 블록 + 풀 밖 직접 할당)
+static uint64_t PoolHeapAllocs()
+{
+    vector<MemoryPoolStats> stats;
+    GMemoryManager->GetStats(stats);
+
+    uint64_t total = 0;
+    for (const MemoryPoolStats& stat : stats)
+        total += stat.misses;
+    return total;
+}
+
+static int64_t NowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchConfig
+{
+    int32_t maxThreads = 8;
+    uint64_t ops = 1000000;    // 케이스마다 스레드당 반복 횟수
+    string filter;             // 이름에 포함된 케이스만 실행
+};
+
+// 스레드 인덱스와 반복 횟수를 받아 측정 대상을 실행
+using BenchBody = function<void(int32_t threadIndex, uint64_t iterations)>;
+
+struct BenchResult
+{
+    double nsPerOp;       // 스레드 하나가 연산 하나에 쓴 평균 시간
+    double allocsPerOp;
+    double mopsPerSec;    // 전체 스레드 합계 처리량
+};
+
+/*----------------
+    BenchRunner
+-----------------*/
+class BenchRunner
+{
+public:
+    BenchRunner(const BenchConfig& config) : _config(config)
+    {
+        for (int32_t threads = 1; threads < _config.maxThreads; threads *= 2)
+            _threadCounts.push_back(threads);
+        _threadCounts.push_back(_config.maxThreads);
+    }
+
+    const BenchConfig& Config() const { return _config; }
+
+    bool Enabled(const string& name) const
+    {
+        return _config.filter.empty() || name.find(_config.filter) != string::npos;
+    }
+
+    // 1..N 스레드로 측정해 한 줄씩 출력 (opsScale로 느린 케이스의 반복 횟수를 줄임)
+    void Run(const string& name, const BenchBody& body, double opsScale = 1.0, const function<void()>& afterEach = nullptr)
+    {
+        if (!Enabled(name))
+            return;
+
+        uint64_t ops = max<uint64_t>(1, static_cast<uint64_t>(_config.ops * opsScale));
+        for (int32_t threads : _threadCounts)
+        {
+            // 풀과 스레드별 캐시를 채운 뒤 측정
+            Measure(threads, max<uint64_t>(1, ops / 10), body);
+            if (afterEach)
+                afterEach();
+
+            BenchResult result = Measure(threads, ops, body);
+            if (afterEach)
+                afterEach();
+
+            cout << left << setw(44) << name << right
+                << setw(8) << threads
+                << fixed << setprecision(1) << setw(12) << result.nsPerOp
+                << setprecision(2) << setw(12) << result.allocsPerOp
+                << setprecision(2) << setw(12) << result.mopsPerSec << endl;
+        }
+    }
+
+    static void PrintHeader()
+    {
+        cout << left << setw(44) << "Benchmark" << right
+            << setw(8) << "Threads"
+            << setw(12) << "ns/op"
+            << setw(12) << "allocs/op"
+            << setw(12) << "Mops/s" << endl;
+        cout << string(88, '-') << endl;
+    }
+
+private:
+    BenchResult Measure(int32_t threads, uint64_t ops, const BenchBody& body)
+    {
+        atomic<int32_t> ready = 0;
+        atomic<bool> go = false;
+        vector<int64_t> elapsed(threads);
+        vector<uint64_t> allocs(threads);
+
+        for (int32_t i = 0; i < threads; i++)
+        {
+            GThreadManager->Launch([&, i]()
+                {
+                    ready++;
+                    while (!go.load(memory_order_acquire))
+                        this_thread::yield();
+
+                    uint64_t allocStart = ThreadAllocCount();
+                    int64_t start = NowNs();
+                    body(i, ops);
+                    elapsed[i] = NowNs() - start;
+                    allocs[i] = ThreadAllocCount() - allocStart;
+                });
+        }
+
+        // 모든 스레드가 준비되면 동시에 시작
+        while (ready.load() < threads)
+            this_thread::yield();
+
+        uint64_t poolHeapStart = PoolHeapAllocs();
+        int64_t wallStart = NowNs();
+        go.store(true, memory_order_release);
+        GThreadManager->Join();
+        int64_t wall = NowNs() - wallStart;
+        uint64_t poolHeapAllocs = PoolHeapAllocs() - poolHeapStart;
+
+        double totalOps = static_cast<double>(ops) * threads;
+        BenchResult result;
+        result.nsPerOp = accumulate(elapsed.begin(), elapsed.end(), 0.0) / totalOps;
+        result.allocsPerOp = (accumulate(allocs.begin(), allocs.end(), 0.0) + poolHeapAllocs) / totalOps;
+        result.mopsPerSec = totalOps / (wall / 1e9) / 1e6;
+        return result;
+    }
+
+    BenchConfig _config;
+    vector<int32_t> _threadCounts;
+};
+
+// 최적화로 측정 대상이 사라지지 않도록 값을 사용한 것으로 처리
+static atomic<uint64_t> GSink = 0;
+
+static void Consume(uint64_t value)
+{
+    GSink.fetch_add(value, memory_order_relaxed);
+}
+
+/*----------------
+    MemoryPool
+-----------------*/
+static void BenchMemoryPool(BenchRunner& runner)
+{
+    // 작은 크기 / 중간 크기 / 풀 최대 크기 / 청크 풀 / 풀 밖 직접 할당
+    const uint32_t sizes[] = { 32, 256, 1024, 4096, 65536, 100000 };
+    enum { BATCH = 16 };
+
+    for (uint32_t size : sizes)
+    {
+        // 한 번에 여러 개를 할당하고 해제해 풀에 여러 블록이 오가도록 함
+        runner.Run("MemoryPool::Allocate/Release(" + to_string(size) + ")", [size](int32_t, uint64_t iterations)
+            {
+                void* ptrs[BATCH];
+                uint64_t sum = 0;
+                for (uint64_t done = 0; done < iterations; done += BATCH)
+                {
+                    uint64_t count = min<uint64_t>(BATCH, iterations - done);
+                    for (uint64_t i = 0; i < count; i++)
+                    {
+                        ptrs[i] = GMemoryManager->Allocate(size);
+                        static_cast<BYTE*>(ptrs[i])[0] = static_cast<BYTE>(i);
+                    }
+                    for (uint64_t i = 0; i < count; i++)
+                    {
+                        sum += static_cast<BYTE*>(ptrs[i])[0];
+                        GMemoryManager->Release(ptrs[i]);
+                    }
+                }
+                Consume(sum);
+            });
+    }
+}
+
+/*----------------
+    ObjectPool
+-----------------*/
+struct BenchObject
+{
+    BenchObject(uint64_t value) : value(value) {}
+
+    uint64_t value;
+    BYTE payload[56];
+};
+
+static void BenchObjectPool(BenchRunner& runner)
+{
+    runner.Run("ObjectPool<T>::MakeShared(64)", [](int32_t, uint64_t iterations)
+        {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                shared_ptr<BenchObject> object = ObjectPool<BenchObject>::MakeShared(std::source_location::current(), i);
+                sum += object->value;
+            }
+            Consume(sum);
+        });
+
+    // 비교용: 풀을 쓰지 않는 make_shared
+    runner.Run("std::make_shared(64)", [](int32_t, uint64_t iterations)
+        {
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                shared_ptr<BenchObject> object = make_shared<BenchObject>(i);
+                sum += object->value;
+            }
+            Consume(sum);
+        });
+}
+
+/*----------------
+    SendBufferManager
+-----------------*/
+static void BenchSendBuffer(BenchRunner& runner)
+{
+    const uint32_t sizes[] = { 64, 1024, 4000 };
+
+    for (uint32_t size : sizes)
+    {
+        runner.Run("SendBufferManager::Open/Close(" + to_string(size) + ")", [size](int32_t, uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    SendBufferRef sendBuffer = GSendBufferManager->Open(size);
+                    PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
+                    header->size = static_cast<uint16_t>(size);
+                    header->id = 1;
+                    sendBuffer->Close(size);
+                }
+            });
+    }
+}
+
+/*----------------
+    RecvBuffer
+-----------------*/
+static void BenchRecvBuffer(BenchRunner& runner)
+{
+    // 한 번의 수신(1460바이트)을 쓰고, 완성된 100바이트 패킷만큼 읽은 뒤 Clean
+    // 남은 조각이 쌓이다가 여유 공간이 부족해지면 Clean이 데이터를 앞으로 옮김
+    runner.Run("RecvBuffer write/read/Clean(1460)", [](int32_t, uint64_t iterations)
+        {
+            enum { RECV_SIZE = 1460, PACKET_SIZE = 100 };
+
+            RecvBuffer recvBuffer(0x10000);
+            BYTE source[RECV_SIZE];
+            memset(source, 0xAB, sizeof(source));
+
+            uint64_t sum = 0;
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                memcpy(recvBuffer.WritePos(), source, RECV_SIZE);
+                recvBuffer.OnWrite(RECV_SIZE);
+
+                int32_t readSize = recvBuffer.DataSize() / PACKET_SIZE * PACKET_SIZE;
+                sum += recvBuffer.ReadPos()[0];
+                recvBuffer.OnRead(readSize);
+                recvBuffer.Clean();
+            }
+            Consume(sum);
+        });
+}
+
+/*----------------
+    Tracer
+-----------------*/
+static void BenchTracer(BenchRunner& runner)
+{
+    // 꺼져 있을 때는 플래그 확인만, 켜져 있을 때는 TSC 두 번과 링 버퍼 쓰기
+    for (bool enabled : { false, true })
+    {
+        runner.Run(string("TRACE_SCOPE(") + (enabled ? "on" : "off") + ")", [enabled](int32_t, uint64_t iterations)
+            {
+                GTracer->SetEnabled(enabled);
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    TRACE_SCOPE(PacketDispatch, 1, i);
+                }
+            });
+    }
+
+    runner.Run("TRACE_INSTANT(on)", [](int32_t, uint64_t iterations)
+        {
+            GTracer->SetEnabled(true);
+            for (uint64_t i = 0; i < iterations; i++)
+                TRACE_INSTANT(SendQueue, 1, i);
+        });
+
+    GTracer->SetEnabled(false);
+}
+
+/*----------------
+    PacketSession::OnRecv
+-----------------*/
+class BenchPacketSession : public PacketSession
+{
+public:
+    BenchPacketSession(asio::io_context& ioc) : PacketSession(ioc) {}
+
+    int32_t Feed(BYTE* buffer, int32_t len) { return OnRecv(buffer, len); }
+    uint64_t Packets() const { return _packets; }
+    uint64_t Bytes() const { return _bytes; }
+
+protected:
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override
+    {
+        _packets++;
+        _bytes += len;
+    }
+
+private:
+    uint64_t _packets = 0;
+    uint64_t _bytes = 0;
+};
+
+// 패킷 크기가 [minSize, maxSize]인 합성 스트림 생성
+static vector<BYTE> MakePacketStream(uint32_t minSize, uint32_t maxSize, uint32_t streamSize)
+{
+    vector<BYTE> stream;
+    uint32_t seed = 12345;
+    while (stream.size() < streamSize)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t size = minSize + (seed >> 16) % (maxSize - minSize + 1);
+
+        size_t offset = stream.size();
+        stream.resize(offset + size);
+        PacketHeader* header = reinterpret_cast<PacketHeader*>(&stream[offset]);
+        header->size = static_cast<uint16_t>(size);
+        header->id = 1;
+    }
+    return stream;
+}
+
+static void BenchPacketFraming(BenchRunner& runner)
+{
+    struct StreamCase
+    {
+        const char* name;
+        uint32_t minSize;
+        uint32_t maxSize;
+    };
+
+    const StreamCase cases[] = {
+        { "PacketSession::OnRecv framing(16)", 16, 16 },
+        { "PacketSession::OnRecv framing(8..512)", 8, 512 },
+        { "PacketSession::OnRecv framing(1000..4000)", 1000, 4000 },
+    };
+
+    for (const StreamCase& streamCase : cases)
+    {
+        auto stream = make_shared<vector<BYTE>>(MakePacketStream(streamCase.minSize, streamCase.maxSize, 1024 * 1024));
+
+        // Session의 수신 루프처럼 1460바이트씩 RecvBuffer에 받아 OnRecv로 자름 (연산 하나 = 패킷 하나)
+        runner.Run(streamCase.name, [stream](int32_t, uint64_t iterations)
+            {
+                enum { RECV_SIZE = 1460 };
+
+                asio::io_context ioc;
+                auto session = make_shared<BenchPacketSession>(ioc);
+                RecvBuffer recvBuffer(0x10000);
+                size_t streamPos = 0;
+
+                while (session->Packets() < iterations)
+                {
+                    // 스트림 끝에서 처음으로 돌아감 (패킷 경계에서 끝나므로 프레이밍이 유지됨)
+                    int32_t recvSize = static_cast<int32_t>(min<size_t>(RECV_SIZE, stream->size() - streamPos));
+                    memcpy(recvBuffer.WritePos(), stream->data() + streamPos, recvSize);
+                    recvBuffer.OnWrite(recvSize);
+                    streamPos = (streamPos + recvSize) % stream->size();
+
+                    int32_t processLen = session->Feed(recvBuffer.ReadPos(), recvBuffer.DataSize());
+                    recvBuffer.OnRead(processLen);
+                    recvBuffer.Clean();
+                }
+                Consume(session->Bytes());
+            });
+    }
+}
+
+/*----------------
+    Session::Send
+-----------------*/
+class BenchSendSession : public PacketSession
+{
+public:
+    BenchSendSession(asio::io_context& ioc) : PacketSession(ioc) {}
+
+    void WaitConnected()
+    {
+        while (!IsConnected())
+            this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    // 큐에 넣은 데이터가 모두 소켓으로 나갈 때까지 대기
+    void WaitSent(uint64_t bytes)
+    {
+        while (_sentBytes.load() < bytes)
+            this_thread::sleep_for(chrono::microseconds(100));
+    }
+
+    uint64_t SentBytes() const { return _sentBytes.load(); }
+
+protected:
+    virtual void OnSend(int32_t len) override { _sentBytes += len; }
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override {}
+
+private:
+    atomic<uint64_t> _sentBytes = 0;
+};
+
+static void BenchSessionSend(BenchRunner& runner)
+{
+    if (!runner.Enabled("Session::Send"))
+        return;
+
+    // 1. 루프백으로 연결된 세션 준비 (상대편은 받은 데이터를 버리기만 함)
+    asio::io_context ioc;
+    auto work = asio::make_work_guard(ioc);
+
+    asio::ip::tcp::acceptor acceptor(ioc, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0));
+    asio::ip::tcp::socket peer(ioc);
+    vector<BYTE> drain(0x40000);
+    function<void()> readLoop = [&]()
+        {
+            peer.async_read_some(asio::buffer(drain), [&](const std::error_code& error, size_t)
+                {
+                    if (!error)
+                        readLoop();
+                });
+        };
+    acceptor.async_accept(peer, [&](const std::error_code& error)
+        {
+            if (!error)
+                readLoop();
+        });
+
+    shared_ptr<BenchSendSession> session;
+    auto service = make_shared<ClientService>(
+        ioc,
+        NetAddress(acceptor.local_endpoint()),
+        [&session](asio::io_context& ioc)
+        {
+            session = make_shared<BenchSendSession>(ioc);
+            return session;
+        },
+        1);
+
+    // 측정 스레드와 겹치지 않도록 io 스레드는 따로 실행
+    thread ioThread([&ioc]() { ioc.run(); });
+
+    if (!service->Start()) {
+        cerr << "Failed to start Session::Send benchmark" << endl;
+        work.reset();
+        ioc.stop();
+        ioThread.join();
+        return;
+    }
+    session->WaitConnected();
+
+    // 2. 미리 만든 64바이트 패킷을 여러 스레드가 큐에 넣음 (연산 하나 = Send 한 번)
+    enum { PACKET_SIZE = 64 };
+    SendBufferRef sendBuffer = GSendBufferManager->Open(PACKET_SIZE);
+    PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
+    header->size = PACKET_SIZE;
+    header->id = 1;
+    sendBuffer->Close(PACKET_SIZE);
+
+    atomic<uint64_t> queuedBytes = 0;
+    runner.Run("Session::Send(64)", [&](int32_t, uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+                session->Send(sendBuffer);
+            queuedBytes += iterations * PACKET_SIZE;
+        },
+        0.25,
+        [&]() { session->WaitSent(queuedBytes.load()); });
+
+    // 3. 정리
+    service->CloseService();
+    std::error_code ec;
+    peer.close(ec);
+    acceptor.close(ec);
+    work.reset();
+    ioc.stop();
+    ioThread.join();
+}
+
+/*----------------
+    PubSub::Publish
+-----------------*/
+class BenchSubscriberSession : public PacketSession
+{
+public:
+    BenchSubscriberSession(asio::io_context& ioc, atomic<uint64_t>& sentBytes, atomic<int32_t>& connected)
+        : PacketSession(ioc), _sentBytes(sentBytes), _connected(connected) {}
+
+protected:
+    virtual void OnConnected() override { _connected++; }
+    virtual void OnSend(int32_t len) override { _sentBytes += len; }
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override {}
+
+private:
+    atomic<uint64_t>& _sentBytes;
+    atomic<int32_t>& _connected;
+};
+
+// 받은 데이터를 버리기만 하는 상대편 소켓
+struct BenchDrainPeer
+{
+    BenchDrainPeer(asio::io_context& ioc) : socket(ioc) {}
+
+    void ReadLoop()
+    {
+        socket.async_read_some(asio::buffer(buffer), [this](const std::error_code& error, size_t)
+            {
+                if (!error)
+                    ReadLoop();
+            });
+    }
+
+    asio::ip::tcp::socket socket;
+    array<BYTE, 256> buffer;
+};
+
+// 루프백으로 연결한 구독자 subscriberCount명에게 64바이트 패킷을 발행 (연산 하나 = 발행 하나가 모든 구독자의 소켓으로 나갈 때까지)
+// churn이면 발행할 때마다 구독자 하나를 해제했다가 다시 구독
+static bool BenchPubSubCase(BenchRunner& runner, int32_t subscriberCount, bool churn)
+{
+    string name = string("PubSub::Publish(") + to_string(subscriberCount) + (churn ? " subs, churn)" : " subs)");
+    if (!runner.Enabled(name))
+        return true;
+
+#ifndef _WIN32
+    // 구독자마다 양쪽 소켓 두 개가 필요
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < static_cast<rlim_t>(subscriberCount) * 2 + 64) {
+        cout << left << setw(44) << name << right << "  skipped: needs " << subscriberCount * 2 + 64
+            << " file descriptors (ulimit -n is " << limit.rlim_cur << ")" << endl;
+        return false;
+    }
+#endif
+
+    // 임시 포트는 목적지 주소마다 따로 쓰이므로 리스너를 나눠 포트가 모자라지 않게 함
+    enum { SESSIONS_PER_LISTENER = 20000, IO_THREADS = 2, PACKET_SIZE = 64 };
+
+    asio::io_context ioc;
+    auto work = asio::make_work_guard(ioc);
+    PubSub pubSub(ioc, IO_THREADS);
+
+    atomic<uint64_t> sentBytes = 0;
+    atomic<int32_t> connected = 0;
+    vector<SessionRef> sessions;
+    vector<shared_ptr<ClientService>> services;
+    vector<unique_ptr<asio::ip::tcp::acceptor>> acceptors;
+    mutex peerLock;
+    vector<unique_ptr<BenchDrainPeer>> peers;
+
+    function<void(asio::ip::tcp::acceptor&)> acceptLoop = [&](asio::ip::tcp::acceptor& acceptor)
+        {
+            auto peer = make_unique<BenchDrainPeer>(ioc);
+            BenchDrainPeer* pending = peer.get();
+            {
+                lock_guard<mutex> guard(peerLock);
+                peers.push_back(move(peer));
+            }
+            acceptor.async_accept(pending->socket, [&, pending](const std::error_code& error)
+                {
+                    if (error)
+                        return;
+                    pending->ReadLoop();
+                    acceptLoop(acceptor);
+                });
+        };
+
+    vector<thread> ioThreads;
+    for (int32_t i = 0; i < IO_THREADS; i++)
+        ioThreads.emplace_back([&ioc]() { ioc.run(); });
+
+    auto shutdown = [&]()
+        {
+            for (auto& service : services)
+                service->CloseService();
+            std::error_code ec;
+            for (auto& acceptor : acceptors)
+                acceptor->close(ec);
+            {
+                lock_guard<mutex> guard(peerLock);
+                for (auto& peer : peers)
+                    peer->socket.close(ec);
+            }
+            work.reset();
+            ioc.stop();
+            for (thread& ioThread : ioThreads)
+                ioThread.join();
+        };
+
+    // 1. 구독자 연결
+    for (int32_t begin = 0; begin < subscriberCount; begin += SESSIONS_PER_LISTENER)
+    {
+        int32_t count = min<int32_t>(SESSIONS_PER_LISTENER, subscriberCount - begin);
+        acceptors.push_back(make_unique<asio::ip::tcp::acceptor>(ioc, asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"), 0)));
+        acceptLoop(*acceptors.back());
+
+        auto service = make_shared<ClientService>(
+            ioc,
+            NetAddress(acceptors.back()->local_endpoint()),
+            [&](asio::io_context& ioc)
+            {
+                auto session = make_shared<BenchSubscriberSession>(ioc, sentBytes, connected);
+                sessions.push_back(session);
+                return session;
+            },
+            count);
+        services.push_back(service);
+        service->Start();
+    }
+
+    // 더 이상 연결이 늘지 않으면 포기
+    int32_t lastConnected = -1;
+    while (connected.load() < subscriberCount)
+    {
+        this_thread::sleep_for(chrono::seconds(1));
+        if (connected.load() == lastConnected) {
+            cout << left << setw(44) << name << right << "  skipped: only " << lastConnected
+                << " of " << subscriberCount << " subscribers connected" << endl;
+            shutdown();
+            return false;
+        }
+        lastConnected = connected.load();
+    }
+
+    // 2. 구독
+    const PubSub::TopicKey topic = PubSub::MakeTopicKey("bench");
+    for (const SessionRef& session : sessions)
+        pubSub.Subscribe(topic, session);
+    while (pubSub.GetSubscriptionCount() < subscriberCount)
+        this_thread::sleep_for(chrono::milliseconds(1));
+
+    SendBufferRef sendBuffer = GSendBufferManager->Open(PACKET_SIZE);
+    PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
+    header->size = PACKET_SIZE;
+    header->id = 1;
+    sendBuffer->Close(PACKET_SIZE);
+
+    // 3. 측정 (발행 수와 상관없이 한 번 측정에 전달이 20만 건 정도가 되도록 반복 횟수를 줄임)
+    atomic<uint64_t> submitted = 0;
+    atomic<uint64_t> churnIndex = 0;
+    runner.Run(name, [&](int32_t, uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                if (churn)
+                {
+                    const SessionRef& session = sessions[churnIndex++ % sessions.size()];
+                    pubSub.Unsubscribe(topic, session);
+                    pubSub.Subscribe(topic, session);
+                }
+                pubSub.Publish(topic, sendBuffer);
+            }
+
+            uint64_t target = submitted += iterations;
+            while (pubSub.GetPublishCount() < target)
+                this_thread::yield();
+            while (sentBytes.load() < pubSub.GetDeliveryCount() * PACKET_SIZE)
+                this_thread::yield();
+        },
+        200000.0 / subscriberCount / runner.Config().ops);
+
+    // 4. 정리
+    shutdown();
+    return true;
+}
+
+static void BenchPubSub(BenchRunner& runner)
+{
+    for (int32_t subscriberCount : { 1, 100, 1000, 10000, 100000 })
+    {
+        if (!BenchPubSubCase(runner, subscriberCount, false))
+            break;
+    }
+
+    BenchPubSubCase(runner, 1000, true);
+}
+
+/*----------------
+    AoiGrid
+-----------------*/
+// 밀도를 고정하고 월드 크기만 키운 맵에서 모든 엔티티가 매 틱 조금씩 움직임 (연산 하나 = 엔티티 하나의 한 틱)
+// 틱 비용이 밀도에만 비례하면 엔티티 수가 늘어도 ns/op가 거의 같음
+class AoiBenchWorld
+{
+public:
+    static constexpr float VIEW_RANGE = 50.0f;
+    static constexpr float STEP = 5.0f;
+
+    AoiBenchWorld(uint32_t entityCount, float side) : _grid(VIEW_RANGE, VIEW_RANGE), _side(side)
+    {
+        _xs.resize(entityCount);
+        _ys.resize(entityCount);
+        for (uint32_t i = 0; i < entityCount; i++)
+        {
+            _xs[i] = Random() * side;
+            _ys[i] = Random() * side;
+            _grid.AddObserver(i, _xs[i], _ys[i]);
+        }
+        _grid.Update(_events);
+        _grid.FlushMoves(1);
+        _events.clear();
+    }
+
+    uint64_t Tick()
+    {
+        for (uint32_t i = 0; i < _xs.size(); i++)
+        {
+            _xs[i] = clamp(_xs[i] + (Random() * 2 - 1) * STEP, 0.0f, _side);
+            _ys[i] = clamp(_ys[i] + (Random() * 2 - 1) * STEP, 0.0f, _side);
+            _grid.Move(i, _xs[i], _ys[i]);
+        }
+
+        _events.clear();
+        _grid.Update(_events);
+        _grid.FlushMoves(1);
+        return _events.size();
+    }
+
+    uint32_t EntityCount() const { return static_cast<uint32_t>(_xs.size()); }
+
+private:
+    float Random()
+    {
+        _seed = _seed * 1103515245 + 12345;
+        return static_cast<float>((_seed >> 8) & 0xFFFFFF) / 0x1000000;
+    }
+
+    AoiGrid _grid;
+    float _side;
+    vector<float> _xs;
+    vector<float> _ys;
+    vector<AoiEvent> _events;
+    uint32_t _seed = 12345;
+};
+
+static void BenchAoiGrid(BenchRunner& runner)
+{
+    // 시야 원 안에 평균 30명 정도
+    const double density = 30.0 / (3.14159 * AoiBenchWorld::VIEW_RANGE * AoiBenchWorld::VIEW_RANGE);
+
+    for (uint32_t entityCount : { 1000u, 10000u, 100000u })
+    {
+        float side = static_cast<float>(sqrt(entityCount / density));
+        auto worlds = make_shared<vector<unique_ptr<AoiBenchWorld>>>(runner.Config().maxThreads);
+
+        // 월드는 스레드마다 하나 (AoiGrid는 한 스레드에서만 사용), 첫 호출(예열)에서 만듦
+        runner.Run("AoiGrid tick per entity(" + to_string(entityCount) + ")", [worlds, entityCount, side](int32_t threadIndex, uint64_t iterations)
+            {
+                unique_ptr<AoiBenchWorld>& world = (*worlds)[threadIndex];
+                if (world == nullptr)
+                    world = make_unique<AoiBenchWorld>(entityCount, side);
+
+                uint64_t events = 0;
+                for (uint64_t done = 0; done < iterations; done += world->EntityCount())
+                    events += world->Tick();
+                Consume(events);
+            },
+            0.2);
+    }
+}
+
+/*----------------
+    SnapshotRing
+-----------------*/
+// 엔티티 일부가 매 프레임 필드 두 개씩 바뀌고, 클라이언트들의 확인이 1~4프레임 늦은 상황 (연산 하나 = 엔티티 하나를 기준 하나에 대해 인코딩)
+// 같은 기준은 캐시되므로 프레임마다 기준 4개만 인코딩
+class SnapshotBenchWorld
+{
+public:
+    static constexpr uint32_t FIELD_COUNT = 8;
+    static constexpr uint32_t BASE_COUNT = 4;
+    static constexpr uint32_t CHANGE_PERCENT = 5;
+
+    SnapshotBenchWorld(uint32_t entityCount) : _ring(FIELD_COUNT, entityCount), _entityCount(entityCount)
+    {
+        for (uint32_t slot = 0; slot < entityCount; slot++)
+        {
+            for (uint32_t field = 0; field < FIELD_COUNT; field++)
+                _ring.Set(slot, field, Random());
+        }
+
+        // 모든 기준 프레임이 링에 있는 상태에서 시작 (첫 프레임들의 전체 상태 전송은 측정에서 제외)
+        for (uint32_t i = 0; i <= BASE_COUNT; i++)
+            _ring.Commit();
+    }
+
+    uint64_t Tick()
+    {
+        for (uint32_t i = 0; i < _entityCount * CHANGE_PERCENT / 100; i++)
+        {
+            uint32_t slot = Random() % _entityCount;
+            _ring.Set(slot, 0, Random());
+            _ring.Set(slot, 1, Random());
+        }
+        uint32_t frame = _ring.Commit();
+
+        uint64_t bytes = 0;
+        for (uint32_t lag = 1; lag <= BASE_COUNT; lag++)
+        {
+            for (const SendBufferRef& packet : _ring.EncodeDelta(frame > lag ? frame - lag : 0, 1))
+                bytes += packet->WriteSize();
+        }
+        _deltaBytes += bytes;
+        _frames++;
+        return bytes;
+    }
+
+    // 전체 상태 크기 (확인이 없는 클라이언트가 받는 크기)
+    uint64_t FullBytes()
+    {
+        uint64_t bytes = 0;
+        for (const SendBufferRef& packet : _ring.EncodeDelta(0, 1))
+            bytes += packet->WriteSize();
+        return bytes;
+    }
+
+    double AverageDeltaBytes() const { return _frames == 0 ? 0.0 : static_cast<double>(_deltaBytes) / _frames / BASE_COUNT; }
+    uint32_t EntityCount() const { return _entityCount; }
+
+private:
+    uint32_t Random()
+    {
+        _seed = _seed * 1103515245 + 12345;
+        return _seed >> 8;
+    }
+
+    SnapshotRing _ring;
+    uint32_t _entityCount;
+    uint32_t _seed = 12345;
+    uint64_t _deltaBytes = 0;
+    uint64_t _frames = 0;
+};
+
+static void BenchSnapshot(BenchRunner& runner)
+{
+    for (uint32_t entityCount : { 1000u, 10000u })
+    {
+        string name = "SnapshotRing delta per entity(" + to_string(entityCount) + ")";
+        if (!runner.Enabled(name))
+            continue;
+
+        auto worlds = make_shared<vector<unique_ptr<SnapshotBenchWorld>>>(runner.Config().maxThreads);
+        runner.Run(name, [worlds, entityCount](int32_t threadIndex, uint64_t iterations)
+            {
+                unique_ptr<SnapshotBenchWorld>& world = (*worlds)[threadIndex];
+                if (world == nullptr)
+                    world = make_unique<SnapshotBenchWorld>(entityCount);
+
+                uint64_t bytes = 0;
+                for (uint64_t done = 0; done < iterations; done += world->EntityCount() * SnapshotBenchWorld::BASE_COUNT)
+                    bytes += world->Tick();
+                Consume(bytes);
+            },
+            0.2);
+
+        // 클라이언트 하나가 프레임마다 받는 크기 비교
+        SnapshotBenchWorld& world = *(*worlds)[0];
+        double delta = world.AverageDeltaBytes();
+        uint64_t full = world.FullBytes();
+        cout << left << setw(44) << name << right << "  bytes/client/frame: delta " << fixed << setprecision(0) << delta
+            << ", full " << full << " (" << setprecision(1) << full / max(delta, 1.0) << "x smaller)" << endl;
+    }
+}
+
+static void PrintUsage()
+{
+    cout << "Usage: Benchmark [options]" << endl;
+    cout << "  --threads <n>     Maximum thread count; runs 1, 2, 4, ... n (default: hardware threads, up to 8)" << endl;
+    cout << "  --ops <n>         Operations per thread per case (default 1000000)" << endl;
+    cout << "  --filter <text>   Run only cases whose name contains text" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig config;
+    config.maxThreads = static_cast<int32_t>(clamp(thread::hardware_concurrency(), 1u, 8u));
+
+    for (int i = 1; i < argc; i++)
+    {
+        string key = argv[i];
+        if (i + 1 >= argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        string value = argv[++i];
+        try {
+            if (key == "--threads") config.maxThreads = max(1, stoi(value));
+            else if (key == "--ops") config.ops = max<uint64_t>(1, stoull(value));
+            else if (key == "--filter") config.filter = value;
+            else {
+                PrintUsage();
+                return 1;
+            }
+        }
+        catch (const exception&) {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    cout << "=== Core Benchmark ===" << endl;
+    cout << "Max threads: " << config.maxThreads << ", ops per thread: " << config.ops << endl;
+    cout << "ns/op is per thread; Mops/s is the total across threads" << endl << endl;
+
+    BenchRunner runner(config);
+    BenchRunner::PrintHeader();
+
+    BenchMemoryPool(runner);
+    BenchObjectPool(runner);
+    BenchSendBuffer(runner);
+    BenchRecvBuffer(runner);
+    BenchTracer(runner);
+    BenchPacketFraming(runner);
+    BenchSessionSend(runner);
+    BenchPubSub(runner);
+    BenchAoiGrid(runner);
+    BenchSnapshot(runner);
+
+    return 0;
+}
@@ -3,66 +3,29 @@
 #include "Service.h"
 #include "CorePch.h"
 #include "FileTransfer.h"
+#include "LatencyHistogram.h"
+#include "Tracer.h"
 #include "ThreadManager.h"
+#include "AoiGrid.h"
+#include "Snapshot.h"
+#include "Protocol.h"
+#include <iomanip>
 
 CoreGlobal Core;
 
 using namespace std;
 
-// Ŷ ID  - FileTransfer.h FileTransferPacketId  ߱
-enum PacketId
+// ׷   (ũ)
+static void PrintLatencyPercentiles(const char* name, const LatencyHistogram& histogram)
 {
-    PKT_C_CHAT = 1,
-    PKT_S_CHAT = 2,
-
-    //  ׽Ʈ Ŷ ID ߰
-    PKT_C_STRESS_START = 3,    // Ŭ̾Ʈ   ׽Ʈ  û
-    PKT_S_STRESS_START = 4,    //  Ŭ̾Ʈ  ׽Ʈ  Ȯ
-    PKT_C_STRESS_DATA = 5,     // Ŭ̾Ʈ   ׽Ʈ 
-    PKT_S_STRESS_DATA = 6,     //    ׽Ʈ 
-    PKT_C_STRESS_END = 7,      // Ŭ̾Ʈ   ׽Ʈ  ˸
-    PKT_S_STRESS_RESULT = 8,   //    ׽Ʈ 
-
-    //    Ŷ ID (FileTransfer.h FileTransferPacketId ġŴ)
-    PKT_FILE_REQUEST = static_cast<uint16_t>(FileTransferPacketId::FileTransferRequest),
-    PKT_FILE_RESPONSE = static_cast<uint16_t>(FileTransferPacketId::FileTransferResponse),
-    PKT_FILE_DATA = static_cast<uint16_t>(FileTransferPacketId::FileDataChunk),
-    PKT_FILE_COMPLETE = static_cast<uint16_t>(FileTransferPacketId::FileTransferComplete),
-    PKT_FILE_ERROR = static_cast<uint16_t>(FileTransferPacketId::FileTransferError)
-};
-
-struct ChatData
-{
-    char msg[100]; // ޽ ִ 99 + null
-};
-
-//  ׽Ʈ  û Ŷ
-struct StressTestStartData
-{
-    uint32_t messageCount;     //  ޽ 
-    uint32_t messageSize;      // ޽ ũ (Ʈ)
-    uint32_t intervalMs;       //   (и)
-};
-
-//  ׽Ʈ  Ŷ
-struct StressTestData
-{
-    uint32_t sequenceNumber;   // ޽ 
-    uint32_t timestamp;        //  ð (и)
-    char data[4000];           //   ( ũ )
-};
-
-//  ׽Ʈ  Ŷ
-struct StressTestResult
-{
-    uint32_t totalMessages;     //  ޽ 
-    uint32_t receivedMessages;  //  ޽ 
-    uint32_t lostMessages;      // սǵ ޽ 
-    float avgLatencyMs;         //   ð (и)
-    float maxLatencyMs;         // ִ  ð (и)
-    float minLatencyMs;         // ּ  ð (и)
-    float dataRateMBps;         //  ۷ (MB/s)
-};
+    cout << fixed << setprecision(1) << name << " (us): p50 " << histogram.Percentile(50.0) / 1000.0
+        << ", p90 " << histogram.Percentile(90.0) / 1000.0
+        << ", p99 " << histogram.Percentile(99.0) / 1000.0
+        << ", p99.9 " << histogram.Percentile(99.9) / 1000.0
+        << ", p99.99 " << histogram.Percentile(99.99) / 1000.0
+        << ", max " << histogram.Max() / 1000.0
+        << " (" << histogram.TotalCount() << " samples)" << endl;
+}
 
 class ClientSession : public FilePacketSession
 {
@@ -71,14 +34,14 @@ public:
         : FilePacketSession(ioc)
         , _timer(ioc)
         , _stressTestActive(false)
-        , _stressTestTimer(ioc)
+        , _snapshots(SNAPSHOT_FIELD_COUNT, MAX_SNAPSHOT_PLAYERS)
     {
         //   丮 
         SetFileReceiveDirectory("./client_received_files");
 
         //   Ϸ ݹ 
         GetFileTransferManager()->SetTransferCompleteCallback(
-            [this](uint32_t connectionId, bool success, const std::string& filePath) {
+            [this](uint32_t transferId, bool success, const std::string& filePath) {
                 if (success) {
                     cout << "File transfer completed: " << filePath << endl;
 
@@ -100,105 +63,68 @@ public:
     {
         PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
 
-        if (header->id == PKT_S_CHAT)
+        //    Ŷ θ Ŭ(FilePacketSession) ó
+        if (IsFileTransferPacket(header->id))
         {
-            ChatData* chatData = reinterpret_cast<ChatData*>(buffer + sizeof(PacketHeader));
-            cout << "Server Says: " << chatData->msg << endl;
+            FilePacketSession::OnRecvPacket(buffer, len);
+            return;
         }
-        //  ׽Ʈ  Ȯ Ŷ
-        else if (header->id == PKT_S_STRESS_START)
-        {
-            cout << "Server acknowledged stress test start" << endl;
-            _stressTestActive = true;
 
-            // ׽Ʈ  ҷ
-            _stressTestCurrentSeq = 0;
-            StartStressTest();
-        }
-        //  ׽Ʈ  Ŷ (  )
-        else if (header->id == PKT_S_STRESS_DATA)
-        {
-            if (!_stressTestActive) return;
-
-            StressTestData* stressData = reinterpret_cast<StressTestData*>(buffer + sizeof(PacketHeader));
-            _stressTestReceivedCount++;
-
-            //  ð RTT 
-            uint32_t currentTimeMs = static_cast<uint32_t>(chrono::duration_cast<chrono::milliseconds>(
-                chrono::steady_clock::now().time_since_epoch()).count());
-            uint32_t rtt = currentTimeMs - stressData->timestamp;
-
-            //  Ʈ
-            _totalRtt += rtt;
-            _maxRtt = max(_maxRtt, rtt);
-            _minRtt = min(_minRtt, rtt);
-
-            //  Ȳ Ʈ (10% )
-            uint32_t progress = (_stressTestReceivedCount * 100) / _stressTestConfig.messageCount;
-            if (progress % 10 == 0 && progress != _lastReportedProgress) {
-                cout << "Stress test progress: " << progress << "% ("
-                    << _stressTestReceivedCount << "/" << _stressTestConfig.messageCount
-                    << " messages, Avg RTT: " << (_totalRtt / _stressTestReceivedCount) << "ms)" << endl;
-                _lastReportedProgress = progress;
-            }
+        if (GetDispatcher().Dispatch(*this, buffer, len) == Dispatcher::Result::Invalid)
+            cout << "Invalid " << FindPacketInfo(header->id)->name << " packet (" << len << " bytes)" << endl;
+    }
 
-            //  ޽ ޾ 
-            if (_stressTestReceivedCount >= _stressTestConfig.messageCount) {
-                EndStressTest();
-            }
-        }
-        //  ׽Ʈ  Ŷ
-        else if (header->id == PKT_S_STRESS_RESULT)
-        {
-            StressTestResult* result = reinterpret_cast<StressTestResult*>(buffer + sizeof(PacketHeader));
+    void SendChatPacket(const char* msg)
+    {
+        // SendBuffer ٷ Ŷ 
+        PacketWriter<PKT_C_CHAT> writer;
+        if (!writer.IsValid())
+            return;
 
-            cout << "\n===== Stress Test Results =====" << endl;
-            cout << "Total messages: " << result->totalMessages << endl;
-            cout << "Received messages: " << result->receivedMessages << endl;
-            cout << "Lost messages: " << result->lostMessages << endl;
-            cout << "Average latency: " << result->avgLatencyMs << " ms" << endl;
-            cout << "Min latency: " << result->minLatencyMs << " ms" << endl;
-            cout << "Max latency: " << result->maxLatencyMs << " ms" << endl;
-            cout << "Data rate: " << result->dataRateMBps << " MB/s" << endl;
-            cout << "==============================" << endl;
+        cout << "Client Says: " << msg << endl;
+        PacketCopyString(writer->msg, msg);
 
-            _stressTestActive = false;
-        }
-        //    Ŷ θ Ŭ(FilePacketSession) ó
-        else if (header->id == PKT_FILE_REQUEST ||
-            header->id == PKT_FILE_RESPONSE ||
-            header->id == PKT_FILE_DATA ||
-            header->id == PKT_FILE_COMPLETE ||
-            header->id == PKT_FILE_ERROR)
-        {
-            // θ Ŭ OnRecvPacket ȣ
-            FilePacketSession::OnRecvPacket(buffer, len);
-        }
+        Send(writer.Finish());
     }
 
-    void SendChatPacket(const char* msg)
+    //  ȿ ġ ̵
+    void SendMove(float x, float y)
     {
-        // 1. SendBuffer Ҵ û
-        SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader) + sizeof(ChatData));
-        if (sendBuffer == nullptr)
+        PacketWriter<PKT_C_MOVE> writer;
+        if (!writer.IsValid())
             return;
 
-        // 2. ۿ  
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-        ChatData* chatData = reinterpret_cast<ChatData*>(sendBuffer->Buffer() + sizeof(PacketHeader));
+        writer->x = x;
+        writer->y = y;
+        Send(writer.Finish());
+    }
 
-        cout << "Client Says: " << msg << endl;
+    //    ÷̾  
+    void PrintPlayers()
+    {
+        lock_guard<mutex> lock(_snapshotLock);
+        cout << "Snapshot frame " << _snapshots.GetFrame() << endl;
+        for (uint32_t slot = 0; slot < MAX_SNAPSHOT_PLAYERS; slot++)
+        {
+            if (!_snapshots.IsAlive(slot))
+                continue;
 
-        // 3.   ä
-        header->size = sizeof(PacketHeader) + sizeof(ChatData);
-        header->id = PKT_C_CHAT;
-        strcpy_s(chatData->msg, msg);
+            cout << "  Player " << _snapshots.Get(slot, SNAPSHOT_FIELD_ID) << " at ("
+                << _snapshots.GetFloat(slot, SNAPSHOT_FIELD_X) << ", " << _snapshots.GetFloat(slot, SNAPSHOT_FIELD_Y) << ")" << endl;
+        }
+    }
 
-        // 4.  ݱ (  ũ )
-        sendBuffer->Close(header->size);
+    //  // (message   )
+    template<uint16 Id>
+    void SendTopicPacket(const string& topic, const string& message = "")
+    {
+        PacketWriter<Id> writer(static_cast<uint32_t>(message.size()));
+        if (!writer.IsValid())
+            return;
 
-        // 5.  û
-        Send(sendBuffer);
+        PacketCopyString(writer->topic, topic);
+        memcpy(writer.Tail(), message.data(), message.size());
+        Send(writer.Finish());
     }
 
     //    ޼
@@ -228,13 +154,8 @@ public:
         );
 
         if (result) {
-            std::cout << "[Client] File transfer initiated successfully" << std::endl;
-
-            // ù ° ûũ ٷ  ( ûũ  Լ  ڵ ۵)
-            if (!GetFileTransferManager()->SendNextChunk(shared_from_this(), 1)) {
-                std::cerr << "[Client] Failed to send first chunk" << std::endl;
-                return false;
-            }
+            //   ûũ  ϸ ش  ۵ (̾ޱ)
+            std::cout << "[Client] File transfer initiated, waiting for server response" << std::endl;
         }
         else {
             std::cerr << "[Client] Failed to initiate file transfer" << std::endl;
@@ -243,6 +164,39 @@ public:
         return result;
     }
 
+    // 丮   ޼ (    ϸ û/ ְ ʵ ϳ Ʈ )
+    bool SendDirectory(const std::string& dirPath)
+    {
+        std::error_code ec;
+        if (!fs::is_directory(dirPath, ec)) {
+            std::cout << "[Client] Error: Directory does not exist: " << dirPath << std::endl;
+            return false;
+        }
+
+        std::cout << "\n[Client] Starting directory transfer: " << dirPath << std::endl;
+
+        bool result = GetFileTransferManager()->StartPackSend(shared_from_this(), dirPath);
+        if (result) {
+            std::cout << "[Client] Directory transfer initiated, waiting for server response" << std::endl;
+        }
+        else {
+            std::cerr << "[Client] Failed to initiate directory transfer" << std::endl;
+        }
+
+        return result;
+    }
+
+    //   丮  ٿε ( 丮 )
+    bool DownloadFile(const std::string& filename)
+    {
+        bool result = GetFileTransferManager()->StartFileDownload(shared_from_this(), filename, "./client_received_files");
+        if (!result) {
+            std::cerr << "[Client] Failed to request download: " << filename << std::endl;
+        }
+
+        return result;
+    }
+
     //  ׽Ʈ  û
     void RequestStressTest(uint32_t messageCount, uint32_t messageSize, uint32_t intervalMs)
     {
@@ -264,93 +218,220 @@ public:
         //  ʱȭ
         _stressTestCurrentSeq = 0;
         _stressTestReceivedCount = 0;
-        _totalRtt = 0;
-        _maxRtt = 0;
-        _minRtt = UINT32_MAX;
+        _rttHistogram.Reset();
         _lastReportedProgress = 0;
 
-        // 1. SendBuffer Ҵ
-        SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader) + sizeof(StressTestStartData));
-        if (sendBuffer == nullptr) {
+        // SendBuffer ٷ û Ŷ 
+        PacketWriter<PKT_C_STRESS_START> writer;
+        if (!writer.IsValid()) {
             cout << "Failed to allocate send buffer" << endl;
             return;
         }
 
-        // 2. ۿ  
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-        StressTestStartData* startData = reinterpret_cast<StressTestStartData*>(sendBuffer->Buffer() + sizeof(PacketHeader));
-
-        // 3.   ä
-        header->size = sizeof(PacketHeader) + sizeof(StressTestStartData);
-        header->id = PKT_C_STRESS_START;
-        startData->messageCount = messageCount;
-        startData->messageSize = messageSize;
-        startData->intervalMs = intervalMs;
-
-        // 4.  ݱ
-        sendBuffer->Close(header->size);
-
-        // 5. 
-        Send(sendBuffer);
+        writer->messageCount = messageCount;
+        writer->messageSize = messageSize;
+        writer->intervalMs = intervalMs;
+        Send(writer.Finish());
 
         cout << "Requested stress test: " << messageCount << " messages, "
             << messageSize << " bytes each, " << intervalMs << "ms interval" << endl;
     }
 
 private:
-    //  ׽Ʈ  
-    void StartStressTest()
+    using Dispatcher = PacketDispatcher<ClientSession>;
+
+    static const Dispatcher& GetDispatcher()
     {
-        // ù ° ޽ 
-        SendStressTestData();
+        static const Dispatcher SDispatcher = []()
+        {
+            Dispatcher dispatcher;
+            dispatcher.Register<PKT_S_CHAT, &ClientSession::HandleChat>();
+            dispatcher.Register<PKT_S_PUBLISH, &ClientSession::HandlePublish>();
+            dispatcher.Register<PKT_S_ENTER, &ClientSession::HandleEnter>();
+            dispatcher.Register<PKT_S_LEAVE, &ClientSession::HandleLeave>();
+            dispatcher.Register<PKT_S_MOVE_BATCH, &ClientSession::HandleMoveBatch>();
+            dispatcher.Register<PKT_S_SNAPSHOT, &ClientSession::HandleSnapshot>();
+            dispatcher.Register<PKT_S_STRESS_START, &ClientSession::HandleStressStart>();
+            dispatcher.Register<PKT_S_STRESS_DATA, &ClientSession::HandleStressData>();
+            dispatcher.Register<PKT_S_STRESS_RESULT, &ClientSession::HandleStressResult>();
+            return dispatcher;
+        }();
+        return SDispatcher;
     }
 
-    void SendStressTestData()
+    void HandleChat(const PacketReader<PKT_S_CHAT>& packet)
     {
-        if (!_stressTestActive || _stressTestCurrentSeq >= _stressTestConfig.messageCount) {
-            return;
-        }
+        cout << "Server Says: " << PacketString(packet->msg) << endl;
+    }
+
+    //   ޽
+    void HandlePublish(const PacketReader<PKT_S_PUBLISH>& packet)
+    {
+        cout << "[" << PacketString(packet->topic) << "] "
+            << string(reinterpret_cast<const char*>(packet.Tail()), packet.TailSize()) << endl;
+    }
 
-        // 1. SendBuffer Ҵ
-        size_t packetSize = sizeof(PacketHeader) + sizeof(StressTestData);
-        SendBufferRef sendBuffer = GSendBufferManager->Open(packetSize);
-        if (sendBuffer == nullptr) {
-            cout << "Failed to allocate send buffer for stress test data" << endl;
+    // þ /Ż
+    void HandleEnter(const PacketReader<PKT_S_ENTER>& packet)
+    {
+        cout << "Player " << packet->id << " entered view at (" << packet->x << ", " << packet->y << ")" << endl;
+    }
+
+    void HandleLeave(const PacketReader<PKT_S_LEAVE>& packet)
+    {
+        cout << "Player " << packet->id << " left view" << endl;
+    }
+
+    // ֺ ̵  (  þ  ƼƼ   )
+    void HandleMoveBatch(const PacketReader<PKT_S_MOVE_BATCH>& packet)
+    {
+        if (packet.TailSize() < sizeof(AoiMoveBatchHeader))
             return;
+
+        const AoiMoveBatchHeader* batch = reinterpret_cast<const AoiMoveBatchHeader*>(packet.Tail());
+        const AoiMoveEntry* entries = reinterpret_cast<const AoiMoveEntry*>(batch + 1);
+        uint32_t count = min<uint32_t>(batch->count, (packet.TailSize() - sizeof(AoiMoveBatchHeader)) / sizeof(AoiMoveEntry));
+        for (uint32_t i = 0; i < count; i++)
+            cout << "Player " << entries[i].id << " moved to (" << entries[i].x << ", " << entries[i].y << ")" << endl;
+    }
+
+    // ÷̾   Ÿ -  ϼǸ Ȯ   Ÿ   
+    void HandleSnapshot(const PacketReader<PKT_S_SNAPSHOT>& packet)
+    {
+        uint32_t completedFrame = 0;
+        {
+            lock_guard<mutex> lock(_snapshotLock);
+            if (_snapshots.Apply(packet.Tail(), static_cast<int32_t>(packet.TailSize())))
+                completedFrame = _snapshots.GetFrame();
         }
 
-        // 2. ۿ  
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-        StressTestData* stressData = reinterpret_cast<StressTestData*>(sendBuffer->Buffer() + sizeof(PacketHeader));
+        if (completedFrame != 0)
+            SendSnapshotAck(completedFrame);
+    }
 
-        // 3.   ä
-        header->size = packetSize;
-        header->id = PKT_C_STRESS_DATA;
+    //  ׽Ʈ  Ȯ Ŷ
+    void HandleStressStart(const PacketReader<PKT_S_STRESS_START>& packet)
+    {
+        cout << "Server acknowledged stress test start" << endl;
+        _stressTestActive = true;
 
-        stressData->sequenceNumber = ++_stressTestCurrentSeq;
-        stressData->timestamp = static_cast<uint32_t>(chrono::duration_cast<chrono::milliseconds>(
+        // ׽Ʈ  ҷ
+        _stressTestCurrentSeq = 0;
+        StartStressTest();
+    }
+
+    //  ׽Ʈ  Ŷ (  )
+    void HandleStressData(const PacketReader<PKT_S_STRESS_DATA>& packet)
+    {
+        if (!_stressTestActive) return;
+
+        _stressTestReceivedCount++;
+
+        //  ð RTT 
+        uint64_t currentTimeNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
             chrono::steady_clock::now().time_since_epoch()).count());
 
-        // ׽Ʈ  ä
-        for (uint32_t i = 0; i < _stressTestConfig.messageSize && i < 4000; ++i) {
-            stressData->data[i] = static_cast<char>((i + _stressTestCurrentSeq) % 256);
+        //  Ʈ
+        _rttHistogram.Record(static_cast<int64_t>(currentTimeNs - packet->timestampNs));
+
+        //  Ȳ Ʈ (10% )
+        uint32_t progress = (_stressTestReceivedCount * 100) / _stressTestConfig.messageCount;
+        if (progress % 10 == 0 && progress != _lastReportedProgress) {
+            cout << "Stress test progress: " << progress << "% ("
+                << _stressTestReceivedCount << "/" << _stressTestConfig.messageCount
+                << " messages, Avg RTT: " << fixed << setprecision(1) << _rttHistogram.Mean() / 1000.0 << "us)" << endl;
+            _lastReportedProgress = progress;
         }
 
-        // 4.  ݱ
-        sendBuffer->Close(packetSize);
+        //  ޽ ޾ 
+        if (_stressTestReceivedCount >= _stressTestConfig.messageCount) {
+            EndStressTest();
+        }
+    }
 
-        // 5. 
-        Send(sendBuffer);
+    //  ׽Ʈ  Ŷ
+    void HandleStressResult(const PacketReader<PKT_S_STRESS_RESULT>& packet)
+    {
+        const StressTestResult& result = packet.Get();
+
+        cout << "\n===== Stress Test Results =====" << endl;
+        cout << "Total messages: " << result.totalMessages << endl;
+        cout << "Received messages: " << result.receivedMessages << endl;
+        cout << "Lost messages: " << result.lostMessages << endl;
+        cout << fixed << setprecision(1);
+        cout << "Average latency: " << result.avgLatencyNs / 1000.0 << " us" << endl;
+        cout << "Min latency: " << result.minLatencyNs / 1000.0 << " us" << endl;
+        cout << "Max latency: " << result.maxLatencyNs / 1000.0 << " us" << endl;
+        cout << "Server latency (us): p50 " << result.p50LatencyNs / 1000.0
+            << ", p90 " << result.p90LatencyNs / 1000.0
+            << ", p99 " << result.p99LatencyNs / 1000.0
+            << ", p99.9 " << result.p999LatencyNs / 1000.0
+            << ", p99.99 " << result.p9999LatencyNs / 1000.0 << endl;
+        cout << "Data rate: " << result.dataRateMBps << " MB/s" << endl;
+        PrintLatencyPercentiles("Client RTT", _rttHistogram);
+
+        // ̹       
+        LatencyHistogram serverHistogram;
+        if (result.histogramSize <= packet.TailSize() &&
+            serverHistogram.Deserialize(packet.Tail(), result.histogramSize)) {
+            _serverLatencyAllRuns.Merge(serverHistogram);
+        }
+        _rttAllRuns.Merge(_rttHistogram);
+        _stressTestRuns++;
 
-        //  ޽ 
-        if (_stressTestCurrentSeq < _stressTestConfig.messageCount) {
-            _stressTestTimer.expires_after(chrono::milliseconds(_stressTestConfig.intervalMs));
-            _stressTestTimer.async_wait([this](const std::error_code& ec) {
-                if (!ec && _stressTestActive) {
-                    SendStressTestData();
-                }
-                });
+        if (_stressTestRuns > 1) {
+            cout << "---- All " << _stressTestRuns << " runs ----" << endl;
+            PrintLatencyPercentiles("Server latency", _serverLatencyAllRuns);
+            PrintLatencyPercentiles("Client RTT", _rttAllRuns);
+        }
+        cout << "==============================" << endl;
+
+        _stressTestActive = false;
+    }
+
+    //  ׽Ʈ  
+    void StartStressTest()
+    {
+        Spawn([this]() { return RunStressTest(); });
+    }
+
+    // ޽  ݸŭ ⸦ ݺϴ ڷƾ
+    asio::awaitable<void> RunStressTest()
+    {
+        while (_stressTestActive && _stressTestCurrentSeq < _stressTestConfig.messageCount)
+        {
+            SendBufferRef sendBuffer = MakeStressTestData();
+            if (sendBuffer == nullptr) {
+                cout << "Failed to allocate send buffer for stress test data" << endl;
+                co_return;
+            }
+
+            if (!co_await SendAsync(sendBuffer))
+                co_return;
+
+            if (_stressTestCurrentSeq < _stressTestConfig.messageCount)
+                co_await Sleep(chrono::milliseconds(_stressTestConfig.intervalMs));
+        }
+    }
+
+    SendBufferRef MakeStressTestData()
+    {
+        // ʹ messageSizeŭ 
+        uint32_t dataSize = min<uint32_t>(_stressTestConfig.messageSize, sizeof(StressTestData::data));
+        PacketWriter<PKT_C_STRESS_DATA> writer(dataSize);
+        if (!writer.IsValid())
+            return nullptr;
+
+        writer->sequenceNumber = ++_stressTestCurrentSeq;
+        writer->timestampNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count());
+
+        // ׽Ʈ  ä
+        for (uint32_t i = 0; i < dataSize; ++i) {
+            writer->data[i] = static_cast<char>((i + _stressTestCurrentSeq) % 256);
         }
+
+        return writer.Finish();
     }
 
     //  ׽Ʈ 
@@ -359,18 +440,24 @@ private:
         if (!_stressTestActive) return;
 
         //  Ŷ 
-        SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader));
-        if (sendBuffer != nullptr) {
-            PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-            header->size = sizeof(PacketHeader);
-            header->id = PKT_C_STRESS_END;
-            sendBuffer->Close(header->size);
-            Send(sendBuffer);
-        }
+        PacketWriter<PKT_C_STRESS_END> writer;
+        if (writer.IsValid())
+            Send(writer.Finish());
 
         cout << "Stress test completed. Waiting for server results..." << endl;
     }
 
+private:
+    void SendSnapshotAck(uint32_t frame)
+    {
+        PacketWriter<PKT_C_SNAPSHOT_ACK> writer;
+        if (!writer.IsValid())
+            return;
+
+        writer->frame = frame;
+        Send(writer.Finish());
+    }
+
 private:
     asio::steady_timer _timer;
 
@@ -379,11 +466,17 @@ private:
     StressTestStartData _stressTestConfig;
     uint32_t _stressTestCurrentSeq;
     uint32_t _stressTestReceivedCount;
-    uint32_t _totalRtt;
-    uint32_t _maxRtt;
-    uint32_t _minRtt;
+    LatencyHistogram _rttHistogram;
     uint32_t _lastReportedProgress;
-    asio::steady_timer _stressTestTimer;
+
+    //     ׽Ʈ  ׷
+    LatencyHistogram _serverLatencyAllRuns;
+    LatencyHistogram _rttAllRuns;
+    uint32_t _stressTestRuns = 0;
+
+    //    (io 忡 , /players  忡 )
+    SnapshotReceiver _snapshots;
+    mutex _snapshotLock;
 };
 
 //  ɾ ó Լ
@@ -392,10 +485,18 @@ void ProcessUserCommands(shared_ptr<ClientSession> session)
     cout << "=== File Transfer Client ===" << endl;
     cout << "Commands:" << endl;
     cout << "  /send <filepath> - Send a file to server" << endl;
+    cout << "  /senddir <dirpath> - Send all files in a directory as one pack stream" << endl;
+    cout << "  /download <filename> - Download a file from the server's public directory" << endl;
     cout << "  /stress <count> <size> <interval> - Run stress test" << endl;
     cout << "    count: Number of messages to send" << endl;
     cout << "    size: Size of each message in bytes" << endl;
     cout << "    interval: Time between messages in milliseconds" << endl;
+    cout << "  /sub <topic>, /unsub <topic> - Subscribe to or leave a topic" << endl;
+    cout << "  /pub <topic> <message> - Publish a message to every subscriber of a topic" << endl;
+    cout << "  /move <x> <y> - Move in the world (nearby players are reported)" << endl;
+    cout << "  /players - List every player from the last world snapshot" << endl;
+    cout << "  /trace on|off - Start or stop recording trace events" << endl;
+    cout << "  /trace dump <path> - Write recorded events as Chrome trace JSON" << endl;
     cout << "  /quit - Quit the application" << endl;
     cout << "  <message> - Send a chat message" << endl;
     cout << "=========================" << endl;
@@ -420,6 +521,26 @@ void ProcessUserCommands(shared_ptr<ClientSession> session)
                 cout << "Failed to start file transfer" << endl;
             }
         }
+        // 丮  ɾ: /senddir <dirpath>
+        else if (input.substr(0, 9) == "/senddir ")
+        {
+            string dirPath = input.substr(9);
+            cout << "Sending directory: " << dirPath << endl;
+
+            if (!session->SendDirectory(dirPath)) {
+                cout << "Failed to start directory transfer" << endl;
+            }
+        }
+        // ٿε ɾ: /download <filename>
+        else if (input.substr(0, 10) == "/download ")
+        {
+            string filename = input.substr(10);
+            cout << "Downloading file: " << filename << endl;
+
+            if (!session->DownloadFile(filename)) {
+                cout << "Failed to start file download" << endl;
+            }
+        }
         //  ׽Ʈ ɾ: /stress <count> <size> <interval>
         else if (input.substr(0, 8) == "/stress ")
         {
@@ -437,6 +558,53 @@ void ProcessUserCommands(shared_ptr<ClientSession> session)
                 cout << "Invalid stress test parameters. Usage: /stress <count> <size> <interval>" << endl;
             }
         }
+        //  ɾ: /sub <topic>, /unsub <topic>, /pub <topic> <message>
+        else if (input.substr(0, 5) == "/sub ")
+        {
+            session->SendTopicPacket<PKT_C_SUBSCRIBE>(input.substr(5));
+        }
+        else if (input.substr(0, 7) == "/unsub ")
+        {
+            session->SendTopicPacket<PKT_C_UNSUBSCRIBE>(input.substr(7));
+        }
+        else if (input.substr(0, 5) == "/pub ")
+        {
+            string params = input.substr(5);
+            size_t space = params.find(' ');
+            if (space == string::npos) {
+                cout << "Usage: /pub <topic> <message>" << endl;
+            }
+            else {
+                session->SendTopicPacket<PKT_C_PUBLISH>(params.substr(0, space), params.substr(space + 1));
+            }
+        }
+        //  ÷̾ 
+        else if (input == "/players")
+        {
+            session->PrintPlayers();
+        }
+        // ̵ ɾ: /move <x> <y>
+        else if (input.substr(0, 6) == "/move ")
+        {
+            stringstream ss(input.substr(6));
+            float x, y;
+            if (ss >> x >> y) {
+                session->SendMove(x, y);
+            }
+            else {
+                cout << "Usage: /move <x> <y>" << endl;
+            }
+        }
+        // ̺Ʈ 
+        else if (input == "/trace on" || input == "/trace off")
+        {
+            GTracer->SetEnabled(input == "/trace on");
+            cout << "Tracing " << (GTracer->IsEnabled() ? "enabled" : "disabled") << endl;
+        }
+        else if (input.substr(0, 12) == "/trace dump ")
+        {
+            GTracer->DumpChromeTrace(input.substr(12));
+        }
         // Ϲ ä ޽
         else
         {
@@ -0,0 +1,622 @@
+﻿#include "pch.h"
+#include "Session.h"
+#include "Service.h"
+#include "CorePch.h"
+#include "ThreadManager.h"
+#include "LatencyHistogram.h"
+#include "Protocol.h"
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+
+CoreGlobal Core;
+
+using namespace std;
+
+enum class LoadMode
+{
+    Closed, // 연결마다 정해진 수의 요청을 유지 (응답이 오면 다음 요청)
+    Open,   // 전체 초당 요청 수를 고정 (응답과 상관없이 예정 시각에 전송)
+    Churn,  // 정해진 수의 요청을 마치면 연결을 끊고 다시 연결
+};
+
+struct LoadConfig
+{
+    string host = "127.0.0.1";
+    uint16_t port = 7777;
+    LoadMode mode = LoadMode::Closed;
+    int32_t connections = 100;
+    int32_t threads = 4;
+    uint32_t payloadSize = 64;
+    uint32_t outstanding = 1;      // closed/churn: 연결당 동시에 보낼 요청 수
+    double rate = 10000.0;         // open: 전체 초당 요청 수
+    uint32_t churnRequests = 10;   // churn: 연결당 요청 수
+    uint32_t durationSec = 10;
+    uint32_t intervalMs = 1000;    // 보고 주기
+};
+
+static int64_t NowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*----------------
+    LoadStats
+-----------------*/
+// 보고 구간 동안 모은 통계
+struct LoadStats
+{
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t bytes = 0;
+    uint64_t connects = 0;
+    uint64_t disconnects = 0;
+    uint64_t errors = 0;
+    vector<int64_t> latencies;     // 예정 전송 시각부터 응답까지 (coordinated omission 보정)
+    vector<int64_t> serviceTimes;  // 실제 전송 시각부터 응답까지
+    vector<int64_t> connectTimes;  // 연결 요청부터 연결 완료까지
+
+    void Merge(const LoadStats& other)
+    {
+        requests += other.requests;
+        responses += other.responses;
+        bytes += other.bytes;
+        connects += other.connects;
+        disconnects += other.disconnects;
+        errors += other.errors;
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+        serviceTimes.insert(serviceTimes.end(), other.serviceTimes.begin(), other.serviceTimes.end());
+        connectTimes.insert(connectTimes.end(), other.connectTimes.begin(), other.connectTimes.end());
+    }
+};
+
+/*----------------
+    LoadTotals
+-----------------*/
+// 전체 실행 누적 통계 (오래 실행해도 메모리가 늘지 않도록 히스토그램에 누적)
+struct LoadTotals
+{
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t bytes = 0;
+    uint64_t connects = 0;
+    uint64_t disconnects = 0;
+    uint64_t errors = 0;
+    LatencyHistogram latency;
+    LatencyHistogram serviceTime;
+    LatencyHistogram connectTime;
+
+    void Add(const LoadStats& stats)
+    {
+        requests += stats.requests;
+        responses += stats.responses;
+        bytes += stats.bytes;
+        connects += stats.connects;
+        disconnects += stats.disconnects;
+        errors += stats.errors;
+        for (int64_t value : stats.latencies)
+            latency.Record(value);
+        for (int64_t value : stats.serviceTimes)
+            serviceTime.Record(value);
+        for (int64_t value : stats.connectTimes)
+            connectTime.Record(value);
+    }
+};
+
+// 정렬된 값에서 백분위 (마이크로초)
+static double Percentile(const vector<int64_t>& sorted, double percentile)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    size_t index = static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)] / 1000.0;
+}
+
+class LoadGenerator;
+
+/*----------------
+    LoadSession
+-----------------*/
+class LoadSession : public PacketSession
+{
+public:
+    LoadSession(asio::io_context& ioc, LoadGenerator& generator, int32_t slot);
+
+    void Stop();
+
+protected:
+    virtual void OnConnected() override;
+    virtual void OnDisconnected() override;
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override;
+
+private:
+    struct Pending
+    {
+        uint32_t sequenceNumber;
+        int64_t intendedNs; // 보내기로 예정된 시각
+        int64_t sentNs;     // 실제로 보낸 시각
+    };
+
+    void SendStart();
+    void SendRequest(int64_t intendedNs);
+    void OnResponse(const StressTestData& data, uint32_t size);
+    void ScheduleOpenLoop();
+    shared_ptr<LoadSession> GetLoadSessionRef() { return static_pointer_cast<LoadSession>(shared_from_this()); }
+
+    LoadGenerator& _generator;
+    int32_t _slot;
+    asio::steady_timer _timer;
+
+    // 수신 콜백과 타이머 콜백이 다른 io 스레드에서 동시에 돌 수 있음
+    mutex _lock;
+    deque<Pending> _pending;
+    uint32_t _nextSequence = 0;
+    uint32_t _completed = 0;
+    bool _ready = false;
+    int64_t _connectStartNs = 0; // 세션 생성 시각 (생성 직후 연결 시작)
+    int64_t _nextIntendedNs = 0;
+    int64_t _periodNs = 0;
+};
+
+/*----------------
+    LoadGenerator
+-----------------*/
+class LoadGenerator
+{
+public:
+    LoadGenerator(const LoadConfig& config) : _config(config) {}
+
+    bool Run();
+
+    const LoadConfig& Config() const { return _config; }
+    bool IsRunning() const { return _running; }
+    int64_t StartNs() const { return _startNs; }
+
+    // 세션이 슬롯 통계에 기록
+    template<typename Func>
+    void Record(int32_t slot, Func&& func)
+    {
+        Slot& target = *_slots[slot];
+        lock_guard<mutex> guard(target.lock);
+        func(target.stats);
+    }
+
+    // churn: 끊긴 슬롯에 새 세션 연결
+    void Reconnect(int32_t slot);
+
+private:
+    struct Slot
+    {
+        mutex lock;
+        LoadStats stats;
+        shared_ptr<LoadSession> session;
+    };
+
+    SessionRef CreateSlotSession(asio::io_context& ioc, int32_t slot);
+    LoadStats Collect();
+    void PrintInterval(double elapsedSec, double intervalSec, LoadStats& stats);
+    void PrintSummary(double elapsedSec, const LoadTotals& total);
+
+    LoadConfig _config;
+    asio::io_context _ioc;
+    shared_ptr<ClientService> _service;
+    vector<unique_ptr<Slot>> _slots;
+    atomic<int32_t> _nextSlot = 0;
+    atomic<bool> _running = false;
+    int64_t _startNs = 0;
+};
+
+LoadSession::LoadSession(asio::io_context& ioc, LoadGenerator& generator, int32_t slot)
+    : PacketSession(ioc)
+    , _generator(generator)
+    , _slot(slot)
+    , _timer(ioc)
+    , _connectStartNs(NowNs())
+{
+}
+
+void LoadSession::Stop()
+{
+    lock_guard<mutex> guard(_lock);
+    _ready = false;
+    _timer.cancel();
+}
+
+void LoadSession::OnConnected()
+{
+    int64_t connectNs = NowNs() - _connectStartNs;
+    _generator.Record(_slot, [connectNs](LoadStats& stats) {
+        stats.connects++;
+        stats.connectTimes.push_back(connectNs);
+        });
+
+    // 서버는 과부하 테스트가 시작된 세션의 데이터만 에코함
+    SendStart();
+}
+
+void LoadSession::OnDisconnected()
+{
+    Stop();
+    _generator.Record(_slot, [](LoadStats& stats) { stats.disconnects++; });
+
+    // churn 모드면 같은 슬롯에 새로 연결 (이 세션의 콜백 밖에서)
+    if (_generator.Config().mode == LoadMode::Churn && _generator.IsRunning()) {
+        LoadGenerator* generator = &_generator;
+        int32_t slot = _slot;
+        asio::post(GetSocket().get_executor(), [generator, slot]() { generator->Reconnect(slot); });
+    }
+}
+
+void LoadSession::OnRecvPacket(BYTE* buffer, int32_t len)
+{
+    PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
+
+    if (header->id == PKT_S_STRESS_DATA) {
+        PacketReader<PKT_S_STRESS_DATA> packet(buffer, len);
+        if (packet.IsValid())
+            OnResponse(packet.Get(), header->size);
+    }
+    else if (header->id == PKT_S_STRESS_START) {
+        const LoadConfig& config = _generator.Config();
+        lock_guard<mutex> guard(_lock);
+        _ready = true;
+
+        if (config.mode == LoadMode::Open) {
+            // 연결마다 시작 시각을 엇갈려 전체 요청이 고르게 퍼지도록 함
+            _periodNs = static_cast<int64_t>(1e9 * config.connections / config.rate);
+            int64_t offset = _periodNs * _slot / config.connections;
+            _nextIntendedNs = max(NowNs(), _generator.StartNs()) + offset;
+            ScheduleOpenLoop();
+        }
+        else {
+            int64_t now = NowNs();
+            for (uint32_t i = 0; i < config.outstanding; i++)
+                SendRequest(now);
+        }
+    }
+}
+
+void LoadSession::SendStart()
+{
+    PacketWriter<PKT_C_STRESS_START> writer;
+    if (!writer.IsValid())
+        return;
+
+    writer->messageCount = UINT32_MAX;
+    writer->messageSize = _generator.Config().payloadSize;
+    writer->intervalMs = 0;
+    Send(writer.Finish());
+}
+
+void LoadSession::SendRequest(int64_t intendedNs)
+{
+    // _lock을 잡은 상태에서 호출
+    if (!_ready || !_generator.IsRunning())
+        return;
+
+    uint32_t payloadSize = _generator.Config().payloadSize;
+    PacketWriter<PKT_C_STRESS_DATA> writer(payloadSize);
+    if (!writer.IsValid())
+        return;
+
+    int64_t now = NowNs();
+    writer->sequenceNumber = ++_nextSequence;
+    writer->timestampNs = static_cast<uint64_t>(now); // 서버 통계용
+    memset(writer->data, static_cast<int>(_nextSequence & 0xFF), payloadSize);
+    SendBufferRef sendBuffer = writer.Finish();
+
+    _pending.push_back(Pending{ _nextSequence, intendedNs, now });
+    Send(sendBuffer);
+
+    _generator.Record(_slot, [](LoadStats& stats) { stats.requests++; });
+}
+
+void LoadSession::OnResponse(const StressTestData& data, uint32_t size)
+{
+    const LoadConfig& config = _generator.Config();
+    int64_t now = NowNs();
+    bool reconnect = false;
+
+    {
+        lock_guard<mutex> guard(_lock);
+
+        // 한 연결의 응답은 보낸 순서대로 옴
+        uint64_t skipped = 0;
+        while (!_pending.empty() && _pending.front().sequenceNumber != data.sequenceNumber) {
+            _pending.pop_front();
+            skipped++;
+        }
+
+        if (_pending.empty()) {
+            _generator.Record(_slot, [](LoadStats& stats) { stats.errors++; });
+            return;
+        }
+
+        Pending pending = _pending.front();
+        _pending.pop_front();
+        _completed++;
+
+        _generator.Record(_slot, [&](LoadStats& stats) {
+            stats.responses++;
+            stats.bytes += size;
+            stats.errors += skipped;
+            stats.latencies.push_back(now - pending.intendedNs);
+            stats.serviceTimes.push_back(now - pending.sentNs);
+            });
+
+        // 다음 요청 (open 모드는 타이머가 보냄)
+        if (config.mode == LoadMode::Closed) {
+            SendRequest(now);
+        }
+        else if (config.mode == LoadMode::Churn) {
+            if (_completed >= config.churnRequests)
+                reconnect = _pending.empty();
+            else if (_nextSequence < config.churnRequests)
+                SendRequest(now);
+        }
+    }
+
+    if (reconnect)
+        Disconnect("Churn");
+}
+
+void LoadSession::ScheduleOpenLoop()
+{
+    // _lock을 잡은 상태에서 호출
+    _timer.expires_at(chrono::steady_clock::time_point(chrono::duration_cast<chrono::steady_clock::duration>(chrono::nanoseconds(_nextIntendedNs))));
+
+    auto self = GetLoadSessionRef();
+    _timer.async_wait([this, self](const std::error_code& error) {
+        if (error)
+            return;
+
+        lock_guard<mutex> guard(_lock);
+        if (!_ready || !_generator.IsRunning())
+            return;
+
+        // 늦게 깨어났으면 밀린 요청을 원래 예정 시각으로 모두 보냄 (지연 시간은 예정 시각부터 계산)
+        int64_t now = NowNs();
+        while (_nextIntendedNs <= now) {
+            SendRequest(_nextIntendedNs);
+            _nextIntendedNs += _periodNs;
+        }
+
+        ScheduleOpenLoop();
+        });
+}
+
+bool LoadGenerator::Run()
+{
+    for (int32_t i = 0; i < _config.connections; i++)
+        _slots.push_back(make_unique<Slot>());
+
+    _service = make_shared<ClientService>(
+        _ioc,
+        NetAddress(_config.host, _config.port),
+        [this](asio::io_context& ioc) { return CreateSlotSession(ioc, _nextSlot++); },
+        _config.connections);
+
+    // 1. 연결 시작 후 io 스레드 실행
+    _running = true;
+    _startNs = NowNs();
+    if (!_service->Start()) {
+        cerr << "Failed to start client service" << endl;
+        return false;
+    }
+
+    auto work = asio::make_work_guard(_ioc);
+    for (int32_t i = 0; i < _config.threads; i++)
+    {
+        GThreadManager->Launch([this]()
+            {
+                _ioc.run();
+            });
+    }
+
+    // 2. 보고 주기마다 구간 통계 출력
+    LoadTotals total;
+    int64_t endNs = _startNs + static_cast<int64_t>(_config.durationSec) * 1000000000;
+    int64_t lastNs = _startNs;
+
+    while (NowNs() < endNs)
+    {
+        int64_t nextNs = min(lastNs + static_cast<int64_t>(_config.intervalMs) * 1000000, endNs);
+        this_thread::sleep_for(chrono::nanoseconds(max<int64_t>(0, nextNs - NowNs())));
+
+        int64_t now = NowNs();
+        LoadStats stats = Collect();
+        total.Add(stats);
+        PrintInterval((now - _startNs) / 1e9, (now - lastNs) / 1e9, stats);
+        lastNs = now;
+    }
+
+    // 3. 종료
+    _running = false;
+    for (auto& slot : _slots)
+    {
+        shared_ptr<LoadSession> session;
+        {
+            lock_guard<mutex> guard(slot->lock);
+            session = slot->session;
+        }
+        if (session)
+            session->Stop();
+    }
+
+    total.Add(Collect());
+    PrintSummary((NowNs() - _startNs) / 1e9, total);
+
+    _service->CloseService();
+    work.reset();
+    _ioc.stop();
+    GThreadManager->Join();
+    return true;
+}
+
+void LoadGenerator::Reconnect(int32_t slot)
+{
+    if (!_running)
+        return;
+
+    SessionRef session = CreateSlotSession(_ioc, slot);
+    session->SetService(_service);
+    session->Connect();
+}
+
+SessionRef LoadGenerator::CreateSlotSession(asio::io_context& ioc, int32_t slot)
+{
+    // 종료할 때 멈출 수 있도록 슬롯에 현재 세션을 보관
+    auto session = make_shared<LoadSession>(ioc, *this, slot);
+    lock_guard<mutex> guard(_slots[slot]->lock);
+    _slots[slot]->session = session;
+    return session;
+}
+
+LoadStats LoadGenerator::Collect()
+{
+    LoadStats merged;
+    for (auto& slot : _slots)
+    {
+        LoadStats stats;
+        {
+            lock_guard<mutex> guard(slot->lock);
+            swap(stats, slot->stats);
+        }
+        merged.Merge(stats);
+    }
+    return merged;
+}
+
+void LoadGenerator::PrintInterval(double elapsedSec, double intervalSec, LoadStats& stats)
+{
+    sort(stats.latencies.begin(), stats.latencies.end());
+    sort(stats.serviceTimes.begin(), stats.serviceTimes.end());
+
+    cout << fixed << setprecision(1)
+        << "[" << setw(6) << elapsedSec << "s] "
+        << "conns " << _service->GetCurrentSessionCount()
+        << "  req/s " << setprecision(0) << stats.requests / intervalSec
+        << "  resp/s " << stats.responses / intervalSec
+        << setprecision(2) << "  MB/s " << stats.bytes / intervalSec / (1024.0 * 1024.0)
+        << setprecision(0)
+        << "  lat(us) p50 " << Percentile(stats.latencies, 50)
+        << " p90 " << Percentile(stats.latencies, 90)
+        << " p99 " << Percentile(stats.latencies, 99)
+        << " p99.9 " << Percentile(stats.latencies, 99.9)
+        << " max " << Percentile(stats.latencies, 100);
+
+    if (_config.mode == LoadMode::Open)
+        cout << "  svc p99 " << Percentile(stats.serviceTimes, 99);
+
+    if (_config.mode == LoadMode::Churn) {
+        sort(stats.connectTimes.begin(), stats.connectTimes.end());
+        cout << "  conn/s " << stats.connects / intervalSec
+            << " connect p99 " << Percentile(stats.connectTimes, 99);
+    }
+
+    if (stats.errors > 0)
+        cout << "  errors " << stats.errors;
+
+    cout << endl;
+}
+
+void LoadGenerator::PrintSummary(double elapsedSec, const LoadTotals& total)
+{
+    auto us = [](const LatencyHistogram& histogram, double percentile) { return histogram.Percentile(percentile) / 1000.0; };
+
+    cout << "\n==== Load Test Summary ====" << endl;
+    cout << fixed << setprecision(2);
+    cout << "Duration: " << elapsedSec << " s" << endl;
+    cout << "Requests: " << total.requests << ", responses: " << total.responses << ", errors: " << total.errors << endl;
+    cout << "Throughput: " << total.responses / elapsedSec << " msgs/s, "
+        << total.bytes / elapsedSec / (1024.0 * 1024.0) << " MB/s" << endl;
+    cout << "Latency (us, from intended send time): p50 " << us(total.latency, 50)
+        << " p90 " << us(total.latency, 90)
+        << " p99 " << us(total.latency, 99)
+        << " p99.9 " << us(total.latency, 99.9)
+        << " p99.99 " << us(total.latency, 99.99)
+        << " max " << total.latency.Max() / 1000.0 << endl;
+    cout << "Service time (us, from actual send time): p50 " << us(total.serviceTime, 50)
+        << " p99 " << us(total.serviceTime, 99)
+        << " max " << total.serviceTime.Max() / 1000.0 << endl;
+    cout << "Connects: " << total.connects << " (p99 " << us(total.connectTime, 99) << " us)"
+        << ", disconnects: " << total.disconnects << endl;
+    cout << "===========================" << endl;
+}
+
+static void PrintUsage()
+{
+    cout << "Usage: LoadGenerator [options]" << endl;
+    cout << "  --host <addr>          Server address (default 127.0.0.1)" << endl;
+    cout << "  --port <port>          Server port (default 7777)" << endl;
+    cout << "  --mode <closed|open|churn>" << endl;
+    cout << "  --connections <n>      Number of connections (default 100)" << endl;
+    cout << "  --threads <n>          Number of io threads (default 4)" << endl;
+    cout << "  --size <bytes>         Payload size, up to 4000 (default 64)" << endl;
+    cout << "  --outstanding <n>      closed/churn: requests in flight per connection (default 1)" << endl;
+    cout << "  --rate <msgs/s>        open: aggregate request rate (default 10000)" << endl;
+    cout << "  --churn-requests <n>   churn: requests per connection before reconnecting (default 10)" << endl;
+    cout << "  --duration <sec>       Test duration (default 10)" << endl;
+    cout << "  --interval <ms>        Report interval (default 1000)" << endl;
+}
+
+static bool ParseArgs(int argc, char* argv[], LoadConfig& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string key = argv[i];
+        if (key == "--help" || i + 1 >= argc)
+            return false;
+
+        string value = argv[++i];
+        if (key == "--host") config.host = value;
+        else if (key == "--port") config.port = static_cast<uint16_t>(stoi(value));
+        else if (key == "--connections") config.connections = stoi(value);
+        else if (key == "--threads") config.threads = stoi(value);
+        else if (key == "--size") config.payloadSize = static_cast<uint32_t>(stoul(value));
+        else if (key == "--outstanding") config.outstanding = static_cast<uint32_t>(stoul(value));
+        else if (key == "--rate") config.rate = stod(value);
+        else if (key == "--churn-requests") config.churnRequests = static_cast<uint32_t>(stoul(value));
+        else if (key == "--duration") config.durationSec = static_cast<uint32_t>(stoul(value));
+        else if (key == "--interval") config.intervalMs = static_cast<uint32_t>(stoul(value));
+        else if (key == "--mode") {
+            if (value == "closed") config.mode = LoadMode::Closed;
+            else if (value == "open") config.mode = LoadMode::Open;
+            else if (value == "churn") config.mode = LoadMode::Churn;
+            else return false;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return config.connections > 0 && config.threads > 0 && config.payloadSize <= sizeof(StressTestData::data) &&
+        config.outstanding > 0 && config.rate > 0 && config.churnRequests > 0 && config.intervalMs > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    LoadConfig config;
+    try {
+        if (!ParseArgs(argc, argv, config)) {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const exception&) {
+        PrintUsage();
+        return 1;
+    }
+
+    const char* modeNames[] = { "closed", "open", "churn" };
+    cout << "=== Load Generator ===" << endl;
+    cout << "Target: " << config.host << ":" << config.port
+        << ", mode: " << modeNames[static_cast<int32_t>(config.mode)]
+        << ", connections: " << config.connections
+        << ", io threads: " << config.threads
+        << ", payload: " << config.payloadSize << " bytes" << endl;
+
+    LoadGenerator generator(config);
+    return generator.Run() ? 0 : 1;
+}
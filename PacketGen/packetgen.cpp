@@ -0,0 +1,808 @@
+﻿#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// 패킷 정의(.idl)를 읽어 패킷 헤더(.h)를 만드는 빌드 도구
+// 사용법: PacketGen <입력.idl> <출력.h>
+// 출력 내용이 같으면 파일을 건드리지 않음 (정의가 그대로면 다시 컴파일되지 않도록)
+//
+// 만드는 것 (PacketCodec.h의 틀을 사용)
+//   상수, enum, PacketId
+//   1바이트 정렬 구조체 + SIZE/MIN_SIZE/HAS_HEADER 상수와 크기 static_assert
+//   패킷마다 PacketTraits 특수화 (PacketReader/PacketWriter/PacketDispatcher가 사용)
+//   ID로 찾는 GPacketInfos 표와 FindPacketInfo
+
+/*----------------
+    Token
+-----------------*/
+struct Token
+{
+    enum class Type
+    {
+        Identifier,
+        Number,
+        Symbol,     // { } [ ] : ; = , 또는 ...
+        End,
+    };
+
+    Type type = Type::End;
+    string text;
+    int line = 0;
+};
+
+// 주석: 줄 전체가 주석이면 선언 위의 설명, 코드 뒤에 붙으면 그 줄의 꼬리 설명
+struct SourceComments
+{
+    map<int, string> fullLine;
+    map<int, string> trailing;
+    set<int> blankLines;
+};
+
+struct ParseError
+{
+    int line;
+    string message;
+};
+
+/*----------------
+    Declarations
+-----------------*/
+struct ConstDecl
+{
+    string type;
+    string name;
+    uint64_t value = 0;
+    string doc;
+    string comment;
+};
+
+struct EnumValue
+{
+    string name;
+    string value;
+    string comment;
+};
+
+struct EnumDecl
+{
+    string name;
+    string type;
+    vector<EnumValue> values;
+    string doc;
+};
+
+struct FieldDecl
+{
+    string type;
+    string name;
+    uint32_t count = 0;         // 0이면 배열 아님
+    string countText;
+    bool tail = false;
+    uint32_t offset = 0;        // 본문 시작(HAS_HEADER면 PacketHeader 포함) 기준
+    uint32_t size = 0;
+    string comment;
+};
+
+struct StructDecl
+{
+    string name;
+    bool hasHeader = false;
+    vector<FieldDecl> fields;
+    uint32_t size = 0;
+    uint32_t minSize = 0;
+    string doc;
+};
+
+struct PacketDecl
+{
+    string name;
+    uint32_t id = 0;
+    string body;                // 비어 있으면 PacketHeader만
+    bool trailing = false;
+    bool groupStart = false;    // ID 목록에서 앞에 빈 줄을 둘지 (정의에서 빈 줄이나 설명으로 나뉜 곳)
+    string doc;
+    string comment;
+};
+
+// 출력 순서를 유지하기 위한 선언 목록
+struct Declaration
+{
+    enum class Kind
+    {
+        Const,
+        Enum,
+        Struct,
+    };
+
+    Kind kind;
+    size_t index;
+};
+
+/*----------------
+    Parser
+-----------------*/
+class Parser
+{
+public:
+    Parser(vector<Token> tokens, SourceComments comments) : _tokens(std::move(tokens)), _comments(std::move(comments)) {}
+
+    void Parse()
+    {
+        while (Peek().type != Token::Type::End)
+        {
+            const Token& keyword = Expect(Token::Type::Identifier);
+            if (keyword.text == "const")
+                ParseConst(keyword.line);
+            else if (keyword.text == "enum")
+                ParseEnum(keyword.line);
+            else if (keyword.text == "struct")
+                ParseStruct(keyword.line);
+            else if (keyword.text == "packet")
+                ParsePacket(keyword.line);
+            else
+                throw ParseError{ keyword.line, "unknown declaration '" + keyword.text + "'" };
+        }
+    }
+
+    vector<Declaration> declarations;
+    vector<ConstDecl> consts;
+    vector<EnumDecl> enums;
+    vector<StructDecl> structs;
+    vector<PacketDecl> packets;
+
+private:
+    static uint32_t PrimitiveSize(const string& type)
+    {
+        static const map<string, uint32_t> SPrimitives =
+        {
+            { "int8", 1 }, { "uint8", 1 }, { "char", 1 },
+            { "int16", 2 }, { "uint16", 2 },
+            { "int32", 4 }, { "uint32", 4 }, { "float", 4 },
+            { "int64", 8 }, { "uint64", 8 }, { "double", 8 },
+        };
+
+        auto it = SPrimitives.find(type);
+        return it == SPrimitives.end() ? 0 : it->second;
+    }
+
+    static bool IsIntegerType(const string& type)
+    {
+        return type != "char" && type != "float" && type != "double" && PrimitiveSize(type) != 0;
+    }
+
+    uint32_t TypeSize(const string& type, int line) const
+    {
+        if (uint32_t size = PrimitiveSize(type))
+            return size;
+
+        for (const EnumDecl& decl : enums)
+        {
+            if (decl.name == type)
+                return PrimitiveSize(decl.type);
+        }
+
+        for (const StructDecl& decl : structs)
+        {
+            if (decl.name == type)
+            {
+                if (decl.hasHeader || decl.minSize != decl.size)
+                    throw ParseError{ line, "struct '" + type + "' cannot be used as a field" };
+                return decl.size;
+            }
+        }
+
+        throw ParseError{ line, "unknown type '" + type + "'" };
+    }
+
+    bool IsDefined(const string& name) const
+    {
+        for (const ConstDecl& decl : consts)
+            if (decl.name == name) return true;
+        for (const EnumDecl& decl : enums)
+            if (decl.name == name) return true;
+        for (const StructDecl& decl : structs)
+            if (decl.name == name) return true;
+        return false;
+    }
+
+    void ParseConst(int line)
+    {
+        ConstDecl decl;
+        decl.type = Expect(Token::Type::Identifier).text;
+        if (!IsIntegerType(decl.type))
+            throw ParseError{ line, "const must have an integer type" };
+
+        decl.name = ExpectNewName();
+        ExpectSymbol("=");
+        decl.value = ParseNumber(Expect(Token::Type::Number));
+        int end = ExpectSymbol(";").line;
+
+        decl.doc = DocAbove(line);
+        decl.comment = TrailingAt(end);
+        declarations.push_back({ Declaration::Kind::Const, consts.size() });
+        consts.push_back(std::move(decl));
+    }
+
+    void ParseEnum(int line)
+    {
+        EnumDecl decl;
+        decl.name = ExpectNewName();
+        ExpectSymbol(":");
+        decl.type = Expect(Token::Type::Identifier).text;
+        if (!IsIntegerType(decl.type))
+            throw ParseError{ line, "enum '" + decl.name + "' must have an integer type" };
+
+        ExpectSymbol("{");
+        while (!AcceptSymbol("}"))
+        {
+            EnumValue value;
+            const Token& name = Expect(Token::Type::Identifier);
+            value.name = name.text;
+            ExpectSymbol("=");
+            value.value = Expect(Token::Type::Number).text;
+            AcceptSymbol(",");
+            value.comment = TrailingAt(name.line);
+            decl.values.push_back(std::move(value));
+        }
+
+        decl.doc = DocAbove(line);
+        declarations.push_back({ Declaration::Kind::Enum, enums.size() });
+        enums.push_back(std::move(decl));
+    }
+
+    void ParseStruct(int line)
+    {
+        StructDecl decl;
+        decl.name = ExpectNewName();
+        if (AcceptSymbol(":"))
+        {
+            const Token& base = Expect(Token::Type::Identifier);
+            if (base.text != "PacketHeader")
+                throw ParseError{ base.line, "struct can only derive from PacketHeader" };
+            decl.hasHeader = true;
+        }
+
+        uint32_t offset = decl.hasHeader ? 4 : 0;
+        ExpectSymbol("{");
+        while (!AcceptSymbol("}"))
+        {
+            FieldDecl field;
+            const Token& first = Expect(Token::Type::Identifier);
+            field.type = first.text;
+            if (field.type == "tail")
+            {
+                field.tail = true;
+                field.type = Expect(Token::Type::Identifier).text;
+            }
+
+            field.name = Expect(Token::Type::Identifier).text;
+            uint32_t elementSize = TypeSize(field.type, first.line);
+            if (AcceptSymbol("["))
+            {
+                const Token& count = Next();
+                field.countText = count.text;
+                field.count = static_cast<uint32_t>(ResolveCount(count));
+                if (field.count == 0)
+                    throw ParseError{ count.line, "array '" + field.name + "' must not be empty" };
+                ExpectSymbol("]");
+            }
+
+            int end = ExpectSymbol(";").line;
+            if (!decl.fields.empty() && decl.fields.back().tail)
+                throw ParseError{ first.line, "tail field '" + decl.fields.back().name + "' must be the last field" };
+            if (field.tail && field.count == 0)
+                throw ParseError{ first.line, "tail field '" + field.name + "' must be an array" };
+
+            for (const FieldDecl& other : decl.fields)
+            {
+                if (other.name == field.name)
+                    throw ParseError{ first.line, "duplicate field '" + field.name + "'" };
+            }
+
+            field.offset = offset;
+            field.size = elementSize * (field.count == 0 ? 1 : field.count);
+            field.comment = TrailingAt(end);
+            offset += field.size;
+            decl.fields.push_back(std::move(field));
+        }
+
+        if (decl.fields.empty())
+            throw ParseError{ line, "struct '" + decl.name + "' has no fields" };
+
+        decl.size = offset;
+        decl.minSize = decl.fields.back().tail ? decl.fields.back().offset : offset;
+        if (decl.size > 0xFFFF)
+            throw ParseError{ line, "struct '" + decl.name + "' does not fit in a packet" };
+
+        decl.doc = DocAbove(line);
+        declarations.push_back({ Declaration::Kind::Struct, structs.size() });
+        structs.push_back(std::move(decl));
+    }
+
+    void ParsePacket(int line)
+    {
+        PacketDecl decl;
+        decl.name = Expect(Token::Type::Identifier).text;
+        ExpectSymbol("=");
+        const Token& id = Expect(Token::Type::Number);
+        uint64_t value = ParseNumber(id);
+        if (value == 0 || value > 0xFFFF)
+            throw ParseError{ id.line, "packet id must be between 1 and 65535" };
+        decl.id = static_cast<uint32_t>(value);
+
+        if (AcceptSymbol(":"))
+        {
+            if (!AcceptSymbol("..."))
+            {
+                const Token& body = Expect(Token::Type::Identifier);
+                decl.body = body.text;
+
+                bool found = false;
+                for (const StructDecl& s : structs)
+                    found |= s.name == body.text;
+                if (!found)
+                    throw ParseError{ body.line, "unknown struct '" + body.text + "'" };
+
+                decl.trailing = AcceptSymbol("...");
+            }
+            else
+            {
+                decl.trailing = true;
+            }
+        }
+        else
+        {
+            decl.trailing = AcceptSymbol("...");
+        }
+
+        int end = ExpectSymbol(";").line;
+
+        for (const PacketDecl& other : packets)
+        {
+            if (other.name == decl.name)
+                throw ParseError{ line, "duplicate packet '" + decl.name + "'" };
+            if (other.id == decl.id)
+                throw ParseError{ line, "packet id " + to_string(decl.id) + " is already used by " + other.name };
+        }
+
+        decl.doc = DocAbove(line);
+        decl.comment = TrailingAt(end);
+        decl.groupStart = !decl.doc.empty() || _comments.blankLines.count(line - 1) != 0;
+        packets.push_back(std::move(decl));
+    }
+
+    uint64_t ResolveCount(const Token& token) const
+    {
+        if (token.type == Token::Type::Number)
+            return ParseNumber(token);
+
+        for (const ConstDecl& decl : consts)
+        {
+            if (decl.name == token.text)
+                return decl.value;
+        }
+
+        throw ParseError{ token.line, "unknown array size '" + token.text + "'" };
+    }
+
+    static uint64_t ParseNumber(const Token& token)
+    {
+        try
+        {
+            size_t used = 0;
+            uint64_t value = stoull(token.text, &used, 0);
+            if (used == token.text.size())
+                return value;
+        }
+        catch (const exception&)
+        {
+        }
+
+        throw ParseError{ token.line, "invalid number '" + token.text + "'" };
+    }
+
+    // 선언 바로 위에 빈 줄 없이 붙은 주석 줄
+    string DocAbove(int line) const
+    {
+        vector<string> lines;
+        for (int i = line - 1; _comments.fullLine.count(i) != 0; i--)
+            lines.insert(lines.begin(), _comments.fullLine.at(i));
+
+        string doc;
+        for (const string& text : lines)
+            doc += (doc.empty() ? "" : "\n") + text;
+        return doc;
+    }
+
+    string TrailingAt(int line) const
+    {
+        auto it = _comments.trailing.find(line);
+        return it == _comments.trailing.end() ? "" : it->second;
+    }
+
+    string ExpectNewName()
+    {
+        const Token& token = Expect(Token::Type::Identifier);
+        if (IsDefined(token.text))
+            throw ParseError{ token.line, "'" + token.text + "' is already defined" };
+        return token.text;
+    }
+
+    const Token& Peek() const { return _tokens[_pos]; }
+
+    const Token& Next()
+    {
+        const Token& token = _tokens[_pos];
+        if (token.type != Token::Type::End)
+            _pos++;
+        return token;
+    }
+
+    const Token& Expect(Token::Type type)
+    {
+        const Token& token = Next();
+        if (token.type != type)
+            throw ParseError{ token.line, token.type == Token::Type::End ? "unexpected end of file" : "unexpected '" + token.text + "'" };
+        return token;
+    }
+
+    const Token& ExpectSymbol(const char* symbol)
+    {
+        const Token& token = Next();
+        if (token.type != Token::Type::Symbol || token.text != symbol)
+            throw ParseError{ token.line, string("expected '") + symbol + "'" };
+        return token;
+    }
+
+    bool AcceptSymbol(const char* symbol)
+    {
+        if (Peek().type != Token::Type::Symbol || Peek().text != symbol)
+            return false;
+        _pos++;
+        return true;
+    }
+
+private:
+    vector<Token> _tokens;
+    SourceComments _comments;
+    size_t _pos = 0;
+};
+
+/*----------------
+    Tokenize
+-----------------*/
+static vector<Token> Tokenize(const string& source, SourceComments& comments)
+{
+    vector<Token> tokens;
+    int line = 1;
+    bool lineHasCode = false;
+    bool lineHasAnything = false;
+    size_t i = 0;
+
+    auto endLine = [&]()
+    {
+        if (!lineHasAnything)
+            comments.blankLines.insert(line);
+        line++;
+        lineHasCode = false;
+        lineHasAnything = false;
+    };
+
+    while (i < source.size())
+    {
+        char c = source[i];
+        if (c == '\n')
+        {
+            endLine();
+            i++;
+        }
+        else if (isspace(static_cast<unsigned char>(c)))
+        {
+            i++;
+        }
+        else if (source.compare(i, 2, "//") == 0)
+        {
+            size_t end = source.find('\n', i);
+            if (end == string::npos)
+                end = source.size();
+
+            string text = source.substr(i + 2, end - i - 2);
+            while (!text.empty() && isspace(static_cast<unsigned char>(text.back())))
+                text.pop_back();
+            size_t start = text.find_first_not_of(' ');
+            text = start == string::npos ? "" : text.substr(start);
+
+            if (lineHasCode)
+                comments.trailing[line] = text;
+            else if (!text.empty())
+                comments.fullLine[line] = text;
+            lineHasAnything = true;
+            i = end;
+        }
+        else if (source.compare(i, 2, "/*") == 0)
+        {
+            size_t end = source.find("*/", i + 2);
+            if (end == string::npos)
+                throw ParseError{ line, "unterminated block comment" };
+            for (size_t j = i; j < end; j++)
+            {
+                if (source[j] == '\n')
+                    endLine();
+            }
+            lineHasAnything = true;
+            i = end + 2;
+        }
+        else
+        {
+            Token token;
+            token.line = line;
+            if (isalpha(static_cast<unsigned char>(c)) || c == '_')
+            {
+                size_t start = i;
+                while (i < source.size() && (isalnum(static_cast<unsigned char>(source[i])) || source[i] == '_'))
+                    i++;
+                token.type = Token::Type::Identifier;
+                token.text = source.substr(start, i - start);
+            }
+            else if (isdigit(static_cast<unsigned char>(c)))
+            {
+                size_t start = i;
+                while (i < source.size() && isalnum(static_cast<unsigned char>(source[i])))
+                    i++;
+                token.type = Token::Type::Number;
+                token.text = source.substr(start, i - start);
+            }
+            else if (source.compare(i, 3, "...") == 0)
+            {
+                token.type = Token::Type::Symbol;
+                token.text = "...";
+                i += 3;
+            }
+            else if (string("{}[]:;=,").find(c) != string::npos)
+            {
+                token.type = Token::Type::Symbol;
+                token.text = string(1, c);
+                i++;
+            }
+            else
+            {
+                throw ParseError{ line, string("unexpected character '") + c + "'" };
+            }
+
+            tokens.push_back(std::move(token));
+            lineHasCode = true;
+            lineHasAnything = true;
+        }
+    }
+
+    tokens.push_back(Token{ Token::Type::End, "", line });
+    return tokens;
+}
+
+/*----------------
+    Generate
+-----------------*/
+static void WriteDoc(ostringstream& out, const string& doc, const string& indent = "")
+{
+    if (doc.empty())
+        return;
+
+    istringstream lines(doc);
+    string line;
+    while (getline(lines, line))
+        out << indent << "// " << line << "\n";
+}
+
+// 꼬리 주석을 같은 열에 맞춰 씀
+static void WriteAligned(ostringstream& out, const vector<pair<string, string>>& lines, const string& indent)
+{
+    size_t width = 0;
+    for (const auto& [code, comment] : lines)
+        width = max(width, code.size());
+
+    for (const auto& [code, comment] : lines)
+    {
+        out << indent << code;
+        if (!comment.empty())
+            out << string(width - code.size() + 4, ' ') << "// " << comment;
+        out << "\n";
+    }
+}
+
+static string Generate(const Parser& parser, const string& sourceName)
+{
+    ostringstream out;
+    out << "#pragma once\n";
+    out << "// 자동 생성 파일 - 직접 수정하지 말 것 (" << sourceName << "을 고치면 빌드할 때 PacketGen이 다시 만듦)\n";
+    out << "#include \"PacketCodec.h\"\n";
+
+    // 상수, enum, 구조체 (정의 순서대로)
+    bool packed = false;
+    for (const Declaration& declaration : parser.declarations)
+    {
+        if (declaration.kind == Declaration::Kind::Const)
+        {
+            if (packed) { out << "#pragma pack(pop)\n"; packed = false; }
+
+            const ConstDecl& decl = parser.consts[declaration.index];
+            out << "\n";
+            WriteDoc(out, decl.doc);
+            out << "inline constexpr " << decl.type << " " << decl.name << " = " << decl.value << ";";
+            if (!decl.comment.empty())
+                out << "    // " << decl.comment;
+            out << "\n";
+        }
+        else if (declaration.kind == Declaration::Kind::Enum)
+        {
+            if (packed) { out << "#pragma pack(pop)\n"; packed = false; }
+
+            const EnumDecl& decl = parser.enums[declaration.index];
+            out << "\n";
+            WriteDoc(out, decl.doc);
+            out << "enum " << decl.name << " : " << decl.type << "\n{\n";
+            vector<pair<string, string>> lines;
+            for (const EnumValue& value : decl.values)
+                lines.push_back({ value.name + " = " + value.value + ",", value.comment });
+            WriteAligned(out, lines, "    ");
+            out << "};\n";
+        }
+        else
+        {
+            const StructDecl& decl = parser.structs[declaration.index];
+            out << "\n";
+            if (!packed) { out << "#pragma pack(push, 1)\n"; packed = true; }
+            out << "/*----------------\n    " << decl.name << "\n-----------------*/\n";
+            WriteDoc(out, decl.doc);
+            out << "struct " << decl.name << (decl.hasHeader ? " : PacketHeader" : "") << "\n{\n";
+            out << "    static constexpr uint32 SIZE = " << decl.size << ";\n";
+            out << "    static constexpr uint32 MIN_SIZE = " << decl.minSize << ";";
+            if (decl.minSize != decl.size)
+                out << "    // 마지막 필드(" << decl.fields.back().name << ")는 쓴 만큼만 보냄";
+            out << "\n";
+            out << "    static constexpr bool HAS_HEADER = " << (decl.hasHeader ? "true" : "false") << ";\n\n";
+
+            vector<pair<string, string>> lines;
+            for (const FieldDecl& field : decl.fields)
+            {
+                string code = field.type + " " + field.name;
+                if (field.count != 0)
+                    code += "[" + field.countText + "]";
+                lines.push_back({ code + ";", field.comment });
+            }
+            WriteAligned(out, lines, "    ");
+            out << "};\n";
+        }
+    }
+    if (packed)
+        out << "#pragma pack(pop)\n";
+
+    // 크기 확인 (정의와 컴파일러의 배치가 다르면 빌드 실패)
+    out << "\n";
+    for (const StructDecl& decl : parser.structs)
+        out << "static_assert(sizeof(" << decl.name << ") == " << decl.name << "::SIZE);\n";
+
+    // 패킷 ID
+    out << "\n/*----------------\n    PacketId\n-----------------*/\n";
+    out << "enum PacketId : uint16\n{\n";
+    vector<pair<string, string>> lines;
+    uint32_t maxId = 0;
+    for (const PacketDecl& packet : parser.packets)
+    {
+        maxId = max(maxId, packet.id);
+        if (packet.groupStart && !lines.empty())
+        {
+            WriteAligned(out, lines, "    ");
+            lines.clear();
+            out << "\n";
+        }
+        WriteDoc(out, packet.doc, "    ");
+        lines.push_back({ "PKT_" + packet.name + " = " + to_string(packet.id) + ",", packet.comment });
+    }
+    WriteAligned(out, lines, "    ");
+    out << "};\n\n";
+    out << "inline constexpr uint16 PROTOCOL_MAX_PACKET_ID = " << maxId << ";\n";
+
+    // 패킷별 정의
+    out << "\n/*----------------\n    PacketTraits\n-----------------*/\n";
+    for (const PacketDecl& packet : parser.packets)
+    {
+        out << "template<> struct PacketTraits<PKT_" << packet.name << "> { using Body = "
+            << (packet.body.empty() ? "NoPacketBody" : packet.body)
+            << "; static constexpr bool TRAILING = " << (packet.trailing ? "true" : "false")
+            << "; static constexpr const char* NAME = \"" << packet.name << "\"; };\n";
+    }
+
+    // ID로 찾는 표
+    out << "\n// ID 순서가 아니라 정의 순서\n";
+    out << "inline constexpr PacketInfo GPacketInfos[] =\n{\n";
+    for (const PacketDecl& packet : parser.packets)
+    {
+        out << "    { PKT_" << packet.name << ", PacketTraits<PKT_" << packet.name << ">::NAME, PacketReader<PKT_"
+            << packet.name << ">::MIN_PACKET_SIZE, PacketReader<PKT_" << packet.name << ">::MAX_PACKET_SIZE },\n";
+    }
+    out << "};\n\n";
+
+    out << "// 정의되지 않은 ID면 nullptr\n";
+    out << "inline const PacketInfo* FindPacketInfo(uint16 id)\n{\n    switch (id)\n    {\n";
+    for (size_t i = 0; i < parser.packets.size(); i++)
+        out << "    case PKT_" << parser.packets[i].name << ": return &GPacketInfos[" << i << "];\n";
+    out << "    default: return nullptr;\n    }\n}\n";
+
+    return out.str();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        cerr << "usage: PacketGen <input.idl> <output.h>" << endl;
+        return 2;
+    }
+
+    string inputPath = argv[1];
+    string outputPath = argv[2];
+
+    ifstream input(inputPath, ios::binary);
+    if (!input)
+    {
+        cerr << inputPath << ": cannot open" << endl;
+        return 1;
+    }
+    string source((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+    if (source.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        source.erase(0, 3);
+
+    string generated;
+    try
+    {
+        SourceComments comments;
+        vector<Token> tokens = Tokenize(source, comments);
+        Parser parser(std::move(tokens), std::move(comments));
+        parser.Parse();
+
+        string sourceName = inputPath.substr(inputPath.find_last_of("/\\") + 1);
+        generated = "\xEF\xBB\xBF" + Generate(parser, sourceName);
+    }
+    catch (const ParseError& error)
+    {
+        // MSVC와 GCC가 모두 알아보는 형식 (파일(줄): error: 내용)
+        cerr << inputPath << "(" << error.line << "): error: " << error.message << endl;
+        return 1;
+    }
+
+    ifstream existing(outputPath, ios::binary);
+    if (existing)
+    {
+        string current((istreambuf_iterator<char>(existing)), istreambuf_iterator<char>());
+        if (current == generated)
+            return 0;
+    }
+    existing.close();
+
+    // 출력 위치는 빌드 디렉토리라 처음에는 없을 수 있음
+    error_code dirError;
+    filesystem::path outputDir = filesystem::path(outputPath).parent_path();
+    if (!outputDir.empty())
+        filesystem::create_directories(outputDir, dirError);
+
+    ofstream output(outputPath, ios::binary | ios::trunc);
+    output << generated;
+    if (!output)
+    {
+        cerr << outputPath << ": cannot write" << endl;
+        return 1;
+    }
+
+    cout << "PacketGen: " << inputPath << " -> " << outputPath << endl;
+    return 0;
+}
@@ -0,0 +1,370 @@
+﻿#include "pch.h"
+#include "Session.h"
+#include "Service.h"
+#include "CorePch.h"
+#include "ThreadManager.h"
+#include "LatencyHistogram.h"
+#include "PacketCapture.h"
+#include <iomanip>
+#include <unordered_map>
+
+CoreGlobal Core;
+
+using namespace std;
+
+// 서버의 "capture start"로 기록한 파일을 읽어, 캡처된 세션마다 연결을 만들어 같은 패킷을 같은 시간 간격으로 다시 보냄
+
+struct ReplayConfig
+{
+    string path;
+    string host = "127.0.0.1";
+    uint16_t port = 7777;
+    double speed = 1.0;             // 1: 원래 속도, N: N배 빠르게, 0: 간격 없이 최대한 빠르게
+    int32_t copies = 1;             // 캡처된 세션 하나를 몇 개의 연결로 재생할지
+    int32_t threads = 4;
+    uint32_t drainMs = 1000;        // 다 보낸 뒤 응답을 기다리는 시간
+};
+
+// 캡처된 세션 하나의 패킷 (시각순)
+struct ReplayStream
+{
+    uint32_t sessionId = 0;
+    vector<const CapturedPacket*> packets;
+};
+
+static int64_t NowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Replayer;
+
+/*----------------
+    ReplaySession
+-----------------*/
+class ReplaySession : public PacketSession
+{
+public:
+    ReplaySession(asio::io_context& ioc, Replayer& replayer, const ReplayStream& stream)
+        : PacketSession(ioc), _replayer(replayer), _stream(stream), _timer(ioc) {}
+
+    // 모든 연결이 끝난 뒤 메인 스레드에서 한 번 호출
+    void Begin(int64_t startNs);
+
+    // 아래 값은 io 스레드가 모두 끝난 뒤에 읽음
+    uint64_t Sent() const { return _sent; }
+    uint64_t SentBytes() const { return _sentBytes; }
+    uint64_t Received() const { return _received.load(); }
+    const LatencyHistogram& Lag() const { return _lag; }
+
+protected:
+    virtual void OnConnected() override;
+    virtual void OnDisconnected() override;
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override;
+
+private:
+    void SendDue();
+    void SendPacket(const CapturedPacket& packet);
+    shared_ptr<ReplaySession> GetReplaySessionRef() { return static_pointer_cast<ReplaySession>(shared_from_this()); }
+
+    Replayer& _replayer;
+    const ReplayStream& _stream;
+    asio::steady_timer _timer;
+    int64_t _startNs = 0;
+    size_t _next = 0;
+
+    // 타이머 콜백은 한 번에 하나만 돌므로 락 없이 기록
+    uint64_t _sent = 0;
+    uint64_t _sentBytes = 0;
+    LatencyHistogram _lag;      // 예정 시각보다 늦게 보낸 시간
+
+    atomic<uint64_t> _received = 0;
+};
+
+/*----------------
+    Replayer
+-----------------*/
+class Replayer
+{
+public:
+    Replayer(const ReplayConfig& config) : _config(config) {}
+
+    bool Run();
+
+    // 캡처 시각을 재생 시작 기준 나노초로 변환 (speed 0이면 모두 0)
+    int64_t ScheduleOffset(const CapturedPacket& packet) const
+    {
+        if (_config.speed <= 0)
+            return 0;
+        return static_cast<int64_t>((packet.timestampNs - _firstNs) / _config.speed);
+    }
+
+    void OnConnected() { _connected++; }
+    void OnDisconnected() { _disconnected++; }
+    void OnFinished() { _finished++; }
+
+private:
+    void PrintSummary(double elapsedSec, double sendSec, int32_t disconnects);
+
+    ReplayConfig _config;
+    vector<CapturedPacket> _packets;
+    vector<ReplayStream> _streams;
+    int64_t _firstNs = 0;
+
+    asio::io_context _ioc;
+    shared_ptr<ClientService> _service;
+    vector<shared_ptr<ReplaySession>> _sessions;
+
+    atomic<int32_t> _connected = 0;
+    atomic<int32_t> _disconnected = 0;
+    atomic<int32_t> _finished = 0;
+};
+
+void ReplaySession::OnConnected()
+{
+    _replayer.OnConnected();
+}
+
+void ReplaySession::OnDisconnected()
+{
+    _replayer.OnDisconnected();
+}
+
+void ReplaySession::OnRecvPacket(BYTE* buffer, int32_t len)
+{
+    _received.fetch_add(1, memory_order_relaxed);
+}
+
+void ReplaySession::Begin(int64_t startNs)
+{
+    _startNs = startNs;
+
+    auto self = GetReplaySessionRef();
+    asio::post(_timer.get_executor(), [this, self]() { SendDue(); });
+}
+
+void ReplaySession::SendDue()
+{
+    if (!IsConnected()) {
+        _replayer.OnFinished();
+        return;
+    }
+
+    // 예정 시각이 지난 패킷을 모두 보내고 다음 패킷 시각까지 대기
+    int64_t now = NowNs();
+    while (_next < _stream.packets.size())
+    {
+        const CapturedPacket& packet = *_stream.packets[_next];
+        int64_t dueNs = _startNs + _replayer.ScheduleOffset(packet);
+        if (dueNs > now)
+            break;
+
+        SendPacket(packet);
+        _lag.Record(now - dueNs);
+        _next++;
+    }
+
+    if (_next == _stream.packets.size()) {
+        _replayer.OnFinished();
+        return;
+    }
+
+    int64_t dueNs = _startNs + _replayer.ScheduleOffset(*_stream.packets[_next]);
+    _timer.expires_at(chrono::steady_clock::time_point(chrono::duration_cast<chrono::steady_clock::duration>(chrono::nanoseconds(dueNs))));
+
+    auto self = GetReplaySessionRef();
+    _timer.async_wait([this, self](const std::error_code& error) {
+        if (error) {
+            _replayer.OnFinished();
+            return;
+        }
+        SendDue();
+        });
+}
+
+void ReplaySession::SendPacket(const CapturedPacket& packet)
+{
+    uint32_t size = static_cast<uint32_t>(packet.data.size());
+
+    SendBufferRef sendBuffer = GSendBufferManager->Open(size);
+    ::memcpy(sendBuffer->Buffer(), packet.data.data(), size);
+    sendBuffer->Close(size);
+    Send(sendBuffer);
+
+    _sent++;
+    _sentBytes += size;
+}
+
+bool Replayer::Run()
+{
+    // 1. 캡처 파일을 읽어 캡처된 세션별로 나눔
+    if (!PacketCapture::Load(_config.path, _packets))
+        return false;
+
+    if (_packets.empty()) {
+        cerr << "No packets in " << _config.path << endl;
+        return false;
+    }
+
+    unordered_map<uint32_t, size_t> streamIndex;
+    for (const CapturedPacket& packet : _packets)
+    {
+        auto [it, inserted] = streamIndex.try_emplace(packet.sessionId, _streams.size());
+        if (inserted) {
+            _streams.emplace_back();
+            _streams.back().sessionId = packet.sessionId;
+        }
+        _streams[it->second].packets.push_back(&packet);
+    }
+
+    _firstNs = _packets.front().timestampNs;
+    double capturedSec = (_packets.back().timestampNs - _firstNs) / 1e9;
+    int32_t connections = static_cast<int32_t>(_streams.size()) * _config.copies;
+
+    cout << "Loaded " << _packets.size() << " packets from " << _streams.size() << " sessions, spanning "
+        << fixed << setprecision(3) << capturedSec << " s" << endl;
+    cout << "Replaying over " << connections << " connections at ";
+    if (_config.speed > 0)
+        cout << setprecision(2) << _config.speed << "x (" << setprecision(3) << capturedSec / _config.speed << " s)" << endl;
+    else
+        cout << "full speed" << endl;
+
+    // 2. 스트림 하나당 copies개의 연결 (팩토리가 만든 순서대로 스트림 배정)
+    int32_t nextStream = 0;
+    _service = make_shared<ClientService>(
+        _ioc,
+        NetAddress(_config.host, _config.port),
+        [this, &nextStream](asio::io_context& ioc)
+        {
+            const ReplayStream& stream = _streams[nextStream++ % _streams.size()];
+            auto session = make_shared<ReplaySession>(ioc, *this, stream);
+            _sessions.push_back(session);
+            return session;
+        },
+        connections);
+
+    if (!_service->Start()) {
+        cerr << "Failed to start client service" << endl;
+        return false;
+    }
+
+    auto work = asio::make_work_guard(_ioc);
+    for (int32_t i = 0; i < _config.threads; i++)
+        GThreadManager->Launch([this]() { _ioc.run(); });
+
+    int64_t deadline = NowNs() + 10ll * 1000000000;
+    while (_connected.load() + _disconnected.load() < connections && NowNs() < deadline)
+        this_thread::sleep_for(chrono::milliseconds(1));
+
+    if (_connected.load() < connections)
+        cerr << "Only " << _connected.load() << " of " << connections << " connections established" << endl;
+
+    // 3. 같은 기준 시각으로 모든 세션 재생 시작
+    int64_t startNs = NowNs();
+    for (auto& session : _sessions)
+        session->Begin(startNs);
+
+    while (_finished.load() < static_cast<int32_t>(_sessions.size()))
+        this_thread::sleep_for(chrono::milliseconds(1));
+    double sendSec = (NowNs() - startNs) / 1e9;
+
+    // 4. 남은 응답을 받은 뒤 종료
+    this_thread::sleep_for(chrono::milliseconds(_config.drainMs));
+    double elapsedSec = (NowNs() - startNs) / 1e9;
+    int32_t disconnects = _disconnected.load();
+
+    _service->CloseService();
+    work.reset();
+    _ioc.stop();
+    GThreadManager->Join();
+
+    PrintSummary(elapsedSec, sendSec, disconnects);
+    _sessions.clear();
+    return true;
+}
+
+void Replayer::PrintSummary(double elapsedSec, double sendSec, int32_t disconnects)
+{
+    uint64_t sent = 0;
+    uint64_t sentBytes = 0;
+    uint64_t received = 0;
+    LatencyHistogram lag;
+    for (auto& session : _sessions)
+    {
+        sent += session->Sent();
+        sentBytes += session->SentBytes();
+        received += session->Received();
+        lag.Merge(session->Lag());
+    }
+
+    auto us = [&](double percentile) { return lag.Percentile(percentile) / 1000.0; };
+
+    cout << "\n==== Replay Summary ====" << endl;
+    cout << fixed << setprecision(3);
+    cout << "Send phase: " << sendSec << " s, total with drain: " << elapsedSec << " s" << endl;
+    cout << "Sent: " << sent << " packets, " << sentBytes << " bytes" << endl;
+    cout << setprecision(0) << "Rate: " << sent / max(sendSec, 1e-9) << " packets/s, "
+        << setprecision(2) << sentBytes / max(sendSec, 1e-9) / (1024.0 * 1024.0) << " MB/s" << endl;
+    cout << "Received: " << received << " packets" << endl;
+    if (_config.speed > 0) {
+        cout << setprecision(1) << "Schedule lag (us): p50 " << us(50) << " p99 " << us(99)
+            << " p99.9 " << us(99.9) << " max " << lag.Max() / 1000.0 << endl;
+    }
+    cout << "Disconnects during replay: " << disconnects << endl;
+    cout << "========================" << endl;
+}
+
+static void PrintUsage()
+{
+    cout << "Usage: Replay --file <capture> [options]" << endl;
+    cout << "  --file <path>        Capture written by the server's \"capture start\" command" << endl;
+    cout << "  --host <addr>        Server address (default 127.0.0.1)" << endl;
+    cout << "  --port <port>        Server port (default 7777)" << endl;
+    cout << "  --speed <x>          Time scale: 1 = as captured, N = N times faster, 0 = as fast as possible (default 1)" << endl;
+    cout << "  --copies <n>         Connections per captured session (default 1)" << endl;
+    cout << "  --threads <n>        Number of io threads (default 4)" << endl;
+    cout << "  --drain <ms>         Wait for responses after the last send (default 1000)" << endl;
+}
+
+static bool ParseArgs(int argc, char* argv[], ReplayConfig& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string key = argv[i];
+        if (key == "--help" || i + 1 >= argc)
+            return false;
+
+        string value = argv[++i];
+        if (key == "--file") config.path = value;
+        else if (key == "--host") config.host = value;
+        else if (key == "--port") config.port = static_cast<uint16_t>(stoi(value));
+        else if (key == "--speed") config.speed = stod(value);
+        else if (key == "--copies") config.copies = stoi(value);
+        else if (key == "--threads") config.threads = stoi(value);
+        else if (key == "--drain") config.drainMs = static_cast<uint32_t>(stoul(value));
+        else return false;
+    }
+
+    return !config.path.empty() && config.speed >= 0 && config.copies > 0 && config.threads > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    ReplayConfig config;
+    try {
+        if (!ParseArgs(argc, argv, config)) {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const exception&) {
+        PrintUsage();
+        return 1;
+    }
+
+    cout << "=== Replay ===" << endl;
+    cout << "Target: " << config.host << ":" << config.port << ", io threads: " << config.threads << endl;
+
+    Replayer replayer(config);
+    return replayer.Run() ? 0 : 1;
+}
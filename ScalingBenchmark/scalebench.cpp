@@ -0,0 +1,717 @@
+﻿#include "pch.h"
+#include "Session.h"
+#include "Service.h"
+#include "CorePch.h"
+#include "ThreadManager.h"
+#include "LatencyHistogram.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <ctime>
+
+CoreGlobal Core;
+
+using namespace std;
+
+// 한 프로세스 안에서 ServerService와 ClientService를 루프백으로 연결해 처리량과 지연 시간을 측정
+// 서버/클라이언트가 같은 steady_clock을 쓰므로 브로드캐스트로 받은 메시지도 보낸 시각부터 지연 시간을 잼
+
+enum BenchPacketId
+{
+    PKT_C_BENCH_DATA = 1,   // 클라이언트 -> 서버
+    PKT_S_BENCH_DATA = 2,   // 서버 -> 클라이언트 (에코 또는 브로드캐스트)
+};
+
+// 패킷 헤더 뒤에 붙는 고정 부분 (그 뒤에 페이로드)
+struct BenchData
+{
+    uint32_t senderId;      // 보낸 클라이언트 세션 번호
+    uint32_t sequence;
+    int64_t timestampNs;    // 보낸 시각 (steady_clock 나노초)
+};
+
+static const uint32_t BENCH_HEADER_SIZE = sizeof(PacketHeader) + sizeof(BenchData);
+static const uint32_t MAX_PAYLOAD_SIZE = 60000;    // 패킷 크기가 uint16이므로
+
+enum class BenchMode
+{
+    Echo,       // 받은 메시지를 보낸 세션에게만 돌려줌
+    Broadcast,  // 받은 메시지를 모든 세션에게 보냄
+};
+
+static const char* ModeName(BenchMode mode)
+{
+    return mode == BenchMode::Echo ? "echo" : "broadcast";
+}
+
+struct ScaleConfig
+{
+    vector<BenchMode> modes = { BenchMode::Echo, BenchMode::Broadcast };
+    vector<int32_t> threads = { 1, 2, 4 };          // 서버 io 스레드 수
+    vector<uint32_t> sizes = { 64, 1024 };          // 페이로드 크기
+    vector<int32_t> connections = { 16, 64 };
+    int32_t clientThreads = 0;                      // 0이면 서버 스레드 수와 같게
+    uint32_t outstanding = 1;                       // 연결당 동시에 보낼 메시지 수
+    uint32_t busyPollUs = 0;                        // 서버 io 스레드가 잠들기 전에 폴링하는 최대 시간
+    double warmupSec = 1.0;
+    double durationSec = 3.0;
+    uint16_t port = 7790;
+    string csvPath;
+    string jsonPath;
+    string baselinePath;                            // 이전 CSV와 비교해 처리량이 떨어졌으면 실패
+    double tolerance = 10.0;                        // 허용하는 처리량 감소 (%)
+};
+
+// 한 번의 실행 조건
+struct ScaleCase
+{
+    BenchMode mode;
+    int32_t serverThreads;
+    int32_t clientThreads;
+    int32_t connections;
+    uint32_t payloadSize;
+    uint32_t outstanding;
+};
+
+struct ScaleResult
+{
+    ScaleCase config;
+    double seconds = 0;
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t bytes = 0;
+    double msgsPerSec = 0;
+    double mbPerSec = 0;
+    double cpuUsPerMsg = 0;     // 프로세스 전체 (서버 + 클라이언트) CPU 시간을 받은 메시지 수로 나눈 값
+    double cpuCores = 0;        // 측정 구간 동안 평균적으로 사용한 코어 수
+    LatencyHistogram latency;
+};
+
+static int64_t NowNs()
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 프로세스가 사용한 CPU 시간 (user + kernel, 초)
+static double ProcessCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!::GetProcessTimes(::GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0.0;
+
+    auto toSeconds = [](const FILETIME& time) {
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7;
+        };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+#endif
+}
+
+class ScaleBench;
+
+/*----------------
+    BenchServerSession
+-----------------*/
+class BenchServerSession : public PacketSession
+{
+public:
+    BenchServerSession(asio::io_context& ioc, ScaleBench& bench) : PacketSession(ioc), _bench(bench) {}
+
+protected:
+    virtual void OnConnected() override;
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override;
+
+private:
+    ScaleBench& _bench;
+};
+
+/*----------------
+    BenchClientSession
+-----------------*/
+class BenchClientSession : public PacketSession
+{
+public:
+    BenchClientSession(asio::io_context& ioc, ScaleBench& bench, uint32_t id) : PacketSession(ioc), _bench(bench), _id(id) {}
+
+    // 측정 시작 시 메인 스레드에서 호출
+    void Kick(uint32_t count);
+
+    // 아래 값은 io 스레드가 모두 끝난 뒤에 읽음
+    uint64_t Sent() const { return _sent.load(); }
+    uint64_t Received() const { return _received; }
+    uint64_t Bytes() const { return _bytes; }
+    const LatencyHistogram& Latency() const { return _latency; }
+
+protected:
+    virtual void OnConnected() override;
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override;
+
+private:
+    void SendNext();
+
+    ScaleBench& _bench;
+    uint32_t _id;
+    atomic<uint32_t> _sequence = 0;
+    atomic<uint64_t> _sent = 0;     // Kick(메인 스레드)과 수신 콜백에서 증가
+
+    // 한 세션의 수신 콜백은 동시에 실행되지 않으므로 락 없이 기록
+    uint64_t _received = 0;
+    uint64_t _bytes = 0;
+    LatencyHistogram _latency;
+};
+
+/*----------------
+    ScaleBench
+-----------------*/
+class ScaleBench
+{
+public:
+    ScaleBench(const ScaleConfig& config) : _config(config) {}
+
+    bool Run();
+
+    BenchMode Mode() const { return _case.mode; }
+    uint32_t PayloadSize() const { return _case.payloadSize; }
+    bool IsRunning() const { return _running.load(memory_order_relaxed); }
+    bool IsMeasuring() const { return _measuring.load(memory_order_relaxed); }
+
+    void OnServerConnected() { _serverConnected++; }
+    void OnClientConnected() { _clientConnected++; }
+
+private:
+    bool RunCase(const ScaleCase& config, ScaleResult& result);
+    bool WaitConnected(int32_t connections);
+
+    static void PrintHeader();
+    static void PrintResult(const ScaleResult& result);
+    bool WriteCsv(const string& path) const;
+    bool WriteJson(const string& path) const;
+    bool CheckBaseline(const string& path) const;
+
+    ScaleConfig _config;
+    vector<ScaleResult> _results;
+
+    // 실행 중인 케이스
+    ScaleCase _case = {};
+    atomic<bool> _running = false;      // false가 되면 다음 메시지를 보내지 않음
+    atomic<bool> _measuring = false;    // 워밍업이 끝난 뒤 측정 구간에만 기록
+    atomic<int32_t> _serverConnected = 0;
+    atomic<int32_t> _clientConnected = 0;
+    vector<shared_ptr<BenchClientSession>> _clients;
+};
+
+// 브로드캐스트처럼 응답을 기다리지 않는 전송은 Nagle + 지연 ACK로 수십 ms씩 묶이므로 양쪽 모두 끔
+static void DisableNagle(asio::ip::tcp::socket& socket)
+{
+    std::error_code ec;
+    socket.set_option(asio::ip::tcp::no_delay(true), ec);
+}
+
+void BenchServerSession::OnConnected()
+{
+    DisableNagle(GetSocket());
+    _bench.OnServerConnected();
+}
+
+void BenchServerSession::OnRecvPacket(BYTE* buffer, int32_t len)
+{
+    PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
+    if (header->id != PKT_C_BENCH_DATA)
+        return;
+
+    // 받은 패킷을 그대로 복사해 ID만 바꿔 보냄
+    SendBufferRef sendBuffer = GSendBufferManager->Open(len);
+    ::memcpy(sendBuffer->Buffer(), buffer, len);
+    reinterpret_cast<PacketHeader*>(sendBuffer->Buffer())->id = PKT_S_BENCH_DATA;
+    sendBuffer->Close(len);
+
+    if (_bench.Mode() == BenchMode::Echo) {
+        Send(sendBuffer);
+    }
+    else if (auto service = GetService()) {
+        service->Broadcast(sendBuffer);
+    }
+}
+
+void BenchClientSession::OnConnected()
+{
+    DisableNagle(GetSocket());
+    _bench.OnClientConnected();
+}
+
+void BenchClientSession::Kick(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+        SendNext();
+}
+
+void BenchClientSession::OnRecvPacket(BYTE* buffer, int32_t len)
+{
+    PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
+    if (header->id != PKT_S_BENCH_DATA || len < static_cast<int32_t>(BENCH_HEADER_SIZE))
+        return;
+
+    BenchData data;
+    ::memcpy(&data, buffer + sizeof(PacketHeader), sizeof(data));
+
+    if (_bench.IsMeasuring()) {
+        _received++;
+        _bytes += len;
+        _latency.Record(NowNs() - data.timestampNs);
+    }
+
+    // 닫힌 루프: 자기가 보낸 메시지가 돌아오면 다음 메시지를 보냄 (브로드캐스트로 받은 남의 메시지는 세기만 함)
+    if (data.senderId == _id && _bench.IsRunning())
+        SendNext();
+}
+
+void BenchClientSession::SendNext()
+{
+    uint32_t packetSize = BENCH_HEADER_SIZE + _bench.PayloadSize();
+
+    SendBufferRef sendBuffer = GSendBufferManager->Open(packetSize);
+    PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
+    header->size = static_cast<uint16_t>(packetSize);
+    header->id = PKT_C_BENCH_DATA;
+
+    BenchData data = { _id, ++_sequence, NowNs() };
+    ::memcpy(sendBuffer->Buffer() + sizeof(PacketHeader), &data, sizeof(data));
+    ::memset(sendBuffer->Buffer() + BENCH_HEADER_SIZE, static_cast<int>(data.sequence & 0xFF), _bench.PayloadSize());
+    sendBuffer->Close(packetSize);
+
+    if (_bench.IsMeasuring())
+        _sent.fetch_add(1, memory_order_relaxed);
+    Send(sendBuffer);
+}
+
+bool ScaleBench::Run()
+{
+    PrintHeader();
+
+    for (BenchMode mode : _config.modes)
+    {
+        for (uint32_t size : _config.sizes)
+        {
+            for (int32_t connections : _config.connections)
+            {
+                for (int32_t threads : _config.threads)
+                {
+                    ScaleCase config = { mode, threads, _config.clientThreads > 0 ? _config.clientThreads : threads, connections, size, _config.outstanding };
+                    ScaleResult result;
+                    if (!RunCase(config, result))
+                        return false;
+
+                    PrintResult(result);
+                    _results.push_back(move(result));
+                }
+            }
+        }
+    }
+
+    if (!_config.csvPath.empty() && !WriteCsv(_config.csvPath))
+        return false;
+    if (!_config.jsonPath.empty() && !WriteJson(_config.jsonPath))
+        return false;
+    if (!_config.baselinePath.empty())
+        return CheckBaseline(_config.baselinePath);
+
+    return true;
+}
+
+bool ScaleBench::RunCase(const ScaleCase& config, ScaleResult& result)
+{
+    _case = config;
+    _running = false;
+    _measuring = false;
+    _serverConnected = 0;
+    _clientConnected = 0;
+    _clients.clear();
+
+    // 서버와 클라이언트가 서로 다른 io_context와 스레드를 사용 (서버 스레드 수만 바꿔 확장성을 봄)
+    asio::io_context serverIoc;
+    asio::io_context clientIoc;
+    auto serverWork = asio::make_work_guard(serverIoc);
+    auto clientWork = asio::make_work_guard(clientIoc);
+
+    NetAddress address("127.0.0.1", _config.port);
+
+    // 마지막 연결 뒤에도 accept를 걸어 둘 수 있도록 최대 세션 수에 여유를 둠
+    auto server = make_shared<ServerService>(
+        serverIoc,
+        address,
+        [this](asio::io_context& ioc) { return make_shared<BenchServerSession>(ioc, *this); },
+        config.connections + 1);
+
+    auto client = make_shared<ClientService>(
+        clientIoc,
+        address,
+        [this](asio::io_context& ioc)
+        {
+            auto session = make_shared<BenchClientSession>(ioc, *this, static_cast<uint32_t>(_clients.size()));
+            _clients.push_back(session);
+            return session;
+        },
+        config.connections);
+
+    try {
+        if (!server->Start()) {
+            cerr << "Failed to start server service on port " << _config.port << endl;
+            return false;
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Failed to start server service on port " << _config.port << ": " << e.what() << endl;
+        return false;
+    }
+
+    for (int32_t i = 0; i < config.serverThreads; i++)
+        GThreadManager->Launch([&serverIoc, this]() { ThreadManager::RunIoContext(serverIoc, { _config.busyPollUs }); });
+    for (int32_t i = 0; i < config.clientThreads; i++)
+        GThreadManager->Launch([&clientIoc]() { clientIoc.run(); });
+
+    // 1. 모든 연결이 양쪽에서 완료될 때까지 대기
+    bool connected = client->Start() && WaitConnected(config.connections);
+    double cpuSeconds = 0;
+
+    if (connected) {
+        // 2. 메시지 흘리기 시작 -> 워밍업 -> 측정
+        _running = true;
+        for (auto& session : _clients)
+            session->Kick(config.outstanding);
+
+        this_thread::sleep_for(chrono::duration<double>(_config.warmupSec));
+
+        double cpuStart = ProcessCpuSeconds();
+        int64_t start = NowNs();
+        _measuring = true;
+        this_thread::sleep_for(chrono::duration<double>(_config.durationSec));
+        _measuring = false;
+        int64_t end = NowNs();
+        double cpuEnd = ProcessCpuSeconds();
+
+        cpuSeconds = cpuEnd - cpuStart;
+        result.seconds = (end - start) / 1e9;
+        result.cpuCores = cpuSeconds / result.seconds;
+
+        // 3. 새 메시지를 멈추고 날아가는 중인 메시지가 빠질 시간을 줌
+        _running = false;
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+    else {
+        cerr << "Timed out connecting " << config.connections << " sessions ("
+            << _clientConnected.load() << " client, " << _serverConnected.load() << " server)" << endl;
+    }
+
+    client->CloseService();
+    server->CloseService();
+    clientWork.reset();
+    serverWork.reset();
+    clientIoc.stop();
+    serverIoc.stop();
+    GThreadManager->Join();
+
+    if (!connected)
+        return false;
+
+    // 4. io 스레드가 모두 끝났으므로 세션별 통계를 그대로 합침
+    result.config = config;
+    for (auto& session : _clients)
+    {
+        result.sent += session->Sent();
+        result.received += session->Received();
+        result.bytes += session->Bytes();
+        result.latency.Merge(session->Latency());
+    }
+    _clients.clear();
+
+    result.msgsPerSec = result.received / result.seconds;
+    result.mbPerSec = result.bytes / result.seconds / (1024.0 * 1024.0);
+    result.cpuUsPerMsg = result.received > 0 ? cpuSeconds * 1e6 / result.received : 0.0;
+    return true;
+}
+
+bool ScaleBench::WaitConnected(int32_t connections)
+{
+    int64_t deadline = NowNs() + 10ll * 1000000000;
+    while (_clientConnected.load() < connections || _serverConnected.load() < connections)
+    {
+        if (NowNs() > deadline)
+            return false;
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void ScaleBench::PrintHeader()
+{
+    cout << left << setw(10) << "Mode" << right
+        << setw(6) << "Srv"
+        << setw(6) << "Cli"
+        << setw(7) << "Conns"
+        << setw(7) << "Size"
+        << setw(12) << "msgs/s"
+        << setw(10) << "MB/s"
+        << setw(10) << "cpu us"
+        << setw(7) << "cores"
+        << setw(10) << "p50 us"
+        << setw(10) << "p99 us"
+        << setw(10) << "p99.9 us"
+        << setw(10) << "max us" << endl;
+    cout << string(115, '-') << endl;
+}
+
+void ScaleBench::PrintResult(const ScaleResult& result)
+{
+    auto us = [&](double percentile) { return result.latency.Percentile(percentile) / 1000.0; };
+
+    cout << left << setw(10) << ModeName(result.config.mode) << right
+        << setw(6) << result.config.serverThreads
+        << setw(6) << result.config.clientThreads
+        << setw(7) << result.config.connections
+        << setw(7) << result.config.payloadSize
+        << fixed << setprecision(0) << setw(12) << result.msgsPerSec
+        << setprecision(2) << setw(10) << result.mbPerSec
+        << setprecision(2) << setw(10) << result.cpuUsPerMsg
+        << setprecision(2) << setw(7) << result.cpuCores
+        << setprecision(1) << setw(10) << us(50)
+        << setw(10) << us(99)
+        << setw(10) << us(99.9)
+        << setw(10) << result.latency.Max() / 1000.0 << endl;
+}
+
+bool ScaleBench::WriteCsv(const string& path) const
+{
+    ofstream file(path, ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Cannot open " << path << endl;
+        return false;
+    }
+
+    file << "mode,server_threads,client_threads,connections,payload,outstanding,seconds,sent,received,"
+        "msgs_per_sec,mb_per_sec,cpu_us_per_msg,cpu_cores,p50_us,p90_us,p99_us,p999_us,max_us\n";
+
+    file << fixed;
+    for (const ScaleResult& result : _results)
+    {
+        auto us = [&](double percentile) { return result.latency.Percentile(percentile) / 1000.0; };
+        file << ModeName(result.config.mode) << ','
+            << result.config.serverThreads << ','
+            << result.config.clientThreads << ','
+            << result.config.connections << ','
+            << result.config.payloadSize << ','
+            << result.config.outstanding << ','
+            << setprecision(3) << result.seconds << ','
+            << result.sent << ','
+            << result.received << ','
+            << setprecision(1) << result.msgsPerSec << ','
+            << setprecision(3) << result.mbPerSec << ','
+            << setprecision(3) << result.cpuUsPerMsg << ','
+            << setprecision(3) << result.cpuCores << ','
+            << setprecision(1) << us(50) << ',' << us(90) << ',' << us(99) << ',' << us(99.9) << ','
+            << result.latency.Max() / 1000.0 << '\n';
+    }
+
+    cout << "Wrote " << _results.size() << " rows to " << path << endl;
+    return file.good();
+}
+
+bool ScaleBench::WriteJson(const string& path) const
+{
+    ofstream file(path, ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Cannot open " << path << endl;
+        return false;
+    }
+
+    file << fixed << "{\n  \"hardware_threads\": " << thread::hardware_concurrency()
+        << ",\n  \"warmup_sec\": " << setprecision(3) << _config.warmupSec
+        << ",\n  \"duration_sec\": " << _config.durationSec
+        << ",\n  \"busy_poll_us\": " << _config.busyPollUs
+        << ",\n  \"runs\": [\n";
+
+    for (size_t i = 0; i < _results.size(); i++)
+    {
+        const ScaleResult& result = _results[i];
+        auto us = [&](double percentile) { return result.latency.Percentile(percentile) / 1000.0; };
+        file << "    {\"mode\": \"" << ModeName(result.config.mode) << "\""
+            << ", \"server_threads\": " << result.config.serverThreads
+            << ", \"client_threads\": " << result.config.clientThreads
+            << ", \"connections\": " << result.config.connections
+            << ", \"payload\": " << result.config.payloadSize
+            << ", \"outstanding\": " << result.config.outstanding
+            << ", \"seconds\": " << setprecision(3) << result.seconds
+            << ", \"sent\": " << result.sent
+            << ", \"received\": " << result.received
+            << ", \"msgs_per_sec\": " << setprecision(1) << result.msgsPerSec
+            << ", \"mb_per_sec\": " << setprecision(3) << result.mbPerSec
+            << ", \"cpu_us_per_msg\": " << result.cpuUsPerMsg
+            << ", \"cpu_cores\": " << result.cpuCores
+            << ", \"latency_us\": {\"p50\": " << setprecision(1) << us(50)
+            << ", \"p90\": " << us(90)
+            << ", \"p99\": " << us(99)
+            << ", \"p99.9\": " << us(99.9)
+            << ", \"max\": " << result.latency.Max() / 1000.0 << "}}"
+            << (i + 1 < _results.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n}\n";
+
+    cout << "Wrote " << _results.size() << " runs to " << path << endl;
+    return file.good();
+}
+
+bool ScaleBench::CheckBaseline(const string& path) const
+{
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Cannot open baseline " << path << endl;
+        return false;
+    }
+
+    // 앞의 다섯 열(mode ~ payload)이 같은 행끼리 msgs/s 비교
+    map<string, double> baseline;
+    string line;
+    getline(file, line);
+    while (getline(file, line))
+    {
+        vector<string> fields;
+        stringstream stream(line);
+        string field;
+        while (getline(stream, field, ','))
+            fields.push_back(field);
+        if (fields.size() < 10)
+            continue;
+
+        string key = fields[0] + "," + fields[1] + "," + fields[2] + "," + fields[3] + "," + fields[4];
+        baseline[key] = atof(fields[9].c_str());
+    }
+
+    bool passed = true;
+    cout << "\n==== Baseline comparison (tolerance " << fixed << setprecision(1) << _config.tolerance << "%) ====" << endl;
+    for (const ScaleResult& result : _results)
+    {
+        const ScaleCase& c = result.config;
+        string key = string(ModeName(c.mode)) + "," + to_string(c.serverThreads) + "," + to_string(c.clientThreads) + ","
+            + to_string(c.connections) + "," + to_string(c.payloadSize);
+
+        auto it = baseline.find(key);
+        if (it == baseline.end() || it->second <= 0)
+            continue;
+
+        double change = (result.msgsPerSec - it->second) / it->second * 100.0;
+        bool regressed = change < -_config.tolerance;
+        passed &= !regressed;
+
+        cout << (regressed ? "REGRESSED " : "ok        ") << key
+            << "  " << setprecision(0) << it->second << " -> " << result.msgsPerSec << " msgs/s ("
+            << showpos << setprecision(1) << change << noshowpos << "%)" << endl;
+    }
+
+    cout << (passed ? "PASSED" : "FAILED") << endl;
+    return passed;
+}
+
+static void PrintUsage()
+{
+    cout << "Usage: ScalingBenchmark [options]" << endl;
+    cout << "  --modes <list>           echo,broadcast (default both)" << endl;
+    cout << "  --threads <list>         Server io thread counts to sweep (default 1,2,4)" << endl;
+    cout << "  --client-threads <n>     Client io threads (default: same as server)" << endl;
+    cout << "  --sizes <list>           Payload sizes in bytes, up to 60000 (default 64,1024)" << endl;
+    cout << "  --connections <list>     Connection counts to sweep (default 16,64)" << endl;
+    cout << "  --outstanding <n>        Messages in flight per connection (default 1)" << endl;
+    cout << "  --busy-poll <us>         Server io threads spin this long before blocking (default 0)" << endl;
+    cout << "  --warmup <sec>           Warm-up before each measurement (default 1)" << endl;
+    cout << "  --duration <sec>         Measurement time per run (default 3)" << endl;
+    cout << "  --port <port>            Loopback port (default 7790)" << endl;
+    cout << "  --csv <path>             Write results as CSV" << endl;
+    cout << "  --json <path>            Write results as JSON" << endl;
+    cout << "  --baseline <csv>         Fail if msgs/s drops below a previous CSV run" << endl;
+    cout << "  --tolerance <percent>    Allowed msgs/s drop against the baseline (default 10)" << endl;
+}
+
+template<typename T, typename Parse>
+static vector<T> ParseList(const string& value, Parse parse)
+{
+    vector<T> list;
+    stringstream stream(value);
+    string item;
+    while (getline(stream, item, ','))
+        list.push_back(static_cast<T>(parse(item)));
+    return list;
+}
+
+static bool ParseArgs(int argc, char* argv[], ScaleConfig& config)
+{
+    auto toInt = [](const string& text) { return stoi(text); };
+
+    for (int i = 1; i < argc; i++)
+    {
+        string key = argv[i];
+        if (key == "--help" || i + 1 >= argc)
+            return false;
+
+        string value = argv[++i];
+        if (key == "--threads") config.threads = ParseList<int32_t>(value, toInt);
+        else if (key == "--client-threads") config.clientThreads = stoi(value);
+        else if (key == "--sizes") config.sizes = ParseList<uint32_t>(value, toInt);
+        else if (key == "--connections") config.connections = ParseList<int32_t>(value, toInt);
+        else if (key == "--outstanding") config.outstanding = static_cast<uint32_t>(stoul(value));
+        else if (key == "--busy-poll") config.busyPollUs = static_cast<uint32_t>(stoul(value));
+        else if (key == "--warmup") config.warmupSec = stod(value);
+        else if (key == "--duration") config.durationSec = stod(value);
+        else if (key == "--port") config.port = static_cast<uint16_t>(stoi(value));
+        else if (key == "--csv") config.csvPath = value;
+        else if (key == "--json") config.jsonPath = value;
+        else if (key == "--baseline") config.baselinePath = value;
+        else if (key == "--tolerance") config.tolerance = stod(value);
+        else if (key == "--modes") {
+            config.modes.clear();
+            for (const string& name : ParseList<string>(value, [](const string& text) { return text; }))
+            {
+                if (name == "echo") config.modes.push_back(BenchMode::Echo);
+                else if (name == "broadcast") config.modes.push_back(BenchMode::Broadcast);
+                else return false;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+
+    auto positive = [](int32_t value) { return value > 0; };
+    return !config.modes.empty() && !config.threads.empty() && !config.sizes.empty() && !config.connections.empty() &&
+        all_of(config.threads.begin(), config.threads.end(), positive) &&
+        all_of(config.connections.begin(), config.connections.end(), positive) &&
+        all_of(config.sizes.begin(), config.sizes.end(), [](uint32_t size) { return size <= MAX_PAYLOAD_SIZE; }) &&
+        config.clientThreads >= 0 && config.outstanding > 0 && config.warmupSec >= 0 && config.durationSec > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    ScaleConfig config;
+    try {
+        if (!ParseArgs(argc, argv, config)) {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const exception&) {
+        PrintUsage();
+        return 1;
+    }
+
+    cout << "=== Scaling Benchmark ===" << endl;
+    cout << "Hardware threads: " << thread::hardware_concurrency()
+        << ", warm-up " << config.warmupSec << " s, measure " << config.durationSec << " s per run"
+        << ", outstanding " << config.outstanding << " per connection" << endl;
+    cout << "msgs/s counts deliveries to clients (broadcast fans out to every connection)" << endl;
+    cout << "cpu us is process CPU time (server + clients) per delivered message" << endl << endl;
+
+    ScaleBench bench(config);
+    return bench.Run() ? 0 : 1;
+}
@@ -4,66 +4,227 @@
 #include "CorePch.h"
 #include "Service.h"
 #include "FileTransfer.h"
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+#include "AdminServer.h"
+#include "Tracer.h"
+#include "Logger.h"
+#include "PacketCapture.h"
+#include "PubSub.h"
+#include "World.h"
+#include "AoiGrid.h"
+#include "Snapshot.h"
+#include "Protocol.h"
+#include <cmath>
 
 CoreGlobal Core;
 
 using namespace std;
 
-// 패킷 ID 정의
-enum PacketId
-{
-    PKT_C_CHAT = 1,
-    PKT_S_CHAT = 2,
-
-    // 과부하 테스트용 패킷 ID 추가
-    PKT_C_STRESS_START = 3,    // 클라이언트가 서버에 과부하 테스트 시작 요청
-    PKT_S_STRESS_START = 4,    // 서버가 클라이언트에 과부하 테스트 시작 확인
-    PKT_C_STRESS_DATA = 5,     // 클라이언트가 보내는 과부하 테스트 데이터
-    PKT_S_STRESS_DATA = 6,     // 서버가 보내는 과부하 테스트 데이터
-    PKT_C_STRESS_END = 7,      // 클라이언트가 서버에 과부하 테스트 종료 알림
-    PKT_S_STRESS_RESULT = 8,   // 서버가 보내는 과부하 테스트 결과
-
-    // 파일 전송 관련 패킷 ID
-    PKT_FILE_REQUEST = static_cast<uint16_t>(FileTransferPacketId::FileTransferRequest),
-    PKT_FILE_RESPONSE = static_cast<uint16_t>(FileTransferPacketId::FileTransferResponse),
-    PKT_FILE_DATA = static_cast<uint16_t>(FileTransferPacketId::FileDataChunk),
-    PKT_FILE_COMPLETE = static_cast<uint16_t>(FileTransferPacketId::FileTransferComplete),
-    PKT_FILE_ERROR = static_cast<uint16_t>(FileTransferPacketId::FileTransferError)
-};
+// 토픽 구독/발행 (main에서 생성)
+PubSub* GPubSub = nullptr;
 
-struct ChatData
+/*----------------
+    GameWorld
+-----------------*/
+// 채팅과 이동을 처리하는 월드 (틱 스레드에서만 상태를 건드림)
+// 플레이어 엔티티 id는 세션 id, 플레이어 목록은 틱마다 스냅샷 델타로 모든 클라이언트에 보냄
+class GameWorld : public World
 {
-    char msg[100]; // 메시지 최대 99자 + null
-};
+public:
+    GameWorld() : World("main"), _grid(CELL_SIZE, VIEW_RANGE), _snapshots(SNAPSHOT_FIELD_COUNT, MAX_SNAPSHOT_PLAYERS)
+    {
+        for (uint32_t slot = MAX_SNAPSHOT_PLAYERS; slot > 0; slot--)
+            _freeSlots.push_back(slot - 1);
+    }
 
-// 과부하 테스트 시작 요청 패킷
-struct StressTestStartData
-{
-    uint32_t messageCount;     // 전송할 메시지 수
-    uint32_t messageSize;      // 메시지 크기 (바이트)
-    uint32_t intervalMs;       // 전송 간격 (밀리초)
-};
+    uint32_t GetPlayerCount() const { return _playerCount.load(std::memory_order_relaxed); }
 
-// 과부하 테스트 데이터 패킷
-struct StressTestData
-{
-    uint32_t sequenceNumber;   // 메시지 순번
-    uint32_t timestamp;        // 전송 시간 (밀리초)
-    char data[4000];           // 데이터 버퍼 (가변 크기로 사용)
-};
+protected:
+    virtual void OnJoin(const SessionRef& session) override
+    {
+        uint32_t id = session->GetSessionId();
+        if (!_grid.AddObserver(id, 0.0f, 0.0f, session))
+            return;
 
-// 과부하 테스트 결과 패킷
-struct StressTestResult
-{
-    uint32_t totalMessages;     // 총 메시지 수
-    uint32_t receivedMessages;  // 받은 메시지 수
-    uint32_t lostMessages;      // 손실된 메시지 수
-    float avgLatencyMs;         // 평균 지연 시간 (밀리초)
-    float maxLatencyMs;         // 최대 지연 시간 (밀리초)
-    float minLatencyMs;         // 최소 지연 시간 (밀리초)
-    float dataRateMBps;         // 데이터 전송률 (MB/s)
+        // 슬롯이 모자라면 스냅샷에서만 빠짐
+        uint32_t slot = NO_SLOT;
+        if (!_freeSlots.empty())
+        {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+            _snapshots.Set(slot, SNAPSHOT_FIELD_ID, id);
+            _snapshots.SetFloat(slot, SNAPSHOT_FIELD_X, 0.0f);
+            _snapshots.SetFloat(slot, SNAPSHOT_FIELD_Y, 0.0f);
+        }
+
+        _players[id] = Player{ session, 0.0f, 0.0f, slot };
+        _playerCount.store(static_cast<uint32_t>(_players.size()), std::memory_order_relaxed);
+    }
+
+    virtual void OnLeave(const SessionRef& session) override
+    {
+        uint32_t id = session->GetSessionId();
+        auto it = _players.find(id);
+        if (it == _players.end())
+            return;
+
+        if (it->second.slot != NO_SLOT)
+        {
+            _snapshots.Remove(it->second.slot);
+            _freeSlots.push_back(it->second.slot);
+        }
+
+        _grid.Remove(id);
+        _players.erase(it);
+        _playerCount.store(static_cast<uint32_t>(_players.size()), std::memory_order_relaxed);
+    }
+
+    virtual void OnPacket(const SessionRef& session, BYTE* packet, int32 len) override
+    {
+        // 크기가 맞지 않는 패킷은 버림
+        GetDispatcher().Dispatch(*this, packet, len, session);
+    }
+
+    virtual void OnTick(float deltaSeconds) override
+    {
+        _events.clear();
+        _grid.Update(_events);
+
+        for (const AoiEvent& event : _events)
+        {
+            if (event.type == AoiEvent::Type::Move)
+                continue;
+
+            auto observer = _players.find(event.observer);
+            if (observer == _players.end())
+                continue;
+
+            SendBufferRef sendBuffer = event.type == AoiEvent::Type::Enter ?
+                MakeEntityPacket<PKT_S_ENTER>(event.subject) : MakeEntityPacket<PKT_S_LEAVE>(event.subject);
+            if (sendBuffer == nullptr)
+            {
+                // 알림 하나를 못 만들어도 스냅샷과 이동 묶음은 이번 틱에 보냄
+                LOG_WARN_EVERY(1000, "[GameWorld] Failed to allocate AOI packet for observer {}", event.observer);
+                continue;
+            }
+
+            Send(observer->second.session, sendBuffer);
+        }
+
+        // 플레이어 목록 스냅샷: 클라이언트마다 마지막으로 확인한 프레임 기준 델타 (기준이 같은 클라이언트는 버퍼 공유)
+        _snapshots.Commit();
+        for (auto& [id, player] : _players)
+        {
+            for (const SendBufferRef& packet : _snapshots.EncodeDelta(player.ackedFrame, PKT_S_SNAPSHOT))
+                Send(player.session, packet);
+        }
+
+        // 진입 알림이 이동 묶음보다 먼저 도착하도록 모아 둔 출력을 먼저 보냄
+        FlushOutput();
+        _grid.FlushMoves(PKT_S_MOVE_BATCH);
+    }
+
+private:
+    using Dispatcher = PacketDispatcher<GameWorld, const SessionRef&>;
+
+    static const Dispatcher& GetDispatcher()
+    {
+        static const Dispatcher SDispatcher = []()
+        {
+            Dispatcher dispatcher;
+            dispatcher.Register<PKT_C_CHAT, &GameWorld::HandleChat>();
+            dispatcher.Register<PKT_C_MOVE, &GameWorld::HandleMove>();
+            dispatcher.Register<PKT_C_SNAPSHOT_ACK, &GameWorld::HandleSnapshotAck>();
+            return dispatcher;
+        }();
+        return SDispatcher;
+    }
+
+    void HandleChat(const PacketReader<PKT_C_CHAT>& packet, const SessionRef& session)
+    {
+        LOG_INFO("Client Says: {}", PacketString(packet->msg));
+
+        // 에코 응답 (틱 끝에 다른 출력과 함께 전송)
+        PacketWriter<PKT_S_CHAT> writer;
+        if (!writer.IsValid()) return;
+
+        PacketCopyString(writer->msg, "Server received your message!");
+        Send(session, writer.Finish());
+    }
+
+    void HandleMove(const PacketReader<PKT_C_MOVE>& packet, const SessionRef& session)
+    {
+        auto it = _players.find(session->GetSessionId());
+        if (it == _players.end()) return;
+
+        float x = packet->x;
+        float y = packet->y;
+        if (!std::isfinite(x) || !std::isfinite(y)) return;
+
+        it->second.x = x;
+        it->second.y = y;
+        _grid.Move(it->first, x, y);
+        if (it->second.slot != NO_SLOT)
+        {
+            _snapshots.SetFloat(it->second.slot, SNAPSHOT_FIELD_X, x);
+            _snapshots.SetFloat(it->second.slot, SNAPSHOT_FIELD_Y, y);
+        }
+    }
+
+    void HandleSnapshotAck(const PacketReader<PKT_C_SNAPSHOT_ACK>& packet, const SessionRef& session)
+    {
+        auto it = _players.find(session->GetSessionId());
+        if (it == _players.end()) return;
+
+        // 링에 남아 있는 프레임만 기준으로 받음 (앞으로만 진행)
+        uint32_t frame = packet->frame;
+        if (frame > it->second.ackedFrame && _snapshots.HasFrame(frame))
+            it->second.ackedFrame = frame;
+    }
+
+    // 시야 진입/이탈 알림 (제거된 엔티티는 위치 0)
+    template<uint16 Id>
+    SendBufferRef MakeEntityPacket(uint32_t id)
+    {
+        PacketWriter<Id> writer;
+        if (!writer.IsValid()) return nullptr;
+
+        writer->id = id;
+        auto subject = _players.find(id);
+        if (subject != _players.end())
+        {
+            writer->x = subject->second.x;
+            writer->y = subject->second.y;
+        }
+        return writer.Finish();
+    }
+
+private:
+    static constexpr float CELL_SIZE = 100.0f;
+    static constexpr float VIEW_RANGE = 100.0f;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    struct Player
+    {
+        SessionRef session;
+        float x;
+        float y;
+        uint32_t slot;              // 스냅샷 슬롯 (NO_SLOT이면 스냅샷에 없음)
+        uint32_t ackedFrame = 0;    // 클라이언트가 마지막으로 확인한 스냅샷 프레임
+    };
+
+    AoiGrid _grid;
+    SnapshotRing _snapshots;
+    std::vector<uint32_t> _freeSlots;
+    std::unordered_map<uint32_t, Player> _players;
+    std::vector<AoiEvent> _events;
+    std::atomic<uint32_t> _playerCount = 0;
 };
 
+// 게임 월드 (main에서 생성)
+GameWorld* GWorld = nullptr;
+
 class GameSession : public FilePacketSession
 {
 public:
@@ -96,9 +257,14 @@ public:
         std::cout << "Setting receive directory to: " << absPath << std::endl;
         SetFileReceiveDirectory(absPath);
 
+        // 클라이언트가 내려받을 수 있는 공개 디렉토리 (패치, 맵 등 - 모든 세션이 공유 캐시를 통해 전송)
+        std::string serveDir = "./server_public_files";
+        fs::create_directories(serveDir, ec);
+        SetFileServeDirectory(fs::absolute(serveDir, ec).string());
+
         // 파일 전송 완료 콜백 설정
         GetFileTransferManager()->SetTransferCompleteCallback(
-            [this](uint32_t connectionId, bool success, const std::string& filePath) {
+            [this](uint32_t transferId, bool success, const std::string& filePath) {
                 if (success) {
                     std::cout << "\n===================================" << std::endl;
                     std::cout << "🎉 File transfer completed!" << std::endl;
@@ -125,17 +291,22 @@ public:
 
     virtual void OnConnected() override
     {
-        std::cout << "Client Connected" << std::endl;
+        LOG_INFO("Client Connected (session {})", GetSessionId());
+
+        GWorld->PostJoin(GetSessionRef());
     }
 
     virtual void OnDisconnected() override
     {
-        std::cout << "Client DisConnected" << std::endl;
+        LOG_INFO("Client DisConnected (session {})", GetSessionId());
+
+        GPubSub->UnsubscribeAll(GetSessionRef());
+        GWorld->PostLeave(GetSessionRef());
 
         // 과부하 테스트 진행 중이었다면 정리
         if (_stressTestActive) {
             _stressTestActive = false;
-            std::cout << "Stress test ended due to client disconnection" << std::endl;
+            LOG_INFO("Stress test ended due to client disconnection");
         }
     }
 
@@ -143,203 +314,211 @@ public:
     {
         PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
 
-        // 중요: 패킷 ID 로깅 (과부하 테스트 시에는 로깅 비활성화)
-        if (!_stressTestActive || header->id != PKT_C_STRESS_DATA) {
-            std::cout << "Received packet with ID: " << header->id << ", Size: " << header->size << std::endl;
+        // 패킷 ID 로깅 (디버그 레벨로 빌드할 때만)
+        LOG_DEBUG("Received packet with ID: {}, Size: {}", header->id, header->size);
+
+        // 채팅, 이동, 스냅샷 확인은 월드의 틱 스레드로 넘김
+        if (header->id == PKT_C_CHAT || header->id == PKT_C_MOVE || header->id == PKT_C_SNAPSHOT_ACK)
+        {
+            GWorld->PostPacket(GetSessionRef(), buffer, len);
+            return;
         }
 
-        // 1. 패킷 데이터 추출
-        // 일반 채팅 메시지 처리
-        if (header->id == PKT_C_CHAT)
+        // 파일 전송 관련 패킷은 부모 클래스(FilePacketSession)에서 처리
+        if (IsFileTransferPacket(header->id))
         {
-            ChatData* chatData = reinterpret_cast<ChatData*>(buffer + sizeof(PacketHeader));
-            std::cout << "Client Says: " << chatData->msg << std::endl;
-
-            // 2. 응답 패킷 생성
-            // 에코 응답
-            SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader) + sizeof(ChatData));
-            PacketHeader* resHeader = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-            ChatData* resData = reinterpret_cast<ChatData*>(sendBuffer->Buffer() + sizeof(PacketHeader));
-
-            // 3. 응답 데이터 구성
-            resHeader->size = sizeof(PacketHeader) + sizeof(ChatData);
-            resHeader->id = PKT_S_CHAT;
-            strcpy_s(resData->msg, "Server received your message!");
-
-            // 4. 버퍼 닫고 전송
-            sendBuffer->Close(resHeader->size);
-            Send(sendBuffer);
+            LOG_DEBUG("Processing file transfer packet");
+            FilePacketSession::OnRecvPacket(buffer, len);
+            return;
         }
-        // 과부하 테스트 시작 요청
-        else if (header->id == PKT_C_STRESS_START)
+
+        switch (GetDispatcher().Dispatch(*this, buffer, len))
         {
-            StressTestStartData* startData = reinterpret_cast<StressTestStartData*>(buffer + sizeof(PacketHeader));
-
-            // 요청 정보 출력
-            std::cout << "\n==== Stress Test Request ====" << std::endl;
-            std::cout << "Message count: " << startData->messageCount << std::endl;
-            std::cout << "Message size: " << startData->messageSize << " bytes" << std::endl;
-            std::cout << "Interval: " << startData->intervalMs << " ms" << std::endl;
-            std::cout << "=============================" << std::endl;
-
-            // 테스트 설정 저장
-            _stressTestConfig = *startData;
-
-            // 테스트 통계 초기화
-            _stressTestActive = true;
-            _stressTestStartTime = chrono::steady_clock::now();
-            _receivedMessages.clear();
-            _lastReceivedSeq = 0;
-            _receivedBytes = 0;
-            _totalLatency = 0;
-            _maxLatency = 0;
-            _minLatency = UINT32_MAX;
-
-            // 시작 확인 패킷 전송
-            SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader));
-            PacketHeader* resHeader = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-            resHeader->size = sizeof(PacketHeader);
-            resHeader->id = PKT_S_STRESS_START;
-            sendBuffer->Close(resHeader->size);
-            Send(sendBuffer);
-
-            std::cout << "Stress test started" << std::endl;
+        case Dispatcher::Result::Unknown:
+            LOG_WARN("Unknown packet type: {}", header->id);
+            break;
+        case Dispatcher::Result::Invalid:
+            LOG_WARN("Invalid {} packet ({} bytes)", FindPacketInfo(header->id)->name, len);
+            break;
+        default:
+            break;
         }
-        // 과부하 테스트 데이터
-        else if (header->id == PKT_C_STRESS_DATA)
+    }
+
+private:
+    using Dispatcher = PacketDispatcher<GameSession>;
+
+    static const Dispatcher& GetDispatcher()
+    {
+        static const Dispatcher SDispatcher = []()
         {
-            if (!_stressTestActive) return;
-
-            StressTestData* stressData = reinterpret_cast<StressTestData*>(buffer + sizeof(PacketHeader));
-
-            // 현재 시간
-            uint32_t currentTimeMs = static_cast<uint32_t>(chrono::duration_cast<chrono::milliseconds>(
-                chrono::steady_clock::now().time_since_epoch()).count());
-
-            // 지연 시간 측정
-            uint32_t latency = currentTimeMs - stressData->timestamp;
-
-            // 통계 업데이트
-            _receivedMessages.insert(stressData->sequenceNumber);
-            _lastReceivedSeq = max(_lastReceivedSeq, stressData->sequenceNumber);
-            _receivedBytes += header->size - sizeof(PacketHeader);
-            _totalLatency += latency;
-            _maxLatency = max(_maxLatency, latency);
-            _minLatency = min(_minLatency, latency);
-
-            // 진행 상황 로깅 (100개마다 로그)
-            if (_receivedMessages.size() % 100 == 0) {
-                float progress = static_cast<float>(_receivedMessages.size()) / _stressTestConfig.messageCount * 100.0f;
-                std::cout << "Stress test progress: " << std::fixed << std::setprecision(1)
-                    << progress << "% (" << _receivedMessages.size() << "/"
-                    << _stressTestConfig.messageCount << " messages)" << std::endl;
-            }
+            Dispatcher dispatcher;
+            dispatcher.Register<PKT_C_STRESS_START, &GameSession::HandleStressStart>();
+            dispatcher.Register<PKT_C_STRESS_DATA, &GameSession::HandleStressData>();
+            dispatcher.Register<PKT_C_STRESS_END, &GameSession::HandleStressEnd>();
+            dispatcher.Register<PKT_C_SUBSCRIBE, &GameSession::HandleSubscribe>();
+            dispatcher.Register<PKT_C_UNSUBSCRIBE, &GameSession::HandleUnsubscribe>();
+            dispatcher.Register<PKT_C_PUBLISH, &GameSession::HandlePublish>();
+            return dispatcher;
+        }();
+        return SDispatcher;
+    }
 
-            // 응답 패킷 전송 (에코)
-            SendBufferRef sendBuffer = GSendBufferManager->Open(header->size);
-            if (sendBuffer != nullptr) {
-                PacketHeader* resHeader = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-                StressTestData* resData = reinterpret_cast<StressTestData*>(sendBuffer->Buffer() + sizeof(PacketHeader));
+    // 과부하 테스트 시작 요청
+    void HandleStressStart(const PacketReader<PKT_C_STRESS_START>& packet)
+    {
+        // 테스트 설정 저장
+        _stressTestConfig = packet.Get();
+
+        // 요청 정보 출력
+        std::cout << "\n==== Stress Test Request ====" << std::endl;
+        std::cout << "Message count: " << _stressTestConfig.messageCount << std::endl;
+        std::cout << "Message size: " << _stressTestConfig.messageSize << " bytes" << std::endl;
+        std::cout << "Interval: " << _stressTestConfig.intervalMs << " ms" << std::endl;
+        std::cout << "=============================" << std::endl;
+
+        // 테스트 통계 초기화
+        _stressTestActive = true;
+        _stressTestStartTime = chrono::steady_clock::now();
+        _receivedMessages.clear();
+        _lastReceivedSeq = 0;
+        _receivedBytes = 0;
+        _latencyHistogram.Reset();
+
+        // 시작 확인 패킷 전송
+        PacketWriter<PKT_S_STRESS_START> writer;
+        if (writer.IsValid())
+            Send(writer.Finish());
+
+        std::cout << "Stress test started" << std::endl;
+    }
 
-                resHeader->size = header->size;
-                resHeader->id = PKT_S_STRESS_DATA;
+    // 과부하 테스트 데이터
+    void HandleStressData(const PacketReader<PKT_C_STRESS_DATA>& packet)
+    {
+        if (!_stressTestActive) return;
+
+        // 현재 시간
+        uint64_t currentTimeNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count());
+
+        // 지연 시간 측정 (클라이언트 전송부터 서버 수신까지)
+        int64_t latency = static_cast<int64_t>(currentTimeNs - packet->timestampNs);
+
+        // 통계 업데이트
+        uint32_t sequenceNumber = packet->sequenceNumber;
+        _receivedMessages.insert(sequenceNumber);
+        _lastReceivedSeq = max(_lastReceivedSeq, sequenceNumber);
+        _receivedBytes += packet.Size() - sizeof(PacketHeader);
+        _latencyHistogram.Record(latency);
+
+        // 진행 상황 로깅 (1초에 한 번)
+        LOG_INFO_EVERY(1000, "Stress test progress: {:.1f}% ({}/{} messages)",
+            static_cast<float>(_receivedMessages.size()) / _stressTestConfig.messageCount * 100.0f,
+            _receivedMessages.size(), _stressTestConfig.messageCount);
+
+        // 응답 패킷 전송 (받은 본문을 그대로 에코)
+        PacketWriter<PKT_S_STRESS_DATA> writer(packet.TailSize());
+        if (writer.IsValid()) {
+            memcpy(&writer.Get(), &packet.Get(), StressTestData::MIN_SIZE + packet.TailSize());
+            Send(writer.Finish());
+        }
+    }
 
-                // 원본 데이터 복사 (에코)
-                memcpy(resData, stressData, header->size - sizeof(PacketHeader));
+    // 과부하 테스트 종료
+    void HandleStressEnd(const PacketReader<PKT_C_STRESS_END>& packet)
+    {
+        if (!_stressTestActive) return;
 
-                // 타임스탬프 업데이트
-                resData->timestamp = stressData->timestamp;
+        std::cout << "Client requested stress test end" << std::endl;
 
-                sendBuffer->Close(resHeader->size);
-                Send(sendBuffer);
-            }
-        }
-        // 과부하 테스트 종료
-        else if (header->id == PKT_C_STRESS_END)
-        {
-            if (!_stressTestActive) return;
+        // 테스트 결과 계산 및 전송
+        SendStressTestResult();
 
-            std::cout << "Client requested stress test end" << std::endl;
+        // 테스트 종료
+        _stressTestActive = false;
+    }
 
-            // 테스트 결과 계산 및 전송
-            SendStressTestResult();
+    // 토픽 구독/해제
+    void HandleSubscribe(const PacketReader<PKT_C_SUBSCRIBE>& packet)
+    {
+        std::string topic(PacketString(packet->topic));
+        GPubSub->Subscribe(PubSub::MakeTopicKey(topic), GetSessionRef());
+        LOG_INFO("Session {} subscribed to topic '{}'", GetSessionId(), topic);
+    }
 
-            // 테스트 종료
-            _stressTestActive = false;
-        }
-        // 파일 전송 관련 패킷은 부모 클래스(FilePacketSession)에서 처리
-        else if (IsFileTransferPacket(header->id))
-        {
-            std::cout << "Processing file transfer packet" << std::endl;
+    void HandleUnsubscribe(const PacketReader<PKT_C_UNSUBSCRIBE>& packet)
+    {
+        std::string topic(PacketString(packet->topic));
+        GPubSub->Unsubscribe(PubSub::MakeTopicKey(topic), GetSessionRef());
+        LOG_INFO("Session {} unsubscribed from topic '{}'", GetSessionId(), topic);
+    }
 
-            // 부모 클래스의 OnRecvPacket 호출
-            FilePacketSession::OnRecvPacket(buffer, len);
-        }
-        else
-        {
-            std::cout << "Unknown packet type: " << header->id << std::endl;
-        }
+    // 토픽 발행 - 패킷을 한 번만 만들어 모든 구독자가 같은 버퍼를 보냄
+    void HandlePublish(const PacketReader<PKT_C_PUBLISH>& packet)
+    {
+        PacketWriter<PKT_S_PUBLISH> writer(packet.TailSize());
+        if (!writer.IsValid()) return;
+
+        memcpy(&writer.Get(), &packet.Get(), TopicData::SIZE + packet.TailSize());
+        GPubSub->Publish(PubSub::MakeTopicKey(PacketString(packet->topic)), writer.Finish());
     }
 
-private:
     // 과부하 테스트 결과 전송
     void SendStressTestResult()
     {
         auto testDuration = chrono::duration_cast<chrono::milliseconds>(
             chrono::steady_clock::now() - _stressTestStartTime).count();
 
-        // 결과 패킷 생성
-        SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader) + sizeof(StressTestResult));
-        if (sendBuffer == nullptr) return;
+        // 결과 패킷 생성 (결과 뒤에 히스토그램을 붙여 보냄)
+        uint32_t histogramSize = _latencyHistogram.SerializedSize();
+        PacketWriter<PKT_S_STRESS_RESULT> writer(histogramSize);
+        if (!writer.IsValid()) return;
 
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-        StressTestResult* result = reinterpret_cast<StressTestResult*>(sendBuffer->Buffer() + sizeof(PacketHeader));
-
-        // 패킷 구성
-        header->size = sizeof(PacketHeader) + sizeof(StressTestResult);
-        header->id = PKT_S_STRESS_RESULT;
+        StressTestResult& result = writer.Get();
 
         // 결과 데이터 채우기
-        result->totalMessages = _stressTestConfig.messageCount;
-        result->receivedMessages = static_cast<uint32_t>(_receivedMessages.size());
-        result->lostMessages = _lastReceivedSeq - result->receivedMessages;
-
-        result->avgLatencyMs = result->receivedMessages > 0 ?
-            static_cast<float>(_totalLatency) / result->receivedMessages : 0.0f;
-        result->maxLatencyMs = static_cast<float>(_maxLatency);
-        result->minLatencyMs = _minLatency != UINT32_MAX ? static_cast<float>(_minLatency) : 0.0f;
+        result.totalMessages = _stressTestConfig.messageCount;
+        result.receivedMessages = static_cast<uint32_t>(_receivedMessages.size());
+        result.lostMessages = _lastReceivedSeq - result.receivedMessages;
+
+        result.avgLatencyNs = static_cast<uint64_t>(_latencyHistogram.Mean());
+        result.minLatencyNs = _latencyHistogram.Min();
+        result.maxLatencyNs = _latencyHistogram.Max();
+        result.p50LatencyNs = _latencyHistogram.Percentile(50.0);
+        result.p90LatencyNs = _latencyHistogram.Percentile(90.0);
+        result.p99LatencyNs = _latencyHistogram.Percentile(99.0);
+        result.p999LatencyNs = _latencyHistogram.Percentile(99.9);
+        result.p9999LatencyNs = _latencyHistogram.Percentile(99.99);
+        result.histogramSize = _latencyHistogram.Serialize(writer.Tail(), histogramSize);
 
         // 데이터 전송률 계산 (MB/s)
-        result->dataRateMBps = testDuration > 0 ?
+        result.dataRateMBps = testDuration > 0 ?
             (_receivedBytes / 1024.0f / 1024.0f) / (testDuration / 1000.0f) : 0.0f;
 
-        // 패킷 전송
-        sendBuffer->Close(header->size);
+        // 패킷 전송 (버퍼는 sendBuffer가 잡고 있으므로 아래에서 result를 계속 읽어도 됨)
+        SendBufferRef sendBuffer = writer.Finish();
         Send(sendBuffer);
 
         // 콘솔에도 결과 출력
         std::cout << "\n==== Stress Test Results ====" << std::endl;
-        std::cout << "Total messages: " << result->totalMessages << std::endl;
-        std::cout << "Received messages: " << result->receivedMessages << std::endl;
-        std::cout << "Lost messages: " << result->lostMessages << std::endl;
+        std::cout << "Total messages: " << result.totalMessages << std::endl;
+        std::cout << "Received messages: " << result.receivedMessages << std::endl;
+        std::cout << "Lost messages: " << result.lostMessages << std::endl;
         std::cout << "Test duration: " << testDuration << " ms" << std::endl;
-        std::cout << "Average latency: " << result->avgLatencyMs << " ms" << std::endl;
-        std::cout << "Min latency: " << result->minLatencyMs << " ms" << std::endl;
-        std::cout << "Max latency: " << result->maxLatencyMs << " ms" << std::endl;
-        std::cout << "Data rate: " << result->dataRateMBps << " MB/s" << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "Average latency: " << result.avgLatencyNs / 1000.0 << " us" << std::endl;
+        std::cout << "Min latency: " << result.minLatencyNs / 1000.0 << " us" << std::endl;
+        std::cout << "Max latency: " << result.maxLatencyNs / 1000.0 << " us" << std::endl;
+        std::cout << "Latency percentiles (us): p50 " << result.p50LatencyNs / 1000.0
+            << ", p90 " << result.p90LatencyNs / 1000.0
+            << ", p99 " << result.p99LatencyNs / 1000.0
+            << ", p99.9 " << result.p999LatencyNs / 1000.0
+            << ", p99.99 " << result.p9999LatencyNs / 1000.0 << std::endl;
+        std::cout << "Data rate: " << result.dataRateMBps << " MB/s" << std::endl;
         std::cout << "============================" << std::endl;
     }
 
-    bool IsFileTransferPacket(uint16_t packetId)
-    {
-        // 각 패킷 ID를 명시적으로 확인
-        return packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferRequest) ||
-            packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferResponse) ||
-            packetId == static_cast<uint16_t>(FileTransferPacketId::FileDataChunk) ||
-            packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferComplete) ||
-            packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferError);
-    }
-
     void SendFileCompleteMessage(const std::string& filePath)
     {
         // 파일명만 추출
@@ -349,16 +528,11 @@ private:
         std::string completeMsg = "Server received file: " + filename;
 
         // 채팅 메시지로 전송
-        SendBufferRef sendBuffer = GSendBufferManager->Open(sizeof(PacketHeader) + sizeof(ChatData));
-        PacketHeader* resHeader = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
-        ChatData* resData = reinterpret_cast<ChatData*>(sendBuffer->Buffer() + sizeof(PacketHeader));
+        PacketWriter<PKT_S_CHAT> writer;
+        if (!writer.IsValid()) return;
 
-        resHeader->size = sizeof(PacketHeader) + sizeof(ChatData);
-        resHeader->id = PKT_S_CHAT;
-        strcpy_s(resData->msg, completeMsg.c_str());
-
-        sendBuffer->Close(resHeader->size);
-        Send(sendBuffer);
+        PacketCopyString(writer->msg, completeMsg);
+        Send(writer.Finish());
     }
 
 private:
@@ -369,14 +543,51 @@ private:
     std::set<uint32_t> _receivedMessages;
     uint32_t _lastReceivedSeq;
     uint64_t _receivedBytes;
-    uint64_t _totalLatency;
-    uint32_t _maxLatency;
-    uint32_t _minLatency;
+    LatencyHistogram _latencyHistogram;
     asio::steady_timer _stressTestTimer;
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+    // 스레드 배치 옵션: --cpus 0-3,8 (io 스레드를 차례로 한 코어씩 고정), --numa-node 0, --io-threads 4
+    // 월드 옵션: --tick-rate 20 (초당 틱 수)
+    // 지연 시간 옵션: --busy-poll 50 (io 스레드가 잠들기 전 최대 50us 폴링), --busy-poll-fixed (창 크기 고정), --socket-busy-poll 50 (SO_BUSY_POLL)
+    std::vector<int32_t> ioCpus;
+    int32_t numaNode = -1;
+    int32_t ioThreadCount = 4;
+    IoLoopOptions loopOptions;
+    int32_t socketBusyPoll = 0;
+    uint32 tickRate = 20;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--cpus" && i + 1 < argc) {
+            if (!ThreadManager::ParseCpuList(argv[++i], ioCpus)) {
+                std::cerr << "Invalid CPU list: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--numa-node" && i + 1 < argc)
+            numaNode = std::stoi(argv[++i]);
+        else if (arg == "--io-threads" && i + 1 < argc)
+            ioThreadCount = std::stoi(argv[++i]);
+        else if (arg == "--busy-poll" && i + 1 < argc)
+            loopOptions.busyPollUs = static_cast<uint32>(std::stoul(argv[++i]));
+        else if (arg == "--busy-poll-fixed")
+            loopOptions.adaptive = false;
+        else if (arg == "--socket-busy-poll" && i + 1 < argc)
+            socketBusyPoll = std::stoi(argv[++i]);
+        else if (arg == "--tick-rate" && i + 1 < argc)
+            tickRate = static_cast<uint32>(std::stoul(argv[++i]));
+        else {
+            std::cerr << "Usage: server [--cpus <list>] [--numa-node <n>] [--io-threads <n>]"
+                " [--busy-poll <us>] [--busy-poll-fixed] [--socket-busy-poll <us>] [--tick-rate <hz>]" << std::endl;
+            return 1;
+        }
+    }
+    if (ioThreadCount < 1)
+        ioThreadCount = 1;
+
     // 초기화: 파일 저장 디렉토리 생성 및 테스트
     std::string receiveDir = "./server_received_files";
     std::error_code ec;
@@ -428,26 +639,50 @@ int main()
     }
 
     asio::io_context ioc;
+    PubSub pubSub(ioc, static_cast<uint32>(ioThreadCount));
+    GPubSub = &pubSub;
+
+    // 게임 월드는 io 스레드가 아니라 전용 틱 스레드에서 고정 주기로 처리
+    auto world = make_shared<GameWorld>();
+    GWorld = world.get();
+    TickScheduler tickScheduler(tickRate);
+    tickScheduler.AddWorld(world);
 
     auto service = make_shared<ServerService>(
         ioc,
         NetAddress("0.0.0.0", 7777),
         [](asio::io_context& ioc) { return make_shared<GameSession>(ioc); },
-        100);
+        1000);
+    service->SetSocketBusyPoll(socketBusyPoll);
 
     std::cout << "File Transfer Server Starting..." << std::endl;
     service->Start();
     std::cout << "File Transfer Server Started" << std::endl;
 
     // 서버가 계속 실행되도록 유지
-    for (int32_t i = 0; i < 4; i++)
+    for (int32_t i = 0; i < ioThreadCount; i++)
     {
-        GThreadManager->Launch([&ioc]()
+        ThreadOptions options;
+        options.name = "io-" + std::to_string(i);
+        options.numaNode = numaNode;
+        if (!ioCpus.empty())
+            options.cpus.push_back(ioCpus[i % ioCpus.size()]);
+
+        GThreadManager->Launch([&ioc, loopOptions]()
             {
-                ioc.run();
-            });
+                ThreadManager::RunIoContext(ioc, loopOptions);
+            }, options);
     }
 
+    ThreadOptions tickOptions;
+    tickOptions.name = "tick";
+    tickOptions.numaNode = numaNode;
+    tickScheduler.Start(tickOptions);
+
+    // 관리 포트 (로컬에서만 지표 스크랩)
+    AdminServer admin(NetAddress("127.0.0.1", 7778));
+    admin.Start();
+
     // 메인 스레드에서 명령어 처리
     std::string cmd;
     while (true)
@@ -461,7 +696,18 @@ int main()
         // 서버 상태 출력
         else if (cmd == "status")
         {
+            // 비동기 로그가 상태 출력 사이에 끼지 않도록 먼저 비움
+            GLogger->Flush();
             std::cout << "Connected clients: " << service->GetCurrentSessionCount() << std::endl;
+            std::cout << "Topic subscriptions: " << pubSub.GetSubscriptionCount() << std::endl;
+            std::cout << "World players: " << world->GetPlayerCount() << " (tick " << world->GetTickCount()
+                << " at " << tickScheduler.GetTickRate() << " Hz, dropped packets " << world->GetDroppedPackets() << ")" << std::endl;
+
+            // 코어 지표 (모든 스레드의 샤드를 합산)
+            std::cout << "\nMetrics:\n" << GMetrics->FormatText();
+
+            // 메모리 풀 크기 구간별 사용량
+            std::cout << "\nMemory pools:\n" << GMemoryManager->FormatStats();
 
             // 수신된 파일 목록 출력
             std::cout << "\nReceived files in: " << absPath << std::endl;
@@ -489,6 +735,25 @@ int main()
                 std::cerr << "Error listing files: " << e.what() << std::endl;
             }
         }
+        // 이벤트 추적: trace on | trace off | trace dump <path>
+        else if (cmd == "trace on" || cmd == "trace off")
+        {
+            GTracer->SetEnabled(cmd == "trace on");
+            std::cout << "Tracing " << (GTracer->IsEnabled() ? "enabled" : "disabled") << std::endl;
+        }
+        else if (cmd.substr(0, 11) == "trace dump ")
+        {
+            GTracer->DumpChromeTrace(cmd.substr(11));
+        }
+        // 수신 패킷 캡처 (Replay 도구 입력): capture start <path> | capture stop
+        else if (cmd.substr(0, 14) == "capture start ")
+        {
+            GPacketCapture->Start(cmd.substr(14));
+        }
+        else if (cmd == "capture stop")
+        {
+            GPacketCapture->Stop();
+        }
         // 저장 테스트 명령어
         else if (cmd.substr(0, 5) == "test ")
         {
@@ -517,6 +782,8 @@ int main()
     }
 
     // 종료 처리
+    admin.Stop();
+    tickScheduler.Stop();
     ioc.stop();
     GThreadManager->Join();
 
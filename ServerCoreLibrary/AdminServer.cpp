@@ -0,0 +1,283 @@
+﻿#include "pch.h"
+#include "AdminServer.h"
+#include "ThreadManager.h"
+#include <charconv>
+
+namespace
+{
+    // 요청 하나를 읽고 응답을 보낸 뒤 닫는 연결 (Connection: close)
+    struct AdminConnection : public std::enable_shared_from_this<AdminConnection>
+    {
+        enum { MAX_REQUEST_SIZE = 4096 };
+
+        AdminConnection(asio::io_context& ioc) : socket(ioc) {}
+
+        void Start(std::shared_ptr<const std::string> metricsResponse)
+        {
+            response = std::move(metricsResponse);
+            RegisterRead();
+        }
+
+        void RegisterRead()
+        {
+            auto self = shared_from_this();
+            socket.async_read_some(
+                asio::buffer(request.data() + requestSize, request.size() - requestSize),
+                [this, self](const std::error_code& error, size_t bytesTransferred)
+                {
+                    if (error)
+                        return;
+
+                    requestSize += bytesTransferred;
+                    std::string_view text(request.data(), requestSize);
+
+                    // 헤더가 끝날 때까지 읽음 (본문이 있는 요청은 받지 않음)
+                    if (text.find("\r\n\r\n") == std::string_view::npos) {
+                        if (requestSize < request.size())
+                            RegisterRead();
+                        return;
+                    }
+
+                    if (text.starts_with("GET /metrics ") || text.starts_with("GET / "))
+                        Write(response);
+                    else
+                        Write(NotFound());
+                });
+        }
+
+        void Write(std::shared_ptr<const std::string> data)
+        {
+            auto self = shared_from_this();
+            asio::async_write(socket, asio::buffer(*data),
+                [this, self, data](const std::error_code& error, size_t bytesTransferred)
+                {
+                    std::error_code ec;
+                    socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+                    socket.close(ec);
+                });
+        }
+
+        static std::shared_ptr<const std::string> NotFound()
+        {
+            static const auto notFound = std::make_shared<const std::string>(
+                "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\nConnection: close\r\n\r\nNot Found\n");
+            return notFound;
+        }
+
+        asio::ip::tcp::socket socket;
+        std::array<char, MAX_REQUEST_SIZE> request;
+        size_t requestSize = 0;
+        std::shared_ptr<const std::string> response;
+    };
+
+    const char* TypeName(MetricType type)
+    {
+        switch (type) {
+        case MetricType::Counter: return "counter";
+        case MetricType::Gauge: return "gauge";
+        case MetricType::Histogram: return "histogram";
+        }
+        return "untyped";
+    }
+}
+
+AdminServer::AdminServer(const NetAddress& address, uint32 refreshMs)
+    : _address(address)
+    , _refreshMs(refreshMs)
+    , _acceptor(_ioc)
+    , _refreshTimer(_ioc)
+{
+}
+
+AdminServer::~AdminServer()
+{
+    Stop();
+}
+
+bool AdminServer::Start()
+{
+    std::error_code ec;
+    _acceptor.open(_address.GetEndpoint().protocol(), ec);
+    if (!ec)
+        _acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+    if (!ec)
+        _acceptor.bind(_address.GetEndpoint(), ec);
+    if (!ec)
+        _acceptor.listen(asio::socket_base::max_listen_connections, ec);
+
+    if (ec) {
+        std::cerr << "[Admin] Failed to listen on " << _address.GetIPAddress() << ":" << _address.GetPort()
+            << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // 첫 스크랩 전에 응답을 만들어 둠
+    Render();
+    RegisterAccept();
+    RegisterRefresh();
+
+    _thread = std::thread([this]()
+        {
+            ThreadManager::InitTLS();
+            ThreadManager::SetThreadName("admin");
+            _ioc.run();
+            ThreadManager::DestroyTLS();
+        });
+
+    std::cout << "[Admin] Serving metrics on http://" << _address.GetIPAddress() << ":" << _address.GetPort() << "/metrics" << std::endl;
+    return true;
+}
+
+void AdminServer::Stop()
+{
+    if (!_thread.joinable())
+        return;
+
+    _ioc.stop();
+    _thread.join();
+
+    std::error_code ec;
+    _acceptor.close(ec);
+}
+
+void AdminServer::RegisterAccept()
+{
+    auto connection = std::make_shared<AdminConnection>(_ioc);
+    _acceptor.async_accept(
+        connection->socket,
+        [this, connection](const std::error_code& error)
+        {
+            if (error == asio::error::operation_aborted)
+                return;
+
+            if (!error)
+                connection->Start(_response);
+
+            RegisterAccept();
+        });
+}
+
+void AdminServer::RegisterRefresh()
+{
+    _refreshTimer.expires_after(std::chrono::milliseconds(_refreshMs));
+    _refreshTimer.async_wait(
+        [this](const std::error_code& error)
+        {
+            if (error)
+                return;
+
+            Render();
+            RegisterRefresh();
+        });
+}
+
+void AdminServer::Render()
+{
+    // 이전 스냅샷과 본문 버퍼를 재사용하므로 지표 수가 늘지 않는 한 할당 없음
+    GMetrics->Snapshot(_snapshots);
+    _body.clear();
+
+    const std::string* family = nullptr;
+    for (const MetricSnapshot& snapshot : _snapshots)
+    {
+        // 스냅샷이 이름순이므로 같은 이름의 첫 항목에만 HELP/TYPE 출력
+        if (family == nullptr || *family != snapshot.name) {
+            family = &snapshot.name;
+            _body.append("# HELP ").append(snapshot.name).append(" ").append(snapshot.help).append("\n");
+            _body.append("# TYPE ").append(snapshot.name).append(" ").append(TypeName(snapshot.type)).append("\n");
+        }
+
+        if (snapshot.type != MetricType::Histogram) {
+            AppendSample(snapshot, "", snapshot.value);
+            continue;
+        }
+
+        // 버킷 i의 상한은 2^i - 1, 값이 들어간 마지막 버킷까지만 누적으로 출력
+        int32 top = MetricHistogram::BUCKET_COUNT - 1;
+        while (top > 0 && snapshot.buckets[top] == 0)
+            top--;
+
+        uint64 cumulative = 0;
+        char le[24];
+        for (int32 i = 0; i <= top && i < 64; i++)
+        {
+            cumulative += snapshot.buckets[i];
+            uint64 bound = (1ull << i) - 1;
+            *std::to_chars(le, le + sizeof(le) - 1, bound).ptr = '\0';
+            AppendSample(snapshot, "_bucket", le, cumulative);
+        }
+        AppendSample(snapshot, "_bucket", "+Inf", snapshot.count);
+        AppendSample(snapshot, "_sum", nullptr, snapshot.sum);
+        AppendSample(snapshot, "_count", nullptr, snapshot.count);
+    }
+
+    auto response = std::make_shared<std::string>();
+    response->reserve(_body.size() + 128);
+    response->append("HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: ");
+    response->append(std::to_string(_body.size()));
+    response->append("\r\nConnection: close\r\n\r\n");
+    response->append(_body);
+
+    // 이전 응답을 보내는 중인 연결은 자기 사본을 들고 있음
+    _response = std::move(response);
+}
+
+void AdminServer::AppendSample(const MetricSnapshot& snapshot, const char* suffix, const char* le, uint64 value)
+{
+    _body.append(snapshot.name).append(suffix);
+    AppendLabels(snapshot, le);
+    _body.push_back(' ');
+    AppendNumber(value);
+    _body.push_back('\n');
+}
+
+void AdminServer::AppendSample(const MetricSnapshot& snapshot, const char* suffix, int64 value)
+{
+    _body.append(snapshot.name).append(suffix);
+    AppendLabels(snapshot, nullptr);
+    _body.push_back(' ');
+    AppendNumber(value);
+    _body.push_back('\n');
+}
+
+void AdminServer::AppendLabels(const MetricSnapshot& snapshot, const char* le)
+{
+    bool hasLabel = !snapshot.labelKey.empty();
+    if (!hasLabel && le == nullptr)
+        return;
+
+    _body.push_back('{');
+    if (hasLabel) {
+        _body.append(snapshot.labelKey).append("=\"");
+        for (char c : snapshot.labelValue)
+        {
+            // 레이블 값 이스케이프 (\, ", 줄바꿈)
+            if (c == '\\' || c == '"')
+                _body.push_back('\\');
+            if (c == '\n') {
+                _body.append("\\n");
+                continue;
+            }
+            _body.push_back(c);
+        }
+        _body.push_back('"');
+    }
+    if (le != nullptr) {
+        if (hasLabel)
+            _body.push_back(',');
+        _body.append("le=\"").append(le).append("\"");
+    }
+    _body.push_back('}');
+}
+
+void AdminServer::AppendNumber(uint64 value)
+{
+    char text[24];
+    _body.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+}
+
+void AdminServer::AppendNumber(int64 value)
+{
+    char text[24];
+    _body.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+#include "NetAddress.h"
+#include "Metrics.h"
+
+/*----------------
+    AdminServer
+-----------------*/
+// 관리용 포트에서 Prometheus 텍스트 형식으로 지표를 내보내는 최소 HTTP 리스너
+// 게임 트래픽과 섞이지 않도록 자체 io_context와 스레드 하나에서만 동작
+// 응답은 타이머가 주기적으로 미리 만들어 두고, 요청에는 만들어 둔 버퍼를 그대로 보냄 (스크랩 비용은 쓰기 한 번)
+class AdminServer
+{
+public:
+    AdminServer(const NetAddress& address, uint32 refreshMs = 1000);
+    ~AdminServer();
+
+    bool Start();
+    void Stop();
+
+    const NetAddress& GetNetAddress() const { return _address; }
+
+private:
+    void RegisterAccept();
+    void RegisterRefresh();
+
+    // 스냅샷을 Prometheus 텍스트로 변환해 응답 버퍼 교체
+    void Render();
+    void AppendSample(const MetricSnapshot& snapshot, const char* suffix, const char* le, uint64 value);
+    void AppendSample(const MetricSnapshot& snapshot, const char* suffix, int64 value);
+    void AppendLabels(const MetricSnapshot& snapshot, const char* le);
+    void AppendNumber(uint64 value);
+    void AppendNumber(int64 value);
+
+private:
+    NetAddress _address;
+    uint32 _refreshMs;
+
+    asio::io_context _ioc;
+    asio::ip::tcp::acceptor _acceptor;
+    asio::steady_timer _refreshTimer;
+    std::thread _thread;
+
+    // 아래는 관리 스레드에서만 접근하므로 락 없음
+    std::shared_ptr<const std::string> _response;   // 진행 중인 전송이 들고 있을 수 있어 shared_ptr로 교체
+    std::string _body;
+    std::vector<MetricSnapshot> _snapshots;
+};
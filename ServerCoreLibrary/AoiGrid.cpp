@@ -0,0 +1,372 @@
+﻿#include "pch.h"
+#include "AoiGrid.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define AOI_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+AoiGrid::AoiGrid(float cellSize, float viewRange)
+    : _cellSize(cellSize), _inverseCellSize(1.0f / cellSize), _viewRange(viewRange)
+{
+    assert(cellSize > 0.0f && viewRange > 0.0f);
+    _cellRadius = static_cast<int32>(std::ceil(viewRange / cellSize));
+    assert(_cellRadius <= MAX_CELL_INDEX);
+}
+
+AoiGrid::~AoiGrid()
+{
+}
+
+bool AoiGrid::Add(EntityId id, float x, float y)
+{
+    return Insert(id, x, y, false, nullptr);
+}
+
+bool AoiGrid::AddObserver(EntityId id, float x, float y, SessionRef session)
+{
+    return Insert(id, x, y, true, std::move(session));
+}
+
+bool AoiGrid::Insert(EntityId id, float x, float y, bool observer, SessionRef session)
+{
+    if (!std::isfinite(x) || !std::isfinite(y))
+        return false;
+
+    auto [it, inserted] = _entities.try_emplace(id);
+    if (!inserted)
+        return false;
+
+    Entity& entity = it->second;
+    entity.observer = observer;
+    entity.session = std::move(session);
+
+    AddToCell(id, entity, CellOf(x, y), x, y);
+    return true;
+}
+
+void AoiGrid::Remove(EntityId id)
+{
+    auto it = _entities.find(id);
+    if (it == _entities.end())
+        return;
+
+    // 이 엔티티를 보던 관찰자는 모두 주변 셀에 있으므로 셀만 표시하면 다음 Update에서 Leave가 나감
+    RemoveFromCell(id, it->second);
+    _entities.erase(it);
+}
+
+void AoiGrid::Move(EntityId id, float x, float y)
+{
+    if (!std::isfinite(x) || !std::isfinite(y))
+        return;
+
+    auto it = _entities.find(id);
+    if (it == _entities.end())
+        return;
+
+    Entity& entity = it->second;
+    CellKey key = CellOf(x, y);
+    if (key != entity.cell)
+    {
+        // 셀을 옮기면 떠난 셀과 들어간 셀 주변 모두 다시 계산
+        RemoveFromCell(id, entity);
+        AddToCell(id, entity, key, x, y);
+    }
+    else
+    {
+        Cell& cell = _cells.find(key)->second;
+        cell.xs[entity.slot] = x;
+        cell.ys[entity.slot] = y;
+        MarkDirty(key, cell);
+    }
+
+    // 셀을 옮기면 새 슬롯의 기록은 새로 시작하므로 한 번만 넣었는지는 엔티티 쪽으로 판단
+    _cells.find(key)->second.movedTicks[entity.slot] = _tick;
+    if (entity.movedTick != _tick)
+    {
+        entity.movedTick = _tick;
+        _moved.push_back(id);
+    }
+}
+
+void AoiGrid::Update(std::vector<AoiEvent>& events)
+{
+
+    // 1. 바뀐 셀에서 시야 범위 안에 있는 관찰자만 고름 (그 밖의 관찰자는 보이는 것이 바뀔 수 없음)
+    _observers.clear();
+    for (CellKey key : _dirtyCells)
+    {
+        int32 cx = CellX(key);
+        int32 cy = CellY(key);
+        for (int32 dx = -_cellRadius; dx <= _cellRadius; dx++)
+        {
+            for (int32 dy = -_cellRadius; dy <= _cellRadius; dy++)
+            {
+                auto cellIt = _cells.find(MakeCellKey(cx + dx, cy + dy));
+                if (cellIt == _cells.end() || cellIt->second.visitTick == _tick)
+                    continue;
+
+                // 관찰자는 셀 하나에만 있으므로 셀을 한 번씩만 훑으면 중복이 없음
+                cellIt->second.visitTick = _tick;
+                for (EntityId observerId : cellIt->second.observers)
+                    _observers.emplace_back(observerId, &_entities.find(observerId)->second);
+            }
+        }
+    }
+
+    // 2. 관찰자마다 시야를 다시 구해 이전 시야와 비교 (둘 다 id 오름차순, 움직였는지는 후보 값의 최하위 비트)
+    for (auto& [observerId, observer] : _observers)
+    {
+        const Cell& cell = _cells.find(observer->cell)->second;
+        _nextVisible.clear();
+        CollectInRange(observerId, observer->cell, cell.xs[observer->slot], cell.ys[observer->slot], _nextVisible);
+        std::sort(_nextVisible.begin(), _nextVisible.end());
+
+        std::vector<EntityId>& visible = observer->visible;
+        size_t oldIndex = 0;
+        size_t newIndex = 0;
+        while (oldIndex < visible.size() || newIndex < _nextVisible.size())
+        {
+            EntityId next = newIndex < _nextVisible.size() ? static_cast<EntityId>(_nextVisible[newIndex] >> 1) : 0;
+            if (newIndex == _nextVisible.size() || (oldIndex < visible.size() && visible[oldIndex] < next))
+            {
+                events.push_back({ AoiEvent::Type::Leave, observerId, visible[oldIndex++] });
+            }
+            else if (oldIndex == visible.size() || next < visible[oldIndex])
+            {
+                events.push_back({ AoiEvent::Type::Enter, observerId, next });
+                newIndex++;
+            }
+            else
+            {
+                if (_nextVisible[newIndex] & 1)
+                    events.push_back({ AoiEvent::Type::Move, observerId, next });
+                oldIndex++;
+                newIndex++;
+            }
+        }
+
+        visible.resize(_nextVisible.size());
+        for (size_t i = 0; i < _nextVisible.size(); i++)
+            visible[i] = static_cast<EntityId>(_nextVisible[i] >> 1);
+    }
+    _lastUpdatedObservers = static_cast<uint32>(_observers.size());
+
+    // 3. FlushMoves용으로 움직인 엔티티를 지금 있는 셀별로 모음 (그 사이 제거된 엔티티는 제외)
+    _movedByCell.clear();
+    for (EntityId id : _moved)
+    {
+        auto it = _entities.find(id);
+        if (it != _entities.end())
+            _movedByCell.emplace_back(it->second.cell, id);
+    }
+    // 같은 틱에 제거 후 다시 추가된 엔티티는 두 번 들어 있을 수 있음
+    std::sort(_movedByCell.begin(), _movedByCell.end());
+    _movedByCell.erase(std::unique(_movedByCell.begin(), _movedByCell.end()), _movedByCell.end());
+
+    // 4. 이번 틱에 비게 된 셀 정리
+    for (CellKey key : _dirtyCells)
+    {
+        auto cellIt = _cells.find(key);
+        if (cellIt != _cells.end() && cellIt->second.ids.empty())
+            _cells.erase(cellIt);
+    }
+
+    _dirtyCells.clear();
+    _moved.clear();
+    _tick++;
+}
+
+void AoiGrid::FlushMoves(uint16 packetId)
+{
+    _lastBatchCount = 0;
+
+    for (size_t begin = 0; begin < _movedByCell.size(); )
+    {
+        CellKey key = _movedByCell[begin].first;
+        size_t end = begin;
+        while (end < _movedByCell.size() && _movedByCell[end].first == key)
+            end++;
+
+        const Cell& cell = _cells.find(key)->second;
+
+        // 1. 셀 묶음 패킷을 한 번만 만듦
+        _batches.clear();
+        for (size_t offset = begin; offset < end; offset += MAX_BATCH_ENTRIES)
+        {
+            uint16 count = static_cast<uint16>(std::min<size_t>(MAX_BATCH_ENTRIES, end - offset));
+            uint16 size = static_cast<uint16>(sizeof(PacketHeader) + sizeof(AoiMoveBatchHeader) + count * sizeof(AoiMoveEntry));
+
+            SendBufferRef sendBuffer = GSendBufferManager->Open(size);
+            if (sendBuffer == nullptr)
+                continue;
+
+            PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
+            header->size = size;
+            header->id = packetId;
+            reinterpret_cast<AoiMoveBatchHeader*>(header + 1)->count = count;
+
+            AoiMoveEntry* entries = reinterpret_cast<AoiMoveEntry*>(sendBuffer->Buffer() + sizeof(PacketHeader) + sizeof(AoiMoveBatchHeader));
+            for (uint16 i = 0; i < count; i++)
+            {
+                EntityId id = _movedByCell[offset + i].second;
+                uint32 slot = _entities.find(id)->second.slot;
+                entries[i] = { id, cell.xs[slot], cell.ys[slot] };
+            }
+
+            sendBuffer->Close(size);
+            _batches.push_back(std::move(sendBuffer));
+        }
+        _lastBatchCount += static_cast<uint32>(_batches.size());
+        begin = end;
+
+        // 2. 이 셀이 시야 범위에 드는 관찰자 (= 주변 셀의 관찰자) 모두에게 같은 버퍼를 보냄
+        int32 cx = CellX(key);
+        int32 cy = CellY(key);
+        for (int32 dx = -_cellRadius; dx <= _cellRadius; dx++)
+        {
+            for (int32 dy = -_cellRadius; dy <= _cellRadius; dy++)
+            {
+                auto nearIt = _cells.find(MakeCellKey(cx + dx, cy + dy));
+                if (nearIt == _cells.end())
+                    continue;
+
+                for (EntityId observerId : nearIt->second.observers)
+                {
+                    const SessionRef& session = _entities.find(observerId)->second.session;
+                    if (session == nullptr)
+                        continue;
+
+                    for (const SendBufferRef& batch : _batches)
+                        session->Send(batch);
+                }
+            }
+        }
+    }
+
+    _batches.clear();
+    _movedByCell.clear();
+}
+
+const std::vector<AoiGrid::EntityId>& AoiGrid::GetVisible(EntityId observer) const
+{
+    static const std::vector<EntityId> SEmpty;
+
+    auto it = _entities.find(observer);
+    return it != _entities.end() ? it->second.visible : SEmpty;
+}
+
+AoiGrid::CellKey AoiGrid::CellOf(float x, float y) const
+{
+    // 범위를 넘는 값을 int32로 바꾸면 미정의 동작이므로 바꾸기 전에 셀 좌표 한계로 자름 (x, y는 유한한 값)
+    constexpr float LIMIT = static_cast<float>(MAX_CELL_INDEX);
+    int32 cx = static_cast<int32>(std::clamp(std::floor(x * _inverseCellSize), -LIMIT, LIMIT));
+    int32 cy = static_cast<int32>(std::clamp(std::floor(y * _inverseCellSize), -LIMIT, LIMIT));
+    return MakeCellKey(cx, cy);
+}
+
+void AoiGrid::AddToCell(EntityId id, Entity& entity, CellKey key, float x, float y)
+{
+    Cell& cell = _cells[key];
+    MarkDirty(key, cell);
+    entity.cell = key;
+    entity.slot = static_cast<uint32>(cell.ids.size());
+    cell.xs.push_back(x);
+    cell.ys.push_back(y);
+    cell.ids.push_back(id);
+    cell.movedTicks.push_back(entity.movedTick);
+    if (entity.observer)
+        cell.observers.push_back(id);
+}
+
+void AoiGrid::RemoveFromCell(EntityId id, Entity& entity)
+{
+    Cell& cell = _cells.find(entity.cell)->second;
+    MarkDirty(entity.cell, cell);
+
+    // 마지막 엔티티를 빈자리로 옮겨 배열을 연속으로 유지
+    uint32 last = static_cast<uint32>(cell.ids.size() - 1);
+    if (entity.slot != last)
+    {
+        cell.xs[entity.slot] = cell.xs[last];
+        cell.ys[entity.slot] = cell.ys[last];
+        cell.ids[entity.slot] = cell.ids[last];
+        cell.movedTicks[entity.slot] = cell.movedTicks[last];
+        _entities.find(cell.ids[entity.slot])->second.slot = entity.slot;
+    }
+    cell.xs.pop_back();
+    cell.ys.pop_back();
+    cell.ids.pop_back();
+    cell.movedTicks.pop_back();
+
+    if (entity.observer)
+    {
+        auto observerIt = std::find(cell.observers.begin(), cell.observers.end(), id);
+        *observerIt = cell.observers.back();
+        cell.observers.pop_back();
+    }
+}
+
+void AoiGrid::MarkDirty(CellKey key, Cell& cell)
+{
+    if (cell.dirtyTick == _tick)
+        return;
+
+    cell.dirtyTick = _tick;
+    _dirtyCells.push_back(key);
+}
+
+void AoiGrid::CollectInRange(EntityId self, CellKey center, float x, float y, std::vector<uint64>& out) const
+{
+    float rangeSq = _viewRange * _viewRange;
+    int32 cx = CellX(center);
+    int32 cy = CellY(center);
+    for (int32 dx = -_cellRadius; dx <= _cellRadius; dx++)
+    {
+        for (int32 dy = -_cellRadius; dy <= _cellRadius; dy++)
+        {
+            auto it = _cells.find(MakeCellKey(cx + dx, cy + dy));
+            if (it != _cells.end())
+                FilterInRange(it->second, x, y, rangeSq, self, _tick, out);
+        }
+    }
+}
+
+void AoiGrid::FilterInRange(const Cell& cell, float x, float y, float rangeSq, EntityId self, uint64 tick, std::vector<uint64>& out)
+{
+    const uint32 count = static_cast<uint32>(cell.ids.size());
+    uint32 i = 0;
+
+#ifdef AOI_HAS_SSE2
+    // 4개씩 거리 제곱을 구해 비교 결과를 비트 마스크로 받음
+    const __m128 px = _mm_set1_ps(x);
+    const __m128 py = _mm_set1_ps(y);
+    const __m128 range = _mm_set1_ps(rangeSq);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&cell.xs[i]), px);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&cell.ys[i]), py);
+        __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        uint32 mask = static_cast<uint32>(_mm_movemask_ps(_mm_cmple_ps(distSq, range)));
+        while (mask != 0)
+        {
+            uint32 index = i + std::countr_zero(mask);
+            if (cell.ids[index] != self)
+                out.push_back((static_cast<uint64>(cell.ids[index]) << 1) | (cell.movedTicks[index] == tick));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        float dx = cell.xs[i] - x;
+        float dy = cell.ys[i] - y;
+        if (dx * dx + dy * dy <= rangeSq && cell.ids[i] != self)
+            out.push_back((static_cast<uint64>(cell.ids[i]) << 1) | (cell.movedTicks[i] == tick));
+    }
+}
@@ -0,0 +1,153 @@
+﻿#pragma once
+#include "CorePch.h"
+#include <unordered_map>
+
+class Session;
+class SendBuffer;
+using SessionRef = std::shared_ptr<Session>;
+using SendBufferRef = std::shared_ptr<SendBuffer>;
+
+// 시야 변화 이벤트
+struct AoiEvent
+{
+    enum class Type : uint8
+    {
+        Enter,  // subject가 observer의 시야에 들어옴
+        Leave,  // subject가 시야에서 나가거나 제거됨
+        Move,   // 시야 안의 subject가 이번 틱에 움직임
+    };
+
+    Type type;
+    uint32 observer;
+    uint32 subject;
+};
+
+/*
+    FlushMoves가 보내는 셀 묶음 패킷 (리틀 엔디언)
+    [PacketHeader][AoiMoveBatchHeader][AoiMoveEntry x count]
+*/
+#pragma pack(push, 1)
+struct AoiMoveBatchHeader
+{
+    uint16 count;
+};
+
+struct AoiMoveEntry
+{
+    uint32 id;
+    float x;
+    float y;
+};
+#pragma pack(pop)
+
+/*----------------
+    AoiGrid
+-----------------*/
+// 위치 기반 관심 영역 (Area of Interest)
+// 월드를 한 변이 cellSize인 균등 격자로 나누고, 엔티티가 있는 셀만 셀 좌표 해시로 보관
+// 셀마다 위치를 구조체 배열(x[], y[])로 저장해 시야 반경 판정을 SIMD로 4개씩 처리
+// 한 틱에 바뀐 셀 주변의 관찰자만 다시 계산하므로 틱 비용은 전체 인구가 아니라 움직인 곳의 밀도에 비례
+// 스레드 안전하지 않음 (월드 하나를 맡은 스레드에서만 사용)
+class AoiGrid
+{
+public:
+    using EntityId = uint32;
+
+    enum
+    {
+        MAX_BATCH_ENTRIES = 256,   // 셀 묶음 패킷 하나에 넣는 최대 엔티티 수 (넘으면 패킷을 나눔)
+        MAX_CELL_INDEX = 1 << 24,  // 셀 좌표 한계 (더 먼 좌표는 가장자리 셀에 모임, 주변 셀 좌표를 더해도 int32를 넘지 않음)
+    };
+
+    // cellSize는 viewRange와 비슷하게 잡으면 주변 3x3 셀만 훑음
+    AoiGrid(float cellSize, float viewRange);
+    ~AoiGrid();
+
+    // 보이기만 하는 엔티티 (NPC, 아이템 등), 좌표가 NaN이나 무한대면 false
+    bool Add(EntityId id, float x, float y);
+    // 주변을 보는 엔티티 (session이 있으면 FlushMoves 패킷을 받음)
+    bool AddObserver(EntityId id, float x, float y, SessionRef session = nullptr);
+    void Remove(EntityId id);
+    // 좌표가 NaN이나 무한대면 무시
+    void Move(EntityId id, float x, float y);
+
+    // 이번 틱의 추가/이동/제거를 반영해 바뀐 곳 주변 관찰자의 시야를 갱신하고 이벤트를 events에 추가
+    void Update(std::vector<AoiEvent>& events);
+
+    // 직전 Update에서 움직인 엔티티를 셀마다 패킷으로 묶어, 그 셀이 시야 범위에 드는 관찰자 모두에게 같은 버퍼를 보냄 (Update 바로 다음에 호출)
+    // 셀 단위라 시야 반경 밖의 엔티티가 섞일 수 있으므로 받는 쪽은 Enter로 알려진 엔티티만 반영할 것
+    void FlushMoves(uint16 packetId);
+
+    bool Contains(EntityId id) const { return _entities.find(id) != _entities.end(); }
+    uint32 GetEntityCount() const { return static_cast<uint32>(_entities.size()); }
+    uint32 GetCellCount() const { return static_cast<uint32>(_cells.size()); }
+    // 관찰자가 지금 보고 있는 엔티티 (id 오름차순, 관찰자가 아니면 빈 목록)
+    const std::vector<EntityId>& GetVisible(EntityId observer) const;
+
+    // 통계 (직전 Update)
+    uint32 GetLastUpdatedObservers() const { return _lastUpdatedObservers; }
+    uint32 GetLastBatchCount() const { return _lastBatchCount; }
+
+private:
+    using CellKey = uint64;
+
+    // 셀 안의 엔티티 (구조체 배열, 제거할 때 마지막 원소와 맞바꿈)
+    struct Cell
+    {
+        std::vector<float> xs;
+        std::vector<float> ys;
+        std::vector<EntityId> ids;
+        std::vector<uint64> movedTicks;     // 엔티티가 마지막으로 움직인 틱 (시야 판정용 사본, 기준은 Entity::movedTick)
+        std::vector<EntityId> observers;    // 이 셀에 있는 관찰자
+        uint64 dirtyTick = 0;               // 마지막으로 바뀐 틱 (비어도 Update가 끝날 때까지 남겨 둠)
+        uint64 visitTick = 0;               // Update에서 관찰자를 이미 모은 틱
+    };
+
+    struct Entity
+    {
+        CellKey cell = 0;
+        uint32 slot = 0;                    // Cell 배열 안의 위치
+        uint64 movedTick = 0;               // 마지막으로 움직인 틱 (셀을 옮겨도 유지되므로 한 틱에 _moved에 한 번만 넣음)
+        bool observer = false;
+        SessionRef session;
+        std::vector<EntityId> visible;
+    };
+
+    CellKey CellOf(float x, float y) const;
+    static CellKey MakeCellKey(int32 cx, int32 cy) { return (static_cast<uint64>(static_cast<uint32>(cx)) << 32) | static_cast<uint32>(cy); }
+    static int32 CellX(CellKey key) { return static_cast<int32>(key >> 32); }
+    static int32 CellY(CellKey key) { return static_cast<int32>(key & 0xFFFFFFFF); }
+
+    bool Insert(EntityId id, float x, float y, bool observer, SessionRef session);
+    void AddToCell(EntityId id, Entity& entity, CellKey key, float x, float y);
+    void RemoveFromCell(EntityId id, Entity& entity);
+    void MarkDirty(CellKey key, Cell& cell);
+
+    // (x, y)에서 viewRange 이내인 엔티티를 (id << 1 | 이번 틱에 움직였으면 1)로 out에 추가 (self 제외)
+    void CollectInRange(EntityId self, CellKey center, float x, float y, std::vector<uint64>& out) const;
+    static void FilterInRange(const Cell& cell, float x, float y, float rangeSq, EntityId self, uint64 tick, std::vector<uint64>& out);
+
+private:
+    float _cellSize;
+    float _inverseCellSize;
+    float _viewRange;
+    int32 _cellRadius;                      // 시야가 닿는 주변 셀 범위 (셀 개수)
+
+    std::unordered_map<CellKey, Cell> _cells;
+    std::unordered_map<EntityId, Entity> _entities;
+
+    uint64 _tick = 1;
+    std::vector<CellKey> _dirtyCells;       // 이번 틱에 구성원이나 위치가 바뀐 셀
+    std::vector<EntityId> _moved;           // 이번 틱에 움직인 엔티티
+
+    // 직전 Update에서 움직인 엔티티 (FlushMoves용, 셀 순으로 정렬)
+    std::vector<std::pair<CellKey, EntityId>> _movedByCell;
+
+    // Update 작업 공간 (틱마다 재사용)
+    std::vector<std::pair<EntityId, Entity*>> _observers;
+    std::vector<uint64> _nextVisible;
+    std::vector<SendBufferRef> _batches;
+
+    uint32 _lastUpdatedObservers = 0;
+    uint32 _lastBatchCount = 0;
+};
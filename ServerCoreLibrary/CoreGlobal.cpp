@@ -3,20 +3,42 @@
 #include "SendBuffer.h"
 #include "ThreadManager.h"
 #include "MemoryPool.h"
+#include "FileCache.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "Logger.h"
+#include "PacketCapture.h"
 
 ThreadManager* GThreadManager = nullptr;
 SendBufferManager* GSendBufferManager = nullptr;
 MemoryPoolManager* GMemoryManager = nullptr;
+FileCache* GFileCache = nullptr;
+MetricsRegistry* GMetrics = nullptr;
+Tracer* GTracer = nullptr;
+Logger* GLogger = nullptr;
+PacketCapture* GPacketCapture = nullptr;
 CoreGlobal::CoreGlobal()
 {
+	// ٸ  ü 尡   Ƿ     ߿ 
+	GMetrics = new MetricsRegistry();
+	GTracer = new Tracer();
+	GLogger = new Logger();
 	GThreadManager = new ThreadManager();
 	GSendBufferManager = new SendBufferManager();
 	GMemoryManager = new MemoryPoolManager();
+	GFileCache = new FileCache();
+	GPacketCapture = new PacketCapture();
 }
 
 CoreGlobal::~CoreGlobal()
 {
+	delete GPacketCapture;
+	// ĳõ ̽ ޸ Ǯ ݳǹǷ ޸ Ǯ  
+	delete GFileCache;
 	delete GThreadManager;
 	delete GSendBufferManager;
 	delete GMemoryManager;
+	delete GLogger;
+	delete GTracer;
+	delete GMetrics;
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
 extern class ThreadManager* GThreadManager;
 extern class SendBufferManager* GSendBufferManager;
 extern class MemoryPoolManager* GMemoryManager;
+extern class FileCache* GFileCache;
+extern class MetricsRegistry* GMetrics;
+extern class Tracer* GTracer;
+extern class Logger* GLogger;
+extern class PacketCapture* GPacketCapture;
 
 class CoreGlobal
 {
@@ -5,19 +5,47 @@
 // 여기에 자주 업데이트할 파일을 추가하지 마세요. 그러면 성능이 저하됩니다.
 
 #pragma once
+#ifdef _WIN32
 #define _WIN32_WINNT 0x0601  // Windows 7 이상
+#endif
 // 여기에 미리 컴파일하려는 헤더 추가
 #include "framework.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
 using BYTE = unsigned char;
-using int8 = __int8;
-using int16 = __int16;
-using int32 = __int32;
-using int64 = __int64;
-using uint8 = unsigned __int8;
-using uint16 = unsigned __int16;
-using uint32 = unsigned __int32;
-using uint64 = unsigned __int64;
+using int8 = std::int8_t;
+using int16 = std::int16_t;
+using int32 = std::int32_t;
+using int64 = std::int64_t;
+using uint8 = std::uint8_t;
+using uint16 = std::uint16_t;
+using uint32 = std::uint32_t;
+using uint64 = std::uint64_t;
+
+#ifndef _MSC_VER
+// MSVC 보안 문자열 함수 대체 (배열 크기를 넘으면 잘라서 항상 널 종료)
+template<size_t N>
+inline int strcpy_s(char (&dest)[N], const char* src)
+{
+    std::snprintf(dest, N, "%s", src);
+    return 0;
+}
+
+template<size_t N>
+inline int strncpy_s(char (&dest)[N], const char* src, size_t count)
+{
+    size_t len = ::strnlen(src, count);
+    if (len >= N)
+        len = N - 1;
+    ::memcpy(dest, src, len);
+    dest[len] = '\0';
+    return 0;
+}
+#endif
 
 #include <asio.hpp>
 #include <memory>
@@ -28,6 +56,7 @@ using uint64 = unsigned __int64;
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <system_error>
@@ -35,6 +64,7 @@ using uint64 = unsigned __int64;
 #include <set>
 #include <functional>
 #include <map>
+#include <source_location>
 
 #include "SendBuffer.h"
 #include "Session.h"
@@ -2,4 +2,7 @@
 #include "CoreTLS.h"
 
 thread_local uint32 LThreadId = 0;
-thread_local std::shared_ptr<SendBufferChunk> LSendBufferChunk;
\ No newline at end of file
+thread_local std::shared_ptr<SendBufferChunk> LSendBufferChunk;
+thread_local MetricShard* LMetricShard = nullptr;
+thread_local TraceRing* LTraceRing = nullptr;
+thread_local LogQueue* LLogQueue = nullptr;
\ No newline at end of file
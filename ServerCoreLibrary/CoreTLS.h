@@ -1,6 +1,12 @@
 #pragma once
 
 class SendBufferChunk;
+struct MetricShard;
+struct TraceRing;
+struct LogQueue;
 
 extern thread_local uint32 LThreadId;
-extern thread_local std::shared_ptr<SendBufferChunk> LSendBufferChunk;
\ No newline at end of file
+extern thread_local std::shared_ptr<SendBufferChunk> LSendBufferChunk;
+extern thread_local MetricShard* LMetricShard;
+extern thread_local TraceRing* LTraceRing;
+extern thread_local LogQueue* LLogQueue;
\ No newline at end of file
@@ -0,0 +1,198 @@
+﻿#include "pch.h"
+#include "Crc32c.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CRC32C_HAS_SSE42
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CRC32C_TARGET_SSE42
+#else
+#include <cpuid.h>
+#define CRC32C_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif
+
+namespace
+{
+    // 반사(reflected) 형태의 Castagnoli 다항식
+    const uint32 CRC32C_POLY = 0x82F63B78;
+
+    struct Crc32cTables
+    {
+        Crc32cTables()
+        {
+            // 1. 바이트 단위 테이블
+            for (uint32 i = 0; i < 256; i++)
+            {
+                uint32 crc = i;
+                for (int32 k = 0; k < 8; k++)
+                    crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : (crc >> 1);
+                slice[0][i] = crc;
+            }
+
+            // 2. slicing-by-8 테이블
+            for (uint32 i = 0; i < 256; i++)
+            {
+                for (int32 t = 1; t < 8; t++)
+                    slice[t][i] = (slice[t - 1][i] >> 8) ^ slice[0][slice[t - 1][i] & 0xFF];
+            }
+
+            // 3. Combine용 x^(2^n) mod P 테이블
+            uint32 p = 1u << 30; // x^1
+            x2n[0] = p;
+            for (int32 n = 1; n < 32; n++)
+                x2n[n] = p = MultModP(p, p);
+        }
+
+        // GF(2) 다항식 곱셈 (a * b mod P)
+        static uint32 MultModP(uint32 a, uint32 b)
+        {
+            uint32 m = 1u << 31;
+            uint32 p = 0;
+            for (;;)
+            {
+                if (a & m)
+                {
+                    p ^= b;
+                    if ((a & (m - 1)) == 0)
+                        break;
+                }
+                m >>= 1;
+                b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : (b >> 1);
+            }
+            return p;
+        }
+
+        // x^(n * 2^k) mod P
+        uint32 X2NModP(uint64 n, uint32 k) const
+        {
+            uint32 p = 1u << 31; // x^0
+            while (n)
+            {
+                if (n & 1)
+                    p = MultModP(x2n[k & 31], p);
+                n >>= 1;
+                k++;
+            }
+            return p;
+        }
+
+        uint32 slice[8][256];
+        uint32 x2n[32];
+    };
+
+    const Crc32cTables& Tables()
+    {
+        static const Crc32cTables tables;
+        return tables;
+    }
+}
+
+uint32 Crc32c::Update(uint32 crc, const void* data, size_t len)
+{
+    const uint8* bytes = static_cast<const uint8*>(data);
+
+    if (IsHardwareAccelerated())
+        return UpdateHardware(crc, bytes, len);
+
+    return UpdateSoftware(crc, bytes, len);
+}
+
+uint32 Crc32c::Combine(uint32 crc1, uint32 crc2, uint64 len2)
+{
+    // crc1에 x^(8 * len2)를 곱해 B 길이만큼 밀어낸 뒤 crc2와 합침
+    const Crc32cTables& tables = Tables();
+    return Crc32cTables::MultModP(tables.X2NModP(len2, 3), crc1) ^ crc2;
+}
+
+bool Crc32c::IsHardwareAccelerated()
+{
+#ifdef CRC32C_HAS_SSE42
+    static const bool supported = []()
+        {
+#ifdef _MSC_VER
+            int32 info[4] = {};
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0;
+#else
+            uint32 eax = 0, ebx = 0, ecx = 0, edx = 0;
+            if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+                return false;
+            return (ecx & bit_SSE4_2) != 0;
+#endif
+        }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+uint32 Crc32c::UpdateSoftware(uint32 crc, const uint8* data, size_t len)
+{
+    const Crc32cTables& tables = Tables();
+    crc = ~crc;
+
+    // 8바이트씩 처리
+    while (len >= 8)
+    {
+        uint32 lo, hi;
+        ::memcpy(&lo, data, sizeof(lo));
+        ::memcpy(&hi, data + 4, sizeof(hi));
+        lo ^= crc;
+
+        crc = tables.slice[7][lo & 0xFF] ^
+            tables.slice[6][(lo >> 8) & 0xFF] ^
+            tables.slice[5][(lo >> 16) & 0xFF] ^
+            tables.slice[4][lo >> 24] ^
+            tables.slice[3][hi & 0xFF] ^
+            tables.slice[2][(hi >> 8) & 0xFF] ^
+            tables.slice[1][(hi >> 16) & 0xFF] ^
+            tables.slice[0][hi >> 24];
+
+        data += 8;
+        len -= 8;
+    }
+
+    // 남은 바이트 처리
+    while (len-- > 0)
+        crc = (crc >> 8) ^ tables.slice[0][(crc ^ *data++) & 0xFF];
+
+    return ~crc;
+}
+
+#ifdef CRC32C_HAS_SSE42
+CRC32C_TARGET_SSE42
+uint32 Crc32c::UpdateHardware(uint32 crc, const uint8* data, size_t len)
+{
+    uint64 value = ~crc;
+
+    // 1. 8바이트 정렬까지 바이트 단위 처리
+    while (len > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0)
+    {
+        value = _mm_crc32_u8(static_cast<uint32>(value), *data++);
+        len--;
+    }
+
+    // 2. 8바이트씩 처리
+    while (len >= 8)
+    {
+        uint64 word;
+        ::memcpy(&word, data, sizeof(word));
+        value = _mm_crc32_u64(value, word);
+        data += 8;
+        len -= 8;
+    }
+
+    // 3. 남은 바이트 처리
+    while (len-- > 0)
+        value = _mm_crc32_u8(static_cast<uint32>(value), *data++);
+
+    return ~static_cast<uint32>(value);
+}
+#else
+uint32 Crc32c::UpdateHardware(uint32 crc, const uint8* data, size_t len)
+{
+    return UpdateSoftware(crc, data, len);
+}
+#endif
@@ -0,0 +1,26 @@
+﻿#pragma once
+
+/*----------------
+    Crc32c
+-----------------*/
+// CRC32C (Castagnoli) 체크섬
+// SSE4.2를 지원하는 CPU에서는 crc32 명령어를 사용하고, 아니면 slicing-by-8 테이블 사용
+class Crc32c
+{
+public:
+    // 새 체크섬 계산
+    static uint32 Compute(const void* data, size_t len) { return Update(0, data, len); }
+
+    // 이전 체크섬에 이어서 계산 (스트리밍용)
+    static uint32 Update(uint32 crc, const void* data, size_t len);
+
+    // crc(A)와 crc(B)로 crc(A + B) 계산 (len2 = B의 길이)
+    // 데이터를 다시 읽지 않고 청크 체크섬을 파일 체크섬으로 합칠 때 사용
+    static uint32 Combine(uint32 crc1, uint32 crc2, uint64 len2);
+
+    static bool IsHardwareAccelerated();
+
+private:
+    static uint32 UpdateSoftware(uint32 crc, const uint8* data, size_t len);
+    static uint32 UpdateHardware(uint32 crc, const uint8* data, size_t len);
+};
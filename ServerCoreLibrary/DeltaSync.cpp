@@ -0,0 +1,363 @@
+﻿#include "pch.h"
+#include "DeltaSync.h"
+#include "Crc32c.h"
+#include <cmath>
+
+namespace
+{
+    // 한 번에 파일에서 읽어 올 크기
+    const size_t READ_SIZE = 256 * 1024;
+
+    inline uint64 Rotl64(uint64 x, int32 r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64 FMix64(uint64 k)
+    {
+        k ^= k >> 33;
+        k *= 0xFF51AFD7ED558CCDull;
+        k ^= k >> 33;
+        k *= 0xC4CEB9FE1A85EC53ull;
+        k ^= k >> 33;
+        return k;
+    }
+}
+
+/*----------------
+    RollingChecksum
+-----------------*/
+void RollingChecksum::Reset(const uint8* data, uint32 len)
+{
+    _a = 0;
+    _b = 0;
+    _len = len;
+
+    // b는 a의 누적합 (앞쪽 바이트일수록 가중치가 큼)
+    for (uint32 i = 0; i < len; i++)
+    {
+        _a += data[i] + CHAR_OFFSET;
+        _b += _a;
+    }
+}
+
+/*----------------
+    DeltaSync
+-----------------*/
+uint32 DeltaSync::ChooseBlockSize(uint64 fileSize)
+{
+    uint32 blockSize = static_cast<uint32>(std::sqrt(static_cast<double>(fileSize))) & ~7u;
+    if (blockSize < MIN_BLOCK_SIZE)
+        return MIN_BLOCK_SIZE;
+    if (blockSize > MAX_BLOCK_SIZE)
+        return MAX_BLOCK_SIZE;
+    return blockSize;
+}
+
+BlockSignature DeltaSync::Signature(const uint8* data, uint32 len)
+{
+    BlockSignature signature = {};
+
+    RollingChecksum rolling;
+    rolling.Reset(data, len);
+    signature.weak = rolling.Value();
+    StrongHash(data, len, signature.strong);
+
+    return signature;
+}
+
+void DeltaSync::StrongHash(const uint8* data, uint32 len, uint32 out[4])
+{
+    // MurmurHash3 x64_128
+    const uint64 c1 = 0x87C37B91114253D5ull;
+    const uint64 c2 = 0x4CF5AD432745937Full;
+
+    uint64 h1 = 0;
+    uint64 h2 = 0;
+
+    // 1. 16바이트 단위 처리
+    const uint32 blocks = len / 16;
+    for (uint32 i = 0; i < blocks; i++)
+    {
+        uint64 k1, k2;
+        ::memcpy(&k1, data + i * 16, sizeof(k1));
+        ::memcpy(&k2, data + i * 16 + 8, sizeof(k2));
+
+        k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = Rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+
+        k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = Rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    // 2. 남은 바이트 처리
+    const uint8* tail = data + blocks * 16;
+    const uint32 rest = len & 15;
+    uint64 k1 = 0;
+    uint64 k2 = 0;
+
+    for (uint32 i = rest; i > 8; i--)
+        k2 ^= static_cast<uint64>(tail[i - 1]) << ((i - 9) * 8);
+    if (rest > 8)
+    {
+        k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+
+    for (uint32 i = (rest < 8 ? rest : 8); i > 0; i--)
+        k1 ^= static_cast<uint64>(tail[i - 1]) << ((i - 1) * 8);
+    if (rest > 0)
+    {
+        k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    // 3. 마무리
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = FMix64(h1);
+    h2 = FMix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    out[0] = static_cast<uint32>(h1);
+    out[1] = static_cast<uint32>(h1 >> 32);
+    out[2] = static_cast<uint32>(h2);
+    out[3] = static_cast<uint32>(h2 >> 32);
+}
+
+/*----------------
+    DeltaEncoder
+-----------------*/
+void DeltaEncoder::Init(uint32 blockSize, std::vector<BlockSignature> signatures)
+{
+    Clear();
+
+    _blockSize = blockSize;
+    _signatures = std::move(signatures);
+
+    // 약한 체크섬 색인 구성
+    _tags.assign(0x10000, 0);
+    _index.reserve(_signatures.size());
+    for (uint32 i = 0; i < static_cast<uint32>(_signatures.size()); i++)
+    {
+        _index[_signatures[i].weak].push_back(i);
+        _tags[Tag(_signatures[i].weak)] = 1;
+    }
+}
+
+void DeltaEncoder::Clear()
+{
+    _blockSize = 0;
+    std::vector<BlockSignature>().swap(_signatures);
+    _index.clear();
+    _tags.clear();
+    std::vector<uint8>().swap(_window);
+    _start = 0;
+    _pos = 0;
+    _end = 0;
+    _eof = false;
+    _rollingValid = false;
+    _nextBlock = 0;
+    _lastCopyOp = SIZE_MAX;
+    _consumed = 0;
+    _finished = false;
+    _checksum = 0;
+    _matchedBytes = 0;
+    _literalBytes = 0;
+}
+
+bool DeltaEncoder::Encode(std::istream& input, std::vector<BYTE>& out, uint32 maxSize, uint32& opCount)
+{
+    out.clear();
+    opCount = 0;
+    _lastCopyOp = SIZE_MAX;
+    _consumed = 0;
+
+    while (!_finished)
+    {
+        // 1. 윈도우 하나만큼의 데이터 확보
+        if (_end - _pos < _blockSize && !_eof)
+        {
+            if (!Fill(input))
+                return false;
+            continue;
+        }
+
+        // 2. 블록 하나가 안 되게 남았으면 나머지는 모두 리터럴
+        if (_end - _pos < _blockSize)
+        {
+            if (!FlushLiteral(_end, out, maxSize, opCount))
+                return true;
+
+            _finished = true;
+            break;
+        }
+
+        // 3. 리터럴이 너무 길어지면 먼저 보냄
+        if (_pos - _start >= MAX_LITERAL_SIZE && !FlushLiteral(_pos, out, maxSize, opCount))
+            return true;
+
+        if (opCount > 0 && _consumed >= MAX_INPUT_PER_CALL)
+            return true;
+
+        if (!_rollingValid)
+        {
+            _rolling.Reset(&_window[_pos], _blockSize);
+            _rollingValid = true;
+        }
+
+        int64 block = FindMatch(_rolling.Value(), &_window[_pos]);
+        if (block < 0)
+        {
+            // 4. 일치하는 블록이 없으면 윈도우를 한 바이트 밀기
+            if (_pos + _blockSize == _end)
+            {
+                if (!_eof && !Fill(input))
+                    return false;
+
+                if (_pos + _blockSize == _end)
+                {
+                    // 더 읽을 데이터가 없음
+                    _pos = _end;
+                    continue;
+                }
+            }
+
+            _rolling.Roll(_window[_pos], _window[_pos + _blockSize]);
+            _pos++;
+            continue;
+        }
+
+        // 5. 일치: 앞의 리터럴과 블록 참조를 명령 하나로 기록
+        size_t literal = _pos - _start;
+        DeltaOp op = {};
+        if (literal == 0 && _lastCopyOp != SIZE_MAX)
+            ::memcpy(&op, &out[_lastCopyOp], sizeof(op));
+
+        if (literal == 0 && _lastCopyOp != SIZE_MAX && op.blockIndex + op.blockCount == static_cast<uint32>(block))
+        {
+            // 바로 앞 블록에 이어지면 명령을 늘리기만 함
+            op.blockCount++;
+            ::memcpy(&out[_lastCopyOp], &op, sizeof(op));
+        }
+        else
+        {
+            if (out.size() + sizeof(DeltaOp) + literal > maxSize)
+            {
+                // 패킷이 가득 참 (들어가는 만큼만 리터럴을 보내고 다음 호출에서 이어서 처리)
+                FlushLiteral(_pos, out, maxSize, opCount);
+                return true;
+            }
+
+            op.literalSize = static_cast<uint32>(literal);
+            op.blockIndex = static_cast<uint32>(block);
+            op.blockCount = 1;
+
+            size_t offset = out.size();
+            out.resize(offset + sizeof(op) + literal);
+            ::memcpy(&out[offset], &op, sizeof(op));
+            if (literal > 0)
+                ::memcpy(&out[offset + sizeof(op)], &_window[_start], literal);
+
+            opCount++;
+            _lastCopyOp = offset;
+        }
+
+        // 리터럴과 일치한 블록은 윈도우 안에서 연속이므로 한 번에 체크섬 계산
+        _checksum = Crc32c::Update(_checksum, &_window[_start], literal + _blockSize);
+        _literalBytes += literal;
+        _matchedBytes += _blockSize;
+        _consumed += literal + _blockSize;
+
+        _pos += _blockSize;
+        _start = _pos;
+        _rollingValid = false;
+        _nextBlock = static_cast<uint32>(block) + 1;
+    }
+
+    return true;
+}
+
+bool DeltaEncoder::Fill(std::istream& input)
+{
+    // 이미 보낸 앞부분은 버리고 남은 데이터를 버퍼 앞으로 이동
+    if (_start > 0)
+    {
+        ::memmove(_window.data(), _window.data() + _start, _end - _start);
+        _pos -= _start;
+        _end -= _start;
+        _start = 0;
+    }
+
+    if (_window.size() < _end + READ_SIZE)
+        _window.resize(_end + READ_SIZE);
+
+    input.read(reinterpret_cast<char*>(&_window[_end]), READ_SIZE);
+    size_t readSize = static_cast<size_t>(input.gcount());
+    _end += readSize;
+
+    if (readSize < READ_SIZE)
+    {
+        if (input.bad())
+            return false;
+        _eof = true;
+    }
+
+    return true;
+}
+
+int64 DeltaEncoder::FindMatch(uint32 weak, const uint8* data)
+{
+    if (_tags.empty() || _tags[Tag(weak)] == 0)
+        return -1;
+
+    auto it = _index.find(weak);
+    if (it == _index.end())
+        return -1;
+
+    uint32 strong[4];
+    DeltaSync::StrongHash(data, _blockSize, strong);
+
+    // 수정되지 않은 구간은 순서대로 일치하므로 직전 블록의 다음 블록을 먼저 확인
+    if (_nextBlock < _signatures.size() &&
+        _signatures[_nextBlock].weak == weak &&
+        ::memcmp(_signatures[_nextBlock].strong, strong, sizeof(strong)) == 0)
+        return _nextBlock;
+
+    for (uint32 block : it->second)
+    {
+        if (::memcmp(_signatures[block].strong, strong, sizeof(strong)) == 0)
+            return block;
+    }
+
+    return -1;
+}
+
+bool DeltaEncoder::FlushLiteral(size_t until, std::vector<BYTE>& out, uint32 maxSize, uint32& opCount)
+{
+    while (_start < until)
+    {
+        if (out.size() + sizeof(DeltaOp) >= maxSize)
+            return false;
+
+        size_t len = std::min(until - _start, maxSize - out.size() - sizeof(DeltaOp));
+        DeltaOp op = { static_cast<uint32>(len), 0, 0 };
+
+        size_t offset = out.size();
+        out.resize(offset + sizeof(op) + len);
+        ::memcpy(&out[offset], &op, sizeof(op));
+        ::memcpy(&out[offset + sizeof(op)], &_window[_start], len);
+        opCount++;
+
+        _checksum = Crc32c::Update(_checksum, &_window[_start], len);
+        _literalBytes += len;
+        _consumed += len;
+        _start += len;
+
+        // 리터럴 명령 뒤에는 복사 명령을 이어 붙일 수 없음
+        _lastCopyOp = SIZE_MAX;
+    }
+
+    return true;
+}
@@ -0,0 +1,119 @@
+﻿#pragma once
+#include <istream>
+#include <unordered_map>
+
+/*----------------
+    BlockSignature
+-----------------*/
+// 수신측이 가진 기존 파일의 블록 서명 (FileSignature 패킷 뒤에 배열로 따라옴)
+struct BlockSignature
+{
+    uint32 weak;       // 롤링 체크섬
+    uint32 strong[4];  // 128비트 해시 (약한 체크섬이 같을 때 확인용)
+};
+
+/*----------------
+    DeltaOp
+-----------------*/
+// 델타 명령 하나: literalSize 바이트의 리터럴을 쓴 뒤 기존 파일의 블록 [blockIndex, blockIndex + blockCount) 복사
+// 리터럴 데이터는 이 구조체 바로 뒤에 따라옴 (패킷 안에서 정렬되어 있지 않으므로 memcpy로 읽을 것)
+struct DeltaOp
+{
+    uint32 literalSize;
+    uint32 blockIndex;
+    uint32 blockCount;
+};
+
+/*----------------
+    RollingChecksum
+-----------------*/
+// rsync 방식의 약한 체크섬 - 윈도우를 한 바이트 밀 때 O(1)로 갱신
+class RollingChecksum
+{
+public:
+    void Reset(const uint8* data, uint32 len);
+
+    void Roll(uint8 out, uint8 in)
+    {
+        _a += in - out;
+        _b += _a - _len * (out + CHAR_OFFSET);
+    }
+
+    uint32 Value() const { return (_a & 0xFFFF) | (_b << 16); }
+
+private:
+    enum { CHAR_OFFSET = 31 };
+
+    uint32 _a = 0;
+    uint32 _b = 0;
+    uint32 _len = 0;
+};
+
+/*----------------
+    DeltaSync
+-----------------*/
+class DeltaSync
+{
+public:
+    static const uint32 MIN_BLOCK_SIZE = 1024;
+    static const uint32 MAX_BLOCK_SIZE = 128 * 1024;
+
+    // 기존 파일 크기에 맞는 블록 크기 (rsync처럼 sqrt(파일 크기), 8의 배수)
+    static uint32 ChooseBlockSize(uint64 fileSize);
+
+    static BlockSignature Signature(const uint8* data, uint32 len);
+    static void StrongHash(const uint8* data, uint32 len, uint32 out[4]);
+};
+
+/*----------------
+    DeltaEncoder
+-----------------*/
+// 송신측: 수신측 블록 서명과 일치하는 구간은 블록 참조로, 나머지는 리터럴로 인코딩
+// 파일을 앞에서부터 한 번만 읽으며, 읽은 순서대로 파일 전체 CRC32C도 함께 계산
+class DeltaEncoder
+{
+public:
+    // 한 번에 모아 보낼 최대 리터럴 크기
+    static const uint32 MAX_LITERAL_SIZE = 32 * 1024;
+    // Encode 한 번에 처리할 최대 입력 크기 (전부 일치해도 io 스레드를 오래 붙잡지 않도록)
+    static const uint32 MAX_INPUT_PER_CALL = 4 * 1024 * 1024;
+
+    void Init(uint32 blockSize, std::vector<BlockSignature> signatures);
+    void Clear();
+
+    // input을 이어서 읽으며 델타 명령을 out에 최대 maxSize 바이트까지 기록 (읽기 오류 시 false)
+    bool Encode(std::istream& input, std::vector<BYTE>& out, uint32 maxSize, uint32& opCount);
+
+    bool IsFinished() const { return _finished; }
+    uint32 FileChecksum() const { return _checksum; }
+    uint64 MatchedBytes() const { return _matchedBytes; }
+    uint64 LiteralBytes() const { return _literalBytes; }
+
+private:
+    bool Fill(std::istream& input);
+    int64 FindMatch(uint32 weak, const uint8* data);
+    bool FlushLiteral(size_t until, std::vector<BYTE>& out, uint32 maxSize, uint32& opCount);
+    static uint16 Tag(uint32 weak) { return static_cast<uint16>((weak ^ (weak >> 16)) & 0xFFFF); }
+
+    uint32 _blockSize = 0;
+    std::vector<BlockSignature> _signatures;
+    std::unordered_map<uint32, std::vector<uint32>> _index; // 약한 체크섬 -> 블록 번호
+    std::vector<uint8> _tags;                                // 약한 체크섬 16비트 필터
+
+    // 읽어 둔 입력: [_start, _pos)는 아직 보내지 않은 리터럴, _pos부터 블록 크기만큼이 현재 윈도우
+    std::vector<uint8> _window;
+    size_t _start = 0;
+    size_t _pos = 0;
+    size_t _end = 0;
+    bool _eof = false;
+    bool _rollingValid = false;
+    RollingChecksum _rolling;
+
+    uint32 _nextBlock = 0;        // 직전에 일치한 블록의 다음 블록 (우선 확인)
+    size_t _lastCopyOp = SIZE_MAX; // 이번 패킷에서 이어 붙일 수 있는 마지막 복사 명령 위치
+    uint64 _consumed = 0;         // 이번 Encode 호출에서 처리한 입력 크기
+    bool _finished = false;
+    uint32 _checksum = 0;
+    uint64 _matchedBytes = 0;
+    uint64 _literalBytes = 0;
+};
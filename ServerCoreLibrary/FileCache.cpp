@@ -0,0 +1,137 @@
+﻿#include "pch.h"
+#include "FileCache.h"
+#include "Crc32c.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+bool FileCache::Stat(const std::string& path, FileVersion& version)
+{
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec) || ec)
+        return false;
+
+    version.fileSize = fs::file_size(path, ec);
+    if (ec)
+        return false;
+
+    version.lastWriteTime = static_cast<int64>(fs::last_write_time(path, ec).time_since_epoch().count());
+    return !ec;
+}
+
+std::shared_ptr<FileSegment> FileCache::Acquire(const std::string& path, const FileVersion& version, uint32 segmentIndex)
+{
+    std::string key = path + '#' + std::to_string(segmentIndex);
+
+    // 1. 캐시 확인
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _index.find(key);
+        if (it != _index.end()) {
+            if (it->second->version == version) {
+                _lru.splice(_lru.begin(), _lru, it->second);
+                _hits++;
+                return it->second->segment;
+            }
+
+            // 파일이 바뀌었으면 버리고 다시 읽음
+            EraseLocked(it->second);
+        }
+    }
+
+    // 2. 디스크에서 읽기 (다른 세그먼트 요청을 막지 않도록 락 밖에서)
+    _misses++;
+    std::shared_ptr<FileSegment> segment = Load(path, version, segmentIndex);
+    if (segment == nullptr)
+        return nullptr;
+
+    // 3. 캐시에 추가 (그 사이에 다른 스레드가 먼저 넣었으면 그것을 사용)
+    std::lock_guard<std::mutex> guard(_lock);
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        if (it->second->version == version) {
+            _lru.splice(_lru.begin(), _lru, it->second);
+            return it->second->segment;
+        }
+        EraseLocked(it->second);
+    }
+
+    _lru.push_front(Entry{ key, version, segment });
+    _index[key] = _lru.begin();
+    _cachedBytes += segment->Size();
+    EvictLocked();
+
+    return segment;
+}
+
+void FileCache::SetCapacity(uint64 bytes)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    _capacity = bytes;
+    EvictLocked();
+}
+
+uint64 FileCache::Capacity()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _capacity;
+}
+
+uint64 FileCache::CachedBytes()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    return _cachedBytes;
+}
+
+std::shared_ptr<FileSegment> FileCache::Load(const std::string& path, const FileVersion& version, uint32 segmentIndex)
+{
+    uint64 offset = static_cast<uint64>(segmentIndex) * SEGMENT_SIZE;
+    if (offset >= version.fileSize)
+        return nullptr;
+
+    uint32 size = static_cast<uint32>(std::min<uint64>(SEGMENT_SIZE, version.fileSize - offset));
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return nullptr;
+
+    // 1. 페이지 정렬 메모리에 구간을 한 번만 읽음
+    std::shared_ptr<BYTE> block(
+        static_cast<BYTE*>(::operator new(size, std::align_val_t(PAGE_SIZE))),
+        [](BYTE* ptr) { ::operator delete(ptr, std::align_val_t(PAGE_SIZE)); });
+
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(block.get()), size);
+    if (file.gcount() != static_cast<std::streamsize>(size))
+        return nullptr;
+
+    std::shared_ptr<FileSegment> segment = std::make_shared<FileSegment>();
+    segment->_offset = offset;
+    segment->_size = size;
+    segment->_checksum = Crc32c::Compute(block.get(), size);
+    segment->_block = block;
+
+    // 2. 패킷 크기로 나눈 읽기 전용 슬라이스를 한 번만 만듦 (각 슬라이스가 메모리 블록을 참조)
+    for (uint32 pos = 0; pos < size; pos += SLICE_SIZE)
+    {
+        uint32 len = std::min<uint32>(SLICE_SIZE, size - pos);
+        segment->_slices.push_back(ObjectPool<SendBuffer>::MakeShared(std::source_location::current(), std::shared_ptr<void>(block), block.get() + pos, len));
+    }
+
+    return segment;
+}
+
+void FileCache::EraseLocked(std::list<Entry>::iterator it)
+{
+    _cachedBytes -= it->segment->Size();
+    _index.erase(it->key);
+    _lru.erase(it);
+}
+
+void FileCache::EvictLocked()
+{
+    // 가장 오래 쓰지 않은 세그먼트부터 제거 (방금 넣은 세그먼트는 남김)
+    while (_cachedBytes > _capacity && _lru.size() > 1)
+        EraseLocked(std::prev(_lru.end()));
+}
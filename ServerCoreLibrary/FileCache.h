@@ -0,0 +1,84 @@
+﻿#pragma once
+#include <list>
+#include <unordered_map>
+
+/*----------------
+    FileSegment
+-----------------*/
+// 캐시된 파일 구간 하나 (페이지 정렬 메모리에 한 번만 읽어 둠)
+// 패킷 크기로 나눈 읽기 전용 SendBuffer 슬라이스를 미리 만들어 두고, 모든 세션이 같은 슬라이스를 전송 큐에 넣음
+class FileSegment
+{
+    friend class FileCache;
+
+public:
+    uint64 Offset() const { return _offset; }
+    uint32 Size() const { return _size; }
+    uint32 Checksum() const { return _checksum; }
+    const std::vector<SendBufferRef>& Slices() const { return _slices; }
+
+private:
+    uint64 _offset = 0;
+    uint32 _size = 0;
+    uint32 _checksum = 0;                // 구간 전체의 CRC32C
+    std::shared_ptr<BYTE> _block;        // 슬라이스들이 공유하는 메모리
+    std::vector<SendBufferRef> _slices;
+};
+
+/*----------------
+    FileCache
+-----------------*/
+// 여러 세션이 같은 파일을 내려받을 때 디스크 읽기와 복사를 한 번만 하도록 세그먼트를 공유하는 LRU 캐시
+// 캐시에서 밀려난 세그먼트도 아직 전송 큐에 남은 슬라이스가 있으면 전송이 끝날 때까지 메모리가 유지됨
+class FileCache
+{
+public:
+    enum
+    {
+        PAGE_SIZE = 4096,
+        SEGMENT_SIZE = 1024 * 1024,
+        SLICE_SIZE = 32 * 1024, // 패킷 하나에 담을 크기 (SEGMENT_SIZE의 약수)
+    };
+
+    static const uint64 DEFAULT_CAPACITY = 256ull * 1024 * 1024;
+
+    // 캐시된 세그먼트가 같은 파일 내용인지 구분하기 위한 정보
+    struct FileVersion
+    {
+        uint64 fileSize = 0;
+        int64 lastWriteTime = 0;
+
+        bool operator==(const FileVersion& other) const = default;
+    };
+
+    static bool Stat(const std::string& path, FileVersion& version);
+
+    // 세그먼트를 캐시에서 찾고, 없거나 파일이 바뀌었으면 디스크에서 읽어 캐시에 넣음 (읽기 실패 시 nullptr)
+    std::shared_ptr<FileSegment> Acquire(const std::string& path, const FileVersion& version, uint32 segmentIndex);
+
+    void SetCapacity(uint64 bytes);
+    uint64 Capacity();
+    uint64 CachedBytes();
+    uint64 Hits() const { return _hits; }
+    uint64 Misses() const { return _misses; }
+
+private:
+    struct Entry
+    {
+        std::string key;
+        FileVersion version;
+        std::shared_ptr<FileSegment> segment;
+    };
+
+    static std::shared_ptr<FileSegment> Load(const std::string& path, const FileVersion& version, uint32 segmentIndex);
+    void EraseLocked(std::list<Entry>::iterator it);
+    void EvictLocked();
+
+    std::mutex _lock;
+    std::list<Entry> _lru; // 앞쪽이 최근에 사용한 세그먼트
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+    uint64 _capacity = DEFAULT_CAPACITY;
+    uint64 _cachedBytes = 0;
+    std::atomic<uint64> _hits = 0;
+    std::atomic<uint64> _misses = 0;
+};
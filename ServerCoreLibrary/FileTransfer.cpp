@@ -1,6 +1,319 @@
 #include "pch.h"
 #include "FileTransfer.h"
 #include "CoreGlobal.h"
+#include "Crc32c.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "Logger.h"
+
+/*----------------
+    ChunkBitmap
+-----------------*/
+bool ChunkBitmap::Open(const std::string& path, const FileHeader& header, bool& resumed)
+{
+    Close();
+
+    _path = path;
+    _chunksTotal = header.chunksTotal;
+    _chunksDone = 0;
+    _chunkSize = header.chunkSize;
+    _fileSize = header.fileSize;
+    _bits.assign((header.chunksTotal + 7) / 8, 0);
+    _checksums.assign(header.chunksTotal, 0);
+    resumed = false;
+
+    // 1.  Ͽ   Ʈ ִ Ȯ
+    std::ifstream existing(path, std::ios::binary);
+    if (existing.is_open())
+    {
+        Header saved = {};
+        existing.read(reinterpret_cast<char*>(&saved), sizeof(saved));
+
+        if (existing.good() &&
+            saved.magic == MAGIC &&
+            saved.version == VERSION &&
+            saved.chunkSize == header.chunkSize &&
+            saved.fileSize == header.fileSize &&
+            saved.lastWriteTime == header.lastWriteTime &&
+            saved.chunksTotal == header.chunksTotal)
+        {
+            existing.read(reinterpret_cast<char*>(_bits.data()), _bits.size());
+            existing.read(reinterpret_cast<char*>(_checksums.data()), _checksums.size() * sizeof(uint32_t));
+            resumed = !existing.fail();
+        }
+        existing.close();
+    }
+
+    // 2. ų ٸ  ̸  
+    if (!resumed)
+    {
+        std::fill(_bits.begin(), _bits.end(), 0);
+        std::fill(_checksums.begin(), _checksums.end(), 0);
+        return Create(header);
+    }
+
+    // 3. Ϸ ûũ  
+    for (uint32_t chunkId = 0; chunkId < _chunksTotal; chunkId++)
+    {
+        if (Test(chunkId))
+            _chunksDone++;
+    }
+
+    _stream.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    return _stream.is_open();
+}
+
+bool ChunkBitmap::Create(const FileHeader& header)
+{
+    _stream.open(_path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!_stream.is_open())
+        return false;
+
+    Header saved = {};
+    saved.magic = MAGIC;
+    saved.chunkSize = header.chunkSize;
+    saved.fileSize = header.fileSize;
+    saved.lastWriteTime = header.lastWriteTime;
+    saved.chunksTotal = header.chunksTotal;
+    saved.version = VERSION;
+
+    _stream.write(reinterpret_cast<const char*>(&saved), sizeof(saved));
+    _stream.write(reinterpret_cast<const char*>(_bits.data()), _bits.size());
+    _stream.write(reinterpret_cast<const char*>(_checksums.data()), _checksums.size() * sizeof(uint32_t));
+    _stream.flush();
+    return _stream.good();
+}
+
+void ChunkBitmap::Close()
+{
+    if (_stream.is_open())
+        _stream.close();
+}
+
+void ChunkBitmap::Remove()
+{
+    Close();
+
+    std::error_code ec;
+    if (!_path.empty())
+        fs::remove(_path, ec);
+}
+
+bool ChunkBitmap::Set(uint32_t chunkId, uint32_t checksum)
+{
+    //  ų ̹  ûũ false
+    if (chunkId >= _chunksTotal || Test(chunkId))
+        return false;
+
+    _checksums[chunkId] = checksum;
+
+    uint8_t& bits = _bits[chunkId / 8];
+    bits |= static_cast<uint8_t>(1 << (chunkId % 8));
+    _chunksDone++;
+
+    // üũ ش Ʈ Ʈ ũ ݿ
+    if (_stream.is_open())
+    {
+        _stream.seekp(ChecksumOffset(chunkId));
+        _stream.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        _stream.seekp(sizeof(Header) + chunkId / 8);
+        _stream.put(static_cast<char>(bits));
+        _stream.flush();
+    }
+
+    return true;
+}
+
+void ChunkBitmap::Reset()
+{
+    std::fill(_bits.begin(), _bits.end(), 0);
+    std::fill(_checksums.begin(), _checksums.end(), 0);
+    _chunksDone = 0;
+
+    if (_stream.is_open())
+    {
+        _stream.seekp(sizeof(Header));
+        _stream.write(reinterpret_cast<const char*>(_bits.data()), _bits.size());
+        _stream.flush();
+    }
+}
+
+bool ChunkBitmap::Test(uint32_t chunkId) const
+{
+    if (chunkId >= _chunksTotal)
+        return false;
+
+    return (_bits[chunkId / 8] & (1 << (chunkId % 8))) != 0;
+}
+
+std::vector<ChunkRange> ChunkBitmap::MissingRanges(uint32_t maxRanges, uint32_t& tailChecksum) const
+{
+    std::vector<ChunkRange> ranges;
+    uint32_t skippedBegin = 0;
+
+    uint32_t chunkId = 0;
+    while (chunkId < _chunksTotal)
+    {
+        //   Ʈ   ǳʶ
+        if ((chunkId % 8) == 0 && _bits[chunkId / 8] == 0xFF)
+        {
+            chunkId += 8;
+            continue;
+        }
+
+        if (Test(chunkId))
+        {
+            chunkId++;
+            continue;
+        }
+
+        uint32_t skippedChecksum = RangeChecksum(skippedBegin, chunkId);
+
+        //   ѿ ɸ   ϳ 
+        if (ranges.size() + 1 >= maxRanges)
+        {
+            ranges.push_back({ chunkId, _chunksTotal, skippedChecksum });
+            skippedBegin = _chunksTotal;
+            break;
+        }
+
+        uint32_t begin = chunkId;
+        while (chunkId < _chunksTotal && !Test(chunkId))
+            chunkId++;
+
+        ranges.push_back({ begin, chunkId, skippedChecksum });
+        skippedBegin = chunkId;
+    }
+
+    tailChecksum = RangeChecksum(skippedBegin, _chunksTotal);
+    return ranges;
+}
+
+uint32_t ChunkBitmap::RangeChecksum(uint32_t begin, uint32_t end) const
+{
+    uint32_t checksum = 0;
+    for (uint32_t chunkId = begin; chunkId < end; chunkId++)
+    {
+        uint64_t offset = static_cast<uint64_t>(chunkId) * _chunkSize;
+        uint64_t len = std::min<uint64_t>(_chunkSize, _fileSize - offset);
+        checksum = Crc32c::Combine(checksum, _checksums[chunkId], len);
+    }
+
+    return checksum;
+}
+
+uint32_t ChunkBitmap::FileChecksum(uint64_t fileSize, uint32_t chunkSize) const
+{
+    uint32_t checksum = 0;
+    uint64_t offset = 0;
+
+    for (uint32_t chunkId = 0; chunkId < _chunksTotal; chunkId++)
+    {
+        uint64_t len = std::min<uint64_t>(chunkSize, fileSize - offset);
+        checksum = Crc32c::Combine(checksum, _checksums[chunkId], len);
+        offset += len;
+    }
+
+    return checksum;
+}
+
+/*----------------
+    PackWriter
+-----------------*/
+bool PackWriter::Open(const fs::path& root)
+{
+    Close();
+
+    std::error_code ec;
+    fs::create_directories(root, ec);
+    if (ec)
+        return false;
+
+    _root = root;
+    _buffer.resize(BUFFER_SIZE);
+    _used = 0;
+    _createdDirs.clear();
+    _createdDirs.insert(root.generic_string());
+    _filesWritten = 0;
+    return true;
+}
+
+void PackWriter::Close()
+{
+    //    (Ϸ  EndFile ̹ )
+    if (_file.is_open())
+        _file.close();
+
+    _used = 0;
+    std::vector<char>().swap(_buffer);
+    _createdDirs.clear();
+}
+
+bool PackWriter::BeginFile(const std::string& relativePath)
+{
+    fs::path path = _root / fs::path(relativePath);
+    if (!CreateParentDirectories(path))
+        return false;
+
+    // ۸ PackWriter ϹǷ Ʈ ۴  (  ؾ )
+    _file.rdbuf()->pubsetbuf(nullptr, 0);
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    _used = 0;
+    return _file.is_open();
+}
+
+bool PackWriter::Write(const char* data, size_t len)
+{
+    if (_used + len > _buffer.size() && !Flush())
+        return false;
+
+    // ۺ ū ʹ  ʰ ٷ 
+    if (len >= _buffer.size()) {
+        _file.write(data, len);
+        return _file.good();
+    }
+
+    ::memcpy(&_buffer[_used], data, len);
+    _used += len;
+    return true;
+}
+
+bool PackWriter::EndFile()
+{
+    bool ok = Flush();
+    _file.close();
+    if (!ok || _file.fail())
+        return false;
+
+    _filesWritten++;
+    return true;
+}
+
+bool PackWriter::Flush()
+{
+    if (_used > 0) {
+        _file.write(_buffer.data(), _used);
+        _used = 0;
+    }
+    return _file.good();
+}
+
+bool PackWriter::CreateParentDirectories(const fs::path& path)
+{
+    //  丮  ޾ Ƿ ̹  丮  ýۿ ٽ  
+    fs::path parent = path.parent_path();
+    std::string key = parent.generic_string();
+    if (_createdDirs.count(key) > 0)
+        return true;
+
+    std::error_code ec;
+    fs::create_directories(parent, ec);
+    if (ec)
+        return false;
+
+    _createdDirs.insert(std::move(key));
+    return true;
+}
 
 /*----------------
     FileTransferManager
@@ -13,10 +326,25 @@ FileTransferManager::~FileTransferManager()
 {
     //   Ʈ 
     std::lock_guard<std::mutex> guard(_lock);
-    for (auto& pair : _transfers)
+    for (auto* transfers : { &_sendTransfers, &_recvTransfers })
+    {
+        for (auto& pair : *transfers)
+        {
+            if (pair.second.fileStream.is_open())
+                pair.second.fileStream.close();
+            if (pair.second.partStream.is_open())
+                pair.second.partStream.close();
+            if (pair.second.basisStream.is_open())
+                pair.second.basisStream.close();
+            pair.second.bitmap.Close();
+            pair.second.packWriter.Close();
+        }
+    }
+
+    for (auto& pair : _downloadTransfers)
     {
-        if (pair.second.fileStream.is_open())
-            pair.second.fileStream.close();
+        if (pair.second.stream.is_open())
+            pair.second.stream.close();
     }
 }
 
@@ -35,13 +363,25 @@ bool FileTransferManager::StartFileSend(std::shared_ptr<Session> session, const
     if (ec)
         return false;
 
+    //  ̾ޱ     ֵ  ð 
+    uint64_t lastWriteTime = static_cast<uint64_t>(fs::last_write_time(filePath, ec).time_since_epoch().count());
+    if (ec)
+        return false;
+
+    // SendBuffer ִ ũ⸦ Ͽ ûũ ũ 
+    // ( chunkId * chunkSize  ϹǷ  ߿ ٲ  )
+    const uint32_t maxChunkSize = SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(FileChunk) - 16; // ߰  
+    chunkSize = std::min(chunkSize, maxChunkSize);
+    if (chunkSize == 0)
+        return false;
+
     //  ؽƮ 
-    uint32_t connectionId;
+    uint32_t transferId;
     {
         std::lock_guard<std::mutex> guard(_lock);
-        connectionId = _nextConnectionId++;
+        transferId = _nextTransferId++;
 
-        FileTransferContext& context = _transfers[connectionId];
+        FileTransferContext& context = _sendTransfers[transferId];
         context.filePath = filePath;
         context.fileStream = std::move(file);
         context.fileSize = fileSize;
@@ -50,351 +390,1587 @@ bool FileTransferManager::StartFileSend(std::shared_ptr<Session> session, const
         context.chunksTotal = static_cast<uint32_t>((fileSize + chunkSize - 1) / chunkSize); // ø 
         context.chunksSent = 0;
         context.isCompleted = false;
+        context.awaitingResponse = true; //  ʿ  ˷  
     }
 
     //   û Ŷ 
-    auto packet = CreateFileRequestPacket(filePath, fileSize, chunkSize);
+    auto packet = CreateFileRequestPacket(transferId, filePath, fileSize, chunkSize, lastWriteTime);
     session->Send(packet);
 
     return true;
 }
 
-bool FileTransferManager::StartFileReceive(const std::string& targetDir, const FileHeader& header)
+bool FileTransferManager::StartFileReceive(std::shared_ptr<Session> session, const std::string& targetDir, const FileHeader& header)
 {
+    //  ID ۽  ( ûũ Ϸ Ŷ  ID ã)
+    uint32_t transferId = header.transferId;
+
     //  α
-    std::cout << "\n[FileTransfer] Receiving file: " << header.filename << std::endl;
-    std::cout << "[FileTransfer] File size: " << header.fileSize << " bytes" << std::endl;
-    std::cout << "[FileTransfer] Total chunks: " << header.chunksTotal << std::endl;
+    LOG_INFO("[FileTransfer] Receiving file: {} (transfer {}, {} bytes, {} chunks)",
+        PacketString(header.filename), transferId, header.fileSize, header.chunksTotal);
+
+    //    ( ڰ  ̸ ź)
+    std::string filename(header.filename, strnlen(header.filename, sizeof(header.filename)));
+    if (filename.empty() || fs::path(filename).filename().string() != filename) {
+        LOG_ERROR("[FileTransfer] Invalid file name: {}", filename);
+        session->Send(CreateFileResponsePacket(transferId, false, {}));
+        return false;
+    }
+
+    if (header.chunkSize == 0 ||
+        header.chunksTotal != static_cast<uint32_t>((header.fileSize + header.chunkSize - 1) / header.chunkSize)) {
+        LOG_ERROR("[FileTransfer] Invalid chunk layout (chunkSize={})", header.chunkSize);
+        session->Send(CreateFileResponsePacket(transferId, false, {}));
+        return false;
+    }
 
-    //   
-    std::string filename(header.filename);
     std::string filePath = targetDir + "/" + filename;
+    std::string partPath = filePath + ".part";
+    std::string bitmapPath = filePath + ".bitmap";
 
     // 丮  Ȯ  
     if (!fs::exists(targetDir)) {
-        std::cout << "[FileTransfer] Creating directory: " << targetDir << std::endl;
+        LOG_INFO("[FileTransfer] Creating directory: {}", targetDir);
         std::error_code ec;
         fs::create_directories(targetDir, ec);
         if (ec) {
-            std::cerr << "[FileTransfer] Error creating directory: " << ec.message() << std::endl;
+            LOG_ERROR("[FileTransfer] Cannot create directory: {}", ec.message());
+            session->Send(CreateFileResponsePacket(transferId, false, {}));
             return false;
         }
     }
 
-    //   ִٸ 
-    if (fs::exists(filePath)) {
-        std::string backupPath = filePath + ".bak";
-        std::error_code ec;
-        std::cout << "[FileTransfer] Backing up existing file to: " << backupPath << std::endl;
-        fs::rename(filePath, backupPath, ec);
-        if (ec) {
-            std::cerr << "[FileTransfer] Error backing up file: " << ec.message() << std::endl;
-            //      ǥ
+    std::lock_guard<std::mutex> guard(_lock);
+
+    //  ID̰ų   ޴  ؽƮ   (Ʈ  )
+    for (auto it = _recvTransfers.begin(); it != _recvTransfers.end(); )
+    {
+        if (it->first == transferId || (it->second.filePath == filePath && !it->second.isCompleted)) {
+            if (it->second.partStream.is_open())
+                it->second.partStream.close();
+            if (it->second.basisStream.is_open())
+                it->second.basisStream.close();
+            it->second.bitmap.Close();
+            it = _recvTransfers.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    //  ؽƮ 
+    FileTransferContext& context = _recvTransfers[transferId];
+    context.filePath = filePath;
+    context.partPath = partPath;
+    context.fileSize = header.fileSize;
+    context.bytesSent = 0;
+    context.chunkSize = header.chunkSize;
+    context.chunksTotal = header.chunksTotal;
+    context.chunksSent = 0;
+    context.isCompleted = false;
+
+    // 1. ûũ Ʈ  (  ӽ    ̾ޱ)
+    bool resumed = false;
+    if (!context.bitmap.Open(bitmapPath, header, resumed)) {
+        LOG_ERROR("[FileTransfer] Cannot open chunk bitmap: {}", bitmapPath);
+        _recvTransfers.erase(transferId);
+        session->Send(CreateFileResponsePacket(transferId, false, {}));
+        return false;
+    }
+
+    std::error_code ec;
+    if (resumed && (!fs::exists(partPath, ec) || fs::file_size(partPath, ec) != header.fileSize || ec)) {
+        // ӽ  ų ũⰡ ٸ ó ٽ 
+        LOG_INFO("[FileTransfer] Partial file missing or mismatched, restarting transfer");
+        context.bitmap.Remove();
+        if (!context.bitmap.Open(bitmapPath, header, resumed)) {
+            LOG_ERROR("[FileTransfer] Cannot open chunk bitmap: {}", bitmapPath);
+            _recvTransfers.erase(transferId);
+            session->Send(CreateFileResponsePacket(transferId, false, {}));
+            return false;
+        }
+        resumed = false;
+    }
+
+    // 2.  ޴  ӽ     Ҵ
+    if (!resumed) {
+        LOG_INFO("[FileTransfer] Creating file: {}", partPath);
+        std::ofstream file(partPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_ERROR("[FileTransfer] Cannot create file: {}", partPath);
+            context.bitmap.Remove();
+            _recvTransfers.erase(transferId);
+            session->Send(CreateFileResponsePacket(transferId, false, {}));
+            return false;
+        }
+
+        //  ũ⸸ŭ  ̸ Ҵ
+        if (header.fileSize > 0) {
+            file.seekp(header.fileSize - 1);
+            file.put(0);
+            file.flush();
+        }
+
+        if (!file.good()) {
+            LOG_ERROR("[FileTransfer] Cannot pre-allocate file space");
+            file.close();
+            context.bitmap.Remove();
+            _recvTransfers.erase(transferId);
+            session->Send(CreateFileResponsePacket(transferId, false, {}));
+            return false;
+        }
+    }
+    else {
+        LOG_INFO("[FileTransfer] Resuming transfer: {}/{} chunks already received", context.bitmap.ChunksDone(), header.chunksTotal);
+    }
+
+    // 3. ûũ Ͽ ӽ  α
+    context.partStream.open(partPath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!context.partStream.is_open()) {
+        LOG_ERROR("[FileTransfer] Cannot open file for writing: {}", partPath);
+        context.bitmap.Close();
+        _recvTransfers.erase(transferId);
+        session->Send(CreateFileResponsePacket(transferId, false, {}));
+        return false;
+    }
+
+    LOG_INFO("[FileTransfer] Created transfer context with ID: {}", transferId);
+    LOG_INFO("[FileTransfer] Target file path: {}", filePath);
+
+    // 4.  ûũ   ̸    ٲ κи ޵ Ÿ  û
+    if ((header.flags & FILE_FLAG_DELTA) && context.bitmap.ChunksDone() == 0 && StartDeltaReceive(session, transferId, context)) {
+        LOG_INFO("[FileTransfer] Requesting delta against existing file ({} blocks of {} bytes)", context.deltaBlocksTotal, context.deltaBlockSize);
+        session->Send(CreateFileResponsePacket(transferId, true, {}, true));
+        return true;
+    }
+
+    // 5.  ûũ  ۽ 
+    // ̹  ûũ üũ Բ  ۽  ٽ  ʰ  üũ  
+    uint32_t tailChecksum = 0;
+    std::vector<ChunkRange> ranges = context.bitmap.MissingRanges(MAX_RESPONSE_RANGES, tailChecksum);
+    LOG_INFO("[FileTransfer] Requesting {} missing chunk range(s)", ranges.size());
+    session->Send(CreateFileResponsePacket(transferId, true, ranges, false, tailChecksum));
+
+    // ̹   ̾ ۽  üũ ޾   Ϸ ó
+    return true;
+}
+
+bool FileTransferManager::StartPackSend(std::shared_ptr<Session> session, const std::string& dirPath)
+{
+    std::error_code ec;
+    fs::path root = fs::path(dirPath).lexically_normal();
+    if (!root.has_filename())
+        root = root.parent_path(); // "dir/"  ó
+
+    if (!fs::is_directory(root, ec) || ec)
+        return false;
+
+    std::string dirname = root.filename().string();
+    if (dirname.empty() || dirname == "." || dirname == ".." || dirname.length() >= sizeof(PackHeader::dirname))
+        return false;
+
+    // 1.     ( δ '/' )
+    std::vector<PackFile> files;
+    uint64_t totalSize = 0;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+
+        PackFile file;
+        file.path = it->path().string();
+        file.relativePath = it->path().lexically_relative(root).generic_string();
+        file.size = it->file_size(ec);
+        if (ec || file.relativePath.empty() || file.relativePath.length() > MAX_PACK_PATH) {
+            LOG_ERROR("[FileTransfer] Cannot pack file: {}", file.path);
+            return false;
+        }
+
+        totalSize += file.size;
+        files.push_back(std::move(file));
+    }
+
+    if (ec || files.size() > UINT32_MAX) {
+        LOG_ERROR("[FileTransfer] Cannot enumerate directory: {}", root.string());
+        return false;
+    }
+
+    uint32_t fileCount = static_cast<uint32_t>(files.size());
+
+    // 2.  ؽƮ  (  ü ϳ )
+    uint32_t transferId;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        transferId = _nextTransferId++;
+
+        FileTransferContext& context = _sendTransfers[transferId];
+        context.filePath = root.string();
+        context.fileSize = totalSize;
+        context.isCompleted = false;
+        context.awaitingResponse = true;
+        context.packMode = true;
+        context.packFileCount = fileCount;
+        context.packFiles = std::move(files);
+    }
+
+    LOG_INFO("[FileTransfer] Packing {} file(s), {} bytes from {}", fileCount, totalSize, root.string());
+
+    session->Send(CreatePackRequestPacket(transferId, dirname, fileCount, totalSize));
+    return true;
+}
+
+bool FileTransferManager::StartPackReceive(std::shared_ptr<Session> session, const std::string& targetDir, const PackHeader& header)
+{
+    uint32_t transferId = header.transferId;
+
+    LOG_INFO("[FileTransfer] Receiving pack: {} (transfer {}, {} file(s), {} bytes)",
+        PacketString(header.dirname), transferId, header.fileCount, header.totalSize);
+
+    // 丮 ̸ Ȯ ( ڰ  ̸ ź)
+    std::string dirname(header.dirname, strnlen(header.dirname, sizeof(header.dirname)));
+    if (dirname.empty() || dirname == "." || dirname == ".." || fs::path(dirname).filename().string() != dirname) {
+        LOG_ERROR("[FileTransfer] Invalid directory name: {}", dirname);
+        session->Send(CreateFileResponsePacket(transferId, false, {}));
+        return false;
+    }
+
+    std::string filePath = targetDir + "/" + dirname;
+    std::string partPath = filePath + ".part";
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    //  ID̰ų  丮 ޴  ؽƮ 
+    for (auto it = _recvTransfers.begin(); it != _recvTransfers.end(); )
+    {
+        if (it->first == transferId || (it->second.filePath == filePath && !it->second.isCompleted)) {
+            if (it->second.partStream.is_open())
+                it->second.partStream.close();
+            if (it->second.basisStream.is_open())
+                it->second.basisStream.close();
+            it->second.bitmap.Close();
+            it->second.packWriter.Close();
+            it = _recvTransfers.erase(it);
+        }
+        else {
+            ++it;
         }
     }
 
-    //     Ҵ
-    std::cout << "[FileTransfer] Creating file: " << filePath << std::endl;
-    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
-    if (!file.is_open()) {
-        std::cerr << "[FileTransfer] Error: Cannot create file: " << filePath << std::endl;
-        return false;
+    FileTransferContext& context = _recvTransfers[transferId];
+    context.filePath = filePath;
+    context.partPath = partPath;
+    context.fileSize = header.totalSize;
+    context.isCompleted = false;
+    context.packMode = true;
+    context.packFileCount = header.fileCount;
+
+    //  ̾ Ƿ  ߴܵ ӽ 丮   Ǯ
+    std::error_code ec;
+    fs::remove_all(partPath, ec);
+    if (ec || !context.packWriter.Open(partPath)) {
+        LOG_ERROR("[FileTransfer] Cannot create directory: {}", partPath);
+        _recvTransfers.erase(transferId);
+        session->Send(CreateFileResponsePacket(transferId, false, {}));
+        return false;
+    }
+
+    LOG_INFO("[FileTransfer] Unpacking into: {}", partPath);
+    session->Send(CreateFileResponsePacket(transferId, true, {}));
+    return true;
+}
+
+bool FileTransferManager::ProcessPackData(std::shared_ptr<Session> session, const PackData& pack, const BYTE* data, uint32_t size)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _recvTransfers.find(pack.transferId);
+    if (it == _recvTransfers.end() || it->second.isCompleted || !it->second.packMode || it->second.packFinished) {
+        LOG_ERROR("[FileTransfer] No active pack receive with ID {}", pack.transferId);
+        return false;
+    }
+
+    FileTransferContext& context = it->second;
+    const char* stream = reinterpret_cast<const char*>(data);
+
+    // 1. Ʈ üũ ϸ Ϸ Ǯ
+    context.packChecksum = Crc32c::Update(context.packChecksum, stream, size);
+    context.bytesSent += size;
+
+    GMetrics->Core().fileChunksReceived->Inc();
+    GMetrics->Core().fileBytesReceived->Inc(size);
+
+    if (!UnpackStream(context, stream, size)) {
+        LOG_ERROR("[FileTransfer] Malformed pack stream after {} file(s)", context.packFilesDone);
+        FailFileReceive(session, it->first, context);
+        return false;
+    }
+
+    if (!pack.isLast)
+        return true;
+
+    // 2.  ̸ Ʈ   Ȯ
+    if (context.packInFile || !context.packPending.empty() || context.packFilesDone != context.packFileCount) {
+        LOG_ERROR("[FileTransfer] Pack stream ended after {}/{} file(s)", context.packFilesDone, context.packFileCount);
+        FailFileReceive(session, it->first, context);
+        return false;
+    }
+
+    context.packFinished = true;
+    LOG_INFO("[FileTransfer] Unpacked {} file(s), {} stream bytes", context.packFilesDone, context.bytesSent);
+
+    // ۽ üũ ̹  ٷ 
+    if (context.checksumReceived)
+        VerifyFileReceive(session, it->first, context);
+
+    return true;
+}
+
+bool FileTransferManager::UnpackStream(FileTransferContext& context, const char* data, size_t size)
+{
+    const char* cursor = data;
+    const char* end = data + size;
+
+    while (cursor < end)
+    {
+        // 1.  
+        if (context.packInFile) {
+            size_t len = static_cast<size_t>(std::min<uint64_t>(end - cursor, context.packRemaining));
+            if (!context.packWriter.Write(cursor, len))
+                return false;
+
+            cursor += len;
+            context.packRemaining -= len;
+            if (context.packRemaining == 0) {
+                if (!context.packWriter.EndFile())
+                    return false;
+                context.packInFile = false;
+                context.packFilesDone++;
+            }
+            continue;
+        }
+
+        // 2. Ʈ   (Ŷ 迡 ĥ  Ƿ    )
+        std::vector<char>& pending = context.packPending;
+        size_t need = PACK_ENTRY_SIZE;
+        uint64_t fileSize = 0;
+        uint32_t pathLength = 0;
+        if (pending.size() >= PACK_ENTRY_SIZE) {
+            ::memcpy(&fileSize, pending.data(), sizeof(fileSize));
+            ::memcpy(&pathLength, pending.data() + sizeof(fileSize), sizeof(pathLength));
+            if (pathLength == 0 || pathLength > MAX_PACK_PATH)
+                return false;
+            need += pathLength;
+        }
+
+        size_t len = std::min<size_t>(end - cursor, need - pending.size());
+        pending.insert(pending.end(), cursor, cursor + len);
+        cursor += len;
+
+        //    ݺ  ̸ 
+        if (pending.size() < need || need == PACK_ENTRY_SIZE)
+            continue;
+
+        // 3.   
+        if (context.packFilesDone >= context.packFileCount)
+            return false;
+
+        std::string relativePath(pending.data() + PACK_ENTRY_SIZE, pathLength);
+        if (!IsSafeRelativePath(relativePath)) {
+            LOG_ERROR("[FileTransfer] Unsafe path in pack: {}", relativePath);
+            return false;
+        }
+
+        if (!context.packWriter.BeginFile(relativePath))
+            return false;
+
+        pending.clear();
+        context.packRemaining = fileSize;
+        context.packInFile = true;
+
+        if (fileSize == 0) {
+            if (!context.packWriter.EndFile())
+                return false;
+            context.packInFile = false;
+            context.packFilesDone++;
+        }
+    }
+
+    return true;
+}
+
+bool FileTransferManager::IsSafeRelativePath(const std::string& path)
+{
+    //  丮    ź
+    fs::path relative(path);
+    if (relative.empty() || relative.is_absolute() || relative.has_root_name() || relative.has_root_directory())
+        return false;
+
+    for (const fs::path& part : relative)
+    {
+        if (part.empty() || part == "." || part == "..")
+            return false;
+    }
+
+    return true;
+}
+
+bool FileTransferManager::ProcessFileResponse(std::shared_ptr<Session> session, const FileResponse& response, const ChunkRange* ranges)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    //   Ǵ   ۽ſ  ûũ û
+    auto it = _sendTransfers.find(response.transferId);
+    if (it == _sendTransfers.end() || it->second.isCompleted) {
+        LOG_ERROR("[FileTransfer] No active send transfer with ID {}", response.transferId);
+        return false;
+    }
+
+    FileTransferContext& context = it->second;
+
+    bool signaturesReady = !context.deltaSignatures.empty() &&
+        context.deltaSignatures.size() == context.deltaBlocksTotal;
+
+    if (!response.accepted || (response.delta && !signaturesReady)) {
+        if (response.accepted)
+            LOG_ERROR("[FileTransfer] Incomplete block signatures for delta transfer: {}", context.filePath);
+        else
+            LOG_WARN("[FileTransfer] Transfer rejected by receiver: {}", context.filePath);
+        FailFileSend(it->first, context);
+        return false;
+    }
+
+    if (context.packMode) {
+        //   û  Ʈ ó    
+        if (!context.awaitingResponse)
+            return true;
+
+        LOG_INFO("[FileTransfer] Receiver accepted pack of {} file(s) for {}", context.packFileCount, context.filePath);
+    }
+    else if (response.delta) {
+        //     ûũ  Ÿ  ( ó ٽ )
+        LOG_INFO("[FileTransfer] Receiver requested delta against {} block(s) for {}", context.deltaBlocksTotal, context.filePath);
+
+        context.deltaEncoder.Init(context.deltaBlockSize, std::move(context.deltaSignatures));
+        context.deltaSignatures.clear();
+        context.deltaMode = true;
+        context.pendingRanges.clear();
+        context.rangeIndex = 0;
+        context.fileStream.clear();
+        context.fileStream.seekg(0);
+    }
+    else {
+        if (context.deltaMode) {
+            // Ÿ  ϸ   ü ٽ û - ûũ  ȯ
+            LOG_INFO("[FileTransfer] Falling back to chunk transfer for {}", context.filePath);
+            context.deltaMode = false;
+            context.deltaEncoder.Clear();
+            context.fileChecksum = 0;
+            context.checksumChunkId = 0;
+        }
+        context.deltaSignatures.clear();
+
+        //  ̰ų ̹    ڸ   ü,  ̸ ڿ ߰
+        if (context.awaitingResponse || context.rangeIndex >= context.pendingRanges.size()) {
+            context.pendingRanges.clear();
+            context.rangeIndex = 0;
+            context.tailChecksum = response.tailChecksum;
+        }
+
+        size_t first = context.pendingRanges.size();
+        for (uint32_t i = 0; i < response.rangeCount; i++)
+        {
+            //    
+            ChunkRange range = ranges[i];
+            range.end = std::min(range.end, context.chunksTotal);
+            if (range.begin < range.end)
+                context.pendingRanges.push_back(range);
+        }
+
+        if (context.rangeIndex == first && first < context.pendingRanges.size())
+            context.nextChunkId = context.pendingRanges[first].begin;
+
+        LOG_INFO("[FileTransfer] Receiver requested {} chunk range(s) for {}", (context.pendingRanges.size() - first), context.filePath);
+    }
+
+    //   ־ ٷ ٽ  ( ̸ ߰  ̾ ۵)
+    context.awaitingResponse = false;
+    context.awaitingComplete = false;
+    ScheduleSend(session, it->first, context);
+    return true;
+}
+
+bool FileTransferManager::ProcessFileSignature(const FileSignature& signature, const BlockSignature* signatures)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    //  亸  ϹǷ  ٸ ؽƮ  
+    auto it = _sendTransfers.find(signature.transferId);
+    if (it == _sendTransfers.end() || !it->second.awaitingResponse) {
+        LOG_ERROR("[FileTransfer] Transfer {} is not waiting for block signatures", signature.transferId);
+        return false;
+    }
+
+    FileTransferContext& context = it->second;
+
+    if (signature.firstBlock == 0) {
+        context.deltaSignatures.clear();
+        context.deltaBlockSize = signature.blockSize;
+        context.deltaBlocksTotal = signature.blocksTotal;
+    }
+
+    //  ũ   (߸   信   ó)
+    if (signature.blockSize < DeltaSync::MIN_BLOCK_SIZE || signature.blockSize > DeltaSync::MAX_BLOCK_SIZE ||
+        signature.blockSize != context.deltaBlockSize ||
+        signature.blocksTotal != context.deltaBlocksTotal ||
+        signature.firstBlock != context.deltaSignatures.size() ||
+        signature.count > signature.blocksTotal - signature.firstBlock) {
+        LOG_ERROR("[FileTransfer] Invalid block signatures (first={}, count={})", signature.firstBlock, signature.count);
+        context.deltaSignatures.clear();
+        return false;
+    }
+
+    context.deltaSignatures.insert(context.deltaSignatures.end(), signatures, signatures + signature.count);
+    return true;
+}
+
+bool FileTransferManager::ProcessFileDelta(std::shared_ptr<Session> session, const FileDelta& delta, const BYTE* data, uint32_t size)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _recvTransfers.find(delta.transferId);
+    if (it == _recvTransfers.end() || it->second.isCompleted) {
+        LOG_ERROR("[FileTransfer] No active file receive with ID {}", delta.transferId);
+        return false;
+    }
+
+    FileTransferContext& context = it->second;
+
+    // ü  ȯ ڿ  Ÿ 
+    if (!context.deltaMode) {
+        LOG_WARN("[FileTransfer] Ignoring delta packet, transfer is no longer in delta mode");
+        return false;
+    }
+
+    // Ÿ    (ͷ      )
+    const BYTE* cursor = data;
+    const BYTE* end = data + size;
+    bool valid = true;
+
+    for (uint32_t i = 0; i < delta.opCount && valid; i++)
+    {
+        DeltaOp op;
+        if (static_cast<size_t>(end - cursor) < sizeof(op)) {
+            valid = false;
+            break;
+        }
+
+        ::memcpy(&op, cursor, sizeof(op));
+        cursor += sizeof(op);
+
+        if (op.literalSize > static_cast<size_t>(end - cursor)) {
+            valid = false;
+            break;
+        }
+
+        valid = WriteDeltaOutput(context, reinterpret_cast<const char*>(cursor), op.literalSize) &&
+            CopyDeltaBlocks(context, op.blockIndex, op.blockCount);
+        cursor += op.literalSize;
+    }
+
+    if (valid && delta.isLast && context.deltaOffset != context.fileSize)
+        valid = false;
+
+    if (!valid) {
+        LOG_WARN("[FileTransfer] Invalid delta data, requesting the whole file");
+        RestartFullReceive(session, it->first, context);
+        return false;
+    }
+
+    GMetrics->Core().fileChunksReceived->Inc();
+    GMetrics->Core().fileBytesReceived->Inc(size);
+
+    LOG_INFO_EVERY(1000, "[FileTransfer] Delta progress: {}/{} bytes", context.deltaOffset, context.fileSize);
+
+    //   ۽  üũ 
+    if (IsReceiveComplete(context)) {
+        if (context.checksumReceived)
+            VerifyFileReceive(session, it->first, context);
+        else
+            LOG_INFO("[FileTransfer] Delta applied, waiting for file checksum");
+    }
+
+    return true;
+}
+
+bool FileTransferManager::ProcessFileChunk(std::shared_ptr<Session> session, const FileChunk& chunk, const void* data)
+{
+    //  
+    LOG_DEBUG("[FileTransfer] Processing chunk: ID={}, Size={}, IsLast={}", chunk.chunkId, chunk.chunkSize, (chunk.isLast ? "Yes" : "No"));
+
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _recvTransfers.find(chunk.transferId);
+    if (it == _recvTransfers.end()) {
+        LOG_ERROR("[FileTransfer] No file receive with ID {}", chunk.transferId);
+        return false;
+    }
+
+    FileTransferContext& context = it->second;
+
+    if (context.isCompleted || !context.partStream.is_open()) {
+        LOG_ERROR("[FileTransfer] Transfer context {} is not receiving", it->first);
+        return false;
+    }
+
+    // ûũ ȣ ũ  (Ʈʿ ߸ ϵ ʵ)
+    if (chunk.chunkId >= context.chunksTotal) {
+        LOG_ERROR("[FileTransfer] Invalid chunk ID {}", chunk.chunkId);
+        return false;
+    }
+
+    uint64_t offset = static_cast<uint64_t>(chunk.chunkId) * context.chunkSize;
+    uint32_t expectedSize = static_cast<uint32_t>(std::min<uint64_t>(context.chunkSize, context.fileSize - offset));
+    if (chunk.chunkSize != expectedSize) {
+        LOG_ERROR("[FileTransfer] Unexpected chunk size {} (expected {})", chunk.chunkSize, expectedSize);
+        return false;
+    }
+
+    // üũ  - ջ ûũ  ʰ ٽ û
+    uint32_t checksum = Crc32c::Compute(data, chunk.chunkSize);
+    if (checksum != chunk.checksum) {
+        LOG_WARN("[FileTransfer] Checksum mismatch on chunk {}, requesting it again", chunk.chunkId);
+
+        if (++context.chunkRetries > MAX_CHUNK_RETRIES) {
+            LOG_ERROR("[FileTransfer] Too many corrupted chunks");
+            FailFileReceive(session, it->first, context);
+            return false;
+        }
+
+        // ۽  ûũ ̹ üũ Ƿ ǳʶ  üũ 0
+        session->Send(CreateFileResponsePacket(it->first, true, { { chunk.chunkId, chunk.chunkId + 1, 0 } }));
+        return false;
+    }
+
+    LOG_DEBUG("[FileTransfer] Writing {} bytes at offset {}", chunk.chunkSize, offset);
+
+    //  
+    {
+        TRACE_SCOPE(FileWrite, session->GetSessionId(), chunk.chunkSize);
+        context.partStream.seekp(offset);
+        context.partStream.write(static_cast<const char*>(data), chunk.chunkSize);
+        context.partStream.flush();
+    }
+
+    if (!context.partStream.good()) {
+        LOG_ERROR("[FileTransfer] Failed to write data to file");
+        context.partStream.clear();
+        return false;
+    }
+
+    // Ͱ ϵ ڿ Ʈ  (ߺ ûũ īƮ )
+    if (context.bitmap.Set(chunk.chunkId, checksum)) {
+        context.chunksSent++;
+        context.bytesSent += chunk.chunkSize;
+    }
+
+    GMetrics->Core().fileChunksReceived->Inc();
+    GMetrics->Core().fileBytesReceived->Inc(chunk.chunkSize);
+
+    //  Ȳ 
+    double progressPct = context.chunksTotal > 0 ?
+        static_cast<double>(context.bitmap.ChunksDone()) * 100.0 / context.chunksTotal : 100.0;
+    LOG_INFO_EVERY(1000, "[FileTransfer] Progress: {}/{} chunks ({:.2f}%)", context.bitmap.ChunksDone(), context.chunksTotal, progressPct);
+
+    //  ûũ ޾ ۽  üũ 
+    if (context.bitmap.IsComplete()) {
+        if (context.checksumReceived)
+            VerifyFileReceive(session, it->first, context);
+        else
+            LOG_INFO("[FileTransfer] All chunks received, waiting for file checksum");
+    }
+    else if (chunk.isLast) {
+        LOG_INFO("[FileTransfer] Last chunk received but {} chunk(s) are still missing", context.chunksTotal - context.bitmap.ChunksDone());
+    }
+
+    return true;
+}
+
+bool FileTransferManager::ProcessFileComplete(std::shared_ptr<Session> session, const FileComplete& complete)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    if (complete.isReceiver) {
+        // ۽:    ٸ ؽƮ Ϸ ó
+        auto it = _sendTransfers.find(complete.transferId);
+        if (it == _sendTransfers.end() || !it->second.awaitingComplete) {
+            LOG_ERROR("[FileTransfer] Transfer {} is not waiting for verification", complete.transferId);
+            return false;
+        }
+
+        FileTransferContext& context = it->second;
+        context.awaitingComplete = false;
+        context.isCompleted = true;
+        context.fileStream.close();
+
+        LOG_INFO("[FileTransfer] Receiver {} file: {}", (complete.success ? "verified" : "failed to verify"), context.filePath);
+
+        if (_transferCompleteCallback)
+            _transferCompleteCallback(it->first, complete.success != 0, context.filePath);
+        return true;
+    }
+
+    // : ۽  üũ 
+    auto it = _recvTransfers.find(complete.transferId);
+    if (it == _recvTransfers.end() || it->second.isCompleted) {
+        LOG_ERROR("[FileTransfer] No active file receive with ID {}", complete.transferId);
+        return false;
+    }
+
+    FileTransferContext& context = it->second;
+    context.expectedChecksum = complete.fileChecksum;
+    context.checksumReceived = true;
+
+    // ûũ   ٷ  (û ûũ     )
+    if (IsReceiveComplete(context))
+        VerifyFileReceive(session, it->first, context);
+
+    return true;
+}
+
+void FileTransferManager::VerifyFileReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    // ûũ üũ ġų Ÿ ϸ   ϹǷ  ٽ  
+    uint32_t actualChecksum = context.packMode ? context.packChecksum :
+        context.deltaMode ? context.deltaChecksum :
+        context.bitmap.FileChecksum(context.fileSize, context.chunkSize);
+    if (actualChecksum == context.expectedChecksum) {
+        CompleteFileReceive(session, transferId, context);
+        return;
+    }
+
+    LOG_WARN("[FileTransfer] File checksum mismatch: {:x} (expected {:x})", actualChecksum, context.expectedChecksum);
+
+    //  ̾ޱ  Ƿ ٽ  ޶  
+    if (context.packMode || ++context.verifyRetries > MAX_VERIFY_RETRIES) {
+        FailFileReceive(session, transferId, context);
+        return;
+    }
+
+    // ó ٽ 
+    LOG_INFO("[FileTransfer] Requesting the whole file again");
+    RestartFullReceive(session, transferId, context);
+}
+
+void FileTransferManager::RestartFullReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    // Ÿ  ̾ ûũ  ȯ
+    if (context.deltaMode) {
+        context.deltaMode = false;
+        context.basisStream.close();
+    }
+
+    context.checksumReceived = false;
+    context.bitmap.Reset();
+
+    uint32_t tailChecksum = 0;
+    std::vector<ChunkRange> ranges = context.bitmap.MissingRanges(MAX_RESPONSE_RANGES, tailChecksum);
+    session->Send(CreateFileResponsePacket(transferId, true, ranges, false, tailChecksum));
+}
+
+bool FileTransferManager::StartDeltaReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    std::error_code ec;
+    if (!fs::exists(context.filePath, ec) || ec)
+        return false;
+
+    uint64_t basisSize = fs::file_size(context.filePath, ec);
+    if (ec)
+        return false;
+
+    //  ª    (۽ ͷ )
+    uint32_t blockSize = DeltaSync::ChooseBlockSize(basisSize);
+    uint64_t blocksTotal = basisSize / blockSize;
+    if (blocksTotal == 0 || blocksTotal > UINT32_MAX)
+        return false;
+
+    context.basisStream.open(context.filePath, std::ios::binary);
+    if (!context.basisStream.is_open())
+        return false;
+
+    //      Ŷ  
+    std::vector<char> buffer(blockSize);
+    std::vector<BlockSignature> signatures;
+    signatures.reserve(static_cast<size_t>(std::min<uint64_t>(blocksTotal, MAX_SIGNATURES_PER_PACKET)));
+
+    for (uint32_t block = 0; block < blocksTotal; block++)
+    {
+        context.basisStream.read(buffer.data(), blockSize);
+        if (context.basisStream.gcount() != static_cast<std::streamsize>(blockSize)) {
+            // ̹   ۽ Ϲ   
+            LOG_ERROR("[FileTransfer] Cannot read existing file for signatures: {}", context.filePath);
+            context.basisStream.close();
+            return false;
+        }
+
+        signatures.push_back(DeltaSync::Signature(reinterpret_cast<const uint8*>(buffer.data()), blockSize));
+
+        if (signatures.size() == MAX_SIGNATURES_PER_PACKET || block + 1 == blocksTotal) {
+            uint32_t firstBlock = block + 1 - static_cast<uint32_t>(signatures.size());
+            session->Send(CreateFileSignaturePacket(transferId, blockSize, static_cast<uint32_t>(blocksTotal), firstBlock, signatures));
+            signatures.clear();
+        }
+    }
+
+    context.deltaMode = true;
+    context.deltaBlockSize = blockSize;
+    context.deltaBlocksTotal = static_cast<uint32_t>(blocksTotal);
+    context.deltaOffset = 0;
+    context.deltaChecksum = 0;
+    return true;
+}
+
+bool FileTransferManager::WriteDeltaOutput(FileTransferContext& context, const char* data, uint64_t size)
+{
+    if (size == 0)
+        return true;
+
+    if (size > context.fileSize - context.deltaOffset) {
+        LOG_ERROR("[FileTransfer] Delta output exceeds file size");
+        return false;
+    }
+
+    context.partStream.seekp(context.deltaOffset);
+    context.partStream.write(data, size);
+    if (!context.partStream.good()) {
+        LOG_ERROR("[FileTransfer] Failed to write data to file");
+        context.partStream.clear();
+        return false;
+    }
+
+    context.deltaChecksum = Crc32c::Update(context.deltaChecksum, data, static_cast<size_t>(size));
+    context.deltaOffset += size;
+    context.bytesSent += size;
+    return true;
+}
+
+bool FileTransferManager::CopyDeltaBlocks(FileTransferContext& context, uint32_t blockIndex, uint32_t blockCount)
+{
+    if (blockCount == 0)
+        return true;
+
+    if (blockIndex >= context.deltaBlocksTotal || blockCount > context.deltaBlocksTotal - blockIndex) {
+        LOG_ERROR("[FileTransfer] Invalid block reference {}+{}", blockIndex, blockCount);
+        return false;
+    }
+
+    uint64_t remaining = static_cast<uint64_t>(blockCount) * context.deltaBlockSize;
+    std::vector<char> buffer(static_cast<size_t>(std::min<uint64_t>(remaining, 256 * 1024)));
+
+    context.basisStream.clear();
+    context.basisStream.seekg(static_cast<uint64_t>(blockIndex) * context.deltaBlockSize);
+
+    while (remaining > 0)
+    {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+        context.basisStream.read(buffer.data(), len);
+        if (context.basisStream.gcount() != static_cast<std::streamsize>(len)) {
+            LOG_ERROR("[FileTransfer] Failed to read existing file block {}", blockIndex);
+            return false;
+        }
+
+        if (!WriteDeltaOutput(context, buffer.data(), len))
+            return false;
+
+        remaining -= len;
+    }
+
+    return true;
+}
+
+bool FileTransferManager::IsReceiveComplete(const FileTransferContext& context) const
+{
+    if (context.packMode)
+        return context.packFinished;
+
+    if (context.deltaMode)
+        return context.deltaOffset == context.fileSize;
+
+    return context.bitmap.IsComplete();
+}
+
+void FileTransferManager::CompleteFileReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    context.isCompleted = true;
+    context.partStream.close();
+    context.basisStream.close();
+    context.bitmap.Close();
+    context.packWriter.Close();
+
+    //   ִٸ  ( 丮  üϹǷ   丮 )
+    std::error_code ec;
+    if (fs::exists(context.filePath, ec)) {
+        std::string backupPath = context.filePath + ".bak";
+        if (context.packMode)
+            fs::remove_all(backupPath, ec);
+        LOG_INFO("[FileTransfer] Backing up existing file to: {}", backupPath);
+        fs::rename(context.filePath, backupPath, ec);
+        if (ec) {
+            LOG_WARN("[FileTransfer] Cannot back up existing file: {}", ec.message());
+            //      ǥ
+        }
+    }
+
+    // ӽ   η ̵
+    ec.clear();
+    fs::rename(context.partPath, context.filePath, ec);
+    if (ec) {
+        LOG_ERROR("[FileTransfer] Cannot finalize file: {}", ec.message());
+        session->Send(CreateFileCompletePacket(transferId, true, false, context.expectedChecksum));
+
+        if (_transferCompleteCallback)
+            _transferCompleteCallback(transferId, false, context.filePath);
+        return;
+    }
+
+    // Ϸ  Ʈ  ̻ ʿ 
+    context.bitmap.Remove();
+
+    LOG_INFO("[FileTransfer] File transfer completed: {}", context.filePath);
+    session->Send(CreateFileCompletePacket(transferId, true, true, context.expectedChecksum));
+
+    if (_transferCompleteCallback) {
+        LOG_INFO("[FileTransfer] Calling transfer complete callback");
+        _transferCompleteCallback(transferId, true, context.filePath);
+    }
+}
+
+void FileTransferManager::FailFileReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    context.isCompleted = true;
+    context.partStream.close();
+    context.basisStream.close();
+
+    // ջ ӽ  ̾ ʵ 
+    context.bitmap.Remove();
+    context.packWriter.Close();
+    std::error_code ec;
+    if (context.packMode)
+        fs::remove_all(context.partPath, ec);
+    else
+        fs::remove(context.partPath, ec);
+
+    LOG_ERROR("[FileTransfer] File transfer failed: {}", context.filePath);
+    session->Send(CreateFileCompletePacket(transferId, true, false, 0));
+
+    if (_transferCompleteCallback)
+        _transferCompleteCallback(transferId, false, context.filePath);
+}
+
+void FileTransferManager::FoldSkippedChecksum(FileTransferContext& context, uint32_t untilChunkId, uint32_t skippedChecksum)
+{
+    // ̾ޱ  ǳʶ ûũ [checksumChunkId, untilChunkId)  信   üũ ħ
+    // ( ûũ    Ʈʿ  ̰,   ũ  ð Ȯ)
+    uint64_t begin = static_cast<uint64_t>(context.checksumChunkId) * context.chunkSize;
+    uint64_t end = std::min<uint64_t>(static_cast<uint64_t>(untilChunkId) * context.chunkSize, context.fileSize);
+    if (end > begin)
+        context.fileChecksum = Crc32c::Combine(context.fileChecksum, skippedChecksum, end - begin);
+
+    context.checksumChunkId = untilChunkId;
+}
+
+bool FileTransferManager::FinishFileSend(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    //  ûũ ļ  üũ ϼ (Ÿ  ڴ   )
+    // (  SendNextPack  Ʈ ü üũ )
+    if (context.deltaMode)
+        context.fileChecksum = context.deltaEncoder.FileChecksum();
+    else if (!context.packMode && context.checksumChunkId < context.chunksTotal)
+        FoldSkippedChecksum(context, context.chunksTotal, context.tailChecksum);
+
+    //   (FileTransferComplete)  Ϸ
+    context.awaitingComplete = true;
+    session->Send(CreateFileCompletePacket(transferId, false, true, context.fileChecksum));
+
+    LOG_INFO("All chunks sent, waiting for receiver verification (checksum {:x})", context.fileChecksum);
+    return true;
+}
+
+void FileTransferManager::ScheduleSend(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    // ̹ ⿭   忡 ̾ ۵
+    if (context.scheduled)
+        return;
+
+    context.scheduled = true;
+    context.deficit = 0;
+    _activeSends.push_back(transferId);
+
+    //  â     Ϸ  带 
+    if (!_sendRoundScheduled && _sendInFlight < SEND_WINDOW)
+        ScheduleSendRound(session);
+}
+
+void FileTransferManager::ScheduleSendRound(std::shared_ptr<Session> session)
+{
+    //  ׻ ϳ  (_lock  ¿ ȣ Spawn 帧 ߿ )
+    _sendRoundScheduled = true;
+    session->Spawn([this, session]() -> asio::awaitable<void>
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _sendRoundScheduled = false;
+            PumpSends(session);
+            co_return;
+        });
+}
+
+void FileTransferManager::ScheduleSendStallCheck(std::shared_ptr<Session> session)
+{
+    //   Ϸ   带 ϹǷ ƹ ϵ  
+    //   ʾҴµ   ť   â  ٽ  (OnSend Ѱ ʴ  )
+    _sendStallCheckScheduled = true;
+    session->Spawn([this, session]() -> asio::awaitable<void>
+        {
+            co_await session->Sleep(std::chrono::milliseconds(SEND_STALL_CHECK_MS));
+
+            std::lock_guard<std::mutex> guard(_lock);
+            _sendStallCheckScheduled = false;
+            if (_activeSends.empty() || _sendRoundScheduled)
+                co_return;
+
+            if (_sendInFlight >= SEND_WINDOW && session->IsSendIdle())
+                _sendInFlight = 0;
+            PumpSends(session);
+        });
+}
+
+void FileTransferManager::PumpSends(std::shared_ptr<Session> session)
+{
+    //  â   带 ̾ 
+    // 帶 ϴ ؽƮ SEND_QUANTUM ϰ,  ŭ Ŷ 
+    // ( ߿  ϵ ؽƮ   )
+    while (!_activeSends.empty() && _sendInFlight < SEND_WINDOW)
+    {
+        size_t activeCount = _activeSends.size();
+        for (size_t i = 0; i < activeCount && _sendInFlight < SEND_WINDOW; i++)
+        {
+            uint32_t transferId = _activeSends.front();
+            _activeSends.pop_front();
+
+            auto it = _sendTransfers.find(transferId);
+            if (it == _sendTransfers.end())
+                continue; // ҵ 
+
+            // â      , ʰؼ  縸 ̾ 
+            FileTransferContext& context = it->second;
+            context.deficit = std::min(context.deficit, 0) + SEND_QUANTUM;
+
+            int32_t sent = 0;
+            while (context.deficit > 0 && _sendInFlight < SEND_WINDOW)
+            {
+                sent = SendNextChunk(session, transferId, context);
+                if (sent <= 0)
+                    break;
+
+                // Ŷ ũⰡ  Ŀ , ʰ  忡 
+                context.deficit -= sent;
+                _sendInFlight += sent;
+            }
+
+            if (sent < 0) {
+                FailFileSend(transferId, context);
+                continue;
+            }
+
+            //     ⿭ ڷ,  ٸ ̸    ٽ 
+            if (sent > 0 || context.deficit <= 0) {
+                _activeSends.push_back(transferId);
+            }
+            else {
+                context.scheduled = false;
+                context.deficit = 0;
+            }
+        }
+    }
+
+    if (!_activeSends.empty() && !_sendStallCheckScheduled)
+        ScheduleSendStallCheck(session);
+}
+
+int32_t FileTransferManager::SendNextChunk(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    // ϷǾų   ٸ ̸    (  ٽ ϵ)
+    if (context.isCompleted || context.awaitingResponse || context.awaitingComplete)
+        return 0;
+
+    //   ϸ   
+    if (context.packMode)
+        return SendNextPack(session, transferId, context);
+
+    if (!context.fileStream.is_open()) {
+        //   ٽ 
+        context.fileStream.open(context.filePath, std::ios::binary);
+        if (!context.fileStream.is_open()) {
+            LOG_ERROR("Cannot open file for reading: {}", context.filePath);
+            return -1;
+        }
+    }
+
+    if (context.deltaMode)
+        return SendNextDelta(session, transferId, context);
+
+    // û   ûũ ã
+    while (context.rangeIndex < context.pendingRanges.size() &&
+        context.nextChunkId >= context.pendingRanges[context.rangeIndex].end)
+    {
+        context.rangeIndex++;
+        if (context.rangeIndex < context.pendingRanges.size())
+            context.nextChunkId = context.pendingRanges[context.rangeIndex].begin;
+    }
+
+    if (context.rangeIndex >= context.pendingRanges.size()) {
+        //  ûũ  ( ̹  ûũ  ִ  )
+        LOG_INFO("No more chunks to send");
+        return FinishFileSend(session, transferId, context) ? 0 : -1;
     }
 
-    //  ũ⸸ŭ  ̸ Ҵ
-    try {
-        file.seekp(header.fileSize - 1);
-        file.put(0);
-        file.flush();
-    }
-    catch (const std::exception& e) {
-        std::cerr << "[FileTransfer] Error pre-allocating file space: " << e.what() << std::endl;
-        file.close();
-        return false;
+    // ̹  ûũ 
+    uint32_t chunkId = context.nextChunkId;
+    uint64_t offset = static_cast<uint64_t>(chunkId) * context.chunkSize;
+    uint32_t currentChunkSize = static_cast<uint32_t>(std::min<uint64_t>(context.fileSize - offset, context.chunkSize));
+
+    bool isLastChunk = (chunkId + 1 >= context.pendingRanges[context.rangeIndex].end) &&
+        (context.rangeIndex + 1 == context.pendingRanges.size());
+
+    // ش ġ ̵  Ͽ  б
+    std::vector<char> buffer(currentChunkSize);
+    {
+        TRACE_SCOPE(FileRead, session->GetSessionId(), currentChunkSize);
+        context.fileStream.clear();
+        context.fileStream.seekg(offset);
+        context.fileStream.read(buffer.data(), currentChunkSize);
     }
 
-    if (!file.good()) {
-        std::cerr << "[FileTransfer] Error writing to file" << std::endl;
-        file.close();
-        return false;
+    if (!context.fileStream.good() && !context.fileStream.eof()) {
+        LOG_ERROR("Failed to read data from file");
+        return -1;
     }
 
-    file.close();
+    // ûũ üũ    üũ  ħ ( ûũ ̹  )
+    uint32_t checksum = Crc32c::Compute(buffer.data(), currentChunkSize);
+    if (chunkId >= context.checksumChunkId) {
+        if (chunkId > context.checksumChunkId)
+            FoldSkippedChecksum(context, chunkId, context.pendingRanges[context.rangeIndex].skippedChecksum);
 
-    //  ؽƮ 
-    uint32_t connectionId;
-    {
-        std::lock_guard<std::mutex> guard(_lock);
-        connectionId = _nextConnectionId++;
+        context.fileChecksum = Crc32c::Combine(context.fileChecksum, checksum, currentChunkSize);
+        context.checksumChunkId = chunkId + 1;
+    }
 
-        FileTransferContext& context = _transfers[connectionId];
-        context.filePath = filePath;
-        context.fileSize = header.fileSize;
-        context.bytesSent = 0;
-        context.chunkSize = DEFAULT_CHUNK_SIZE;
-        context.chunksTotal = header.chunksTotal;
-        context.chunksSent = 0;
-        context.isCompleted = false;
+    // ûũ Ŷ   
+    auto packet = CreateFileChunkPacket(transferId, buffer.data(), currentChunkSize, chunkId, checksum, isLastChunk);
+    if (!packet) {
+        LOG_ERROR("Failed to create file chunk packet");
+        return -1;
     }
 
-    std::cout << "[FileTransfer] Created transfer context with ID: " << connectionId << std::endl;
-    std::cout << "[FileTransfer] Target file path: " << filePath << std::endl;
+    session->Send(packet);
 
-    return true;
-}
+    LOG_DEBUG("Sent chunk {} of transfer {} ({} bytes, {})", chunkId, transferId, currentChunkSize, (isLastChunk ? "last chunk" : "more to come"));
 
-bool FileTransferManager::ProcessFileChunk(const FileChunk& chunk, const void* data)
-{
-    //  
-    std::cout << "[FileTransfer] Processing chunk: ID=" << chunk.chunkId
-        << ", Size=" << chunk.chunkSize
-        << ", IsLast=" << (chunk.isLast ? "Yes" : "No") << std::endl;
+    //  Ʈ
+    context.bytesSent += currentChunkSize;
+    context.chunksSent++;
+    context.nextChunkId++;
 
-    std::lock_guard<std::mutex> guard(_lock);
+    GMetrics->Core().fileChunksSent->Inc();
+    GMetrics->Core().fileBytesSent->Inc(currentChunkSize);
 
-    if (_transfers.empty()) {
-        std::cerr << "[FileTransfer] Error: No active file transfers" << std::endl;
-        return false;
+    //  ûũ   üũ 
+    if (isLastChunk && !FinishFileSend(session, transferId, context))
+        return -1;
+
+    return static_cast<int32_t>(packet->WriteSize());
+}
+
+int32_t FileTransferManager::SendNextDelta(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    // Ŷ ϳ ũ⸸ŭ Ÿ  ڵ
+    std::vector<BYTE> ops;
+    uint32_t opCount = 0;
+    if (!context.deltaEncoder.Encode(context.fileStream, ops, MAX_DELTA_PAYLOAD, opCount)) {
+        LOG_ERROR("Failed to read data from file");
+        return -1;
     }
 
-    //  ֱ  ؽƮ 
-    auto it = _transfers.rbegin();
-    FileTransferContext& context = it->second;
+    bool isLast = context.deltaEncoder.IsFinished();
+    auto packet = CreateFileDeltaPacket(transferId, ops, opCount, isLast);
+    session->Send(packet);
 
-    std::cout << "[FileTransfer] Using transfer context: ID=" << it->first
-        << ", FilePath=" << context.filePath << std::endl;
+    LOG_DEBUG("Sent delta packet of transfer {} ({} ops, {} bytes, {})", transferId, opCount, ops.size(), (isLast ? "last packet" : "more to come"));
 
-    //   
-    std::cout << "[FileTransfer] Full file path: " << fs::absolute(context.filePath).string() << std::endl;
+    context.bytesSent += ops.size();
+    context.chunksSent++;
 
-    // 丮 Ȯ  
-    std::string dirPath = fs::path(context.filePath).parent_path().string();
-    if (!fs::exists(dirPath)) {
-        std::cout << "[FileTransfer] Creating directory: " << dirPath << std::endl;
-        std::error_code ec;
-        fs::create_directories(dirPath, ec);
-        if (ec) {
-            std::cerr << "[FileTransfer] Failed to create directory: " << ec.message() << std::endl;
-            return false;
-        }
-    }
+    GMetrics->Core().fileChunksSent->Inc();
+    GMetrics->Core().fileBytesSent->Inc(ops.size());
 
-    //  
-    std::ofstream file(context.filePath, std::ios::binary | std::ios::in | std::ios::out);
-    if (!file.is_open()) {
-        std::cerr << "[FileTransfer] Error: Cannot open file for writing: " << context.filePath << std::endl;
+    if (isLast) {
+        LOG_INFO("Delta encoded: {} bytes matched, {} literal bytes", context.deltaEncoder.MatchedBytes(), context.deltaEncoder.LiteralBytes());
+        if (!FinishFileSend(session, transferId, context))
+            return -1;
+    }
 
-        // ٸ  õ
-        file.open(context.filePath, std::ios::binary | std::ios::trunc);
-        if (!file.is_open()) {
-            std::cerr << "[FileTransfer] Error: Still cannot open file after trying trunc mode" << std::endl;
+    return static_cast<int32_t>(packet->WriteSize());
+}
 
-            //  õ: ٸ ̸ 
-            std::string altPath = dirPath + "/received_" + std::to_string(std::time(nullptr)) + ".bin";
-            file.open(altPath, std::ios::binary | std::ios::trunc);
+int32_t FileTransferManager::SendNextPack(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context)
+{
+    // Ŷ ϳ ũ⸸ŭ [Ʈ ][][] ̾  (ϸ û/ )
+    std::vector<char> payload;
+    payload.reserve(MAX_PACK_PAYLOAD);
 
-            if (!file.is_open()) {
-                std::cerr << "[FileTransfer] Error: All attempts to open file failed" << std::endl;
-                return false;
+    while (payload.size() < MAX_PACK_PAYLOAD && context.packIndex < context.packFiles.size())
+    {
+        const PackFile& file = context.packFiles[context.packIndex];
+
+        // 1. Ʈ   (ɰ ʵ   ϸ  Ŷ)
+        if (!context.packEntrySent) {
+            uint32_t pathLength = static_cast<uint32_t>(file.relativePath.length());
+            if (payload.size() + PACK_ENTRY_SIZE + pathLength > MAX_PACK_PAYLOAD)
+                break;
+
+            if (!context.fileStream.is_open()) {
+                context.fileStream.open(file.path, std::ios::binary);
+                if (!context.fileStream.is_open()) {
+                    LOG_ERROR("Cannot open file for reading: {}", file.path);
+                    return -1;
+                }
             }
 
-            std::cout << "[FileTransfer] Opened alternative file path: " << altPath << std::endl;
-            context.filePath = altPath;
+            size_t offset = payload.size();
+            payload.resize(offset + PACK_ENTRY_SIZE + pathLength);
+            ::memcpy(&payload[offset], &file.size, sizeof(file.size));
+            ::memcpy(&payload[offset + sizeof(file.size)], &pathLength, sizeof(pathLength));
+            ::memcpy(&payload[offset + PACK_ENTRY_SIZE], file.relativePath.data(), pathLength);
+
+            context.packEntrySent = true;
+            context.packFileOffset = 0;
         }
-    }
 
-    //   ȴٸ ũ Ȯ
-    std::error_code ec;
-    uintmax_t fileSize = fs::file_size(context.filePath, ec);
-    if (!ec) {
-        std::cout << "[FileTransfer] Current file size: " << fileSize << " bytes" << std::endl;
+        // 2.   (Ŷ 迡 ߸  Ŷ ̾)
+        uint64_t remaining = file.size - context.packFileOffset;
+        size_t len = static_cast<size_t>(std::min<uint64_t>(remaining, MAX_PACK_PAYLOAD - payload.size()));
+        if (len > 0) {
+            size_t offset = payload.size();
+            payload.resize(offset + len);
+            TRACE_SCOPE(FileRead, session->GetSessionId(), len);
+            context.fileStream.read(&payload[offset], len);
+            if (context.fileStream.gcount() != static_cast<std::streamsize>(len)) {
+                LOG_ERROR("Failed to read data from file: {}", file.path);
+                return -1;
+            }
+            context.packFileOffset += len;
+        }
 
-        //   ۴ٸ ̸  Ҵ
-        if (fileSize < context.fileSize) {
-            file.seekp(context.fileSize - 1);
-            file.put(0);
-            file.flush();
-            std::cout << "[FileTransfer] Pre-allocated file space to " << context.fileSize << " bytes" << std::endl;
+        // 3.  
+        if (context.packFileOffset == file.size) {
+            context.fileStream.close();
+            context.packEntrySent = false;
+            context.packIndex++;
         }
     }
 
-    //   ̵
-    uint64_t offset = static_cast<uint64_t>(chunk.chunkId) * context.chunkSize;
-    file.seekp(offset);
+    bool isLast = context.packIndex >= context.packFiles.size();
+    auto packet = CreatePackDataPacket(transferId, payload, isLast);
+    session->Send(packet);
 
-    std::cout << "[FileTransfer] Writing " << chunk.chunkSize << " bytes at offset " << offset << std::endl;
+    context.fileChecksum = Crc32c::Update(context.fileChecksum, payload.data(), payload.size());
+    context.bytesSent += payload.size();
+    context.chunksSent++;
 
-    //  
-    file.write(static_cast<const char*>(data), chunk.chunkSize);
+    GMetrics->Core().fileChunksSent->Inc();
+    GMetrics->Core().fileBytesSent->Inc(payload.size());
 
-    if (!file.good()) {
-        std::cerr << "[FileTransfer] Error: Failed to write data to file" << std::endl;
-        file.close();
-        return false;
+    if (isLast) {
+        LOG_INFO("Sent pack of transfer {}: {} file(s) in {} packet(s)", transferId, context.packFiles.size(), context.chunksSent);
+        std::vector<PackFile>().swap(context.packFiles);
+        if (!FinishFileSend(session, transferId, context))
+            return -1;
     }
 
-    file.flush();
-    file.close();
+    return static_cast<int32_t>(packet->WriteSize());
+}
 
-    //  Ȯ
-    std::ifstream checkFile(context.filePath, std::ios::binary);
-    if (checkFile.is_open()) {
-        checkFile.seekg(0, std::ios::end);
-        std::streampos fileSize = checkFile.tellg();
-        checkFile.close();
-        std::cout << "[FileTransfer] File size after write: " << fileSize << " bytes" << std::endl;
-    }
+void FileTransferManager::FailFileSend(uint32_t transferId, FileTransferContext& context)
+{
+    context.awaitingResponse = false;
+    context.awaitingComplete = false;
+    context.isCompleted = true;
+    context.scheduled = false;
+    context.fileStream.close();
 
-    //   Ʈ
-    context.chunksSent++;
-    context.bytesSent += chunk.chunkSize;
+    LOG_ERROR("[FileTransfer] File send failed: {}", context.filePath);
 
-    //  Ȳ 
-    double progressPct = static_cast<double>(context.bytesSent) * 100.0 / context.fileSize;
-    std::cout << "[FileTransfer] Progress: " << context.chunksSent << "/" << context.chunksTotal
-        << " chunks (" << std::fixed << std::setprecision(2) << progressPct << "%)" << std::endl;
+    if (_transferCompleteCallback)
+        _transferCompleteCallback(transferId, false, context.filePath);
+}
 
-    //  ûũ ޾Ҵ Ȯ
-    if (chunk.isLast || context.chunksSent >= context.chunksTotal) {
-        context.isCompleted = true;
+bool FileTransferManager::StartFileDownload(std::shared_ptr<Session> session, const std::string& filename, const std::string& targetDir)
+{
+    //  ڰ  ̸ ź (  丮   û  )
+    if (filename.empty() || filename.length() >= sizeof(DownloadRequest::filename) ||
+        fs::path(filename).filename().string() != filename)
+        return false;
 
-        //  ũ 
-        std::error_code ec;
-        uintmax_t actualSize = fs::file_size(context.filePath, ec);
-        if (ec) {
-            std::cerr << "[FileTransfer] Error checking final file size: " << ec.message() << std::endl;
-        }
-        else {
-            std::cout << "[FileTransfer] Final file size: " << actualSize << " bytes "
-                << "(expected: " << context.fileSize << " bytes)" << std::endl;
+    std::error_code ec;
+    fs::create_directories(targetDir, ec);
+    if (ec)
+        return false;
+
+    uint32_t transferId;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        transferId = _nextTransferId++;
+
+        DownloadContext& context = _downloadTransfers[transferId];
+        context.filePath = targetDir + "/" + filename;
+        context.partPath = context.filePath + ".part";
+        context.stream.open(context.partPath, std::ios::binary | std::ios::trunc);
+        if (!context.stream.is_open()) {
+            LOG_ERROR("[FileTransfer] Cannot create file: {}", context.partPath);
+            _downloadTransfers.erase(transferId);
+            return false;
         }
+    }
 
-        std::cout << "[FileTransfer] File transfer completed: " << context.filePath << std::endl;
+    LOG_INFO("[FileTransfer] Requesting download: {} (transfer {})", filename, transferId);
+    session->Send(CreateDownloadRequestPacket(transferId, filename));
+    return true;
+}
 
-        if (_transferCompleteCallback) {
-            std::cout << "[FileTransfer] Calling transfer complete callback" << std::endl;
-            _transferCompleteCallback(it->first, true, context.filePath);
-        }
+bool FileTransferManager::StartFileServe(std::shared_ptr<Session> session, const std::string& serveDir, const DownloadRequest& request)
+{
+    uint32_t transferId = request.transferId;
+
+    std::string filename(request.filename, strnlen(request.filename, sizeof(request.filename)));
+    std::string filePath = serveDir + "/" + filename;
+
+    // 1.  丮   Ȯ
+    FileCache::FileVersion version;
+    if (filename.empty() || fs::path(filename).filename().string() != filename || !FileCache::Stat(filePath, version)) {
+        LOG_WARN("[FileTransfer] Download rejected: {}", filename);
+        session->Send(CreateDownloadResponsePacket(transferId, false, 0));
+        return false;
     }
 
+    std::lock_guard<std::mutex> guard(_lock);
+
+    // 2. ٿε  ( ID  ̴ ٿε  û ü)
+    ServeContext& context = _serveTransfers[transferId];
+    context = ServeContext();
+    context.filePath = filePath;
+    context.version = version;
+
+    LOG_INFO("[FileTransfer] Serving {} ({} bytes, transfer {})", filePath, version.fileSize, transferId);
+    session->Send(CreateDownloadResponsePacket(transferId, true, version.fileSize));
+
+    // 3.  â ϴ ŭ ̽ ť  (  Ϸ  ̾)
+    if (std::find(_activeServes.begin(), _activeServes.end(), transferId) == _activeServes.end())
+        _activeServes.push_back(transferId);
+    PumpServes(session);
     return true;
 }
 
-// SendNextChunk Լ  ʿմϴ.
-bool FileTransferManager::SendNextChunk(std::shared_ptr<Session> session, uint32_t connectionId)
+void FileTransferManager::OnSendCompleted(std::shared_ptr<Session> session, int32_t len)
 {
     std::lock_guard<std::mutex> guard(_lock);
 
-    auto it = _transfers.find(connectionId);
-    if (it == _transfers.end()) {
-        // connectionId 1ε õ  (ù °  ɼ)
-        it = _transfers.find(1);
-        if (it == _transfers.end()) {
-            std::cerr << "Error: No file transfer found with ID " << connectionId << std::endl;
-            return false;
+    // ٸ Ŷ ۷ Բ Ƿ 0 Ʒδ  
+    _sendInFlight = std::max<int64_t>(0, _sendInFlight - len);
+    if (!_activeServes.empty())
+        PumpServes(session);
+
+    // ε   Ʒ    (Ϸ  带  ʵ)
+    if (!_activeSends.empty() && !_sendRoundScheduled && _sendInFlight <= SEND_LOW_WATERMARK)
+        PumpSends(session);
+}
+
+void FileTransferManager::PumpServes(std::shared_ptr<Session> session)
+{
+    // ٿε帶 ̽ ϳ  ־    â  ʵ 
+    while (_sendInFlight < SERVE_WINDOW && !_activeServes.empty())
+    {
+        uint32_t transferId = _activeServes.front();
+        _activeServes.pop_front();
+
+        auto it = _serveTransfers.find(transferId);
+        if (it == _serveTransfers.end())
+            continue;
+
+        int32_t sent = ServeNextSlice(session, transferId, it->second);
+        if (sent > 0) {
+            _sendInFlight += sent;
+            _activeServes.push_back(transferId);
+        }
+        else {
+            // Ϸ Ǵ  (Ϸ Ŷ ̹ )
+            _serveTransfers.erase(it);
         }
     }
+}
 
-    FileTransferContext& context = it->second;
-
-    if (context.isCompleted) {
-        std::cout << "File transfer already completed" << std::endl;
-        return true;
+int32_t FileTransferManager::ServeNextSlice(std::shared_ptr<Session> session, uint32_t transferId, ServeContext& context)
+{
+    // 1.    üũ Բ Ϸ 
+    if (context.offset >= context.version.fileSize) {
+        session->Send(CreateDownloadCompletePacket(transferId, true, context.fileChecksum));
+        LOG_INFO("[FileTransfer] Served {} (cache hits {}, misses {})", context.filePath, GFileCache->Hits(), GFileCache->Misses());
+        return 0;
     }
 
-    if (!context.fileStream.is_open()) {
-        //   ٽ 
-        context.fileStream.open(context.filePath, std::ios::binary);
-        if (!context.fileStream.is_open()) {
-            std::cerr << "Error: Cannot open file for reading: " << context.filePath << std::endl;
-            return false;
+    // 2.  ׸Ʈ  ĳÿ  (ĳÿ  ũ  )
+    if (context.segment == nullptr) {
+        uint32_t segmentIndex = static_cast<uint32_t>(context.offset / FileCache::SEGMENT_SIZE);
+        context.segment = GFileCache->Acquire(context.filePath, context.version, segmentIndex);
+        if (context.segment == nullptr) {
+            LOG_ERROR("[FileTransfer] Failed to read {} at {}", context.filePath, context.offset);
+            session->Send(CreateDownloadCompletePacket(transferId, false, 0));
+            return -1;
         }
+
+        context.sliceIndex = 0;
+        context.fileChecksum = Crc32c::Combine(context.fileChecksum, context.segment->Checksum(), context.segment->Size());
     }
 
-    //  ġ ̵
-    context.fileStream.seekg(context.bytesSent);
+    // 3. Ǹ ٸ    ʹ  ̽ ״ ť 
+    SendBufferRef slice = context.segment->Slices()[context.sliceIndex++];
+    SendBufferRef header = CreateDownloadDataHeader(transferId, context.offset, slice->WriteSize());
+    session->Send(header, slice);
+    context.offset += slice->WriteSize();
 
-    //   
-    uint64_t remainingBytes = context.fileSize - context.bytesSent;
-    if (remainingBytes == 0) {
-        //  Ϸ
-        context.isCompleted = true;
-        context.fileStream.close();
+    GMetrics->Core().fileChunksSent->Inc();
+    GMetrics->Core().fileBytesSent->Inc(slice->WriteSize());
 
-        std::cout << "File transfer completed (no more bytes to send)" << std::endl;
+    // ׸Ʈ     (ĳÿ з ޸𸮰 ٷ ȯǵ)
+    if (context.sliceIndex >= context.segment->Slices().size())
+        context.segment.reset();
 
-        if (_transferCompleteCallback)
-            _transferCompleteCallback(connectionId, true, context.filePath);
+    return static_cast<int32_t>(header->WriteSize() + slice->WriteSize());
+}
 
-        return true;
+bool FileTransferManager::ProcessDownloadResponse(const DownloadResponse& response)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    auto it = _downloadTransfers.find(response.transferId);
+    if (it == _downloadTransfers.end()) {
+        LOG_ERROR("[FileTransfer] No active download with ID {}", response.transferId);
+        return false;
     }
 
-    // ̹  ûũ ũ 
-    // SendBuffer ִ ũ⸦ Ͽ ûũ ũ 
-    const uint32_t maxChunkSize = SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(FileChunk) - 16; // ߰  
-    uint32_t currentChunkSize = static_cast<uint32_t>(std::min<uint64_t>(remainingBytes, context.chunkSize));
-    currentChunkSize = std::min(currentChunkSize, maxChunkSize);
+    DownloadContext& context = it->second;
+    if (!response.accepted) {
+        LOG_WARN("[FileTransfer] Download rejected by server: {}", context.filePath);
+        FinishDownload(it->first, context, false);
+        _downloadTransfers.erase(it);
+        return false;
+    }
 
-    bool isLastChunk = (remainingBytes <= currentChunkSize);
+    context.accepted = true;
+    context.fileSize = response.fileSize;
+    LOG_INFO("[FileTransfer] Downloading {} ({} bytes)", context.filePath, context.fileSize);
+    return true;
+}
 
-    // Ͽ  б
-    std::vector<char> buffer(currentChunkSize);
-    context.fileStream.read(buffer.data(), currentChunkSize);
+bool FileTransferManager::ProcessDownloadData(const DownloadData& data, const BYTE* payload, uint32_t size)
+{
+    std::lock_guard<std::mutex> guard(_lock);
 
-    if (!context.fileStream.good() && !context.fileStream.eof()) {
-        std::cerr << "Error: Failed to read data from file" << std::endl;
+    auto it = _downloadTransfers.find(data.transferId);
+    if (it == _downloadTransfers.end() || !it->second.accepted)
         return false;
-    }
 
-    // ûũ Ŷ   
-    auto packet = CreateFileChunkPacket(buffer.data(), currentChunkSize, context.chunksSent, isLastChunk);
-    if (!packet) {
-        std::cerr << "Error: Failed to create file chunk packet" << std::endl;
+    DownloadContext& context = it->second;
+
+    // TCP   Ƿ   ƴϸ ߸ Ʈ
+    if (data.offset != context.received || context.received + size > context.fileSize) {
+        LOG_ERROR("[FileTransfer] Unexpected download data at {}", data.offset);
+        FinishDownload(it->first, context, false);
+        _downloadTransfers.erase(it);
         return false;
     }
 
-    session->Send(packet);
+    {
+        TRACE_SCOPE(FileWrite, 0, size);
+        context.stream.write(reinterpret_cast<const char*>(payload), size);
+    }
+    context.checksum = Crc32c::Update(context.checksum, payload, size);
+    context.received += size;
 
-    std::cout << "Sent chunk " << context.chunksSent
-        << " (" << currentChunkSize << " bytes, "
-        << (isLastChunk ? "last chunk" : "more to come") << ")" << std::endl;
+    GMetrics->Core().fileChunksReceived->Inc();
+    GMetrics->Core().fileBytesReceived->Inc(size);
+    return true;
+}
 
-    //  Ʈ
-    context.bytesSent += currentChunkSize;
-    context.chunksSent++;
+bool FileTransferManager::ProcessDownloadComplete(const DownloadComplete& complete)
+{
+    std::lock_guard<std::mutex> guard(_lock);
 
-    //  ûũ ߴ Ȯ
-    if (isLastChunk) {
-        context.isCompleted = true;
-        context.fileStream.close();
+    auto it = _downloadTransfers.find(complete.transferId);
+    if (it == _downloadTransfers.end())
+        return false;
 
-        std::cout << "File transfer completed (last chunk sent)" << std::endl;
+    DownloadContext& context = it->second;
+    bool success = complete.success && context.stream.good() &&
+        context.received == context.fileSize && context.checksum == complete.fileChecksum;
 
-        if (_transferCompleteCallback)
-            _transferCompleteCallback(connectionId, true, context.filePath);
+    if (!success && complete.success) {
+        LOG_WARN("[FileTransfer] Download checksum mismatch: {:x} (expected {:x})", context.checksum, complete.fileChecksum);
+    }
+
+    FinishDownload(it->first, context, success);
+    _downloadTransfers.erase(it);
+    return success;
+}
+
+void FileTransferManager::FinishDownload(uint32_t transferId, DownloadContext& context, bool success)
+{
+    context.stream.close();
+
+    std::error_code ec;
+    if (success) {
+        //     ü
+        if (fs::exists(context.filePath, ec))
+            fs::rename(context.filePath, context.filePath + ".bak", ec);
+
+        ec.clear();
+        fs::rename(context.partPath, context.filePath, ec);
+        success = !ec;
+    }
+
+    if (success) {
+        LOG_INFO("[FileTransfer] Download completed: {}", context.filePath);
     }
     else {
-        //  ûũ   (ª  )
-        std::thread([this, session, connectionId]() {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            SendNextChunk(session, connectionId);
-            }).detach();
+        fs::remove(context.partPath, ec);
+        LOG_ERROR("[FileTransfer] Download failed: {}", context.filePath);
     }
 
-    return true;
+    if (_transferCompleteCallback)
+        _transferCompleteCallback(transferId, success, context.filePath);
 }
 
-void FileTransferManager::CancelTransfer(uint32_t connectionId)
+void FileTransferManager::CancelTransfer(uint32_t transferId)
 {
     std::lock_guard<std::mutex> guard(_lock);
 
-    auto it = _transfers.find(connectionId);
-    if (it != _transfers.end())
+    // ⿭  ID  忡 ǳʶ
+    auto it = _sendTransfers.find(transferId);
+    if (it != _sendTransfers.end())
     {
         if (it->second.fileStream.is_open())
             it->second.fileStream.close();
 
-        _transfers.erase(it);
+        _sendTransfers.erase(it);
     }
 }
 
@@ -403,65 +1979,183 @@ void FileTransferManager::SetTransferCompleteCallback(TransferCompleteCallback c
     _transferCompleteCallback = callback;
 }
 
-std::shared_ptr<SendBuffer> FileTransferManager::CreateFileRequestPacket(const std::string& filePath, uint64_t fileSize, uint32_t chunkSize)
+std::shared_ptr<SendBuffer> FileTransferManager::CreateFileRequestPacket(uint32_t transferId, const std::string& filePath, uint64_t fileSize, uint32_t chunkSize, uint64_t lastWriteTime)
+{
+    PacketWriter<PKT_FILE_REQUEST> writer;
+    if (!writer.IsValid())
+        return nullptr;
+
+    writer->transferId = transferId;
+    PacketCopyString(writer->filename, fs::path(filePath).filename().string());  //  ̸
+    writer->fileSize = fileSize;
+    writer->chunksTotal = static_cast<uint32_t>((fileSize + chunkSize - 1) / chunkSize);
+    writer->chunkSize = chunkSize;
+    writer->lastWriteTime = lastWriteTime;
+    writer->flags = FILE_FLAG_DELTA;
+    return writer.Finish();
+}
+
+std::shared_ptr<SendBuffer> FileTransferManager::CreateFileResponsePacket(uint32_t transferId, bool accepted, const std::vector<ChunkRange>& ranges, bool delta, uint32_t tailChecksum)
 {
-    //  ̸ 
-    std::string filename = fs::path(filePath).filename().string();
+    //   MAX_RESPONSE_RANGES ,  迭  κ ڿ 
+    uint32_t rangeCount = static_cast<uint32_t>(std::min<size_t>(ranges.size(), MAX_RESPONSE_RANGES));
+    PacketWriter<PKT_FILE_RESPONSE> writer(rangeCount * sizeof(ChunkRange));
+    if (!writer.IsValid())
+        return nullptr;
+
+    writer->transferId = transferId;
+    writer->accepted = accepted ? 1 : 0;
+    writer->delta = delta ? 1 : 0;
+    writer->rangeCount = rangeCount;
+    writer->tailChecksum = tailChecksum;
+    if (rangeCount > 0)
+        memcpy(writer.Tail(), ranges.data(), rangeCount * sizeof(ChunkRange));
+    return writer.Finish();
+}
 
-    // Ŷ ũ 
-    uint16_t packetSize = sizeof(FileHeader);
+std::shared_ptr<SendBuffer> FileTransferManager::CreateFileSignaturePacket(uint32_t transferId, uint32_t blockSize, uint32_t blocksTotal, uint32_t firstBlock, const std::vector<BlockSignature>& signatures)
+{
+    //   MAX_SIGNATURES_PER_PACKET 
+    uint32_t count = static_cast<uint32_t>(signatures.size());
+    PacketWriter<PKT_FILE_SIGNATURE> writer(count * sizeof(BlockSignature));
+    if (!writer.IsValid())
+        return nullptr;
 
-    // SendBuffer 
-    auto sendBuffer = GSendBufferManager->Open(packetSize);
+    writer->transferId = transferId;
+    writer->blockSize = blockSize;
+    writer->blocksTotal = blocksTotal;
+    writer->firstBlock = firstBlock;
+    writer->count = count;
+    if (count > 0)
+        memcpy(writer.Tail(), signatures.data(), count * sizeof(BlockSignature));
+    return writer.Finish();
+}
 
-    // Ŷ 
-    FileHeader* header = reinterpret_cast<FileHeader*>(sendBuffer->Buffer());
-    header->size = packetSize;
-    header->id = static_cast<uint16_t>(FileTransferPacketId::FileTransferRequest);
+std::shared_ptr<SendBuffer> FileTransferManager::CreateFileDeltaPacket(uint32_t transferId, const std::vector<BYTE>& ops, uint32_t opCount, bool isLast)
+{
+    //  ũ MAX_DELTA_PAYLOAD 
+    PacketWriter<PKT_FILE_DELTA> writer(static_cast<uint32_t>(ops.size()));
+    if (!writer.IsValid())
+        return nullptr;
 
-    strncpy_s(header->filename, filename.c_str(), filename.length());
-    header->filename[filename.length()] = '\0';
+    writer->transferId = transferId;
+    writer->opCount = opCount;
+    writer->isLast = isLast ? 1 : 0;
+    if (!ops.empty())
+        memcpy(writer.Tail(), ops.data(), ops.size());
+    return writer.Finish();
+}
 
-    header->fileSize = fileSize;
-    header->chunksTotal = static_cast<uint32_t>((fileSize + chunkSize - 1) / chunkSize);
+std::shared_ptr<SendBuffer> FileTransferManager::CreatePackRequestPacket(uint32_t transferId, const std::string& dirname, uint32_t fileCount, uint64_t totalSize)
+{
+    PacketWriter<PKT_PACK_REQUEST> writer;
+    if (!writer.IsValid())
+        return nullptr;
 
-    sendBuffer->Close(packetSize);
-    return sendBuffer;
+    writer->transferId = transferId;
+    writer->fileCount = fileCount;
+    writer->totalSize = totalSize;
+    PacketCopyString(writer->dirname, dirname);
+    return writer.Finish();
 }
 
-std::shared_ptr<SendBuffer> FileTransferManager::CreateFileChunkPacket(const void* data, uint32_t chunkSize, uint32_t chunkId, bool isLast)
+std::shared_ptr<SendBuffer> FileTransferManager::CreatePackDataPacket(uint32_t transferId, const std::vector<char>& payload, bool isLast)
 {
-    // Ŷ ũ 
-    uint16_t packetSize = sizeof(FileChunk) + chunkSize;
+    // Ʈ ũ MAX_PACK_PAYLOAD 
+    PacketWriter<PKT_PACK_DATA> writer(static_cast<uint32_t>(payload.size()));
+    if (!writer.IsValid())
+        return nullptr;
 
+    writer->transferId = transferId;
+    writer->isLast = isLast ? 1 : 0;
+    if (!payload.empty())
+        memcpy(writer.Tail(), payload.data(), payload.size());
+    return writer.Finish();
+}
+
+std::shared_ptr<SendBuffer> FileTransferManager::CreateFileChunkPacket(uint32_t transferId, const void* data, uint32_t chunkSize, uint32_t chunkId, uint32_t checksum, bool isLast)
+{
     // SendBuffer ִ ũ Ȯ (SendBufferChunk::SEND_BUFFER_CHUNK_SIZE ۾ƾ )
-    if (packetSize > SendBufferChunk::SEND_BUFFER_CHUNK_SIZE) {
-        std::cerr << "Error: Chunk size too large for SendBuffer. Max allowed: "
-            << (SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(FileChunk))
-            << ", Requested: " << chunkSize << std::endl;
+    if (sizeof(FileChunk) + static_cast<uint64_t>(chunkSize) > SendBufferChunk::SEND_BUFFER_CHUNK_SIZE) {
+        LOG_ERROR("Chunk size too large for SendBuffer. Max allowed: {}, Requested: {}",
+            SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(FileChunk), chunkSize);
         return nullptr;
     }
 
-    // SendBuffer 
-    auto sendBuffer = GSendBufferManager->Open(packetSize);
-    if (!sendBuffer) {
-        std::cerr << "Error: Failed to allocate SendBuffer for file chunk" << std::endl;
+    PacketWriter<PKT_FILE_DATA> writer(chunkSize);
+    if (!writer.IsValid()) {
+        LOG_ERROR("Failed to allocate SendBuffer for file chunk");
         return nullptr;
     }
 
-    // Ŷ 
-    FileChunk* chunk = reinterpret_cast<FileChunk*>(sendBuffer->Buffer());
-    chunk->size = packetSize;
-    chunk->id = static_cast<uint16_t>(FileTransferPacketId::FileDataChunk);
-    chunk->chunkId = chunkId;
-    chunk->chunkSize = chunkSize;
-    chunk->isLast = isLast ? 1 : 0;
+    writer->transferId = transferId;
+    writer->chunkId = chunkId;
+    writer->chunkSize = chunkSize;
+    writer->checksum = checksum;
+    writer->isLast = isLast ? 1 : 0;
+    memcpy(writer.Tail(), data, chunkSize);
+    return writer.Finish();
+}
+
+std::shared_ptr<SendBuffer> FileTransferManager::CreateFileCompletePacket(uint32_t transferId, bool isReceiver, bool success, uint32_t fileChecksum)
+{
+    PacketWriter<PKT_FILE_COMPLETE> writer;
+    if (!writer.IsValid())
+        return nullptr;
+
+    writer->transferId = transferId;
+    writer->fileChecksum = fileChecksum;
+    writer->isReceiver = isReceiver ? 1 : 0;
+    writer->success = success ? 1 : 0;
+    return writer.Finish();
+}
+
+std::shared_ptr<SendBuffer> FileTransferManager::CreateDownloadRequestPacket(uint32_t transferId, const std::string& filename)
+{
+    PacketWriter<PKT_DOWNLOAD_REQUEST> writer;
+    if (!writer.IsValid())
+        return nullptr;
+
+    writer->transferId = transferId;
+    PacketCopyString(writer->filename, filename);
+    return writer.Finish();
+}
+
+std::shared_ptr<SendBuffer> FileTransferManager::CreateDownloadResponsePacket(uint32_t transferId, bool accepted, uint64_t fileSize)
+{
+    PacketWriter<PKT_DOWNLOAD_RESPONSE> writer;
+    if (!writer.IsValid())
+        return nullptr;
+
+    writer->transferId = transferId;
+    writer->accepted = accepted ? 1 : 0;
+    writer->fileSize = fileSize;
+    return writer.Finish();
+}
+
+std::shared_ptr<SendBuffer> FileTransferManager::CreateDownloadDataHeader(uint32_t transferId, uint64_t offset, uint32_t size)
+{
+    //   (Ŷ ũ⿡ ڿ ٴ ̽ ũ )
+    PacketWriter<PKT_DOWNLOAD_DATA> writer;
+    if (!writer.IsValid())
+        return nullptr;
+
+    writer->size = static_cast<uint16_t>(sizeof(DownloadData) + size);
+    writer->transferId = transferId;
+    writer->offset = offset;
+    return writer.Finish();
+}
 
-    //  
-    memcpy(chunk + 1, data, chunkSize);
+std::shared_ptr<SendBuffer> FileTransferManager::CreateDownloadCompletePacket(uint32_t transferId, bool success, uint32_t fileChecksum)
+{
+    PacketWriter<PKT_DOWNLOAD_COMPLETE> writer;
+    if (!writer.IsValid())
+        return nullptr;
 
-    sendBuffer->Close(packetSize);
-    return sendBuffer;
+    writer->transferId = transferId;
+    writer->fileChecksum = fileChecksum;
+    writer->success = success ? 1 : 0;
+    return writer.Finish();
 }
 
 /*----------------
@@ -482,95 +2176,184 @@ void FilePacketSession::SetFileReceiveDirectory(const std::string& dir)
         fs::create_directories(dir);
 }
 
+const FilePacketSession::Dispatcher& FilePacketSession::GetDispatcher()
+{
+    static const Dispatcher SDispatcher = []()
+    {
+        Dispatcher dispatcher;
+        dispatcher.Register<PKT_FILE_REQUEST, &FilePacketSession::HandleFileRequest>();
+        dispatcher.Register<PKT_FILE_RESPONSE, &FilePacketSession::HandleFileResponse>();
+        dispatcher.Register<PKT_FILE_DATA, &FilePacketSession::HandleFileChunk>();
+        dispatcher.Register<PKT_FILE_COMPLETE, &FilePacketSession::HandleFileComplete>();
+        dispatcher.Register<PKT_FILE_ERROR, &FilePacketSession::HandleFileError>();
+        dispatcher.Register<PKT_FILE_SIGNATURE, &FilePacketSession::HandleFileSignature>();
+        dispatcher.Register<PKT_FILE_DELTA, &FilePacketSession::HandleFileDelta>();
+        dispatcher.Register<PKT_PACK_REQUEST, &FilePacketSession::HandlePackRequest>();
+        dispatcher.Register<PKT_PACK_DATA, &FilePacketSession::HandlePackData>();
+        dispatcher.Register<PKT_DOWNLOAD_REQUEST, &FilePacketSession::HandleDownloadRequest>();
+        dispatcher.Register<PKT_DOWNLOAD_RESPONSE, &FilePacketSession::HandleDownloadResponse>();
+        dispatcher.Register<PKT_DOWNLOAD_DATA, &FilePacketSession::HandleDownloadData>();
+        dispatcher.Register<PKT_DOWNLOAD_COMPLETE, &FilePacketSession::HandleDownloadComplete>();
+        return dispatcher;
+    }();
+    return SDispatcher;
+}
+
 void FilePacketSession::OnRecvPacket(BYTE* buffer, int32_t len)
 {
     PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
-    uint16_t packetId = header->id;
+    LOG_DEBUG("[FilePacketSession] Received packet: ID={}, Size={}", header->id, header->size);
+
+    //  κ ũ ID ó Ȯϰ, ڿ  迭 ũ ڵ鷯 Ȯ
+    switch (GetDispatcher().Dispatch(*this, buffer, len))
+    {
+    case Dispatcher::Result::Unknown:
+        LOG_WARN("[FilePacketSession] Unknown packet type: {}", header->id);
+        break;
+    case Dispatcher::Result::Invalid:
+        LOG_ERROR("[FilePacketSession] Invalid {} packet ({} bytes)", FindPacketInfo(header->id)->name, len);
+        break;
+    default:
+        break;
+    }
+}
+
+void FilePacketSession::HandleFileRequest(const PacketReader<PKT_FILE_REQUEST>& packet)
+{
+    LOG_INFO("[FilePacketSession] File request received: {} (receive directory {})", PacketString(packet->filename), _fileReceiveDirectory);
 
-    // :  Ŷ  
-    std::cout << "[FilePacketSession] Received packet: ID=" << packetId
-        << ", Size=" << header->size << std::endl;
+    //    ( ûũ   )
+    bool result = _fileTransferManager->StartFileReceive(GetSessionRef(), _fileReceiveDirectory, packet.Get());
 
-    // FileTransferPacketId  ( ĳ)
-    if (packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferRequest)) {
-        FileHeader* fileHeader = reinterpret_cast<FileHeader*>(buffer);
-        std::cout << "[FilePacketSession] File transfer request: " << fileHeader->filename << std::endl;
-        HandleFileRequest(buffer);
+    if (result) {
+        LOG_INFO("[FilePacketSession] File receive started successfully");
     }
-    else if (packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferResponse)) {
-        std::cout << "[FilePacketSession] File transfer response" << std::endl;
-        HandleFileResponse(buffer);
+    else {
+        LOG_ERROR("[FilePacketSession] Failed to start file receive");
     }
-    else if (packetId == static_cast<uint16_t>(FileTransferPacketId::FileDataChunk)) {
-        FileChunk* chunk = reinterpret_cast<FileChunk*>(buffer);
-        std::cout << "[FilePacketSession] File data chunk: ID=" << chunk->chunkId << std::endl;
-        HandleFileChunk(buffer);
+}
+
+void FilePacketSession::HandleFileResponse(const PacketReader<PKT_FILE_RESPONSE>& packet)
+{
+    //  迭 Ŷ ȿ  ִ Ȯ
+    if (packet.TailSize() < static_cast<uint64_t>(packet->rangeCount) * sizeof(ChunkRange)) {
+        LOG_ERROR("[FilePacketSession] Invalid file response size: {}", packet.Size());
+        return;
     }
-    else if (packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferComplete)) {
-        std::cout << "[FilePacketSession] File transfer complete" << std::endl;
-        HandleFileComplete(buffer);
+
+    const ChunkRange* ranges = reinterpret_cast<const ChunkRange*>(packet.Tail());
+
+    LOG_INFO("[FilePacketSession] File response: {}, {} range(s) requested", (packet->accepted ? "accepted" : "rejected"), packet->rangeCount);
+
+    // û   
+    if (!_fileTransferManager->ProcessFileResponse(GetSessionRef(), packet.Get(), ranges)) {
+        LOG_ERROR("[FilePacketSession] Failed to process file response");
     }
-    else if (packetId == static_cast<uint16_t>(FileTransferPacketId::FileTransferError)) {
-        std::cout << "[FilePacketSession] File transfer error" << std::endl;
-        //  ó
+}
+
+void FilePacketSession::HandleFileChunk(const PacketReader<PKT_FILE_DATA>& packet)
+{
+    // ʹ  ٷ ڿ ġ
+    if (packet.TailSize() < packet->chunkSize) {
+        LOG_ERROR("[FilePacketSession] Invalid file chunk size: {}", packet.Size());
+        return;
     }
-    else {
-        std::cout << "[FilePacketSession] Unknown packet type: " << packetId << std::endl;
+
+    LOG_DEBUG("[FilePacketSession] Processing file chunk: ID={}, Size={}, IsLast={}",
+        packet->chunkId, packet->chunkSize, (packet->isLast ? "Yes" : "No"));
+
+    bool result = _fileTransferManager->ProcessFileChunk(GetSessionRef(), packet.Get(), packet.Tail());
+
+    if (!result) {
+        LOG_ERROR("[FilePacketSession] Failed to process file chunk");
     }
-}
 
-//==========================================
-// FilePacketSession.cpp HandleFileRequest Լ 
-//==========================================
+    //  ûũ (Ϸ  üũ   ó)
+    if (packet->isLast) {
+        LOG_INFO("[FilePacketSession] Last chunk received");
+    }
+}
 
-void FilePacketSession::HandleFileRequest(BYTE* buffer)
+void FilePacketSession::HandleFileSignature(const PacketReader<PKT_FILE_SIGNATURE>& packet)
 {
-    FileHeader* header = reinterpret_cast<FileHeader*>(buffer);
-
-    std::cout << "\n[FilePacketSession] File request received: " << header->filename << std::endl;
-    std::cout << "[FilePacketSession] File size: " << header->fileSize << " bytes" << std::endl;
-    std::cout << "[FilePacketSession] Total chunks: " << header->chunksTotal << std::endl;
-    std::cout << "[FilePacketSession] Receive directory: " << _fileReceiveDirectory << std::endl;
+    //  迭 Ŷ ȿ  ִ Ȯ
+    if (packet.TailSize() < static_cast<uint64_t>(packet->count) * sizeof(BlockSignature)) {
+        LOG_ERROR("[FilePacketSession] Invalid file signature size: {}", packet.Size());
+        return;
+    }
 
-    //   
-    bool result = _fileTransferManager->StartFileReceive(_fileReceiveDirectory, *header);
+    const BlockSignature* signatures = reinterpret_cast<const BlockSignature*>(packet.Tail());
 
-    if (result) {
-        std::cout << "[FilePacketSession] File receive started successfully" << std::endl;
+    //     
+    if (!_fileTransferManager->ProcessFileSignature(packet.Get(), signatures)) {
+        LOG_ERROR("[FilePacketSession] Failed to process file signature");
     }
-    else {
-        std::cerr << "[FilePacketSession] Failed to start file receive" << std::endl;
+}
+
+void FilePacketSession::HandleFileDelta(const PacketReader<PKT_FILE_DELTA>& packet)
+{
+    //   ٷ ڿ ġ
+    if (!_fileTransferManager->ProcessFileDelta(GetSessionRef(), packet.Get(), packet.Tail(), packet.TailSize())) {
+        LOG_ERROR("[FilePacketSession] Failed to process file delta");
     }
 }
 
+void FilePacketSession::HandlePackRequest(const PacketReader<PKT_PACK_REQUEST>& packet)
+{
+    if (!_fileTransferManager->StartPackReceive(GetSessionRef(), _fileReceiveDirectory, packet.Get())) {
+        LOG_ERROR("[FilePacketSession] Failed to start pack receive");
+    }
+}
 
-void FilePacketSession::HandleFileResponse(BYTE* buffer)
+void FilePacketSession::HandlePackData(const PacketReader<PKT_PACK_DATA>& packet)
 {
-    // TODO:   û   ó
+    // Ʈ  ٷ ڿ ġ
+    if (!_fileTransferManager->ProcessPackData(GetSessionRef(), packet.Get(), packet.Tail(), packet.TailSize())) {
+        LOG_ERROR("[FilePacketSession] Failed to process pack data");
+    }
 }
 
-void FilePacketSession::HandleFileChunk(BYTE* buffer)
+void FilePacketSession::HandleFileComplete(const PacketReader<PKT_FILE_COMPLETE>& packet)
 {
-    FileChunk* chunk = reinterpret_cast<FileChunk*>(buffer);
-    void* data = chunk + 1; // ʹ  ٷ ڿ ġ
+    // ۽   üũ̸   ,     Ϸ
+    if (!_fileTransferManager->ProcessFileComplete(GetSessionRef(), packet.Get())) {
+        LOG_ERROR("[FilePacketSession] Failed to process file complete");
+    }
+}
 
-    std::cout << "[FilePacketSession] Processing file chunk: ID=" << chunk->chunkId
-        << ", Size=" << chunk->chunkSize
-        << ", IsLast=" << (chunk->isLast ? "Yes" : "No") << std::endl;
+void FilePacketSession::HandleFileError(const PacketReader<PKT_FILE_ERROR>&)
+{
+    LOG_DEBUG("[FilePacketSession] File transfer error");
+    //  ó
+}
 
-    bool result = _fileTransferManager->ProcessFileChunk(*chunk, data);
+void FilePacketSession::OnSend(int32_t len)
+{
+    // ε峪 ٿε  ̸ ۵ ŭ  Ŷ ť 
+    _fileTransferManager->OnSendCompleted(GetSessionRef(), len);
+}
 
-    if (!result) {
-        std::cerr << "[FilePacketSession] Failed to process file chunk" << std::endl;
+void FilePacketSession::HandleDownloadRequest(const PacketReader<PKT_DOWNLOAD_REQUEST>& packet)
+{
+    if (!_fileTransferManager->StartFileServe(GetSessionRef(), _fileServeDirectory, packet.Get())) {
+        LOG_ERROR("[FilePacketSession] Failed to start file download");
     }
+}
+
+void FilePacketSession::HandleDownloadResponse(const PacketReader<PKT_DOWNLOAD_RESPONSE>& packet)
+{
+    _fileTransferManager->ProcessDownloadResponse(packet.Get());
+}
 
-    //  ûũ Ϸ ó
-    if (chunk->isLast) {
-        std::cout << "[FilePacketSession] Last chunk received, file transfer complete" << std::endl;
+void FilePacketSession::HandleDownloadData(const PacketReader<PKT_DOWNLOAD_DATA>& packet)
+{
+    // ʹ  ٷ ڿ ġ
+    if (!_fileTransferManager->ProcessDownloadData(packet.Get(), packet.Tail(), packet.TailSize())) {
+        LOG_ERROR("[FilePacketSession] Failed to process download data");
     }
 }
 
-void FilePacketSession::HandleFileComplete(BYTE* buffer)
+void FilePacketSession::HandleDownloadComplete(const PacketReader<PKT_DOWNLOAD_COMPLETE>& packet)
 {
-    // TODO:   Ϸ ó
-}
\ No newline at end of file
+    _fileTransferManager->ProcessDownloadComplete(packet.Get());
+}
@@ -1,41 +1,104 @@
 #pragma once
 #include "Session.h"
 #include "SendBuffer.h"
+#include "Protocol.h"
+#include "DeltaSync.h"
+#include "FileCache.h"
 #include <fstream>
 #include <filesystem>
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
 
 namespace fs = std::filesystem;
 
+//   Ŷ ü(FileHeader, FileChunk ) FileTransferFlags Protocol.idl  (Protocol.h)
+
 /*----------------
-    FileHeader
+    ChunkBitmap
 -----------------*/
-struct FileHeader : public PacketHeader
+//    (<>.bitmap) Ǵ ûũ Ϸ Ʈ
+//  ܵ  ־ û    ٽ   
+class ChunkBitmap
 {
-    char filename[256];  // ִ  ̸ 
-    uint64_t fileSize;   // ü  ũ
-    uint32_t chunksTotal; //  ûũ 
+public:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t chunkSize;
+        uint64_t fileSize;
+        uint64_t lastWriteTime;
+        uint32_t chunksTotal;
+        uint32_t version;
+    };
+
+    enum { MAGIC = 0x4D425446 }; // "FTBM"
+    enum { VERSION = 1 };        // Ʈ ڿ ûũ CRC32C 迭 
+
+    //  Ʈ   ̸ ҷ, ƴϸ  
+    bool Open(const std::string& path, const FileHeader& header, bool& resumed);
+    void Close();
+    void Remove();
+
+    //  ûũ  (üũ    Ʈ )
+    bool Set(uint32_t chunkId, uint32_t checksum);
+    bool Test(uint32_t chunkId) const;
+    void Reset();
+    bool IsComplete() const { return _chunksDone >= _chunksTotal; }
+    uint32_t ChunksDone() const { return _chunksDone; }
+
+    //    ûũ   (maxRanges   ϳ ħ)
+    //  ̿ ̹  ûũ  üũ  (skippedChecksum),   ڴ tailChecksum ˷
+    std::vector<ChunkRange> MissingRanges(uint32_t maxRanges, uint32_t& tailChecksum) const;
+
+    //  ûũ üũ  ģ  ü üũ ( ٽ  )
+    uint32_t FileChecksum(uint64_t fileSize, uint32_t chunkSize) const;
+
+private:
+    bool Create(const FileHeader& header);
+    uint64_t ChecksumOffset(uint32_t chunkId) const { return sizeof(Header) + _bits.size() + chunkId * sizeof(uint32_t); }
+    // [begin, end) ûũ  üũ  ģ 
+    uint32_t RangeChecksum(uint32_t begin, uint32_t end) const;
+
+    std::string _path;
+    std::fstream _stream;
+    std::vector<uint8_t> _bits;
+    std::vector<uint32_t> _checksums;
+    uint32_t _chunksTotal = 0;
+    uint32_t _chunksDone = 0;
+    uint32_t _chunkSize = 0;
+    uint64_t _fileSize = 0;
 };
 
 /*----------------
-    FileChunk
+    PackWriter
 -----------------*/
-struct FileChunk : public PacketHeader
+//  Ʈ Ϸ Ǯ    
+//    ϳ  ,    丮 ٽ Ȯ 
+class PackWriter
 {
-    uint32_t chunkId;    // ûũ ȣ
-    uint32_t chunkSize;  // ûũ ũ
-    uint8_t isLast;      //  ûũ 
-    // ʹ  ü ڿ 
-};
+public:
+    enum { BUFFER_SIZE = 1024 * 1024 };
 
-enum class FileTransferPacketId : uint16_t
-{
-    FileTransferRequest = 100,
-    FileTransferResponse = 101,
-    FileDataChunk = 102,
-    FileTransferComplete = 103,
-    FileTransferError = 104
+    bool Open(const fs::path& root);
+    void Close();
+
+    bool BeginFile(const std::string& relativePath);
+    bool Write(const char* data, size_t len);
+    bool EndFile();
+
+    uint32_t FilesWritten() const { return _filesWritten; }
+
+private:
+    bool Flush();
+    bool CreateParentDirectories(const fs::path& path);
 
+    fs::path _root;
+    std::ofstream _file;
+    std::vector<char> _buffer;
+    size_t _used = 0;
+    std::unordered_set<std::string> _createdDirs;
+    uint32_t _filesWritten = 0;
 };
 
 /*----------------
@@ -49,6 +112,44 @@ public:
     // ⼭ ϰ 4KB 
     static const uint32_t DEFAULT_CHUNK_SIZE = 4 * 1024;
 
+    //  Ŷ ϳ   ִ ִ  
+    static const uint32_t MAX_RESPONSE_RANGES = 4096;
+
+    // üũ ġ ٽ û  ִ ִ Ƚ (ʰ   )
+    static const uint32_t MAX_CHUNK_RETRIES = 64;
+    static const uint32_t MAX_VERIFY_RETRIES = 1;
+
+    //  Ŷ ϳ   ִ ִ  
+    static const uint32_t MAX_SIGNATURES_PER_PACKET =
+        (SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(FileSignature) - 16) / sizeof(BlockSignature);
+    // Ÿ Ŷ ϳ  ִ  ũ
+    static const uint32_t MAX_DELTA_PAYLOAD = SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(FileDelta) - 16;
+
+    // ۽ ٷ (deficit round robin): 帶   ؽƮ ϴ ۷
+    // ûũ ũⰡ ޶ ϸ  뿪  Ƿ   ū  ڿ и 
+    static const int32_t SEND_QUANTUM = 16 * 1024;
+    //   ť ְ     ũⰡ SEND_WINDOW   ̾ ,
+    //  Ϸ SEND_LOW_WATERMARK Ʒ  ٽ  (   )
+    static const int64_t SEND_WINDOW = 512 * 1024;
+    static const int64_t SEND_LOW_WATERMARK = 128 * 1024;
+    // â   ä  Ϸ       Ÿ̸
+    static const uint32_t SEND_STALL_CHECK_MS = 50;
+
+    //  Ʈ: Ʈ  ũ( ũ 8 +   4), ִ   , Ŷ ϳ  Ʈ ũ
+    static const uint32_t PACK_ENTRY_SIZE = 12;
+    static const uint32_t MAX_PACK_PATH = 1024;
+    static const uint32_t MAX_PACK_PAYLOAD = SendBufferChunk::SEND_BUFFER_CHUNK_SIZE - sizeof(PackData) - 16;
+
+    // ٿε :   ť ־  ִ ũ (  ŭ  ̽ )
+    static const int64_t SERVE_WINDOW = 512 * 1024;
+
+    struct PackFile
+    {
+        std::string path;         // ۽  
+        std::string relativePath; // Ʈ   
+        uint64_t size;
+    };
+
     struct FileTransferContext
     {
         std::string filePath;
@@ -59,6 +160,56 @@ public:
         uint32_t chunksTotal;
         uint32_t chunksSent;
         bool isCompleted;
+
+        // ۽:  û ûũ 
+        bool awaitingResponse = false;
+        std::vector<ChunkRange> pendingRanges;
+        size_t rangeIndex = 0;
+        uint32_t nextChunkId = 0;
+        bool awaitingComplete = false;  //     
+        uint32_t fileChecksum = 0;      // ûũ üũ  ģ  üũ
+        uint32_t checksumChunkId = 0;   //  ĥ ûũ ȣ
+        uint32_t tailChecksum = 0;      //  ̹     ûũ üũ (FileResponse)
+        bool scheduled = false;         // ۽ ٷ ⿭  ִ 
+        int32_t deficit = 0;            // ̹ 忡    ִ Ʈ 
+        std::vector<BlockSignature> deltaSignatures; //     
+        DeltaEncoder deltaEncoder;
+
+        // Ÿ  (۽/ )
+        bool deltaMode = false;
+        uint32_t deltaBlockSize = 0;
+        uint32_t deltaBlocksTotal = 0;
+
+        //   (۽/ )
+        bool packMode = false;
+        uint32_t packFileCount = 0;
+
+        // ۽:    ϰ  ġ
+        std::vector<PackFile> packFiles;
+        size_t packIndex = 0;
+        uint64_t packFileOffset = 0;
+        bool packEntrySent = false;
+
+        // : ӽ ϰ ûũ Ϸ Ʈ
+        bool checksumReceived = false;  // ۽  üũ  
+        uint32_t expectedChecksum = 0;
+        uint32_t chunkRetries = 0;
+        uint32_t verifyRetries = 0;
+        std::string partPath;
+        std::fstream partStream;
+        ChunkBitmap bitmap;
+        std::ifstream basisStream;      // Ÿ       
+        uint64_t deltaOffset = 0;       // Ÿ  ũ
+        uint32_t deltaChecksum = 0;     //   CRC32C
+
+        // :  Ʈ Ǯ  (ӽ 丮 Ǯ   ü)
+        PackWriter packWriter;
+        std::vector<char> packPending;  // Ŷ 迡 ɸ Ʈ  
+        uint64_t packRemaining = 0;     //  Ͽ   ũ
+        bool packInFile = false;
+        uint32_t packFilesDone = 0;
+        bool packFinished = false;      //   
+        uint32_t packChecksum = 0;      //  Ʈ CRC32C
     };
 
     FileTransferManager();
@@ -67,30 +218,126 @@ public:
     //    (۽ڿ)
     bool StartFileSend(std::shared_ptr<Session> session, const std::string& filePath, uint32_t chunkSize = DEFAULT_CHUNK_SIZE);
 
-    //    (ڿ)
-    bool StartFileReceive(const std::string& targetDir, const FileHeader& header);
+    // 丮    ϳ  Ʈ  (۽ڿ) -     
+    bool StartPackSend(std::shared_ptr<Session> session, const std::string& dirPath);
+
+    //    (ڿ) - ӽ 丮    
+    bool StartPackReceive(std::shared_ptr<Session> session, const std::string& targetDir, const PackHeader& header);
+
+    //  Ʈ  ó (ڿ)
+    bool ProcessPackData(std::shared_ptr<Session> session, const PackData& pack, const BYTE* data, uint32_t size);
+
+    //    (ڿ) -  ûũ   
+    bool StartFileReceive(std::shared_ptr<Session> session, const std::string& targetDir, const FileHeader& header);
+
+    //  û  ó (۽ڿ) - û   
+    bool ProcessFileResponse(std::shared_ptr<Session> session, const FileResponse& response, const ChunkRange* ranges);
+
+    //     ó (۽ڿ) -     
+    bool ProcessFileSignature(const FileSignature& signature, const BlockSignature* signatures);
+
+    // Ÿ  ó (ڿ) - ͷ ״,    Ͽ 
+    bool ProcessFileDelta(std::shared_ptr<Session> session, const FileDelta& delta, const BYTE* data, uint32_t size);
+
+    //  ûũ ó (ڿ) - üũ ٸ ش ûũ û
+    bool ProcessFileChunk(std::shared_ptr<Session> session, const FileChunk& chunk, const void* data);
 
-    //  ûũ ó (ڿ)
-    bool ProcessFileChunk(const FileChunk& chunk, const void* data);
+    //  Ϸ ó (۽  üũ Ǵ   )
+    bool ProcessFileComplete(std::shared_ptr<Session> session, const FileComplete& complete);
 
-    //  ûũ  (۽ڿ)
-    bool SendNextChunk(std::shared_ptr<Session> session, uint32_t connectionId);
+    //   ٿε û (Ŭ̾Ʈ)
+    bool StartFileDownload(std::shared_ptr<Session> session, const std::string& filename, const std::string& targetDir);
 
-    //  
-    void CancelTransfer(uint32_t connectionId);
+    // ٿε û ó () -  ĳ ׸Ʈ ̽   
+    bool StartFileServe(std::shared_ptr<Session> session, const std::string& serveDir, const DownloadRequest& request);
+
+    // ٿε , , Ϸ ó (Ŭ̾Ʈ)
+    bool ProcessDownloadResponse(const DownloadResponse& response);
+    bool ProcessDownloadData(const DownloadData& data, const BYTE* payload, uint32_t size);
+    bool ProcessDownloadComplete(const DownloadComplete& complete);
+
+    //   Ϸ  -  â    ٿε ̽ ε 带 ť 
+    void OnSendCompleted(std::shared_ptr<Session> session, int32_t len);
+
+    // ۽  
+    void CancelTransfer(uint32_t transferId);
 
     //  Ϸ ̺Ʈ ݹ 
-    using TransferCompleteCallback = std::function<void(uint32_t connectionId, bool success, const std::string& filePath)>;
+    using TransferCompleteCallback = std::function<void(uint32_t transferId, bool success, const std::string& filePath)>;
     void SetTransferCompleteCallback(TransferCompleteCallback callback);
 
 private:
-    std::shared_ptr<SendBuffer> CreateFileRequestPacket(const std::string& filePath, uint64_t fileSize, uint32_t chunkSize);
-    std::shared_ptr<SendBuffer> CreateFileChunkPacket(const void* data, uint32_t chunkSize, uint32_t chunkId, bool isLast);
+    // : ĳ ׸Ʈ   ٿε
+    struct ServeContext
+    {
+        std::string filePath;
+        FileCache::FileVersion version;
+        uint64_t offset = 0;                  //   ġ
+        std::shared_ptr<FileSegment> segment; //   ׸Ʈ
+        size_t sliceIndex = 0;
+        uint32_t fileChecksum = 0;            //  ׸Ʈ üũ ģ 
+    };
+
+    // Ŭ̾Ʈ: ޴  ٿε
+    struct DownloadContext
+    {
+        std::string filePath;
+        std::string partPath;
+        std::ofstream stream;
+        uint64_t fileSize = 0;
+        uint64_t received = 0;
+        uint32_t checksum = 0;
+        bool accepted = false;
+    };
+
+    void PumpServes(std::shared_ptr<Session> session);
+    int32_t ServeNextSlice(std::shared_ptr<Session> session, uint32_t transferId, ServeContext& context);
+    void FinishDownload(uint32_t transferId, DownloadContext& context, bool success);
+    std::shared_ptr<SendBuffer> CreateDownloadRequestPacket(uint32_t transferId, const std::string& filename);
+    std::shared_ptr<SendBuffer> CreateDownloadResponsePacket(uint32_t transferId, bool accepted, uint64_t fileSize);
+    std::shared_ptr<SendBuffer> CreateDownloadDataHeader(uint32_t transferId, uint64_t offset, uint32_t size);
+    std::shared_ptr<SendBuffer> CreateDownloadCompletePacket(uint32_t transferId, bool success, uint32_t fileChecksum);
+    std::shared_ptr<SendBuffer> CreateFileRequestPacket(uint32_t transferId, const std::string& filePath, uint64_t fileSize, uint32_t chunkSize, uint64_t lastWriteTime);
+    std::shared_ptr<SendBuffer> CreateFileResponsePacket(uint32_t transferId, bool accepted, const std::vector<ChunkRange>& ranges, bool delta = false, uint32_t tailChecksum = 0);
+    std::shared_ptr<SendBuffer> CreateFileSignaturePacket(uint32_t transferId, uint32_t blockSize, uint32_t blocksTotal, uint32_t firstBlock, const std::vector<BlockSignature>& signatures);
+    std::shared_ptr<SendBuffer> CreateFileDeltaPacket(uint32_t transferId, const std::vector<BYTE>& ops, uint32_t opCount, bool isLast);
+    bool StartDeltaReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    void ScheduleSend(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    void ScheduleSendRound(std::shared_ptr<Session> session);
+    void ScheduleSendStallCheck(std::shared_ptr<Session> session);
+    void PumpSends(std::shared_ptr<Session> session);
+    int32_t SendNextChunk(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    int32_t SendNextDelta(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    int32_t SendNextPack(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    bool UnpackStream(FileTransferContext& context, const char* data, size_t size);
+    static bool IsSafeRelativePath(const std::string& path);
+    void FailFileSend(uint32_t transferId, FileTransferContext& context);
+    bool WriteDeltaOutput(FileTransferContext& context, const char* data, uint64_t size);
+    bool CopyDeltaBlocks(FileTransferContext& context, uint32_t blockIndex, uint32_t blockCount);
+    bool IsReceiveComplete(const FileTransferContext& context) const;
+    void RestartFullReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    void FoldSkippedChecksum(FileTransferContext& context, uint32_t untilChunkId, uint32_t skippedChecksum);
+    void VerifyFileReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    void CompleteFileReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    void FailFileReceive(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    bool FinishFileSend(std::shared_ptr<Session> session, uint32_t transferId, FileTransferContext& context);
+    std::shared_ptr<SendBuffer> CreatePackRequestPacket(uint32_t transferId, const std::string& dirname, uint32_t fileCount, uint64_t totalSize);
+    std::shared_ptr<SendBuffer> CreatePackDataPacket(uint32_t transferId, const std::vector<char>& payload, bool isLast);
+    std::shared_ptr<SendBuffer> CreateFileChunkPacket(uint32_t transferId, const void* data, uint32_t chunkSize, uint32_t chunkId, uint32_t checksum, bool isLast);
+    std::shared_ptr<SendBuffer> CreateFileCompletePacket(uint32_t transferId, bool isReceiver, bool success, uint32_t fileChecksum);
 
     std::mutex _lock;
-    std::map<uint32_t, FileTransferContext> _transfers; // connectionId ->  ؽƮ
+    std::unordered_map<uint32_t, FileTransferContext> _sendTransfers; //  transferId -> ۽ ؽƮ
+    std::unordered_map<uint32_t, FileTransferContext> _recvTransfers; //  transferId ->  ؽƮ
+    std::deque<uint32_t> _activeSends;  // ûũ   ִ ۽ ؽƮ ( κ )
+    bool _sendRoundScheduled = false;
+    bool _sendStallCheckScheduled = false;
+    std::unordered_map<uint32_t, ServeContext> _serveTransfers;       //  transferId -> ٿε  ؽƮ
+    std::deque<uint32_t> _activeServes;                               // ̽  ٿε ( κ )
+    int64_t _sendInFlight = 0;                                        //  ť ְ     ũ (ε ٿε  )
+    std::unordered_map<uint32_t, DownloadContext> _downloadTransfers; //  transferId -> ٿε ؽƮ
     TransferCompleteCallback _transferCompleteCallback;
-    uint32_t _nextConnectionId = 1;
+    uint32_t _nextTransferId = 1;
 };
 
 /*----------------
@@ -102,17 +349,37 @@ public:
     FilePacketSession(asio::io_context& ioc);
 
     void SetFileReceiveDirectory(const std::string& dir);
+    // ٿε û   丮
+    void SetFileServeDirectory(const std::string& dir) { _fileServeDirectory = dir; }
     std::shared_ptr<FileTransferManager> GetFileTransferManager() { return _fileTransferManager; }
 
+    // OnRecvPacket óϴ Ŷ ID (Ļ  ڱ Ŷ   )
+    static bool IsFileTransferPacket(uint16 packetId) { return GetDispatcher().IsRegistered(packetId); }
+
 protected:
     virtual void OnRecvPacket(BYTE* buffer, int32_t len) override;
+    virtual void OnSend(int32_t len) override;
 
 private:
-    void HandleFileRequest(BYTE* buffer);
-    void HandleFileResponse(BYTE* buffer);
-    void HandleFileChunk(BYTE* buffer);
-    void HandleFileComplete(BYTE* buffer);
+    using Dispatcher = PacketDispatcher<FilePacketSession>;
+
+    static const Dispatcher& GetDispatcher();
+
+    void HandleFileRequest(const PacketReader<PKT_FILE_REQUEST>& packet);
+    void HandleFileResponse(const PacketReader<PKT_FILE_RESPONSE>& packet);
+    void HandleFileChunk(const PacketReader<PKT_FILE_DATA>& packet);
+    void HandleFileSignature(const PacketReader<PKT_FILE_SIGNATURE>& packet);
+    void HandleFileDelta(const PacketReader<PKT_FILE_DELTA>& packet);
+    void HandlePackRequest(const PacketReader<PKT_PACK_REQUEST>& packet);
+    void HandlePackData(const PacketReader<PKT_PACK_DATA>& packet);
+    void HandleFileComplete(const PacketReader<PKT_FILE_COMPLETE>& packet);
+    void HandleFileError(const PacketReader<PKT_FILE_ERROR>& packet);
+    void HandleDownloadRequest(const PacketReader<PKT_DOWNLOAD_REQUEST>& packet);
+    void HandleDownloadResponse(const PacketReader<PKT_DOWNLOAD_RESPONSE>& packet);
+    void HandleDownloadData(const PacketReader<PKT_DOWNLOAD_DATA>& packet);
+    void HandleDownloadComplete(const PacketReader<PKT_DOWNLOAD_COMPLETE>& packet);
 
     std::shared_ptr<FileTransferManager> _fileTransferManager;
     std::string _fileReceiveDirectory = "./received_files";
+    std::string _fileServeDirectory = "./public_files";
 };
\ No newline at end of file
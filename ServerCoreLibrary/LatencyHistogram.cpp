@@ -0,0 +1,161 @@
+﻿#include "pch.h"
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::Record(int64 value)
+{
+    value = std::clamp<int64>(value, 0, MAX_VALUE);
+
+    _counts[BucketIndex(value)]++;
+    _totalCount++;
+    _sum += value;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    if (other._totalCount == 0)
+        return;
+
+    for (uint32 i = 0; i < BUCKET_COUNT; i++)
+        _counts[i] += other._counts[i];
+
+    _totalCount += other._totalCount;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+void LatencyHistogram::Reset()
+{
+    _counts.fill(0);
+    _totalCount = 0;
+    _sum = 0;
+    _min = MAX_VALUE;
+    _max = 0;
+}
+
+int64 LatencyHistogram::Percentile(double percentile) const
+{
+    if (_totalCount == 0)
+        return 0;
+
+    // 순위가 target 이상이 되는 첫 버킷
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    uint64 target = std::max<uint64>(1, static_cast<uint64>(std::ceil(percentile / 100.0 * _totalCount)));
+
+    uint64 seen = 0;
+    for (uint32 i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += _counts[i];
+        if (seen >= target)
+            return std::min(BucketHighestValue(i), _max);
+    }
+
+    return _max;
+}
+
+uint32 LatencyHistogram::SerializedSize() const
+{
+    uint32 buckets = static_cast<uint32>(std::count_if(_counts.begin(), _counts.end(), [](uint64 count) { return count != 0; }));
+    return sizeof(SerializedHeader) + buckets * SERIALIZED_ENTRY_SIZE;
+}
+
+uint32 LatencyHistogram::Serialize(BYTE* buffer, uint32 size) const
+{
+    uint32 needed = SerializedSize();
+    if (size < needed)
+        return 0;
+
+    SerializedHeader header = {};
+    header.bucketCount = (needed - sizeof(SerializedHeader)) / SERIALIZED_ENTRY_SIZE;
+    header.totalCount = _totalCount;
+    header.sum = _sum;
+    header.min = _min;
+    header.max = _max;
+    memcpy(buffer, &header, sizeof(header));
+
+    BYTE* pos = buffer + sizeof(header);
+    for (uint32 i = 0; i < BUCKET_COUNT; i++)
+    {
+        if (_counts[i] == 0)
+            continue;
+
+        uint16 index = static_cast<uint16>(i);
+        memcpy(pos, &index, sizeof(index));
+        memcpy(pos + sizeof(index), &_counts[i], sizeof(uint64));
+        pos += SERIALIZED_ENTRY_SIZE;
+    }
+
+    return needed;
+}
+
+bool LatencyHistogram::Deserialize(const BYTE* buffer, uint32 size)
+{
+    if (size < sizeof(SerializedHeader))
+        return false;
+
+    SerializedHeader header;
+    memcpy(&header, buffer, sizeof(header));
+    if (header.bucketCount > BUCKET_COUNT || size < sizeof(header) + header.bucketCount * SERIALIZED_ENTRY_SIZE)
+        return false;
+
+    Reset();
+
+    const BYTE* pos = buffer + sizeof(header);
+    uint64 total = 0;
+    for (uint32 i = 0; i < header.bucketCount; i++)
+    {
+        uint16 index;
+        uint64 count;
+        memcpy(&index, pos, sizeof(index));
+        memcpy(&count, pos + sizeof(index), sizeof(count));
+        pos += SERIALIZED_ENTRY_SIZE;
+
+        if (index >= BUCKET_COUNT) {
+            Reset();
+            return false;
+        }
+
+        _counts[index] += count;
+        total += count;
+    }
+
+    // 버킷 합계와 헤더가 다르면 손상된 데이터
+    if (total != header.totalCount) {
+        Reset();
+        return false;
+    }
+
+    _totalCount = header.totalCount;
+    _sum = header.sum;
+    _min = header.min;
+    _max = header.max;
+    return true;
+}
+
+uint32 LatencyHistogram::BucketIndex(int64 value)
+{
+    if (value < LINEAR_COUNT)
+        return static_cast<uint32>(value);
+
+    // value가 [2^k, 2^(k+1)) 구간이면 상위 SUB_BUCKET_BITS+1 비트로 버킷 결정
+    uint32 exponent = static_cast<uint32>(std::bit_width(static_cast<uint64>(value))) - 1;
+    uint32 shift = exponent - SUB_BUCKET_BITS;
+    uint32 subBucket = static_cast<uint32>(value >> shift) - SUB_BUCKET_COUNT;
+    return LINEAR_COUNT + (exponent - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+int64 LatencyHistogram::BucketHighestValue(uint32 index)
+{
+    if (index < LINEAR_COUNT)
+        return index;
+
+    uint32 octave = (index - LINEAR_COUNT) / SUB_BUCKET_COUNT;
+    uint32 subBucket = (index - LINEAR_COUNT) % SUB_BUCKET_COUNT;
+    uint32 shift = octave + 1;
+    return ((static_cast<int64>(SUB_BUCKET_COUNT + subBucket + 1)) << shift) - 1;
+}
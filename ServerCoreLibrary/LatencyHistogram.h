@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <array>
+
+/*----------------
+    LatencyHistogram
+-----------------*/
+// HDR 방식의 로그-선형 히스토그램 (값 단위: 나노초)
+// 128 미만은 1 단위로 정확히 세고, 그 위는 2의 거듭제곱 구간마다 64개 버킷으로 나눔 (상대 오차 1/64 이하)
+// 버킷 배치가 고정이라 다른 세션이나 다른 실행에서 직렬화한 히스토그램을 그대로 합칠 수 있음
+// 스레드 안전하지 않음 - 세션 하나에서만 기록하거나 호출하는 쪽에서 락을 잡을 것
+class LatencyHistogram
+{
+public:
+    enum
+    {
+        SUB_BUCKET_BITS = 6,
+        SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+        LINEAR_COUNT = SUB_BUCKET_COUNT * 2,   // 이 값 미만은 정확한 값으로 기록
+        MAX_VALUE_BITS = 40,                   // 약 18분까지 기록, 그 이상은 최댓값 버킷에 넣음
+        BUCKET_COUNT = LINEAR_COUNT + (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT,
+    };
+
+    static constexpr int64 MAX_VALUE = (1ll << MAX_VALUE_BITS) - 1;
+
+    LatencyHistogram() { Reset(); }
+
+    void Record(int64 value);
+    void Merge(const LatencyHistogram& other);
+    void Reset();
+
+    uint64 TotalCount() const { return _totalCount; }
+    int64 Min() const { return _totalCount > 0 ? _min : 0; }
+    int64 Max() const { return _max; }
+    double Mean() const { return _totalCount > 0 ? static_cast<double>(_sum) / _totalCount : 0.0; }
+
+    // percentile(0~100) 위치의 값 (해당 버킷에 속하는 가장 큰 값, 단 기록된 최댓값을 넘지 않음)
+    int64 Percentile(double percentile) const;
+
+    // 직렬화 (0이 아닌 버킷만 기록), 버퍼가 작으면 0 반환
+    uint32 SerializedSize() const;
+    uint32 Serialize(BYTE* buffer, uint32 size) const;
+    bool Deserialize(const BYTE* buffer, uint32 size);
+
+private:
+    static uint32 BucketIndex(int64 value);
+    static int64 BucketHighestValue(uint32 index);
+
+    // 직렬화 형식: SerializedHeader 뒤에 { uint16 index; uint64 count; } 가 bucketCount개 (정렬 없이 이어 붙임)
+    struct SerializedHeader
+    {
+        uint32 bucketCount;
+        uint32 reserved;
+        uint64 totalCount;
+        uint64 sum;
+        int64 min;
+        int64 max;
+    };
+
+    enum { SERIALIZED_ENTRY_SIZE = sizeof(uint16) + sizeof(uint64) };
+
+    std::array<uint64, BUCKET_COUNT> _counts;
+    uint64 _totalCount;
+    uint64 _sum;
+    int64 _min;
+    int64 _max;
+};
@@ -0,0 +1,300 @@
+﻿#include "pch.h"
+#include "Logger.h"
+#include <charconv>
+#include <cstdio>
+#include <ctime>
+
+namespace
+{
+    const char* LevelName(LogLevel level)
+    {
+        switch (level) {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        }
+        return "?";
+    }
+
+    template<typename T>
+    void AppendNumber(std::string& out, T value, int32 base = 10)
+    {
+        char text[72];
+        out.append(text, std::to_chars(text, text + sizeof(text), value, base).ptr);
+    }
+
+    void AppendDouble(std::string& out, double value, int32 precision)
+    {
+        char text[64];
+        int len = precision >= 0 ? snprintf(text, sizeof(text), "%.*f", precision, value) : snprintf(text, sizeof(text), "%g", value);
+        out.append(text, std::clamp(len, 0, static_cast<int>(sizeof(text)) - 1));
+    }
+}
+
+Logger::Logger()
+{
+    _out.reserve(64 * 1024);
+    _err.reserve(4 * 1024);
+    _thread = std::thread([this]() { Run(); });
+}
+
+Logger::~Logger()
+{
+    _running.store(false);
+    if (_thread.joinable())
+        _thread.join();
+
+    for (LogQueue* queue : _queues)
+        delete queue;
+}
+
+int64 Logger::NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+LogQueue* Logger::AcquireQueue()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    LogQueue* queue = nullptr;
+    if (!_freeQueues.empty()) {
+        // 끝난 스레드의 큐를 이어서 사용 (쓰는 스레드는 여전히 하나)
+        queue = _freeQueues.back();
+        _freeQueues.pop_back();
+    }
+    else {
+        queue = new LogQueue();
+        _queues.push_back(queue);
+    }
+
+    LLogQueue = queue;
+    return queue;
+}
+
+void Logger::ReleaseQueue()
+{
+    LogQueue* queue = LLogQueue;
+    if (queue == nullptr)
+        return;
+
+    LLogQueue = nullptr;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _freeQueues.push_back(queue);
+}
+
+BYTE* Logger::Reserve(LogQueue* queue, uint32 size)
+{
+    uint64 head = queue->head.load(std::memory_order_relaxed);
+    uint64 tail = queue->tail.load(std::memory_order_acquire);
+    uint32 offset = static_cast<uint32>(head & (LogQueue::CAPACITY - 1));
+
+    // 끝까지 남은 공간에 레코드가 들어가지 않으면 나머지를 패딩으로 채우고 처음부터 씀
+    uint32 padding = offset + size > LogQueue::CAPACITY ? LogQueue::CAPACITY - offset : 0;
+    if (head + padding + size - tail > LogQueue::CAPACITY) {
+        queue->dropped.store(queue->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (padding > 0) {
+        // 패딩은 8바이트 이상 (모든 레코드가 8의 배수)
+        uint32 marker[2] = { padding, UINT32_MAX };
+        ::memcpy(&queue->buffer[offset], marker, sizeof(marker));
+        head += padding;
+        queue->head.store(head, std::memory_order_release);
+        offset = 0;
+    }
+
+    return &queue->buffer[offset];
+}
+
+void Logger::Flush()
+{
+    // 요청 이후에 시작해 끝난 비우기가 두 번 지나면 그 전에 쓴 레코드는 모두 출력된 것
+    uint64 target = _drainedPasses.load() + 2;
+    while (_running.load() && _drainedPasses.load() < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void Logger::Run()
+{
+    while (true)
+    {
+        bool running = _running.load();
+        bool worked = Drain();
+        _drainedPasses.fetch_add(1);
+
+        // 종료 요청 후에는 남은 레코드를 모두 출력하고 끝냄
+        if (!running && !worked)
+            break;
+
+        if (!worked)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool Logger::Drain()
+{
+    // 큐 목록은 늘어나기만 하므로 복사본을 재사용
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _drainQueues.assign(_queues.begin(), _queues.end());
+    }
+    _reportedDrops.resize(_drainQueues.size(), 0);
+
+    bool worked = false;
+    for (size_t i = 0; i < _drainQueues.size(); i++)
+    {
+        LogQueue* queue = _drainQueues[i];
+
+        uint64 tail = queue->tail.load(std::memory_order_relaxed);
+        uint64 head = queue->head.load(std::memory_order_acquire);
+        while (tail < head)
+        {
+            const BYTE* record = &queue->buffer[tail & (LogQueue::CAPACITY - 1)];
+
+            LogRecordHeader header;
+            ::memcpy(&header, record, sizeof(uint32) * 2);
+            if (header.suppressed != UINT32_MAX) {
+                ::memcpy(&header, record, sizeof(header));
+                Format(header, record + sizeof(header));
+            }
+
+            tail += header.size;
+            worked = true;
+        }
+        queue->tail.store(tail, std::memory_order_release);
+
+        // 버린 레코드가 늘었으면 알림 (_reportedDrops는 로거 스레드만 사용)
+        uint64 dropped = queue->dropped.load(std::memory_order_relaxed);
+        if (dropped != _reportedDrops[i]) {
+            _err.append("[Logger] ");
+            AppendNumber(_err, dropped - _reportedDrops[i]);
+            _err.append(" log record(s) dropped, queue full\n");
+            _reportedDrops[i] = dropped;
+            worked = true;
+        }
+    }
+
+    // 스레드별 큐를 차례로 비우므로 스레드 사이의 순서는 근사적
+    if (!_out.empty()) {
+        fwrite(_out.data(), 1, _out.size(), stdout);
+        fflush(stdout);
+        _out.clear();
+    }
+    if (!_err.empty()) {
+        fwrite(_err.data(), 1, _err.size(), stderr);
+        fflush(stderr);
+        _err.clear();
+    }
+
+    return worked;
+}
+
+void Logger::Format(const LogRecordHeader& header, const BYTE* args)
+{
+    std::string& out = header.site->level >= LogLevel::Warn ? _err : _out;
+
+    // [시:분:초.마이크로초][레벨][T스레드]
+    time_t seconds = static_cast<time_t>(header.timestampNs / 1000000000);
+    int64 micros = (header.timestampNs / 1000) % 1000000;
+    tm local;
+#ifdef _MSC_VER
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char prefix[64];
+    int len = snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%06lld][%s][T%u] ",
+        local.tm_hour, local.tm_min, local.tm_sec, static_cast<long long>(micros), LevelName(header.site->level), header.threadId);
+    out.append(prefix, std::clamp(len, 0, static_cast<int>(sizeof(prefix)) - 1));
+
+    // 자리표시자를 만날 때마다 인자를 하나씩 꺼내 변환
+    const char* format = header.format;
+    uint16 remaining = header.argCount;
+    while (*format != '\0')
+    {
+        if (format[0] != '{' || remaining == 0) {
+            out.push_back(*format++);
+            continue;
+        }
+
+        // "{}", "{:.Nf}" 또는 "{:x}" (정수를 16진수로)
+        int32 precision = -1;
+        int32 base = 10;
+        const char* close = strchr(format, '}');
+        if (close == nullptr) {
+            out.append(format);
+            break;
+        }
+        if (format[1] == ':' && format[2] == '.')
+            precision = atoi(format + 3);
+        else if (format[1] == ':' && format[2] == 'x')
+            base = 16;
+        format = close + 1;
+        remaining--;
+
+        LogArgType type = static_cast<LogArgType>(*args++);
+        switch (type) {
+        case LogArgType::Int: {
+            int64 value;
+            ::memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            AppendNumber(out, value, base);
+            break;
+        }
+        case LogArgType::UInt: {
+            uint64 value;
+            ::memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            AppendNumber(out, value, base);
+            break;
+        }
+        case LogArgType::Double: {
+            double value;
+            ::memcpy(&value, args, sizeof(value));
+            args += sizeof(value);
+            AppendDouble(out, value, precision);
+            break;
+        }
+        case LogArgType::Bool:
+            out.append(*args++ ? "true" : "false");
+            break;
+        case LogArgType::Char:
+            out.push_back(static_cast<char>(*args++));
+            break;
+        case LogArgType::String: {
+            uint32 size;
+            ::memcpy(&size, args, sizeof(size));
+            out.append(reinterpret_cast<const char*>(args + sizeof(size)), size);
+            args += sizeof(size) + size;
+            break;
+        }
+        }
+    }
+
+    if (header.suppressed > 0) {
+        out.append(" (suppressed ");
+        AppendNumber(out, header.suppressed);
+        out.append(")");
+    }
+    out.push_back('\n');
+}
+
+bool LogRateLimiter::Allow(int64 intervalMs, uint32& suppressed)
+{
+    int64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64 next = _nextNs.load(std::memory_order_relaxed);
+
+    // 구간 안이거나 다른 스레드가 먼저 통과했으면 생략
+    if (now < next || !_nextNs.compare_exchange_strong(next, now + intervalMs * 1000000)) {
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,256 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <string_view>
+#include <type_traits>
+
+enum class LogLevel : uint8
+{
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+};
+
+// 이 값보다 낮은 레벨의 로그 매크로는 인자 평가까지 통째로 컴파일에서 빠짐 (0:Trace ~ 4:Error)
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 2
+#endif
+
+// 호출 위치마다 하나씩 생기는 정적 정보 (레코드에는 포인터만 기록)
+struct LogSite
+{
+    LogLevel level;
+    const char* file;
+    int32 line;
+};
+
+/*----------------
+    LogQueue
+-----------------*/
+// 스레드 하나가 쓰고 로거 스레드 하나가 읽는 바이트 링 버퍼 (SPSC, 락 없음)
+// 레코드: [LogRecordHeader][인자 태그 + 원본 값]... (8바이트 정렬, 끝에 공간이 모자라면 패딩 레코드로 건너뜀)
+struct LogQueue
+{
+    enum { CAPACITY = 1 << 18 };
+
+    alignas(64) std::atomic<uint64> head = 0;      // 쓰는 쪽 위치
+    alignas(64) std::atomic<uint64> tail = 0;      // 읽는 쪽 위치
+    alignas(64) std::atomic<uint64> dropped = 0;   // 공간이 없어 버린 레코드 수
+    std::array<BYTE, CAPACITY> buffer;
+};
+
+struct LogRecordHeader
+{
+    uint32 size;                // 헤더 포함, 8의 배수
+    uint32 suppressed;          // 속도 제한으로 생략된 같은 위치 로그 수 (패딩 레코드는 UINT32_MAX)
+    const LogSite* site;
+    const char* format;         // 문자열 리터럴 (포맷 ID로 사용)
+    int64 timestampNs;
+    uint16 threadId;
+    uint16 argCount;
+    uint32 reserved;
+};
+
+enum class LogArgType : uint8
+{
+    Int,
+    UInt,
+    Double,
+    Bool,
+    Char,
+    String,
+};
+
+/*----------------
+    Logger
+-----------------*/
+// 비동기 로거 - 호출 스레드는 포맷 ID와 인자 원본만 자기 큐에 복사하고, 문자열 변환과 출력은 백그라운드 스레드가 담당
+// 포맷은 "{}" 자리표시자 (실수는 "{:.2f}"처럼 소수 자릿수, 정수는 "{:x}"로 16진수 지정 가능)
+// 큐가 가득 차면 호출 스레드를 막지 않고 레코드를 버린 뒤 버린 개수를 출력
+class Logger
+{
+public:
+    enum
+    {
+        MAX_STRING_ARG = 1024,   // 문자열 인자는 이 길이까지만 복사
+    };
+
+    Logger();
+    ~Logger();
+
+    template<typename... Args>
+    static void Write(const LogSite* site, uint32 suppressed, const char* format, const Args&... args)
+    {
+        uint32 size = sizeof(LogRecordHeader);
+        ((size += ArgSize(args)), ...);
+        size = (size + 7) & ~7u;
+
+        LogQueue* queue = LocalQueue();
+        BYTE* record = Reserve(queue, size);
+        if (record == nullptr)
+            return;
+
+        LogRecordHeader header = { size, suppressed, site, format, NowNs(), static_cast<uint16>(LThreadId), static_cast<uint16>(sizeof...(Args)), 0 };
+        ::memcpy(record, &header, sizeof(header));
+
+        // 인자가 없는 로그는 헤더만 기록
+        if constexpr (sizeof...(Args) > 0) {
+            BYTE* pos = record + sizeof(header);
+            ((pos = WriteArg(pos, args)), ...);
+        }
+
+        queue->head.store(queue->head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    // 지금까지 기록된 로그를 모두 출력할 때까지 대기 (콘솔 출력 순서를 맞출 때, 종료 시)
+    void Flush();
+
+    // 스레드 종료 시 호출 (ThreadManager::DestroyTLS)
+    void ReleaseQueue();
+
+private:
+    static int64 NowNs();
+
+    static LogQueue* LocalQueue()
+    {
+        LogQueue* queue = LLogQueue;
+        return queue != nullptr ? queue : GLogger->AcquireQueue();
+    }
+
+    LogQueue* AcquireQueue();
+    static BYTE* Reserve(LogQueue* queue, uint32 size);
+
+    /* 인자 인코딩 */
+    template<typename T>
+    static std::string_view AsText(const T& value)
+    {
+        // 배열(문자열 리터럴, char 버퍼)은 null일 수 없으므로 포인터와 나눠 처리
+        if constexpr (std::is_array_v<T>)
+            return std::string_view(value);
+        else if constexpr (std::is_pointer_v<T>)
+            return value != nullptr ? std::string_view(value) : std::string_view("(null)");
+        else
+            return std::string_view(value);
+    }
+
+    template<typename T>
+    static uint32 ArgSize(const T& value)
+    {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            return 1 + sizeof(uint32) + static_cast<uint32>(std::min<size_t>(AsText(value).size(), MAX_STRING_ARG));
+        else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>)
+            return 2;
+        else
+            return 1 + 8;
+    }
+
+    template<typename T>
+    static BYTE* WriteArg(BYTE* pos, const T& value)
+    {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            std::string_view text = AsText(value);
+            uint32 len = static_cast<uint32>(std::min<size_t>(text.size(), MAX_STRING_ARG));
+            *pos++ = static_cast<BYTE>(LogArgType::String);
+            ::memcpy(pos, &len, sizeof(len));
+            ::memcpy(pos + sizeof(len), text.data(), len);
+            return pos + sizeof(len) + len;
+        }
+        else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+            *pos++ = static_cast<BYTE>(std::is_same_v<T, bool> ? LogArgType::Bool : LogArgType::Char);
+            *pos++ = static_cast<BYTE>(value);
+            return pos;
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            double number = static_cast<double>(value);
+            *pos++ = static_cast<BYTE>(LogArgType::Double);
+            ::memcpy(pos, &number, sizeof(number));
+            return pos + sizeof(number);
+        }
+        else if constexpr (std::is_enum_v<T>) {
+            return WriteArg(pos, static_cast<std::underlying_type_t<T>>(value));
+        }
+        else if constexpr (std::is_signed_v<T>) {
+            static_assert(std::is_integral_v<T>, "unsupported log argument type");
+            int64 number = static_cast<int64>(value);
+            *pos++ = static_cast<BYTE>(LogArgType::Int);
+            ::memcpy(pos, &number, sizeof(number));
+            return pos + sizeof(number);
+        }
+        else {
+            static_assert(std::is_integral_v<T>, "unsupported log argument type");
+            uint64 number = static_cast<uint64>(value);
+            *pos++ = static_cast<BYTE>(LogArgType::UInt);
+            ::memcpy(pos, &number, sizeof(number));
+            return pos + sizeof(number);
+        }
+    }
+
+    /* 백그라운드 스레드 */
+    void Run();
+    bool Drain();
+    void Format(const LogRecordHeader& header, const BYTE* args);
+
+private:
+    std::mutex _lock;
+    std::vector<LogQueue*> _queues;             // 만든 모든 큐 (반납된 큐도 남은 레코드를 계속 읽음)
+    std::vector<LogQueue*> _freeQueues;
+
+    std::thread _thread;
+    std::atomic<bool> _running = true;
+    std::atomic<uint64> _drainedPasses = 0;     // Flush가 한 바퀴 이상 비워졌는지 확인하는 용도
+
+    // 로거 스레드 전용
+    std::vector<LogQueue*> _drainQueues;
+    std::vector<uint64> _reportedDrops;         // 큐별로 마지막에 알린 버린 개수
+    std::string _out;
+    std::string _err;
+};
+
+/*----------------
+    LogRateLimiter
+-----------------*/
+// 호출 위치별로 intervalMs마다 한 번만 통과시키고 나머지는 개수만 셈
+class LogRateLimiter
+{
+public:
+    bool Allow(int64 intervalMs, uint32& suppressed);
+
+private:
+    std::atomic<int64> _nextNs = 0;
+    std::atomic<uint32> _suppressed = 0;
+};
+
+#define LOG_AT(logLevel, ...)                                                                           \
+    do {                                                                                                \
+        if constexpr (static_cast<int>(logLevel) >= LOG_MIN_LEVEL) {                                    \
+            static constexpr LogSite logSite = { logLevel, __FILE__, __LINE__ };                        \
+            Logger::Write(&logSite, 0, __VA_ARGS__);                                                    \
+        }                                                                                               \
+    } while (0)
+
+#define LOG_EVERY_AT(logLevel, intervalMs, ...)                                                         \
+    do {                                                                                                \
+        if constexpr (static_cast<int>(logLevel) >= LOG_MIN_LEVEL) {                                    \
+            static LogRateLimiter logLimiter;                                                           \
+            uint32 logSuppressed = 0;                                                                   \
+            if (logLimiter.Allow(intervalMs, logSuppressed)) {                                          \
+                static constexpr LogSite logSite = { logLevel, __FILE__, __LINE__ };                    \
+                Logger::Write(&logSite, logSuppressed, __VA_ARGS__);                                    \
+            }                                                                                           \
+        }                                                                                               \
+    } while (0)
+
+// 사용: LOG_INFO("Sent chunk {} ({} bytes)", chunkId, size); - 포맷은 문자열 리터럴이어야 함
+#define LOG_TRACE(...)  LOG_AT(LogLevel::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...)  LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)   LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...)   LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...)  LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+// 속도 제한: intervalMs 동안 같은 위치의 로그는 한 번만 출력하고 생략된 개수를 덧붙임
+#define LOG_DEBUG_EVERY(intervalMs, ...)    LOG_EVERY_AT(LogLevel::Debug, intervalMs, __VA_ARGS__)
+#define LOG_INFO_EVERY(intervalMs, ...)     LOG_EVERY_AT(LogLevel::Info, intervalMs, __VA_ARGS__)
+#define LOG_WARN_EVERY(intervalMs, ...)     LOG_EVERY_AT(LogLevel::Warn, intervalMs, __VA_ARGS__)
+#define LOG_ERROR_EVERY(intervalMs, ...)    LOG_EVERY_AT(LogLevel::Error, intervalMs, __VA_ARGS__)
@@ -1,7 +1,22 @@
 #include "pch.h"
 #include "MemoryPool.h"
 #include "SendBuffer.h" // SendBufferChunk::SEND_BUFFER_CHUNK_SIZE  
+#include "RecvBuffer.h" // RecvBuffer::DEFAULT_CAPACITY
+#include <iomanip>
+#include <sstream>
+#include <tuple>
 
+#if MEMORY_DEBUG
+namespace
+{
+    enum : BYTE { FREED_FILL = 0xDD };
+
+    uint32* CanaryOf(MemoryHeader* header)
+    {
+        return reinterpret_cast<uint32*>(reinterpret_cast<BYTE*>(header + 1) + header->allocSize);
+    }
+}
+#endif
 
 MemoryPool::MemoryPool(uint32 allocSize) : _allocSize(allocSize)
 {
@@ -17,26 +32,69 @@ MemoryPool::~MemoryPool()
 void MemoryPool::Push(MemoryHeader* ptr)
 {
     ptr->allocSize = 0;
+    ptr->magic = MemoryHeader::FREED_MAGIC;
+
+#if MEMORY_DEBUG
+    // ݳ Ŀ   Pop 巯 ä 
+    ::memset(ptr + 1, FREED_FILL, _allocSize);
+#endif
 
     std::lock_guard<std::mutex> guard(_lock);
     _queue.push_back(ptr);
+    _outstanding--;
 }
 
 MemoryHeader* MemoryPool::Pop()
 {
-    std::lock_guard<std::mutex> guard(_lock);
-    if (_queue.empty())
+    MemoryHeader* header = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _allocated++;
+        _outstanding++;
+        _highWater = std::max(_highWater, _outstanding);
+
+        if (_queue.empty())
+        {
+            //  Ҵ
+            _misses++;
+            return reinterpret_cast<MemoryHeader*>(malloc(_allocSize + sizeof(MemoryHeader) + MemoryHeader::CANARY_SIZE));
+        }
+
+        header = _queue.back();
+        _queue.pop_back();
+    }
+
+#if MEMORY_DEBUG
+    // ݳ    Ͽ  Ȯ (  , ûũ  )
+    const BYTE* data = reinterpret_cast<const BYTE*>(header + 1);
+    for (uint32 i = 0; i < _allocSize; i++)
     {
-        //  Ҵ
-        MemoryHeader* header = reinterpret_cast<MemoryHeader*>(malloc(_allocSize + sizeof(MemoryHeader)));
-        return header;
+        if (data[i] != FREED_FILL) {
+            std::cerr << "[MemoryPool] Block " << static_cast<const void*>(data) << " (size class " << _allocSize
+                << ") was modified after release at offset " << i << std::endl;
+            assert(false);
+            break;
+        }
     }
+#endif
 
-    MemoryHeader* header = _queue.back();
-    _queue.pop_back();
     return header;
 }
 
+MemoryPoolStats MemoryPool::GetStats()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    MemoryPoolStats stats;
+    stats.allocSize = _allocSize;
+    stats.allocated = _allocated;
+    stats.outstanding = _outstanding;
+    stats.freeCached = _queue.size();
+    stats.highWater = _highWater;
+    stats.misses = _misses;
+    return stats;
+}
+
 MemoryPoolManager::MemoryPoolManager()
 {
     //   ޸ Ǯ 
@@ -48,15 +106,25 @@ MemoryPoolManager::MemoryPoolManager()
 
     // 64KB¥ ûũ  Ǯ
     _pools[SendBufferChunk::SEND_BUFFER_CHUNK_SIZE] = new MemoryPool(SendBufferChunk::SEND_BUFFER_CHUNK_SIZE);
+
+    //     Ǯ (  ݳϹǷ    ŭ )
+    _pools[RecvBuffer::DEFAULT_CAPACITY] = new MemoryPool(RecvBuffer::DEFAULT_CAPACITY);
 }
 
 MemoryPoolManager::~MemoryPoolManager()
 {
+    //    (⼭ outstanding   ݳ  )
+    std::cout << "\n[MemoryPool] Statistics at shutdown\n" << FormatStats();
+#if MEMORY_DEBUG
+    std::cout << FormatLeaks();
+#endif
+    std::cout << std::flush;
+
     for (auto& pair : _pools)
         delete pair.second;
 }
 
-void* MemoryPoolManager::Allocate(uint32 size)
+void* MemoryPoolManager::Allocate(uint32 size, const std::source_location& site)
 {
     MemoryPool* pool = nullptr;
 
@@ -64,29 +132,183 @@ void* MemoryPoolManager::Allocate(uint32 size)
     if (it != _pools.end())
         pool = it->second;
 
+    MemoryHeader* header = nullptr;
     if (pool == nullptr)
     {
         // Ǯ  ʴ ū ũ   Ҵ
-        MemoryHeader* header = reinterpret_cast<MemoryHeader*>(malloc(size + sizeof(MemoryHeader)));
-        return MemoryHeader::AttachHeader(header, size);
+        header = reinterpret_cast<MemoryHeader*>(malloc(size + sizeof(MemoryHeader) + MemoryHeader::CANARY_SIZE));
+
+        uint64 outstanding = ++_directOutstanding;
+        uint64 highWater = _directHighWater.load(std::memory_order_relaxed);
+        while (outstanding > highWater && !_directHighWater.compare_exchange_weak(highWater, outstanding));
+        _directAllocated++;
     }
+    else
+    {
+        header = pool->Pop();
+    }
+
+    void* ptr = MemoryHeader::AttachHeader(header, pool, size);
 
-    MemoryHeader* header = pool->Pop();
-    return MemoryHeader::AttachHeader(header, size);
+#if MEMORY_DEBUG
+    *CanaryOf(header) = MemoryHeader::CANARY_VALUE;
+    TrackAllocate(header, site);
+#endif
+
+    return ptr;
 }
 
 void MemoryPoolManager::Release(void* ptr)
 {
     MemoryHeader* header = MemoryHeader::DetachHeader(ptr);
-    uint32_t allocSize = header->allocSize;
 
-    auto it = _pools.find(allocSize);
-    if (it == _pools.end())
+    //    ڰ Ҵ  ʹ Ǯ Ű ʵ ź
+    if (header->magic != MemoryHeader::ALLOCATED_MAGIC)
+    {
+        ReportInvalidRelease(header, ptr);
+        return;
+    }
+
+#if MEMORY_DEBUG
+    if (*CanaryOf(header) != MemoryHeader::CANARY_VALUE) {
+        std::cerr << "[MemoryPool] Buffer overrun past " << header->allocSize << " bytes at " << ptr
+            << " (allocated at " << header->file << ":" << header->line << ")" << std::endl;
+        assert(false);
+    }
+    TrackRelease(header);
+#endif
+
+    if (header->pool == nullptr)
     {
         // Ǯ  ʴ ũ   
+        header->magic = MemoryHeader::FREED_MAGIC;
+        _directOutstanding--;
         free(header);
         return;
     }
 
-    it->second->Push(header);
-}
\ No newline at end of file
+    // Ҵ   Ǯ ݳ (û ũⰡ  ũ ޶ )
+    header->pool->Push(header);
+}
+
+void MemoryPoolManager::GetStats(std::vector<MemoryPoolStats>& stats)
+{
+    stats.clear();
+    for (auto& pair : _pools)
+    {
+        MemoryPoolStats poolStats = pair.second->GetStats();
+        if (poolStats.allocated > 0)
+            stats.push_back(poolStats);
+    }
+
+    MemoryPoolStats direct;
+    direct.allocated = _directAllocated.load();
+    direct.outstanding = _directOutstanding.load();
+    direct.highWater = _directHighWater.load();
+    direct.misses = direct.allocated;
+    if (direct.allocated > 0)
+        stats.push_back(direct);
+}
+
+std::string MemoryPoolManager::FormatStats()
+{
+    std::vector<MemoryPoolStats> stats;
+    GetStats(stats);
+
+    std::ostringstream out;
+    out << std::setw(10) << "size" << std::setw(14) << "allocated" << std::setw(13) << "outstanding"
+        << std::setw(12) << "cached" << std::setw(12) << "high-water" << std::setw(12) << "misses" << "\n";
+
+    uint64 outstandingBytes = 0;
+    uint64 cachedBytes = 0;
+    for (const MemoryPoolStats& entry : stats)
+    {
+        if (entry.allocSize == 0)
+            out << std::setw(10) << "direct";
+        else
+            out << std::setw(10) << entry.allocSize;
+
+        out << std::setw(14) << entry.allocated << std::setw(13) << entry.outstanding
+            << std::setw(12) << entry.freeCached << std::setw(12) << entry.highWater << std::setw(12) << entry.misses << "\n";
+
+        outstandingBytes += entry.outstanding * entry.allocSize;
+        cachedBytes += entry.freeCached * entry.allocSize;
+    }
+
+    out << "Pooled bytes outstanding: " << outstandingBytes << ", cached: " << cachedBytes
+        << ", invalid releases: " << _invalidReleases.load() << "\n";
+    return out.str();
+}
+
+void MemoryPoolManager::ReportInvalidRelease(MemoryHeader* header, void* ptr)
+{
+    _invalidReleases++;
+
+    if (header->magic == MemoryHeader::FREED_MAGIC)
+        std::cerr << "[MemoryPool] Double release of " << ptr << std::endl;
+    else
+        std::cerr << "[MemoryPool] Release of a pointer not allocated by the memory pool: " << ptr << std::endl;
+
+    assert(false);
+}
+
+#if MEMORY_DEBUG
+void MemoryPoolManager::TrackAllocate(MemoryHeader* header, const std::source_location& site)
+{
+    header->file = site.file_name();
+    header->function = site.function_name();
+    header->line = site.line();
+    header->prev = nullptr;
+
+    std::lock_guard<std::mutex> guard(_liveLock);
+    header->next = _liveHead;
+    if (_liveHead != nullptr)
+        _liveHead->prev = header;
+    _liveHead = header;
+}
+
+void MemoryPoolManager::TrackRelease(MemoryHeader* header)
+{
+    std::lock_guard<std::mutex> guard(_liveLock);
+    if (header->prev != nullptr)
+        header->prev->next = header->next;
+    else
+        _liveHead = header->next;
+
+    if (header->next != nullptr)
+        header->next->prev = header->prev;
+}
+
+std::string MemoryPoolManager::FormatLeaks()
+{
+    // Ҵ ġ ݳ    Ʈ հ
+    struct LeakSite
+    {
+        uint64 count = 0;
+        uint64 bytes = 0;
+    };
+    std::map<std::tuple<std::string, uint32, std::string>, LeakSite> sites;
+
+    {
+        std::lock_guard<std::mutex> guard(_liveLock);
+        for (MemoryHeader* header = _liveHead; header != nullptr; header = header->next)
+        {
+            LeakSite& site = sites[{ header->file, header->line, header->function }];
+            site.count++;
+            site.bytes += header->allocSize;
+        }
+    }
+
+    if (sites.empty())
+        return "No leaked blocks\n";
+
+    std::ostringstream out;
+    out << "Leaked blocks by allocation site:\n";
+    for (const auto& [key, site] : sites)
+    {
+        out << "  " << site.count << " block(s), " << site.bytes << " bytes at "
+            << std::get<0>(key) << ":" << std::get<1>(key) << " (" << std::get<2>(key) << ")\n";
+    }
+    return out.str();
+}
+#endif
@@ -1,20 +1,43 @@
 #pragma once
 #include "CorePch.h"
+#include <source_location>
 
 //  
 class SendBufferChunk;
+class MemoryPool;
+
+// 1̸  ڿ ī ΰ, ݳ  ä   ⸦ ˻ϸ,  ִ  Ҵ ġ 
+#ifndef MEMORY_DEBUG
+#ifdef _DEBUG
+#define MEMORY_DEBUG 1
+#else
+#define MEMORY_DEBUG 0
+#endif
+#endif
 
 /*----------------
     MemoryHeader
 -----------------*/
-struct MemoryHeader
+struct alignas(16) MemoryHeader
 {
-    // [MemoryHeader][Data]
-    MemoryHeader(uint32 size) : allocSize(size) {}
+    // [MemoryHeader][Data]([Canary] - MEMORY_DEBUG)
+    enum : uint32
+    {
+        ALLOCATED_MAGIC = 0xA110CA7E,
+        FREED_MAGIC = 0xF4EEF4EE,   // Ǯ ݳ  (ٽ ݳǸ  )
+        CANARY_VALUE = 0xCA7ACA7E,
+#if MEMORY_DEBUG
+        CANARY_SIZE = sizeof(uint32),
+#else
+        CANARY_SIZE = 0,
+#endif
+    };
+
+    MemoryHeader(MemoryPool* owner, uint32 size) : pool(owner), allocSize(size), magic(ALLOCATED_MAGIC) {}
 
-    static void* AttachHeader(MemoryHeader* header, uint32 size)
+    static void* AttachHeader(MemoryHeader* header, MemoryPool* owner, uint32 size)
     {
-        new(header)MemoryHeader(size); // placement new
+        new(header)MemoryHeader(owner, size); // placement new
         return reinterpret_cast<void*>(++header);
     }
 
@@ -24,7 +47,29 @@ struct MemoryHeader
         return header;
     }
 
-    uint32 allocSize;
+    MemoryPool* pool;   // ݳ Ǯ (nullptr̸ Ǯ ۿ  Ҵ)
+    uint32 allocSize;   // û ũ
+    uint32 magic;
+
+#if MEMORY_DEBUG
+    //  ִ  ϰ Ҵ ġ
+    MemoryHeader* prev;
+    MemoryHeader* next;
+    const char* file;
+    const char* function;
+    uint32 line;
+#endif
+};
+
+// ũ  
+struct MemoryPoolStats
+{
+    uint32 allocSize = 0;       // 0̸ Ǯ   Ҵ
+    uint64 allocated = 0;       //  Ҵ Ƚ
+    uint64 outstanding = 0;     // ݳ  
+    uint64 freeCached = 0;      // Ǯ   
+    uint64 highWater = 0;       // outstanding ִ
+    uint64 misses = 0;          // Ǯ  malloc   Ƚ
 };
 
 /*-----------------
@@ -39,10 +84,19 @@ public:
     void          Push(MemoryHeader* ptr);
     MemoryHeader* Pop();
 
+    uint32 GetAllocSize() const { return _allocSize; }
+    MemoryPoolStats GetStats();
+
 private:
     uint32 _allocSize = 0;
     std::mutex _lock;
     std::vector<MemoryHeader*> _queue;
+
+    // _lock ȣ
+    uint64 _allocated = 0;
+    uint64 _outstanding = 0;
+    uint64 _highWater = 0;
+    uint64 _misses = 0;
 };
 
 /*-----------------
@@ -54,22 +108,52 @@ public:
     MemoryPoolManager();
     ~MemoryPoolManager();
 
-    void* Allocate(uint32 size);
+    // site ⺻ ڷ ȣ ġ  (MEMORY_DEBUG   )
+    void* Allocate(uint32 size, const std::source_location& site = std::source_location::current());
     void Release(void* ptr);
 
+    //   ũ   Ҵ  ( Ҵ allocSize 0)
+    void GetStats(std::vector<MemoryPoolStats>& stats);
+    std::string FormatStats();
+
+    // ߸ ͳ   ź Release Ƚ
+    uint64 GetInvalidReleaseCount() const { return _invalidReleases.load(); }
+
+private:
+    void ReportInvalidRelease(MemoryHeader* header, void* ptr);
+
+#if MEMORY_DEBUG
+    void TrackAllocate(MemoryHeader* header, const std::source_location& site);
+    void TrackRelease(MemoryHeader* header);
+    std::string FormatLeaks();
+#endif
+
 private:
     std::map<uint32, MemoryPool*> _pools;
+
+    // Ǯ   Ҵ
+    std::atomic<uint64> _directAllocated = 0;
+    std::atomic<uint64> _directOutstanding = 0;
+    std::atomic<uint64> _directHighWater = 0;
+
+    std::atomic<uint64> _invalidReleases = 0;
+
+#if MEMORY_DEBUG
+    std::mutex _liveLock;
+    MemoryHeader* _liveHead = nullptr;
+#endif
 };
 
 // ü Ǯ ø
+// site    ȣ ġ (   ڿ ⺻ ڸ     տ )
 template<typename Type>
 class ObjectPool
 {
 public:
     template<typename... Args>
-    static Type* Pop(Args&&... args)
+    static Type* Pop(const std::source_location& site, Args&&... args)
     {
-        Type* memory = static_cast<Type*>(GMemoryManager->Allocate(sizeof(Type)));
+        Type* memory = static_cast<Type*>(GMemoryManager->Allocate(sizeof(Type), site));
         new(memory)Type(std::forward<Args>(args)...); // placement new
         return memory;
     }
@@ -81,9 +165,9 @@ public:
     }
 
     template<typename... Args>
-    static std::shared_ptr<Type> MakeShared(Args&&... args)
+    static std::shared_ptr<Type> MakeShared(const std::source_location& site, Args&&... args)
     {
-        std::shared_ptr<Type> ptr = { Pop(std::forward<Args>(args)...), Push };
+        std::shared_ptr<Type> ptr = { Pop(site, std::forward<Args>(args)...), Push };
         return ptr;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,196 @@
+﻿#include "pch.h"
+#include "Metrics.h"
+#include <sstream>
+
+MetricsRegistry::MetricsRegistry()
+{
+    _core.sessionBytesIn = GetCounter("session_bytes_received_total", "Bytes received by all sessions");
+    _core.sessionBytesOut = GetCounter("session_bytes_sent_total", "Bytes sent by all sessions");
+    _core.sessionPacketsIn = GetCounter("session_packets_received_total", "Packets framed by PacketSession");
+    _core.sessionPacketsOut = GetCounter("session_packets_sent_total", "Packets queued with Session::Send");
+    _core.sessionsActive = GetGauge("sessions_active", "Connected sessions");
+    _core.sendQueueDepth = GetGauge("session_send_queue_depth", "Send buffers waiting in session send queues");
+    _core.recvBuffersHeld = GetGauge("session_recv_buffers_held", "Receive buffers currently taken from the memory pool");
+    _core.sendBatchBuffers = GetHistogram("session_send_batch_buffers", "Send buffers gathered into one write");
+
+    _core.serviceAccepts = GetCounter("service_accepts_total", "Connections accepted by server services");
+    _core.serviceRejects = GetCounter("service_rejects_total", "Connections rejected because the session limit was reached");
+
+    _core.fileBytesSent = GetCounter("file_transfer_bytes_sent_total", "File payload bytes sent");
+    _core.fileBytesReceived = GetCounter("file_transfer_bytes_received_total", "File payload bytes received");
+    _core.fileChunksSent = GetCounter("file_transfer_chunks_sent_total", "File data packets sent");
+    _core.fileChunksReceived = GetCounter("file_transfer_chunks_received_total", "File data packets received");
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for (MetricShard* shard : _shards)
+        delete shard;
+}
+
+Counter* MetricsRegistry::GetCounter(const std::string& name, const std::string& help, const std::string& labelKey, const std::string& labelValue)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    MetricInfo* info = Register(MetricType::Counter, name, help, labelKey, labelValue, 1);
+    if (info->handle == nullptr) {
+        Counter& counter = _counters.emplace_back();
+        counter._cell = info->cell;
+        info->handle = &counter;
+    }
+    return static_cast<Counter*>(info->handle);
+}
+
+Gauge* MetricsRegistry::GetGauge(const std::string& name, const std::string& help, const std::string& labelKey, const std::string& labelValue)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    MetricInfo* info = Register(MetricType::Gauge, name, help, labelKey, labelValue, 1);
+    if (info->handle == nullptr) {
+        Gauge& gauge = _gauges.emplace_back();
+        gauge._cell = info->cell;
+        info->handle = &gauge;
+    }
+    return static_cast<Gauge*>(info->handle);
+}
+
+MetricHistogram* MetricsRegistry::GetHistogram(const std::string& name, const std::string& help, const std::string& labelKey, const std::string& labelValue)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+    MetricInfo* info = Register(MetricType::Histogram, name, help, labelKey, labelValue, MetricHistogram::CELL_COUNT);
+    if (info->handle == nullptr) {
+        MetricHistogram& histogram = _histograms.emplace_back();
+        histogram._cell = info->cell;
+        info->handle = &histogram;
+    }
+    return static_cast<MetricHistogram*>(info->handle);
+}
+
+MetricsRegistry::MetricInfo* MetricsRegistry::Register(MetricType type, const std::string& name, const std::string& help,
+    const std::string& labelKey, const std::string& labelValue, uint32 cellCount)
+{
+    // 같은 이름의 지표끼리 붙어서 정렬되도록 이름 뒤에 레이블 값을 붙인 키 사용
+    std::string key = name + '\0' + labelValue;
+    auto it = _metrics.find(key);
+    if (it != _metrics.end()) {
+        assert(it->second.type == type);
+        return &it->second;
+    }
+
+    MetricInfo info = { name, help, labelKey, labelValue, type, 0, nullptr };
+    if (_nextCell + cellCount <= MetricShard::CELL_COUNT) {
+        info.cell = _nextCell;
+        _nextCell += cellCount;
+    }
+    else {
+        // 셀이 부족하면 기록은 버리는 셀로 보냄 (값은 항상 0으로 보고됨)
+        std::cerr << "[Metrics] Out of cells, metric is not recorded: " << name << std::endl;
+    }
+
+    return &_metrics.emplace(key, info).first->second;
+}
+
+MetricShard* MetricsRegistry::AcquireShard()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    MetricShard* shard = nullptr;
+    if (!_freeShards.empty()) {
+        // 끝난 스레드의 샤드를 값 그대로 이어서 사용
+        shard = _freeShards.back();
+        _freeShards.pop_back();
+    }
+    else {
+        shard = new MetricShard();
+        _shards.push_back(shard);
+    }
+
+    LMetricShard = shard;
+    return shard;
+}
+
+void MetricsRegistry::ReleaseShard()
+{
+    MetricShard* shard = LMetricShard;
+    if (shard == nullptr)
+        return;
+
+    LMetricShard = nullptr;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _freeShards.push_back(shard);
+}
+
+uint64 MetricsRegistry::SumCell(uint32 cell) const
+{
+    uint64 sum = 0;
+    for (const MetricShard* shard : _shards)
+        sum += shard->cells[cell].load(std::memory_order_relaxed);
+    return sum;
+}
+
+void MetricsRegistry::Snapshot(std::vector<MetricSnapshot>& snapshots)
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    // 이전 스냅샷의 문자열 버퍼를 재사용 (주기적으로 읽는 쪽이 매번 할당하지 않도록)
+    snapshots.resize(_metrics.size());
+
+    size_t index = 0;
+    for (const auto& [key, info] : _metrics)
+    {
+        MetricSnapshot& snapshot = snapshots[index++];
+        snapshot.name = info.name;
+        snapshot.help = info.help;
+        snapshot.labelKey = info.labelKey;
+        snapshot.labelValue = info.labelValue;
+        snapshot.type = info.type;
+        snapshot.value = 0;
+        snapshot.count = 0;
+        snapshot.sum = 0;
+        snapshot.buckets.fill(0);
+
+        if (info.cell == 0)
+            continue;
+
+        if (info.type == MetricType::Histogram) {
+            snapshot.count = SumCell(info.cell);
+            snapshot.sum = SumCell(info.cell + 1);
+            for (uint32 i = 0; i < MetricHistogram::BUCKET_COUNT; i++)
+                snapshot.buckets[i] = SumCell(info.cell + 2 + i);
+        }
+        else {
+            snapshot.value = static_cast<int64>(SumCell(info.cell));
+        }
+    }
+}
+
+std::string MetricsRegistry::FormatText()
+{
+    std::vector<MetricSnapshot> snapshots;
+    Snapshot(snapshots);
+
+    std::ostringstream out;
+    for (const MetricSnapshot& snapshot : snapshots)
+    {
+        out << snapshot.name;
+        if (!snapshot.labelKey.empty())
+            out << '{' << snapshot.labelKey << "=\"" << snapshot.labelValue << "\"}";
+
+        if (snapshot.type == MetricType::Histogram) {
+            // 가장 큰 값이 들어간 버킷의 상한 (2^i - 1)
+            int32 top = MetricHistogram::BUCKET_COUNT - 1;
+            while (top > 0 && snapshot.buckets[top] == 0)
+                top--;
+
+            uint64 maxBound = top >= 64 ? UINT64_MAX : (1ull << top) - 1;
+            out << " count=" << snapshot.count << " sum=" << snapshot.sum
+                << " avg=" << (snapshot.count > 0 ? static_cast<double>(snapshot.sum) / snapshot.count : 0.0)
+                << " max<=" << maxBound;
+        }
+        else {
+            out << ' ' << snapshot.value;
+        }
+        out << '\n';
+    }
+
+    return out.str();
+}
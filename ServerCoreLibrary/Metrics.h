@@ -0,0 +1,203 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <deque>
+
+/*----------------
+    MetricShard
+-----------------*/
+// 스레드 하나가 기록하는 셀 묶음
+// 주인 스레드만 값을 바꾸므로 원자적 RMW 없이 relaxed load/store로 더하고, 읽는 쪽은 모든 샤드의 셀을 합침
+struct MetricShard
+{
+    enum { CELL_COUNT = 4096 };
+
+    std::array<std::atomic<uint64>, CELL_COUNT> cells = {};
+
+    void Add(uint32 cell, uint64 value)
+    {
+        std::atomic<uint64>& target = cells[cell];
+        target.store(target.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+class MetricsRegistry;
+
+/*----------------
+    Counter
+-----------------*/
+// 단조 증가 값
+class Counter
+{
+    friend class MetricsRegistry;
+
+public:
+    void Inc(uint64 value = 1);
+
+private:
+    uint32 _cell = 0;
+};
+
+/*----------------
+    Gauge
+-----------------*/
+// 오르내리는 값 (샤드별 증감을 합산하므로 Set 없이 Add만 지원)
+class Gauge
+{
+    friend class MetricsRegistry;
+
+public:
+    void Add(int64 delta);
+    void Inc() { Add(1); }
+    void Dec() { Add(-1); }
+
+private:
+    uint32 _cell = 0;
+};
+
+/*----------------
+    MetricHistogram
+-----------------*/
+// 2의 거듭제곱 버킷 히스토그램 (버킷 i = 비트 폭이 i인 값, 즉 [2^(i-1), 2^i - 1])
+class MetricHistogram
+{
+    friend class MetricsRegistry;
+
+public:
+    enum
+    {
+        BUCKET_COUNT = 65,
+        CELL_COUNT = BUCKET_COUNT + 2, // [count][sum][buckets...]
+    };
+
+    void Record(uint64 value);
+
+private:
+    uint32 _cell = 0;
+};
+
+enum class MetricType : uint8
+{
+    Counter,
+    Gauge,
+    Histogram,
+};
+
+// 읽는 시점에 모든 샤드를 합친 값
+struct MetricSnapshot
+{
+    std::string name;
+    std::string help;
+    std::string labelKey;      // 레이블이 없으면 빈 문자열
+    std::string labelValue;
+    MetricType type = MetricType::Counter;
+
+    int64 value = 0;           // Counter, Gauge
+    uint64 count = 0;          // Histogram
+    uint64 sum = 0;
+    std::array<uint64, MetricHistogram::BUCKET_COUNT> buckets = {};
+};
+
+// 코어 라이브러리가 기록하는 지표 (핫패스에서 이름으로 찾지 않도록 미리 등록)
+struct CoreMetrics
+{
+    Counter* sessionBytesIn = nullptr;
+    Counter* sessionBytesOut = nullptr;
+    Counter* sessionPacketsIn = nullptr;
+    Counter* sessionPacketsOut = nullptr;
+    Gauge* sessionsActive = nullptr;
+    Gauge* sendQueueDepth = nullptr;
+    Gauge* recvBuffersHeld = nullptr;
+    MetricHistogram* sendBatchBuffers = nullptr;
+
+    Counter* serviceAccepts = nullptr;
+    Counter* serviceRejects = nullptr;
+
+    Counter* fileBytesSent = nullptr;
+    Counter* fileBytesReceived = nullptr;
+    Counter* fileChunksSent = nullptr;
+    Counter* fileChunksReceived = nullptr;
+};
+
+/*----------------
+    MetricsRegistry
+-----------------*/
+// 스레드별로 샤딩된 지표 저장소
+// 기록은 스레드 로컬 샤드의 셀에 더하기만 하고 (락, 원자적 RMW 없음), 읽을 때 모든 샤드를 합침
+// 스레드가 끝나면 샤드를 반납해 다음 스레드가 이어서 사용하므로 값이 사라지지 않음
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    // 같은 이름과 레이블이면 같은 지표를 반환 (등록은 락을 잡으므로 자주 쓰는 지표는 포인터를 보관할 것)
+    Counter* GetCounter(const std::string& name, const std::string& help, const std::string& labelKey = "", const std::string& labelValue = "");
+    Gauge* GetGauge(const std::string& name, const std::string& help, const std::string& labelKey = "", const std::string& labelValue = "");
+    MetricHistogram* GetHistogram(const std::string& name, const std::string& help, const std::string& labelKey = "", const std::string& labelValue = "");
+
+    const CoreMetrics& Core() const { return _core; }
+
+    // 이름, 레이블 순으로 정렬된 스냅샷 (전달한 벡터의 항목을 덮어써서 재사용)
+    void Snapshot(std::vector<MetricSnapshot>& snapshots);
+    std::string FormatText();
+
+    // 현재 스레드의 샤드 (처음 기록할 때 할당)
+    static MetricShard* LocalShard()
+    {
+        MetricShard* shard = LMetricShard;
+        return shard != nullptr ? shard : GMetrics->AcquireShard();
+    }
+
+    // 스레드 종료 시 호출 (ThreadManager::DestroyTLS)
+    void ReleaseShard();
+
+private:
+    struct MetricInfo
+    {
+        std::string name;
+        std::string help;
+        std::string labelKey;
+        std::string labelValue;
+        MetricType type;
+        uint32 cell;
+        void* handle;
+    };
+
+    MetricShard* AcquireShard();
+    MetricInfo* Register(MetricType type, const std::string& name, const std::string& help,
+        const std::string& labelKey, const std::string& labelValue, uint32 cellCount);
+    uint64 SumCell(uint32 cell) const;
+
+    std::mutex _lock;
+    std::map<std::string, MetricInfo> _metrics;    // 키: 이름 + 레이블 값
+    std::deque<Counter> _counters;                 // 반환한 포인터가 유지되도록 deque 사용
+    std::deque<Gauge> _gauges;
+    std::deque<MetricHistogram> _histograms;
+    uint32 _nextCell = MetricHistogram::CELL_COUNT; // 앞쪽 셀은 셀이 부족할 때 기록을 버리는 용도
+
+    std::vector<MetricShard*> _shards;             // 만든 모든 샤드 (반납된 샤드 포함)
+    std::vector<MetricShard*> _freeShards;
+
+    CoreMetrics _core;
+};
+
+inline void Counter::Inc(uint64 value)
+{
+    MetricsRegistry::LocalShard()->Add(_cell, value);
+}
+
+inline void Gauge::Add(int64 delta)
+{
+    // 음수는 2의 보수로 더해져 합산할 때 상쇄됨
+    MetricsRegistry::LocalShard()->Add(_cell, static_cast<uint64>(delta));
+}
+
+inline void MetricHistogram::Record(uint64 value)
+{
+    MetricShard* shard = MetricsRegistry::LocalShard();
+    shard->Add(_cell, 1);
+    shard->Add(_cell + 1, value);
+    shard->Add(_cell + 2 + static_cast<uint32>(std::bit_width(value)), 1);
+}
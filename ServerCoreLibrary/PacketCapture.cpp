@@ -0,0 +1,166 @@
+﻿#include "pch.h"
+#include "PacketCapture.h"
+#include <algorithm>
+
+namespace
+{
+    const char CAPTURE_MAGIC[8] = { 'P', 'K', 'T', 'C', 'A', 'P', '0', '1' };
+
+    int64 SteadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+PacketCapture::~PacketCapture()
+{
+    Stop();
+}
+
+bool PacketCapture::Start(const std::string& path)
+{
+    if (_thread.joinable()) {
+        std::cerr << "[Capture] Already capturing" << std::endl;
+        return false;
+    }
+
+    _file = fopen(path.c_str(), "wb");
+    if (_file == nullptr) {
+        std::cerr << "[Capture] Cannot open " << path << std::endl;
+        return false;
+    }
+
+    PacketCaptureFileHeader header;
+    ::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.startUnixNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    fwrite(&header, sizeof(header), 1, _file);
+
+    _packets = 0;
+    _bytes = 0;
+    _dropped = 0;
+    _startNs = SteadyNowNs();
+    _stopping = false;
+    _pending.clear();
+    _thread = std::thread([this]() { Run(); });
+    _capturing.store(true);
+
+    std::cout << "[Capture] Writing received packets to " << path << std::endl;
+    return true;
+}
+
+void PacketCapture::Stop()
+{
+    if (!_thread.joinable())
+        return;
+
+    // 새 기록을 막고 남은 버퍼를 모두 쓴 뒤 종료
+    _capturing.store(false);
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _stopping = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+
+    fclose(_file);
+    _file = nullptr;
+
+    std::cout << "[Capture] Stopped: " << _packets.load() << " packets, " << _bytes.load() << " bytes";
+    if (_dropped.load() > 0)
+        std::cout << ", " << _dropped.load() << " packets dropped (writer fell behind)";
+    std::cout << std::endl;
+}
+
+void PacketCapture::Record(uint32 sessionId, const BYTE* packet, uint16 size)
+{
+    PacketCaptureRecord record = { SteadyNowNs() - _startNs, sessionId };
+
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_pending.size() + sizeof(record) + size > MAX_PENDING_BYTES) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const BYTE* recordBytes = reinterpret_cast<const BYTE*>(&record);
+        _pending.insert(_pending.end(), recordBytes, recordBytes + sizeof(record));
+        _pending.insert(_pending.end(), packet, packet + size);
+    }
+
+    _packets.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void PacketCapture::Run()
+{
+    while (true)
+    {
+        bool stopping = false;
+        {
+            // 주기마다 버퍼를 맞바꿔 락을 잡는 시간은 교환 한 번뿐
+            std::unique_lock<std::mutex> lock(_lock);
+            _cv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]() { return _stopping; });
+            _writing.swap(_pending);
+            stopping = _stopping;
+        }
+
+        if (!_writing.empty()) {
+            fwrite(_writing.data(), 1, _writing.size(), _file);
+            _writing.clear();
+        }
+
+        if (stopping)
+            break;
+    }
+
+    fflush(_file);
+}
+
+bool PacketCapture::Load(const std::string& path, std::vector<CapturedPacket>& packets)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        std::cerr << "[Capture] Cannot open " << path << std::endl;
+        return false;
+    }
+
+    PacketCaptureFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || ::memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "[Capture] " << path << " is not a capture file" << std::endl;
+        fclose(file);
+        return false;
+    }
+
+    packets.clear();
+    while (true)
+    {
+        PacketCaptureRecord record;
+        PacketHeader packetHeader;
+        if (fread(&record, sizeof(record), 1, file) != 1 || fread(&packetHeader, sizeof(packetHeader), 1, file) != 1)
+            break;
+
+        if (packetHeader.size < sizeof(PacketHeader)) {
+            std::cerr << "[Capture] Corrupt record after " << packets.size() << " packets" << std::endl;
+            break;
+        }
+
+        CapturedPacket packet;
+        packet.timestampNs = record.timestampNs;
+        packet.sessionId = record.sessionId;
+        packet.data.resize(packetHeader.size);
+        ::memcpy(packet.data.data(), &packetHeader, sizeof(packetHeader));
+
+        // 쓰는 도중 끊긴 마지막 레코드는 버림
+        size_t body = packetHeader.size - sizeof(packetHeader);
+        if (fread(packet.data.data() + sizeof(packetHeader), 1, body, file) != body)
+            break;
+
+        packets.push_back(std::move(packet));
+    }
+    fclose(file);
+
+    // 시각은 락 밖에서 읽으므로 파일 안의 순서가 시각순과 조금 다를 수 있음
+    std::stable_sort(packets.begin(), packets.end(),
+        [](const CapturedPacket& a, const CapturedPacket& b) { return a.timestampNs < b.timestampNs; });
+    return true;
+}
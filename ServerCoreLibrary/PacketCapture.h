@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+
+/*
+    캡처 파일 형식 (리틀 엔디언, 추가만 함)
+    [PacketCaptureFileHeader]
+    [PacketCaptureRecord][패킷 (PacketHeader 포함, 크기는 PacketHeader::size)]
+    [PacketCaptureRecord][패킷]...
+*/
+#pragma pack(push, 1)
+struct PacketCaptureFileHeader
+{
+    char magic[8];              // "PKTCAP01"
+    int64 startUnixNs;          // 캡처 시작 시각 (system_clock, 참고용)
+};
+
+struct PacketCaptureRecord
+{
+    int64 timestampNs;          // 캡처 시작부터 받은 시각까지 (steady_clock)
+    uint32 sessionId;           // Session::GetSessionId
+};
+#pragma pack(pop)
+
+// 파일에서 읽은 패킷 하나
+struct CapturedPacket
+{
+    int64 timestampNs;
+    uint32 sessionId;
+    std::vector<BYTE> data;     // PacketHeader 포함
+};
+
+/*----------------
+    PacketCapture
+-----------------*/
+// PacketSession이 받은 패킷을 그대로 파일에 기록 (재생 도구 입력용)
+// io 스레드는 버퍼에 복사만 하고 파일 쓰기는 백그라운드 스레드가 담당, 밀린 양이 한도를 넘으면 버림
+class PacketCapture
+{
+public:
+    enum
+    {
+        MAX_PENDING_BYTES = 64 * 1024 * 1024,   // 쓰지 못하고 쌓아 둘 수 있는 최대 크기
+        FLUSH_INTERVAL_MS = 50,
+    };
+
+    PacketCapture() = default;
+    ~PacketCapture();
+
+    bool Start(const std::string& path);
+    void Stop();
+
+    bool IsCapturing() const { return _capturing.load(std::memory_order_relaxed); }
+
+    // packet은 PacketHeader로 시작하는 완전한 패킷
+    void Record(uint32 sessionId, const BYTE* packet, uint16 size);
+
+    // 캡처 파일 전체를 시각순으로 읽음
+    static bool Load(const std::string& path, std::vector<CapturedPacket>& packets);
+
+private:
+    void Run();
+
+private:
+    std::atomic<bool> _capturing = false;
+
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::vector<BYTE> _pending;         // io 스레드가 채우는 버퍼 (_lock)
+    bool _stopping = false;             // (_lock)
+    int64 _startNs = 0;
+
+    // 쓰기 스레드 전용
+    std::thread _thread;
+    FILE* _file = nullptr;
+    std::vector<BYTE> _writing;
+
+    // 통계
+    std::atomic<uint64> _packets = 0;
+    std::atomic<uint64> _bytes = 0;
+    std::atomic<uint64> _dropped = 0;
+};
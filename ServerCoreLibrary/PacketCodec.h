@@ -0,0 +1,208 @@
+﻿#pragma once
+#include "CorePch.h"
+#include "Session.h"
+#include "SendBuffer.h"
+#include <string_view>
+
+/*
+    Protocol.idl에서 생성한 패킷(Protocol.h)을 읽고 쓰는 틀
+    패킷 구조체는 1바이트 정렬이라 받은 버퍼를 복사 없이 그대로 읽고, 보낼 때도 SendBuffer에 바로 씀
+    크기와 ID가 모두 컴파일 타임 상수라 패킷마다 검사와 직렬화가 상수로 특수화됨
+*/
+
+// PacketHeader만 있는 패킷의 본문
+struct NoPacketBody
+{
+    static constexpr uint32 SIZE = 0;
+    static constexpr uint32 MIN_SIZE = 0;
+    static constexpr bool HAS_HEADER = false;
+};
+
+// 패킷 ID별 정의 (Protocol.h가 패킷마다 특수화: Body, TRAILING, NAME)
+template<uint16 Id>
+struct PacketTraits;
+
+// 런타임에 ID로 찾는 패킷 정보 (Protocol.h의 GPacketInfos)
+struct PacketInfo
+{
+    uint16 id;
+    const char* name;
+    uint32 minSize;         // PacketHeader 포함 최소 크기
+    uint32 maxSize;         // 뒤에 가변 데이터가 따라오면 UINT16_MAX
+};
+
+// 고정 길이 문자열 필드 읽기 (null이 없어도 필드 밖을 읽지 않음)
+template<size_t N>
+std::string_view PacketString(const char (&field)[N])
+{
+    return std::string_view(field, ::strnlen(field, N));
+}
+
+// 고정 길이 문자열 필드 쓰기 (넘치면 자르고 항상 null로 끝남)
+template<size_t N>
+void PacketCopyString(char (&field)[N], std::string_view value)
+{
+    size_t len = std::min(value.size(), N - 1);
+    memcpy(field, value.data(), len);
+    field[len] = '\0';
+}
+
+/*----------------
+    PacketReader
+-----------------*/
+// 받은 패킷 버퍼 위의 읽기 전용 뷰 (버퍼가 살아 있는 동안만 유효)
+// 본문 구조체가 PacketHeader로 시작하면(HAS_HEADER) 버퍼 처음부터, 아니면 PacketHeader 다음부터 본문
+template<uint16 Id>
+class PacketReader
+{
+public:
+    using Body = typename PacketTraits<Id>::Body;
+
+    static constexpr uint32 BODY_OFFSET = Body::HAS_HEADER ? 0 : sizeof(PacketHeader);
+    static constexpr uint32 MIN_PACKET_SIZE = BODY_OFFSET + Body::MIN_SIZE;
+    static constexpr uint32 MAX_PACKET_SIZE = PacketTraits<Id>::TRAILING ? UINT16_MAX : BODY_OFFSET + Body::SIZE;
+
+    PacketReader(const BYTE* buffer, int32 len) : _buffer(buffer), _len(len) {}
+
+    // 크기가 정의에 맞고 ID가 일치하는지 (Get/Tail 전에 확인할 것)
+    bool IsValid() const
+    {
+        return _len >= static_cast<int32>(MIN_PACKET_SIZE) && _len <= static_cast<int32>(MAX_PACKET_SIZE) && GetHeader()->id == Id;
+    }
+
+    const PacketHeader* GetHeader() const { return reinterpret_cast<const PacketHeader*>(_buffer); }
+    const Body& Get() const { return *reinterpret_cast<const Body*>(_buffer + BODY_OFFSET); }
+    const Body* operator->() const { return &Get(); }
+
+    // 고정 부분 뒤의 가변 데이터 (tail 필드 또는 본문 뒤에 따라오는 데이터)
+    const BYTE* Tail() const { return _buffer + MIN_PACKET_SIZE; }
+    uint32 TailSize() const { return static_cast<uint32>(_len) - MIN_PACKET_SIZE; }
+
+    const BYTE* Buffer() const { return _buffer; }
+    int32 Size() const { return _len; }
+
+private:
+    const BYTE* _buffer;
+    int32 _len;
+};
+
+/*----------------
+    PacketWriter
+-----------------*/
+// SendBuffer에 패킷을 바로 써서 만듦 (고정 부분은 0으로 채우고 헤더는 미리 기록)
+// SendBuffer는 스레드마다 하나만 열 수 있으므로 다음 패킷을 만들기 전에 Finish하거나 소멸시킬 것 (Finish 없이 소멸하면 버림)
+template<uint16 Id>
+class PacketWriter
+{
+public:
+    using Body = typename PacketTraits<Id>::Body;
+
+    static constexpr uint32 BODY_OFFSET = PacketReader<Id>::BODY_OFFSET;
+    static constexpr uint32 MIN_PACKET_SIZE = PacketReader<Id>::MIN_PACKET_SIZE;
+    static constexpr uint32 MAX_PACKET_SIZE = PacketReader<Id>::MAX_PACKET_SIZE;
+
+    // tailSize는 고정 부분 뒤에 쓸 가변 데이터 크기 (패킷이 최대 크기를 넘으면 IsValid가 false)
+    // site는 SendBuffer 할당 위치로 남길 호출 위치
+    explicit PacketWriter(uint32 tailSize = 0, const std::source_location& site = std::source_location::current())
+        : _size(MIN_PACKET_SIZE + tailSize)
+    {
+        if (tailSize > MAX_PACKET_SIZE - MIN_PACKET_SIZE)
+            return;
+
+        _sendBuffer = GSendBufferManager->Open(_size, site);
+        if (_sendBuffer == nullptr)
+            return;
+
+        BYTE* buffer = _sendBuffer->Buffer();
+        memset(buffer, 0, MIN_PACKET_SIZE);
+        PacketHeader* header = reinterpret_cast<PacketHeader*>(buffer);
+        header->size = static_cast<uint16>(_size);
+        header->id = Id;
+    }
+
+    ~PacketWriter()
+    {
+        if (_sendBuffer != nullptr)
+            _sendBuffer->Close(0);
+    }
+
+    PacketWriter(const PacketWriter&) = delete;
+    PacketWriter& operator=(const PacketWriter&) = delete;
+
+    bool IsValid() const { return _sendBuffer != nullptr; }
+
+    Body& Get() { return *reinterpret_cast<Body*>(_sendBuffer->Buffer() + BODY_OFFSET); }
+    Body* operator->() { return &Get(); }
+    BYTE* Tail() { return _sendBuffer->Buffer() + MIN_PACKET_SIZE; }
+    uint32 TailSize() const { return _size - MIN_PACKET_SIZE; }
+
+    // 다 쓴 패킷을 닫아 반환 (IsValid가 false면 nullptr)
+    SendBufferRef Finish()
+    {
+        if (_sendBuffer != nullptr)
+            _sendBuffer->Close(_size);
+        return std::move(_sendBuffer);
+    }
+
+private:
+    uint32 _size;
+    SendBufferRef _sendBuffer;
+};
+
+/*--------------------
+    PacketDispatcher
+--------------------*/
+// 패킷 ID로 색인하는 핸들러 표 (owner의 멤버 함수를 (const PacketReader<Id>&, Args...)로 호출)
+// 핸들러마다 PacketReader<Id>로 특수화된 함수가 만들어져 크기 검사까지 상수로 처리됨
+// 시작할 때 Register로 채운 뒤에는 읽기만 하므로 여러 스레드에서 동시에 Dispatch 가능
+template<typename Owner, typename... Args>
+class PacketDispatcher
+{
+public:
+    enum class Result
+    {
+        Handled,
+        Unknown,    // 등록된 핸들러가 없음
+        Invalid,    // 크기가 정의와 맞지 않음
+    };
+
+    template<uint16 Id, void (Owner::*Handler)(const PacketReader<Id>&, Args...)>
+    void Register()
+    {
+        if (_handlers.size() <= Id)
+            _handlers.resize(Id + 1, nullptr);
+        _handlers[Id] = &Invoke<Id, Handler>;
+    }
+
+    // 핸들러가 등록된 ID인지
+    bool IsRegistered(uint16 id) const { return id < _handlers.size() && _handlers[id] != nullptr; }
+
+    Result Dispatch(Owner& owner, const BYTE* buffer, int32 len, Args... args) const
+    {
+        if (len < static_cast<int32>(sizeof(PacketHeader)))
+            return Result::Invalid;
+
+        uint16 id = reinterpret_cast<const PacketHeader*>(buffer)->id;
+        if (id >= _handlers.size() || _handlers[id] == nullptr)
+            return Result::Unknown;
+
+        return _handlers[id](owner, buffer, len, args...) ? Result::Handled : Result::Invalid;
+    }
+
+private:
+    using Handler = bool (*)(Owner&, const BYTE*, int32, Args...);
+
+    template<uint16 Id, void (Owner::*Method)(const PacketReader<Id>&, Args...)>
+    static bool Invoke(Owner& owner, const BYTE* buffer, int32 len, Args... args)
+    {
+        PacketReader<Id> reader(buffer, len);
+        if (!reader.IsValid())
+            return false;
+
+        (owner.*Method)(reader, args...);
+        return true;
+    }
+
+private:
+    std::vector<Handler> _handlers;
+};
@@ -0,0 +1,176 @@
+﻿#include "pch.h"
+#include "PubSub.h"
+#include "Session.h"
+#include "SendBuffer.h"
+#include "Metrics.h"
+
+PubSub::PubSub(asio::io_context& ioc, uint32 shardCount)
+{
+    if (shardCount == 0)
+        shardCount = std::max(1u, std::thread::hardware_concurrency());
+
+    _shards.reserve(shardCount);
+    for (uint32 i = 0; i < shardCount; i++)
+        _shards.push_back(std::make_unique<Shard>(ioc));
+
+    _publishMetric = GMetrics->GetCounter("pubsub_publishes_total", "Messages published to topics");
+    _deliveryMetric = GMetrics->GetCounter("pubsub_deliveries_total", "Messages queued to topic subscribers");
+    _subscriptionMetric = GMetrics->GetGauge("pubsub_subscriptions", "Active topic subscriptions");
+}
+
+PubSub::~PubSub()
+{
+    // 남은 구독은 지표에서 제외
+    _subscriptionMetric->Add(-_subscriptionCount.load());
+}
+
+PubSub::TopicKey PubSub::MakeTopicKey(std::string_view name)
+{
+    uint64 hash = 14695981039346656037ull;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void PubSub::Subscribe(TopicKey topic, const SessionRef& session)
+{
+    Shard& shard = ShardOf(topic);
+    asio::post(shard.strand, [this, &shard, topic, session]()
+        {
+            AddSubscriber(shard, topic, session);
+        });
+}
+
+void PubSub::Unsubscribe(TopicKey topic, const SessionRef& session)
+{
+    Shard& shard = ShardOf(topic);
+    asio::post(shard.strand, [this, &shard, topic, session]()
+        {
+            RemoveSubscriber(shard, topic, session.get(), true);
+        });
+}
+
+void PubSub::UnsubscribeAll(const SessionRef& session)
+{
+    // 세션이 어느 샤드에 구독했는지 모르므로 모든 샤드에 넘김 (접속 종료 때 한 번뿐)
+    for (auto& shardPtr : _shards)
+    {
+        Shard& shard = *shardPtr;
+        asio::post(shard.strand, [this, &shard, session]()
+            {
+                auto it = shard.sessionTopics.find(session.get());
+                if (it == shard.sessionTopics.end())
+                    return;
+
+                std::vector<TopicKey> topics = std::move(it->second);
+                shard.sessionTopics.erase(it);
+                for (TopicKey topic : topics)
+                    RemoveSubscriber(shard, topic, session.get(), false);
+            });
+    }
+}
+
+void PubSub::Publish(TopicKey topic, SendBufferRef sendBuffer)
+{
+    Shard& shard = ShardOf(topic);
+    asio::post(shard.strand, [this, &shard, topic, sendBuffer = std::move(sendBuffer)]()
+        {
+            FanOut(shard, topic, sendBuffer);
+        });
+}
+
+void PubSub::AddSubscriber(Shard& shard, TopicKey topic, const SessionRef& session)
+{
+    if (!session->IsConnected())
+        return;
+
+    Topic& entry = shard.topics[topic];
+    auto [it, inserted] = entry.indices.emplace(session.get(), static_cast<uint32>(entry.subscribers.size()));
+    if (!inserted)
+        return;
+
+    entry.subscribers.push_back(session);
+    shard.sessionTopics[session.get()].push_back(topic);
+
+    _subscriptionCount.fetch_add(1, std::memory_order_relaxed);
+    _subscriptionMetric->Inc();
+}
+
+void PubSub::RemoveSubscriber(Shard& shard, TopicKey topic, Session* session, bool eraseReverse)
+{
+    auto topicIt = shard.topics.find(topic);
+    if (topicIt == shard.topics.end())
+        return;
+
+    Topic& entry = topicIt->second;
+    auto indexIt = entry.indices.find(session);
+    if (indexIt == entry.indices.end())
+        return;
+
+    // 마지막 구독자를 빈자리로 옮겨 배열을 연속으로 유지
+    uint32 index = indexIt->second;
+    entry.indices.erase(indexIt);
+    if (index != entry.subscribers.size() - 1)
+    {
+        entry.subscribers[index] = std::move(entry.subscribers.back());
+        entry.indices[entry.subscribers[index].get()] = index;
+    }
+    entry.subscribers.pop_back();
+
+    if (entry.subscribers.empty())
+        shard.topics.erase(topicIt);
+
+    if (eraseReverse)
+    {
+        auto reverseIt = shard.sessionTopics.find(session);
+        if (reverseIt != shard.sessionTopics.end())
+        {
+            std::vector<TopicKey>& topics = reverseIt->second;
+            topics.erase(std::find(topics.begin(), topics.end(), topic));
+            if (topics.empty())
+                shard.sessionTopics.erase(reverseIt);
+        }
+    }
+
+    _subscriptionCount.fetch_sub(1, std::memory_order_relaxed);
+    _subscriptionMetric->Dec();
+}
+
+void PubSub::FanOut(Shard& shard, TopicKey topic, const SendBufferRef& sendBuffer)
+{
+    _publishMetric->Inc();
+
+    auto topicIt = shard.topics.find(topic);
+    if (topicIt == shard.topics.end())
+    {
+        _publishCount.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    // 끊긴 세션은 모아 두었다가 순회가 끝난 뒤 제거 (순회 중에는 배열을 건드리지 않음)
+    std::vector<Session*> disconnected;
+    uint64 delivered = 0;
+    for (const SessionRef& session : topicIt->second.subscribers)
+    {
+        if (!session->IsConnected())
+        {
+            disconnected.push_back(session.get());
+            continue;
+        }
+
+        session->Send(sendBuffer);
+        delivered++;
+    }
+
+    _deliveryMetric->Inc(delivered);
+
+    for (Session* session : disconnected)
+        RemoveSubscriber(shard, topic, session, true);
+
+    // 발행 횟수가 보이면 그 발행의 전달 횟수도 보이도록 나중에 올림
+    _deliveryCount.fetch_add(delivered, std::memory_order_relaxed);
+    _publishCount.fetch_add(1, std::memory_order_release);
+}
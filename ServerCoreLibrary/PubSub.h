@@ -0,0 +1,81 @@
+﻿#pragma once
+#include "CorePch.h"
+#include <string_view>
+
+class Session;
+class SendBuffer;
+class Counter;
+class Gauge;
+using SessionRef = std::shared_ptr<Session>;
+using SendBufferRef = std::shared_ptr<SendBuffer>;
+
+/*----------------
+    PubSub
+-----------------*/
+// 토픽 구독과 발행 (Service::Broadcast를 토픽 단위로 나눈 것)
+// 토픽은 키에 따라 샤드로 나뉘고 샤드마다 strand 하나가 구독자 목록을 소유하므로 락이 없음
+// Subscribe/Unsubscribe/Publish는 해당 샤드에 작업을 넘기고 바로 돌아옴 (구독자 변동이 많아도 발행자가 기다리지 않음)
+// 같은 스레드에서 호출한 작업은 토픽마다 호출 순서대로 처리됨
+// io_context가 멈춘 뒤에 파괴할 것 (Service와 같이 넘긴 작업이 this를 사용)
+class PubSub
+{
+public:
+    using TopicKey = uint64;
+
+    // shardCount가 0이면 코어 수만큼
+    PubSub(asio::io_context& ioc, uint32 shardCount = 0);
+    ~PubSub();
+
+    // 문자열 토픽을 키로 변환 (FNV-1a, 정수 토픽과 섞어 쓸 때는 범위가 겹치지 않게 할 것)
+    static TopicKey MakeTopicKey(std::string_view name);
+
+    // 이미 구독 중이면 무시
+    void Subscribe(TopicKey topic, const SessionRef& session);
+    void Unsubscribe(TopicKey topic, const SessionRef& session);
+    // 세션의 모든 구독 해제 (OnDisconnected에서 호출, 호출하지 않아도 다음 발행 때 끊긴 세션은 빠짐)
+    void UnsubscribeAll(const SessionRef& session);
+
+    // sendBuffer는 Close까지 끝난 패킷 하나, 모든 구독자의 전송 큐가 같은 버퍼를 공유 (구독자별 복사 없음)
+    void Publish(TopicKey topic, SendBufferRef sendBuffer);
+
+    uint32 GetShardCount() const { return static_cast<uint32>(_shards.size()); }
+
+    // 통계 (샤드에서 처리를 마친 기준)
+    uint64 GetPublishCount() const { return _publishCount.load(std::memory_order_acquire); }
+    uint64 GetDeliveryCount() const { return _deliveryCount.load(std::memory_order_relaxed); }
+    int64 GetSubscriptionCount() const { return _subscriptionCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Topic
+    {
+        std::vector<SessionRef> subscribers;            // 발행할 때 순서대로 훑는 연속 배열
+        std::unordered_map<Session*, uint32> indices;   // subscribers 안의 위치 (제거할 때 마지막 원소와 맞바꿈)
+    };
+
+    struct Shard
+    {
+        Shard(asio::io_context& ioc) : strand(asio::make_strand(ioc)) {}
+
+        asio::strand<asio::io_context::executor_type> strand;
+        std::unordered_map<TopicKey, Topic> topics;
+        std::unordered_map<Session*, std::vector<TopicKey>> sessionTopics;  // UnsubscribeAll용 역색인
+    };
+
+    Shard& ShardOf(TopicKey topic) { return *_shards[topic % _shards.size()]; }
+
+    // 샤드 strand 안에서만 호출
+    void AddSubscriber(Shard& shard, TopicKey topic, const SessionRef& session);
+    void RemoveSubscriber(Shard& shard, TopicKey topic, Session* session, bool eraseReverse);
+    void FanOut(Shard& shard, TopicKey topic, const SendBufferRef& sendBuffer);
+
+private:
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    std::atomic<uint64> _publishCount = 0;
+    std::atomic<uint64> _deliveryCount = 0;
+    std::atomic<int64> _subscriptionCount = 0;
+
+    Counter* _publishMetric = nullptr;
+    Counter* _deliveryMetric = nullptr;
+    Gauge* _subscriptionMetric = nullptr;
+};
@@ -1,10 +1,44 @@
 #include "pch.h"
 #include "RecvBuffer.h"
+#include "Metrics.h"
 
-RecvBuffer::RecvBuffer(int32_t bufferSize) : _bufferSize(bufferSize)
+RecvBuffer::RecvBuffer(int32_t bufferSize, [[maybe_unused]] const std::source_location& site) : _bufferSize(bufferSize)
 {
     _capacity = bufferSize * BUFFER_COUNT;  // 10 ũ  
-    _buffer.resize(_capacity);  //  ޸ Ҵ
+
+#if !RECV_BUFFER_ON_DEMAND
+    Acquire(site);
+#endif
+}
+
+RecvBuffer::~RecvBuffer()
+{
+    if (_buffer != nullptr) {
+        GMemoryManager->Release(_buffer);
+        GMetrics->Core().recvBuffersHeld->Dec();
+    }
+}
+
+void RecvBuffer::Acquire(const std::source_location& site)
+{
+    if (_buffer != nullptr)
+        return;
+
+    _buffer = static_cast<BYTE*>(GMemoryManager->Allocate(_capacity, site));
+    _readPos = _writePos = 0;
+    GMetrics->Core().recvBuffersHeld->Inc();
+}
+
+bool RecvBuffer::Release()
+{
+    if (_buffer == nullptr || DataSize() > 0)
+        return false;
+
+    GMemoryManager->Release(_buffer);
+    _buffer = nullptr;
+    _readPos = _writePos = 0;
+    GMetrics->Core().recvBuffersHeld->Dec();
+    return true;
 }
 
 void RecvBuffer::Clean()
@@ -1,12 +1,37 @@
 #pragma once
 
+// 1̸   ۸ ޸ Ǯ ݳϰ Ͽ  Ͱ  ٽ 
+// ( ޸𸮰   ƴ϶     )
+// Windows IOCP 0Ʈ б⸦ ٷ ϷϹǷ   ۸  
+#ifndef RECV_BUFFER_ON_DEMAND
+#ifdef _WIN32
+#define RECV_BUFFER_ON_DEMAND 0
+#else
+#define RECV_BUFFER_ON_DEMAND 1
+#endif
+#endif
+
 class RecvBuffer
 {
-    enum { BUFFER_COUNT = 10 };
-
 public:
-    RecvBuffer(int32_t bufferSize);
-    ~RecvBuffer() = default;
+    enum
+    {
+        BUFFER_COUNT = 10,
+        DEFAULT_BUFFER_SIZE = 0x10000, // 64KB (ִ Ŷ ũ)
+        DEFAULT_CAPACITY = DEFAULT_BUFFER_SIZE * BUFFER_COUNT, // ޸ Ǯ  ũ  
+    };
+
+    RecvBuffer(int32_t bufferSize, const std::source_location& site = std::source_location::current());
+    ~RecvBuffer();
+
+    RecvBuffer(const RecvBuffer&) = delete;
+    RecvBuffer& operator=(const RecvBuffer&) = delete;
+
+    // ޸ Ǯ ۸  (̹  ƹ͵  )
+    void            Acquire(const std::source_location& site = std::source_location::current());
+    //   Ͱ   ۸ Ǯ ݳ
+    bool            Release();
+    bool            IsAcquired() const { return _buffer != nullptr; }
 
     void            Clean();
     bool            OnRead(int32_t numOfBytes);
@@ -22,5 +47,5 @@ private:
     int32_t         _bufferSize = 0;
     int32_t         _readPos = 0;
     int32_t         _writePos = 0;
-    std::vector<BYTE> _buffer;
-};
\ No newline at end of file
+    BYTE*           _buffer = nullptr;
+};
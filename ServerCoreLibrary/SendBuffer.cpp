@@ -6,8 +6,14 @@ SendBuffer::SendBuffer(std::shared_ptr<SendBufferChunk> owner, BYTE* buffer, uin
 {
 }
 
+SendBuffer::SendBuffer(std::shared_ptr<void> block, BYTE* buffer, uint32_t size)
+    : _bufferPtr(buffer), _allocSize(size), _writeSize(size), _block(std::move(block))
+{
+}
+
 void SendBuffer::Close(uint32_t writeSize)
 {
+    assert(_owner != nullptr);
     assert(_allocSize >= writeSize);
     _writeSize = writeSize;
     _owner->Close(writeSize);
@@ -27,7 +33,7 @@ void SendBufferChunk::Reset()
     _usedSize = 0;
 }
 
-std::shared_ptr<SendBuffer> SendBufferChunk::Open(uint32_t allocSize)
+std::shared_ptr<SendBuffer> SendBufferChunk::Open(uint32_t allocSize, const std::source_location& site)
 {
     // 1. ũ Ȯ
     assert(allocSize <= SEND_BUFFER_CHUNK_SIZE);
@@ -41,7 +47,7 @@ std::shared_ptr<SendBuffer> SendBufferChunk::Open(uint32_t allocSize)
     _open = true;
 
     // 4. ObjectPool  SendBuffer 
-    return ObjectPool<SendBuffer>::MakeShared(shared_from_this(), Buffer(), allocSize);
+    return ObjectPool<SendBuffer>::MakeShared(site, shared_from_this(), Buffer(), allocSize);
 }
 
 void SendBufferChunk::Close(uint32_t writeSize)
@@ -55,7 +61,7 @@ void SendBufferChunk::Close(uint32_t writeSize)
     SendBufferManager
 ----------------------*/
 
-std::shared_ptr<SendBuffer> SendBufferManager::Open(uint32_t size)
+std::shared_ptr<SendBuffer> SendBufferManager::Open(uint32_t size, const std::source_location& site)
 {
     // 1. 庰 SendBufferChunk Ȯ/Ҵ
     if (LSendBufferChunk == nullptr)
@@ -78,7 +84,7 @@ std::shared_ptr<SendBuffer> SendBufferManager::Open(uint32_t size)
     }
 
     // 4.  
-    return LSendBufferChunk->Open(size);
+    return LSendBufferChunk->Open(size, site);
 }
 
 std::shared_ptr<SendBufferChunk> SendBufferManager::Pop()
@@ -96,7 +102,7 @@ std::shared_ptr<SendBufferChunk> SendBufferManager::Pop()
     //return std::shared_ptr<SendBufferChunk>(new SendBufferChunk(), PushGlobal);
     
     // 2.  ûũ ʿϸ ObjectPool 
-    return ObjectPool<SendBufferChunk>::MakeShared();
+    return ObjectPool<SendBufferChunk>::MakeShared(std::source_location::current());
 }
 
 void SendBufferManager::Push(std::shared_ptr<SendBufferChunk> buffer)
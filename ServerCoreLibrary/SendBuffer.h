@@ -8,6 +8,8 @@ class SendBuffer
 {
 public:
     SendBuffer(std::shared_ptr<SendBufferChunk> owner, BYTE* buffer, uint32_t allocSize);
+    // б  ̽: block Ű  ޸𸮸    (̹  ¶ Close ʿ)
+    SendBuffer(std::shared_ptr<void> block, BYTE* buffer, uint32_t size);
     ~SendBuffer() = default;
 
     BYTE* Buffer() { return _bufferPtr; }
@@ -20,6 +22,7 @@ private:
     uint32_t        _allocSize = 0;   // Ҵ ũ
     uint32_t        _writeSize = 0;   //   ũ
     std::shared_ptr<SendBufferChunk> _owner;  //  ûũ
+    std::shared_ptr<void> _block;             // ̽ ϴ  ޸ (ûũ  )
 };
 
 /*--------------------
@@ -36,7 +39,7 @@ public:
     ~SendBufferChunk() = default;
 
     void                        Reset();
-    std::shared_ptr<SendBuffer> Open(uint32_t allocSize);
+    std::shared_ptr<SendBuffer> Open(uint32_t allocSize, const std::source_location& site);
     void                        Close(uint32_t writeSize);
 
     bool                        IsOpen() const { return _open; }
@@ -55,7 +58,8 @@ private:
 class SendBufferManager
 {
 public:
-    std::shared_ptr<SendBuffer> Open(uint32_t size);
+    // site ⺻ ڷ ȣ ġ  (MEMORY_DEBUG   )
+    std::shared_ptr<SendBuffer> Open(uint32_t size, const std::source_location& site = std::source_location::current());
 
 private:
     std::shared_ptr<SendBufferChunk> Pop();
@@ -2,6 +2,7 @@
 #include "Service.h"
 #include "Session.h"
 #include "Listener.h"
+#include "Metrics.h"
 
 #include "ThreadManager.h"
 
@@ -22,11 +23,15 @@ Service::~Service()
 
 void Service::CloseService()
 {
-    std::unique_lock<std::recursive_mutex> lock(_lock);
-    for (const auto& session : _sessions)
-        session->Disconnect("Service Close");
+    // Disconnect ReleaseSession _sessions Ƿ 纻 ȸ
+    std::set<SessionRef> sessions;
+    {
+        std::unique_lock<std::recursive_mutex> lock(_lock);
+        sessions.swap(_sessions);
+    }
 
-    _sessions.clear();
+    for (const auto& session : sessions)
+        session->Disconnect("Service Close");
 }
 
 void Service::Broadcast(std::shared_ptr<SendBuffer> sendBuffer)
@@ -133,16 +138,22 @@ void ServerService::StartAccept()
         session->GetSocket(),
         [this, session](const std::error_code& error)
         {
+            // CloseService acceptor  (ٽ ɸ    )
+            if (error == asio::error::operation_aborted)
+                return;
+
             if (!error)
             {
                 if (GetCurrentSessionCount() < GetMaxSessionCount())
                 {
+                    GMetrics->Core().serviceAccepts->Inc();
                     session->ProcessConnect();
                     //AddSession(session);
                 }
                 else
                 {
                     //   ʰǸ  ź
+                    GMetrics->Core().serviceRejects->Inc();
                     session->Disconnect("Max sessions");
                 }
             }
@@ -41,12 +41,17 @@ public:
     int32_t GetMaxSessionCount() const { return _maxSessionCount; }
     asio::io_context& GetIOContext() { return _ioc; }
 
+    // SO_BUSY_POLL applied to every new session socket (0: off, Linux only)
+    void SetSocketBusyPoll(int32_t microseconds) { _socketBusyPollUs = microseconds; }
+    int32_t GetSocketBusyPoll() const { return _socketBusyPollUs; }
+
 protected:
     asio::io_context& _ioc;
     ServiceType _type;
     NetAddress _netAddress;
     int32_t _maxSessionCount;
     int32_t _sessionCount = 0;
+    int32_t _socketBusyPollUs = 0;
     SessionFactory _sessionFactory;
     std::recursive_mutex _lock;
     std::set<SessionRef> _sessions;
@@ -2,10 +2,31 @@
 #include "Session.h"
 #include "Service.h"
 #include "SocketUtils.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "PacketCapture.h"
 #include <iostream>
 
+static std::atomic<uint32> SNextSessionId = 1;
+
+//  κ ī (θ 庰   Ʈ ã ΰ, Ŀ   ª ǥ ã)
+static Counter* DisconnectCounter(const char* cause)
+{
+    thread_local std::vector<std::pair<std::string, Counter*>> LDisconnectCounters;
+    for (const auto& [name, counter] : LDisconnectCounters)
+    {
+        if (name == cause)
+            return counter;
+    }
+
+    Counter* counter = GMetrics->GetCounter("session_disconnects_total", "Disconnects by cause", "cause", cause);
+    LDisconnectCounters.emplace_back(cause, counter);
+    return counter;
+}
+
 Session::Session(asio::io_context& ioc)
     : _socket(ioc)
+    , _sessionId(SNextSessionId.fetch_add(1))
     , _recvBuffer(BUFFER_SIZE)
 {
 }
@@ -13,6 +34,10 @@ Session::Session(asio::io_context& ioc)
 Session::~Session()
 {
     Disconnect("Destructor");
+
+    //  ϰ  ۴ ť ̿ 
+    if (!_sendQueue.empty())
+        GMetrics->Core().sendQueueDepth->Add(-static_cast<int64>(_sendQueue.size()));
 }
 
 void Session::Start()
@@ -21,25 +46,91 @@ void Session::Start()
 }
 
 void Session::Send(std::shared_ptr<SendBuffer> sendBuffer)
+{
+    PushSend(sendBuffer);
+}
+
+uint64 Session::PushSend(const SendBufferRef& sendBuffer)
 {
     // 1.   Ȯ
     if (!IsConnected())
-        return;
+        return 0;
 
+    uint64 sequence = 0;
     bool registerSend = false;
     {
         // 2.  ť  ߰ (    )
         std::lock_guard<std::mutex> lock(_sendLock);
         _sendQueue.push(sendBuffer);
+        sequence = ++_sendQueuedCount;
+        GMetrics->Core().sendQueueDepth->Inc();
+        TRACE_INSTANT(SendQueue, _sessionId, sendBuffer->WriteSize());
 
         // 3.    ƴϸ   ʿ
         if (_sendRegistered.exchange(true) == false)
             registerSend = true;
     }
 
+    GMetrics->Core().sessionPacketsOut->Inc();
+
     // 4. ʿ  
     if (registerSend)
         RegisterSend();
+
+    return sequence;
+}
+
+void Session::Send(std::shared_ptr<SendBuffer> header, std::shared_ptr<SendBuffer> body)
+{
+    //  ( ̽ )   Ŷ - ٸ Ŷ ̿  ʵ   ť ߰
+    if (!IsConnected())
+        return;
+
+    bool registerSend = false;
+    {
+        std::lock_guard<std::mutex> lock(_sendLock);
+        _sendQueue.push(header);
+        _sendQueue.push(body);
+        _sendQueuedCount += 2;
+        GMetrics->Core().sendQueueDepth->Add(2);
+        TRACE_INSTANT(SendQueue, _sessionId, header->WriteSize() + body->WriteSize());
+
+        if (_sendRegistered.exchange(true) == false)
+            registerSend = true;
+    }
+
+    GMetrics->Core().sessionPacketsOut->Inc();
+
+    if (registerSend)
+        RegisterSend();
+}
+
+void Session::SendBatch(const SendBufferRef* sendBuffers, size_t count)
+{
+    if (!IsConnected() || count == 0)
+        return;
+
+    bool registerSend = false;
+    {
+        std::lock_guard<std::mutex> lock(_sendLock);
+        int32_t bytes = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            _sendQueue.push(sendBuffers[i]);
+            bytes += sendBuffers[i]->WriteSize();
+        }
+        _sendQueuedCount += count;
+        GMetrics->Core().sendQueueDepth->Add(static_cast<int64>(count));
+        TRACE_INSTANT(SendQueue, _sessionId, bytes);
+
+        if (_sendRegistered.exchange(true) == false)
+            registerSend = true;
+    }
+
+    GMetrics->Core().sessionPacketsOut->Inc(count);
+
+    if (registerSend)
+        RegisterSend();
 }
 
 bool Session::Connect()
@@ -50,9 +141,10 @@ bool Session::Connect()
     if (auto service = GetService())
     {
         const NetAddress& address = service->GetNetAddress();
+        auto self = shared_from_this();  //     
         _socket.async_connect(
             address.GetEndpoint(),
-            [this](const std::error_code& error)
+            [this, self](const std::error_code& error)
             {
                 if (!error)
                 {
@@ -77,6 +169,15 @@ void Session::Disconnect(const char* cause)
     _socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
     _socket.close(ec);
 
+    //  ϷḦ ٸ ڷƾ з 
+    {
+        std::lock_guard<std::mutex> lock(_sendLock);
+        WakeSendWaiters(true);
+    }
+
+    GMetrics->Core().sessionsActive->Dec();
+    DisconnectCounter(cause)->Inc();
+
     OnDisconnected();
     if (auto service = GetService())
         service->ReleaseSession(GetSessionRef());
@@ -100,6 +201,26 @@ void Session::RegisterRecv()
     if (!IsConnected())
         return;
 
+#if RECV_BUFFER_ON_DEMAND
+    // ۸ ݳ    Ͱ     
+    if (!_recvBuffer.IsAcquired())
+    {
+        auto self = shared_from_this();
+        _socket.async_wait(asio::ip::tcp::socket::wait_read,
+            [this, self](const std::error_code& error)
+            {
+                if (error) {
+                    Disconnect("RegisterRecv Error");
+                    return;
+                }
+
+                _recvBuffer.Acquire();
+                RegisterRecv();
+            });
+        return;
+    }
+#endif
+
     // 2.   غ
     BYTE* buffer = _recvBuffer.WritePos();  // ͸  ġ
     int32_t len = _recvBuffer.FreeSize();   //   ִ 
@@ -112,14 +233,18 @@ void Session::RegisterRecv()
     );
 */
 
-    // 3. 񵿱  
+    // 3. 񵿱   (  ҵ  ƿ   )
+    auto self = shared_from_this();
     GetSocket().async_read_some(
         asio::buffer(buffer, len),
-        [this](const std::error_code& error, size_t bytesTransferred)
+        [this, self](const std::error_code& error, size_t bytesTransferred)
         {
             // 4.   
             if (!error)
             {
+                GMetrics->Core().sessionBytesIn->Inc(bytesTransferred);
+                TRACE_SCOPE(SessionRecv, _sessionId, bytesTransferred);
+
                 // 5. ۿ  ó
                 if (_recvBuffer.OnWrite(bytesTransferred))
                 {
@@ -134,8 +259,9 @@ void Session::RegisterRecv()
                         return;
                     }
 
-                    // 8.    ٽ  
+                    // 8.    ٽ   ( ¸  ݳ)
                     _recvBuffer.Clean();
+                    ReleaseRecvBufferIfIdle();
                     RegisterRecv();
                 }
             }
@@ -166,6 +292,7 @@ void Session::RegisterSend()
                 asio::buffer(buffer->Buffer(), buffer->WriteSize())
             );
         }
+        _sendInFlightCount = pendingBuffers.size();
     }
 
     // 3.  Ͱ     
@@ -174,9 +301,15 @@ void Session::RegisterSend()
         return;
     }
 
+    GMetrics->Core().sendQueueDepth->Add(-static_cast<int64>(pendingBuffers.size()));
+    GMetrics->Core().sendBatchBuffers->Record(pendingBuffers.size());
+    TRACE_INSTANT(SendWrite, _sessionId, pendingBuffers.size());
+
     // 4. 񵿱  
     auto self = shared_from_this();  //  
-    _socket.async_write_some(
+    // async_write  ۸    Ϸ  (κ   Ŷ ǵ ʵ)
+    asio::async_write(
+        _socket,
         sendBuffers,
         // pendingBuffers ݹ鿡 ĸó ( īƮ )
         [this, self, pendingBuffers](const std::error_code& error, size_t bytesTransferred) {
@@ -193,6 +326,15 @@ void Session::RegisterSend()
 void Session::ProcessConnect()
 {
     _connected.store(true);
+    GMetrics->Core().sessionsActive->Inc();
+
+    //   ٻ  ( ʰų     ˸)
+    if (int32_t busyPoll = GetService()->GetSocketBusyPoll(); busyPoll > 0)
+    {
+        static std::atomic<bool> SBusyPollWarned = false;
+        if (!SocketUtils::SetBusyPoll(_socket, busyPoll) && !SBusyPollWarned.exchange(true))
+            std::cerr << "[Session] SO_BUSY_POLL is not available on this socket" << std::endl;
+    }
 
     //  
     GetService()->AddSession(GetSessionRef());
@@ -200,8 +342,8 @@ void Session::ProcessConnect()
     //  ڵ忡 
     OnConnected();
 
-    //  
-    RegisterRecv();
+    //   (CoroutineSession 帧 )
+    Start();
 }
 
 void Session::ProcessDisconnect()
@@ -226,13 +368,28 @@ void Session::ProcessSend(size_t bytesTransferred)
         return;
     }
 
+    GMetrics->Core().sessionBytesOut->Inc(bytesTransferred);
+    TRACE_SCOPE(SendComplete, _sessionId, bytesTransferred);
+
     //  ڵ忡 
     OnSend(bytesTransferred);
 
-    std::lock_guard<std::mutex> lock(_sendLock);
-    if (_sendQueue.empty())
-        _sendRegistered.store(false);
-    else
+    // RegisterSend _sendLock Ƿ  Ǭ  ȣ
+    bool registerSend = false;
+    {
+        std::lock_guard<std::mutex> lock(_sendLock);
+        _sendWrittenCount += _sendInFlightCount;
+        _sendInFlightCount = 0;
+        if (!_sendWaiters.empty())
+            WakeSendWaiters(false);
+
+        if (_sendQueue.empty())
+            _sendRegistered.store(false);
+        else
+            registerSend = true;
+    }
+
+    if (registerSend)
         RegisterSend();
 }
 
@@ -250,17 +407,125 @@ void Session::HandleError(const std::error_code& error)
     }
 }
 
+void Session::WakeSendWaiters(bool all)
+{
+    // _sendLock  ¿ ȣ,  ڷƾ ڱ ⿡ ̾
+    for (size_t i = 0; i < _sendWaiters.size();)
+    {
+        if (all || _sendWaiters[i].sequence <= _sendWrittenCount)
+        {
+            asio::post(_socket.get_executor(), std::move(_sendWaiters[i].handler));
+            _sendWaiters[i] = std::move(_sendWaiters.back());
+            _sendWaiters.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+asio::awaitable<bool> Session::SendAsync(SendBufferRef sendBuffer, SendCompletion completion)
+{
+    uint64 sequence = PushSend(sendBuffer);
+    if (sequence == 0)
+        co_return false;
+
+    if (completion == SendCompletion::Queued)
+        co_return true;
+
+    //  ۱ Ͽ ų   
+    co_await asio::async_initiate<decltype(asio::use_awaitable), void()>(
+        [this, sequence](auto handler)
+        {
+            std::lock_guard<std::mutex> lock(_sendLock);
+            if (!IsConnected() || _sendWrittenCount >= sequence)
+                asio::post(_socket.get_executor(), std::move(handler));
+            else
+                _sendWaiters.push_back({ sequence, std::move(handler) });
+        },
+        asio::use_awaitable);
+
+    bool written = false;
+    {
+        std::lock_guard<std::mutex> lock(_sendLock);
+        written = _sendWrittenCount >= sequence;
+    }
+    co_return written;
+}
+
+asio::awaitable<void> Session::Sleep(std::chrono::steady_clock::duration duration)
+{
+    asio::steady_timer timer(_socket.get_executor(), duration);
+    std::error_code error;
+    co_await timer.async_wait(asio::redirect_error(asio::use_awaitable, error));
+}
+
+void Session::ReleaseRecvBufferIfIdle()
+{
+#if RECV_BUFFER_ON_DEMAND
+    // ó  Ŷ     ݳ  Ƿ ioctl  ư
+    if (_recvBuffer.DataSize() > 0)
+        return;
+
+    // Ͽ ̹  Ͱ   бⰡ ٷ Ƿ ۸  
+    // ޾  Ÿ Ǯ ݳߴ ٽ  ʵ, бⰡ ٷ   ݳ
+    std::error_code error;
+    if (_socket.available(error) > 0 || error)
+        return;
+
+    _recvBuffer.Release();
+#endif
+}
+
+asio::awaitable<bool> Session::RecvAsync()
+{
+    if (!IsConnected())
+        co_return false;
+
+    std::error_code error;
+#if RECV_BUFFER_ON_DEMAND
+    if (!_recvBuffer.IsAcquired())
+    {
+        co_await _socket.async_wait(asio::ip::tcp::socket::wait_read, asio::redirect_error(asio::use_awaitable, error));
+        if (error) {
+            Disconnect("RecvAsync Error");
+            co_return false;
+        }
+        _recvBuffer.Acquire();
+    }
+#endif
+
+    size_t bytesTransferred = co_await _socket.async_read_some(
+        asio::buffer(_recvBuffer.WritePos(), _recvBuffer.FreeSize()),
+        asio::redirect_error(asio::use_awaitable, error));
+
+    if (error) {
+        Disconnect("RecvAsync Error");
+        co_return false;
+    }
+
+    GMetrics->Core().sessionBytesIn->Inc(bytesTransferred);
+    if (!_recvBuffer.OnWrite(static_cast<int32_t>(bytesTransferred))) {
+        Disconnect("Read Overflow");
+        co_return false;
+    }
+    co_return true;
+}
+
 /* PacketSession Implementation */
 int32_t PacketSession::OnRecv(BYTE* buffer, int32_t len)
 {
     int32_t processLen = 0;
+    uint64 packetCount = 0;
+    bool capturing = GPacketCapture->IsCapturing();
 
     // ۿ ִ   Ŷ ó
     while (true)
     {
         // 1. ּ Ŷ  ũ Ȯ
         int32_t dataSize = len - processLen;
-        if (dataSize < sizeof(PacketHeader))
+        if (dataSize < static_cast<int32_t>(sizeof(PacketHeader)))
             break;
 
         // 2. Ŷ  
@@ -270,12 +535,72 @@ int32_t PacketSession::OnRecv(BYTE* buffer, int32_t len)
         if (dataSize < header->size)
             break;
 
-        // 4. Ŷ ó
-        OnRecvPacket(&buffer[processLen], header->size);
+        // 4. Ŷ ó (ĸó ̸ ó   )
+        if (capturing)
+            GPacketCapture->Record(GetSessionId(), &buffer[processLen], header->size);
+        {
+            TRACE_SCOPE(PacketDispatch, GetSessionId(), header->id);
+            OnRecvPacket(&buffer[processLen], header->size);
+        }
 
         // 5. ó  Ʈ
         processLen += header->size;
+        packetCount++;
     }
 
+    if (packetCount > 0)
+        GMetrics->Core().sessionPacketsIn->Inc(packetCount);
+
     return processLen;  // ó   ȯ
-}
\ No newline at end of file
+}
+
+/* CoroutineSession Implementation */
+void CoroutineSession::Start()
+{
+    Spawn([this]() -> asio::awaitable<void>
+        {
+            co_await Run();
+            Disconnect("Flow Finished");
+        });
+}
+
+asio::awaitable<CoroutineSession::PacketView> CoroutineSession::ReadPacket()
+{
+    RecvBuffer& recvBuffer = GetRecvBuffer();
+
+    //   Ŷ   Ƿ Һ
+    if (_lastPacketSize > 0) {
+        recvBuffer.OnRead(_lastPacketSize);
+        _lastPacketSize = 0;
+    }
+
+    while (true)
+    {
+        // ۿ  Ŷ     ġ 
+        int32_t dataSize = recvBuffer.DataSize();
+        if (dataSize >= static_cast<int32_t>(sizeof(PacketHeader)))
+        {
+            PacketHeader* header = reinterpret_cast<PacketHeader*>(recvBuffer.ReadPos());
+            if (header->size < sizeof(PacketHeader)) {
+                Disconnect("Invalid Packet Size");
+                co_return PacketView();
+            }
+
+            if (dataSize >= header->size)
+            {
+                if (GPacketCapture->IsCapturing())
+                    GPacketCapture->Record(GetSessionId(), recvBuffer.ReadPos(), header->size);
+                GMetrics->Core().sessionPacketsIn->Inc();
+
+                _lastPacketSize = header->size;
+                co_return PacketView{ recvBuffer.ReadPos(), header->size };
+            }
+        }
+
+        // ڶ Ͽ  ޾  (Clean ִ Ŷ ũ ̻   )
+        recvBuffer.Clean();
+        ReleaseRecvBufferIfIdle();
+        if (!co_await RecvAsync())
+            co_return PacketView();
+    }
+}
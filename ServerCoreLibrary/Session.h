@@ -20,16 +20,26 @@ class Session : public std::enable_shared_from_this<Session>
 
     enum
     {
-        BUFFER_SIZE = 0x10000, // 64KB
+        BUFFER_SIZE = RecvBuffer::DEFAULT_BUFFER_SIZE, // 64KB
     };
 
 public:
+    // SendAsync  
+    enum class SendCompletion
+    {
+        Queued,     //  ť  ٷ (Send )
+        Written,    // Ͽ    (帧 )
+    };
+
     Session(asio::io_context& ioc);
     virtual ~Session();
 
     /* External Interface */
-    void                Start();
+    virtual void        Start();
     void                Send(std::shared_ptr<SendBuffer> sendBuffer);
+    void                Send(std::shared_ptr<SendBuffer> header, std::shared_ptr<SendBuffer> body);
+    //  Ŷ   ,     ť ߰ (ƽ    ¿)
+    void                SendBatch(const SendBufferRef* sendBuffers, size_t count);
     bool                Connect();
     void                Disconnect(const char* cause);
 
@@ -41,8 +51,31 @@ public:
     NetAddress          GetAddress() { return _netAddress; }
     asio::ip::tcp::socket& GetSocket() { return _socket; }
     bool                IsConnected() { return _connected; }
+    uint32              GetSessionId() const { return _sessionId; }
+    //      ť  ִ
+    bool                IsSendIdle() const { return !_sendRegistered; }
     std::shared_ptr<Session> GetSessionRef() { return std::static_pointer_cast<Session>(shared_from_this()); }
 
+    /* ڷƾ ̽ (asio C++20 ڷƾ, Spawn  帧 ȿ co_await) */
+    //     false
+    asio::awaitable<bool> SendAsync(SendBufferRef sendBuffer, SendCompletion completion = SendCompletion::Queued);
+    asio::awaitable<void> Sleep(std::chrono::steady_clock::duration duration);
+
+    //   ⿡ ڷƾ 帧  (帧    )
+    // ׻ post ̷ ϹǷ   ä ȣص  (co_spawn io 忡 θ ٷ )
+    // ڷƾ  asio 庰 ĳÿ ϹǷ ܰ踶  Ҵ  
+    template<typename Flow>
+    void Spawn(Flow flow)
+    {
+        asio::co_spawn(_socket.get_executor(),
+            [self = shared_from_this(), flow = std::move(flow)]() mutable -> asio::awaitable<void>
+            {
+                co_await asio::post(co_await asio::this_coro::executor, asio::use_awaitable);
+                co_await flow();
+            },
+            asio::detached);
+    }
+
 private:
     void Dispatch(EventType type, size_t bytes);
 
@@ -67,8 +100,19 @@ private:
 
     void                HandleError(const std::error_code& error);
 
+    uint64              PushSend(const SendBufferRef& sendBuffer);
+    void                WakeSendWaiters(bool all);
+
+protected:
+    /* ڷƾ  (CoroutineSession) - ۿ    ޾ ,   false */
+    asio::awaitable<bool> RecvAsync();
+    //    Ͽ  ͵    ۸ Ǯ ݳ (RECV_BUFFER_ON_DEMAND)
+    void                ReleaseRecvBufferIfIdle();
+    RecvBuffer&         GetRecvBuffer() { return _recvBuffer; }
+
 private:
     asio::ip::tcp::socket      _socket;
+    uint32                     _sessionId;         // μ ȿ  ȣ (, α׿)
     NetAddress                 _netAddress;
     std::atomic<bool>          _connected = false;
 
@@ -78,6 +122,17 @@ private:
     std::mutex                 _sendLock;
     std::queue<std::shared_ptr<SendBuffer>> _sendQueue;
     std::atomic<bool>          _sendRegistered = false;
+
+    // SendCompletion::Written  (_sendLock) -   Ϸùȣ   
+    struct SendWaiter
+    {
+        uint64 sequence;
+        asio::any_completion_handler<void()> handler;
+    };
+    uint64                     _sendQueuedCount = 0;
+    uint64                     _sendWrittenCount = 0;
+    uint64                     _sendInFlightCount = 0;     //   async_write   
+    std::vector<SendWaiter>    _sendWaiters;
 };
 
 /*-----------------
@@ -101,6 +156,38 @@ public:
     }
 
 protected:
-    virtual int32_t OnRecv(BYTE* buffer, int32_t len) sealed;
-    virtual void OnRecvPacket(BYTE* buffer, int32_t len) abstract;
-};
\ No newline at end of file
+    virtual int32_t OnRecv(BYTE* buffer, int32_t len) final;
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) = 0;
+};
+
+/*-----------------
+    CoroutineSession
+------------------*/
+// Ǹ Run ڷƾ ϰ, Ŷ OnRecvPacket ݹ  ReadPacket  
+// 帧  ʴ  Ͽ  Ƿ   帧   ʿ 
+class CoroutineSession : public PacketSession
+{
+public:
+    //  Ŷ (PacketHeader ),  ReadPacket  ȿ,   buffer == nullptr
+    struct PacketView
+    {
+        BYTE* buffer = nullptr;
+        int32_t len = 0;
+    };
+
+    CoroutineSession(asio::io_context& ioc) : PacketSession(ioc) {}
+    virtual ~CoroutineSession() {}
+
+    virtual void Start() override;
+
+    asio::awaitable<PacketView> ReadPacket();
+
+protected:
+    //  ڵ忡 ,    
+    virtual asio::awaitable<void> Run() = 0;
+
+    virtual void OnRecvPacket(BYTE* buffer, int32_t len) override {}
+
+private:
+    int32_t _lastPacketSize = 0;     //  ۿ Һ   Ŷ
+};
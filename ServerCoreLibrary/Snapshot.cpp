@@ -0,0 +1,367 @@
+﻿#include "pch.h"
+#include "Snapshot.h"
+#include "SendBuffer.h"
+#include "Metrics.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SNAPSHOT_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    uint32 StrideOf(uint32 maxEntities)
+    {
+        return (maxEntities + 3) & ~3u;
+    }
+
+    void InitFrame(SnapshotFrame& frame, uint32 fieldCount, uint32 stride)
+    {
+        frame.frame = 0;
+        frame.columns.assign(static_cast<size_t>(fieldCount + 1) * stride, 0);
+    }
+}
+
+/*----------------
+    SnapshotRing
+-----------------*/
+SnapshotRing::SnapshotRing(uint32 fieldCount, uint32 maxEntities, uint32 historySize)
+    : _fieldCount(fieldCount), _maxEntities(maxEntities), _stride(StrideOf(maxEntities))
+{
+    assert(fieldCount > 0 && fieldCount <= MAX_FIELDS && historySize > 0);
+
+    InitFrame(_working, _fieldCount, _stride);
+    InitFrame(_empty, _fieldCount, _stride);
+    _history.resize(historySize);
+    for (SnapshotFrame& frame : _history)
+        InitFrame(frame, _fieldCount, _stride);
+
+    // 기준 프레임은 링 크기를 넘지 않으므로 캐시 배열은 재할당되지 않음 (반환한 참조가 Commit까지 유지)
+    _cache.reserve(historySize);
+    _masks.resize(_stride);
+
+    _encodeMetric = GMetrics->GetCounter("snapshot_delta_encodes_total", "Snapshot deltas encoded (one per distinct base frame per frame)");
+    _bytesMetric = GMetrics->GetCounter("snapshot_delta_bytes_total", "Bytes of encoded snapshot deltas before fan-out");
+}
+
+void SnapshotRing::Set(uint32 slot, uint32 field, uint32 value)
+{
+    assert(slot < _maxEntities && field < _fieldCount);
+    _working.columns[static_cast<size_t>(field) * _stride + slot] = value;
+    _working.columns[static_cast<size_t>(_fieldCount) * _stride + slot] = 1;
+}
+
+void SnapshotRing::Remove(uint32 slot)
+{
+    assert(slot < _maxEntities);
+
+    // 값도 지워 두어야 같은 슬롯에 다시 들어온 엔티티와 섞이지 않음
+    for (uint32 field = 0; field <= _fieldCount; field++)
+        _working.columns[static_cast<size_t>(field) * _stride + slot] = 0;
+}
+
+uint32 SnapshotRing::Commit()
+{
+    _frame++;
+    SnapshotFrame& frame = _history[_frame % _history.size()];
+    frame.frame = _frame;
+    frame.columns = _working.columns;  // 크기가 같아 재할당 없이 복사
+
+    _cache.clear();
+    return _frame;
+}
+
+bool SnapshotRing::HasFrame(uint32 frame) const
+{
+    return frame != 0 && frame <= _frame && _frame - frame < _history.size()
+        && _history[frame % _history.size()].frame == frame;
+}
+
+const SnapshotFrame& SnapshotRing::BaseOf(uint32 baseFrame) const
+{
+    return HasFrame(baseFrame) ? _history[baseFrame % _history.size()] : _empty;
+}
+
+const std::vector<SendBufferRef>& SnapshotRing::EncodeDelta(uint32 baseFrame, uint16 packetId)
+{
+    const SnapshotFrame& base = BaseOf(baseFrame);
+    for (const auto& [cachedBase, packets] : _cache)
+    {
+        if (cachedBase == base.frame)
+            return packets;
+    }
+
+    std::vector<SendBufferRef>& packets = _cache.emplace_back(base.frame, std::vector<SendBufferRef>()).second;
+    if (_frame == 0)
+        return packets;
+
+    // 1. 슬롯별로 바뀐 필드를 비트 마스크로 (생존 열이 바뀌면 SNAPSHOT_REMOVED 비트)
+    const SnapshotFrame& current = _history[_frame % _history.size()];
+    BuildMasks(current, base);
+
+    // 2. 바뀐 슬롯만 레코드로 써서 패킷에 바로 기록
+    const uint32* alive = &current.columns[static_cast<size_t>(_fieldCount) * _stride];
+    const uint16 fullMask = static_cast<uint16>((1u << _fieldCount) - 1);
+    const uint32 maxRecordSize = sizeof(SnapshotRecordHeader) + _fieldCount * sizeof(uint32);
+
+    SendBufferRef sendBuffer;
+    BYTE* write = nullptr;
+    BYTE* end = nullptr;
+    uint16 recordCount = 0;
+    uint64 totalBytes = 0;
+
+    auto closePacket = [&](bool last)
+        {
+            PacketHeader* header = reinterpret_cast<PacketHeader*>(sendBuffer->Buffer());
+            SnapshotDeltaHeader* deltaHeader = reinterpret_cast<SnapshotDeltaHeader*>(header + 1);
+            uint16 size = static_cast<uint16>(write - sendBuffer->Buffer());
+            header->size = size;
+            header->id = packetId;
+            deltaHeader->frame = _frame;
+            deltaHeader->baseFrame = base.frame;
+            deltaHeader->recordCount = recordCount;
+            deltaHeader->fieldCount = static_cast<uint8>(_fieldCount);
+            deltaHeader->flags = last ? SNAPSHOT_LAST_PACKET : 0;
+
+            sendBuffer->Close(size);
+            totalBytes += size;
+            packets.push_back(std::move(sendBuffer));
+        };
+
+    for (uint32 slot = 0; slot < _maxEntities; slot++)
+    {
+#ifdef SNAPSHOT_HAS_SSE2
+        // 바뀐 것이 없는 슬롯 8개를 한 번에 건너뜀
+        if ((slot & 7) == 0 && slot + 8 <= _stride)
+        {
+            __m128i masks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&_masks[slot]));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(masks, _mm_setzero_si128())) == 0xFFFF)
+            {
+                slot += 7;
+                continue;
+            }
+        }
+#endif
+        uint16 mask = _masks[slot];
+        if (mask == 0)
+            continue;
+
+        // 새로 들어온 엔티티는 모든 필드, 나간 엔티티는 제거 표시만
+        if (mask & SNAPSHOT_REMOVED)
+            mask = alive[slot] ? fullMask : static_cast<uint16>(SNAPSHOT_REMOVED);
+        else if (alive[slot] == 0)
+            continue;
+
+        if (sendBuffer == nullptr || static_cast<uint32>(end - write) < maxRecordSize || recordCount == UINT16_MAX)
+        {
+            if (sendBuffer != nullptr)
+                closePacket(false);
+
+            sendBuffer = GSendBufferManager->Open(MAX_PACKET_SIZE);
+            if (sendBuffer == nullptr)
+                break;
+
+            write = sendBuffer->Buffer() + sizeof(PacketHeader) + sizeof(SnapshotDeltaHeader);
+            end = sendBuffer->Buffer() + MAX_PACKET_SIZE;
+            recordCount = 0;
+        }
+
+        SnapshotRecordHeader record{ slot, mask };
+        ::memcpy(write, &record, sizeof(record));
+        write += sizeof(record);
+        for (uint32 bits = mask & fullMask; bits != 0; bits &= bits - 1)
+        {
+            uint32 field = std::countr_zero(bits);
+            ::memcpy(write, &current.columns[static_cast<size_t>(field) * _stride + slot], sizeof(uint32));
+            write += sizeof(uint32);
+        }
+        recordCount++;
+    }
+
+    // 바뀐 것이 없어도 기준이 링에서 밀려나기 전에 빈 델타를 보내 확인을 새 프레임으로 당김 (밀려나면 전체 상태를 다시 보내야 함)
+    if (sendBuffer == nullptr && base.frame != 0 && _frame - base.frame >= _history.size() / 2)
+    {
+        sendBuffer = GSendBufferManager->Open(MAX_PACKET_SIZE);
+        if (sendBuffer != nullptr)
+            write = sendBuffer->Buffer() + sizeof(PacketHeader) + sizeof(SnapshotDeltaHeader);
+    }
+
+    if (sendBuffer != nullptr)
+        closePacket(true);
+
+    _encodeMetric->Inc();
+    _bytesMetric->Inc(totalBytes);
+    return packets;
+}
+
+void SnapshotRing::BuildMasks(const SnapshotFrame& current, const SnapshotFrame& base)
+{
+    std::fill(_masks.begin(), _masks.end(), static_cast<uint16>(0));
+    for (uint32 field = 0; field < _fieldCount; field++)
+    {
+        size_t offset = static_cast<size_t>(field) * _stride;
+        CompareColumn(&current.columns[offset], &base.columns[offset], _stride, static_cast<uint16>(1u << field), _masks.data());
+    }
+
+    size_t aliveOffset = static_cast<size_t>(_fieldCount) * _stride;
+    CompareColumn(&current.columns[aliveOffset], &base.columns[aliveOffset], _stride, SNAPSHOT_REMOVED, _masks.data());
+}
+
+void SnapshotRing::CompareColumn(const uint32* current, const uint32* base, uint32 count, uint16 bit, uint16* masks)
+{
+    uint32 i = 0;
+
+#ifdef SNAPSHOT_HAS_SSE2
+    // 4슬롯씩 XOR해 0이 아닌 칸만 비트로 받음
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i diff = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i)));
+        uint32 changed = ~static_cast<uint32>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(diff, zero)))) & 0xF;
+        while (changed != 0)
+        {
+            masks[i + std::countr_zero(changed)] |= bit;
+            changed &= changed - 1;
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (current[i] != base[i])
+            masks[i] |= bit;
+    }
+}
+
+/*--------------------
+    SnapshotReceiver
+--------------------*/
+SnapshotReceiver::SnapshotReceiver(uint32 fieldCount, uint32 maxEntities, uint32 historySize)
+    : _fieldCount(fieldCount), _maxEntities(maxEntities), _stride(StrideOf(maxEntities))
+{
+    assert(fieldCount > 0 && fieldCount <= SnapshotRing::MAX_FIELDS && historySize > 0);
+
+    InitFrame(_empty, _fieldCount, _stride);
+    InitFrame(_last, _fieldCount, _stride);
+    _history.resize(historySize);
+    for (SnapshotFrame& frame : _history)
+        InitFrame(frame, _fieldCount, _stride);
+}
+
+bool SnapshotReceiver::Apply(const BYTE* payload, int32 len)
+{
+    if (len < static_cast<int32>(sizeof(SnapshotDeltaHeader)))
+        return false;
+
+    SnapshotDeltaHeader header;
+    ::memcpy(&header, payload, sizeof(header));
+    if (header.fieldCount != _fieldCount || header.frame == 0)
+        return false;
+
+    SnapshotFrame& target = _history[header.frame % _history.size()];
+
+    // 1. 프레임의 첫 패킷이면 기준 프레임을 복사해 시작
+    if (header.frame != _building)
+    {
+        if (header.frame <= _frame)
+            return false;
+
+        // 마지막으로 완성된 프레임의 칸이면 먼저 옮겨 둠 (프레임이 끝나지 않아도 Get과 기준 프레임으로 계속 씀)
+        if (target.frame == _frame && _frame != 0)
+        {
+            _last.frame = target.frame;
+            _last.columns.swap(target.columns);
+            target.frame = 0;
+        }
+
+        const SnapshotFrame* base = header.baseFrame == 0 ? &_empty : FindFrame(header.baseFrame);
+        if (base == nullptr || base == &target)
+            return false;
+
+        target.frame = 0;   // 완성될 때까지 기준으로 쓰지 않음
+        target.columns = base->columns;
+        _building = header.frame;
+    }
+
+    // 2. 레코드 적용
+    const BYTE* read = payload + sizeof(SnapshotDeltaHeader);
+    const BYTE* end = payload + len;
+    const uint16 fullMask = static_cast<uint16>((1u << _fieldCount) - 1);
+    for (uint16 i = 0; i < header.recordCount; i++)
+    {
+        SnapshotRecordHeader record;
+        if (end - read < static_cast<ptrdiff_t>(sizeof(record)))
+        {
+            _building = 0;
+            return false;
+        }
+        ::memcpy(&record, read, sizeof(record));
+        read += sizeof(record);
+
+        if (record.slot >= _maxEntities || (record.mask & ~fullMask & ~SNAPSHOT_REMOVED) != 0)
+        {
+            _building = 0;
+            return false;
+        }
+
+        if (record.mask & SNAPSHOT_REMOVED)
+        {
+            for (uint32 field = 0; field <= _fieldCount; field++)
+                target.columns[static_cast<size_t>(field) * _stride + record.slot] = 0;
+            continue;
+        }
+
+        if (end - read < static_cast<ptrdiff_t>(std::popcount(record.mask) * sizeof(uint32)))
+        {
+            _building = 0;
+            return false;
+        }
+
+        for (uint32 bits = record.mask; bits != 0; bits &= bits - 1)
+        {
+            uint32 field = std::countr_zero(bits);
+            ::memcpy(&target.columns[static_cast<size_t>(field) * _stride + record.slot], read, sizeof(uint32));
+            read += sizeof(uint32);
+        }
+        target.columns[static_cast<size_t>(_fieldCount) * _stride + record.slot] = 1;
+    }
+
+    if ((header.flags & SNAPSHOT_LAST_PACKET) == 0)
+        return false;
+
+    // 3. 마지막 패킷이면 프레임 완성
+    target.frame = header.frame;
+    _frame = header.frame;
+    _building = 0;
+    return true;
+}
+
+const SnapshotFrame* SnapshotReceiver::FindFrame(uint32 frame) const
+{
+    const SnapshotFrame& candidate = _history[frame % _history.size()];
+    if (candidate.frame == frame)
+        return &candidate;
+
+    return _last.frame == frame && frame != 0 ? &_last : nullptr;
+}
+
+const SnapshotFrame& SnapshotReceiver::CurrentFrame() const
+{
+    const SnapshotFrame* frame = _frame == 0 ? nullptr : FindFrame(_frame);
+    return frame != nullptr ? *frame : _empty;
+}
+
+bool SnapshotReceiver::IsAlive(uint32 slot) const
+{
+    return Get(slot, _fieldCount) != 0;
+}
+
+uint32 SnapshotReceiver::Get(uint32 slot, uint32 field) const
+{
+    if (slot >= _maxEntities || field > _fieldCount)
+        return 0;
+
+    return CurrentFrame().columns[static_cast<size_t>(field) * _stride + slot];
+}
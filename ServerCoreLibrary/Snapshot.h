@@ -0,0 +1,149 @@
+﻿#pragma once
+#include "CorePch.h"
+#include <bit>
+
+class SendBuffer;
+class Counter;
+using SendBufferRef = std::shared_ptr<SendBuffer>;
+
+/*
+    스냅샷 델타 패킷 (리틀 엔디언)
+    [PacketHeader][SnapshotDeltaHeader][레코드 x recordCount]
+    레코드 = [SnapshotRecordHeader][바뀐 필드 값(uint32) x popcount(mask)]
+    mask의 하위 비트가 필드 번호, SNAPSHOT_REMOVED면 값 없이 제거
+    한 프레임이 패킷 여러 개로 나뉘면 마지막 패킷에만 SNAPSHOT_LAST_PACKET
+*/
+#pragma pack(push, 1)
+struct SnapshotDeltaHeader
+{
+    uint32 frame;
+    uint32 baseFrame;       // 0이면 빈 상태 기준 (전체 상태)
+    uint16 recordCount;
+    uint8 fieldCount;
+    uint8 flags;
+};
+
+struct SnapshotRecordHeader
+{
+    uint32 slot;
+    uint16 mask;
+};
+#pragma pack(pop)
+
+enum : uint16
+{
+    SNAPSHOT_REMOVED = 0x8000,
+};
+
+enum : uint8
+{
+    SNAPSHOT_LAST_PACKET = 0x01,
+};
+
+// 한 프레임의 월드 상태 (필드별 열 배열, 마지막 열은 생존 여부)
+struct SnapshotFrame
+{
+    uint32 frame = 0;
+    std::vector<uint32> columns;
+};
+
+/*----------------
+    SnapshotRing
+-----------------*/
+// 최근 월드 상태를 프레임 단위로 보관하고, 클라이언트가 마지막으로 확인(ack)한 프레임 기준 델타를 만듦
+// 엔티티는 0..maxEntities-1 슬롯, 상태는 슬롯마다 uint32 필드 fieldCount개 (float는 비트 그대로 저장)
+// 상태를 필드별 열로 저장해 두 프레임 비교를 SIMD XOR로 4슬롯씩 처리
+// 같은 기준 프레임의 델타는 프레임마다 한 번만 만들어 그 프레임을 확인한 모든 클라이언트가 버퍼를 공유
+// 스레드 안전하지 않음 (월드 하나를 맡은 스레드에서만 사용)
+class SnapshotRing
+{
+public:
+    enum
+    {
+        MAX_FIELDS = 15,                // mask의 최상위 비트는 SNAPSHOT_REMOVED
+        MAX_PACKET_SIZE = 8192,         // 델타 패킷 하나의 최대 크기 (넘으면 패킷을 나눔)
+    };
+
+    // historySize는 클라이언트 확인이 늦어도 델타를 만들 수 있는 프레임 수 (그보다 오래되면 전체 상태를 보냄)
+    SnapshotRing(uint32 fieldCount, uint32 maxEntities, uint32 historySize = 32);
+
+    /* 작업 상태 (다음 Commit에 들어감) */
+    // 죽은 슬롯에 쓰면 새 엔티티로 취급
+    void Set(uint32 slot, uint32 field, uint32 value);
+    void SetFloat(uint32 slot, uint32 field, float value) { Set(slot, field, std::bit_cast<uint32>(value)); }
+    void Remove(uint32 slot);
+
+    // 작업 상태를 새 프레임으로 기록하고 프레임 번호 반환 (1부터)
+    uint32 Commit();
+
+    // 마지막 프레임을 baseFrame 기준 델타로 인코딩 (바뀐 것이 없으면 빈 목록이나 빈 델타 하나, 다음 Commit까지 유효)
+    // baseFrame이 링에 없으면 전체 상태, 같은 프레임 안에서 같은 기준은 캐시된 버퍼를 그대로 반환
+    const std::vector<SendBufferRef>& EncodeDelta(uint32 baseFrame, uint16 packetId);
+
+    uint32 GetFrame() const { return _frame; }
+    uint32 GetFieldCount() const { return _fieldCount; }
+    uint32 GetMaxEntities() const { return _maxEntities; }
+    // 델타 기준으로 쓸 수 있는 프레임인지
+    bool HasFrame(uint32 frame) const;
+
+    // 통계 (직전 Commit 이후)
+    uint32 GetEncodeCount() const { return static_cast<uint32>(_cache.size()); }
+
+private:
+    const SnapshotFrame& BaseOf(uint32 baseFrame) const;
+
+    void BuildMasks(const SnapshotFrame& current, const SnapshotFrame& base);
+    static void CompareColumn(const uint32* current, const uint32* base, uint32 count, uint16 bit, uint16* masks);
+
+private:
+    uint32 _fieldCount;
+    uint32 _maxEntities;
+    uint32 _stride;                         // 열 하나의 길이 (maxEntities를 4의 배수로 올림)
+
+    SnapshotFrame _working;
+    SnapshotFrame _empty;                   // 프레임 0 (아무도 없는 상태)
+    std::vector<SnapshotFrame> _history;    // frame % historySize
+    uint32 _frame = 0;
+
+    std::vector<std::pair<uint32, std::vector<SendBufferRef>>> _cache;  // 이번 프레임에 만든 델타 (기준 프레임별)
+    std::vector<uint16> _masks;             // 인코딩 작업 공간 (슬롯별 바뀐 필드)
+
+    Counter* _encodeMetric = nullptr;
+    Counter* _bytesMetric = nullptr;
+};
+
+/*--------------------
+    SnapshotReceiver
+--------------------*/
+// 받는 쪽: 델타 패킷을 기준 프레임에 적용해 최근 프레임들을 보관
+// 서버가 아직 확인을 못 받은 동안에는 예전 프레임 기준 델타가 오므로 기준 프레임을 historySize만큼 남겨 둠
+class SnapshotReceiver
+{
+public:
+    SnapshotReceiver(uint32 fieldCount, uint32 maxEntities, uint32 historySize = 32);
+
+    // payload는 PacketHeader 다음부터, 프레임이 완성되면 true (GetFrame을 서버에 확인으로 보낼 것)
+    // 프레임의 마지막 패킷이 아니거나, 기준 프레임이 없거나, 형식이 잘못되면 false
+    bool Apply(const BYTE* payload, int32 len);
+
+    // 마지막으로 완성된 프레임 (0이면 아직 없음)
+    uint32 GetFrame() const { return _frame; }
+    bool IsAlive(uint32 slot) const;
+    uint32 Get(uint32 slot, uint32 field) const;
+    float GetFloat(uint32 slot, uint32 field) const { return std::bit_cast<float>(Get(slot, field)); }
+
+private:
+    const SnapshotFrame* FindFrame(uint32 frame) const;
+    const SnapshotFrame& CurrentFrame() const;
+
+private:
+    uint32 _fieldCount;
+    uint32 _maxEntities;
+    uint32 _stride;
+
+    SnapshotFrame _empty;
+    SnapshotFrame _last;                    // 받는 중인 프레임이 마지막으로 완성된 프레임의 칸을 쓰게 되면 그 프레임을 여기로 옮김
+    std::vector<SnapshotFrame> _history;
+    uint32 _frame = 0;
+    uint32 _building = 0;                   // 패킷 여러 개로 나뉘어 받는 중인 프레임
+};
@@ -1,6 +1,10 @@
 #include "pch.h"
 #include "SocketUtils.h"
 
+#if defined(__linux__) && !defined(SO_BUSY_POLL)
+#define SO_BUSY_POLL 46
+#endif
+
 
 bool SocketUtils::SetReuseAddress(asio::ip::tcp::socket& socket, bool flag)
 {
@@ -16,6 +20,19 @@ bool SocketUtils::SetTcpNoDelay(asio::ip::tcp::socket& socket, bool flag)
     return !ec;
 }
 
+bool SocketUtils::SetBusyPoll(asio::ip::tcp::socket& socket, int32_t microseconds)
+{
+#ifdef SO_BUSY_POLL
+    // Linux only: recv on an empty socket polls the device queue this long before sleeping
+    // (values above net.core.busy_read need CAP_NET_ADMIN)
+    std::error_code ec;
+    socket.set_option(asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>(microseconds), ec);
+    return !ec;
+#else
+    return false;
+#endif
+}
+
 bool SocketUtils::SetLinger(asio::ip::tcp::socket& socket, bool onoff, int32_t linger_time)
 {
     std::error_code ec;
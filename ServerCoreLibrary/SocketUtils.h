@@ -11,6 +11,7 @@ public:
     static bool SetReceiveBufferSize(asio::ip::tcp::socket& socket, int32_t size);
     static bool SetSendBufferSize(asio::ip::tcp::socket& socket, int32_t size);
     static bool SetKeepAlive(asio::ip::tcp::socket& socket, bool flag);
+    static bool SetBusyPoll(asio::ip::tcp::socket& socket, int32_t microseconds);
 
     // Socket state
     static bool IsConnected(const asio::ip::tcp::socket& socket);
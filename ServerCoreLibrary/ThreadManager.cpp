@@ -1,6 +1,100 @@
 #include "pch.h"
 #include "ThreadManager.h"
 #include "CoreTLS.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include "Logger.h"
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+	// Names registered through SetThreadName, keyed by LThreadId (read back by trace dumps)
+	std::mutex GThreadNameLock;
+	std::map<uint32, std::string> GThreadNames;
+
+#ifndef _WIN32
+	// From linux/mempolicy.h (not every toolchain ships numaif.h)
+	enum { LINUX_MPOL_PREFERRED = 1 };
+#endif
+
+	bool PinToCpus(const std::vector<int32>& cpus)
+	{
+#ifdef _WIN32
+		// A thread can only be pinned inside one processor group; use the group of the first CPU
+		WORD group = static_cast<WORD>(cpus[0] / 64);
+		KAFFINITY mask = 0;
+		for (int32 cpu : cpus)
+		{
+			if (cpu / 64 == group)
+				mask |= KAFFINITY(1) << (cpu % 64);
+		}
+
+		GROUP_AFFINITY affinity = {};
+		affinity.Group = group;
+		affinity.Mask = mask;
+		return ::SetThreadGroupAffinity(::GetCurrentThread(), &affinity, nullptr) != FALSE;
+#else
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (int32 cpu : cpus)
+		{
+			if (cpu >= 0 && cpu < CPU_SETSIZE)
+				CPU_SET(cpu, &set);
+		}
+		return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#endif
+	}
+
+	bool PreferNumaNode(int32 node)
+	{
+#ifdef _WIN32
+		// Windows allocates from the node of the CPU that first touches a page, so pinning is enough
+		return true;
+#else
+		// Allocations fall back to other nodes instead of failing when this one is full
+		unsigned long mask[16] = {};
+		if (node < 0 || node >= static_cast<int32>(sizeof(mask) * 8))
+			return false;
+		mask[node / (sizeof(unsigned long) * 8)] = 1UL << (node % (sizeof(unsigned long) * 8));
+		return ::syscall(SYS_set_mempolicy, LINUX_MPOL_PREFERRED, mask, sizeof(mask) * 8) == 0;
+#endif
+	}
+
+	bool SetPriority(ThreadPriority priority)
+	{
+#ifdef _WIN32
+		int value = THREAD_PRIORITY_NORMAL;
+		switch (priority)
+		{
+		case ThreadPriority::Low: value = THREAD_PRIORITY_BELOW_NORMAL; break;
+		case ThreadPriority::High: value = THREAD_PRIORITY_ABOVE_NORMAL; break;
+		case ThreadPriority::Critical: value = THREAD_PRIORITY_HIGHEST; break;
+		default: break;
+		}
+		return ::SetThreadPriority(::GetCurrentThread(), value) != FALSE;
+#else
+		// Per-thread nice value (raising priority needs CAP_SYS_NICE)
+		int nice = 0;
+		switch (priority)
+		{
+		case ThreadPriority::Low: nice = 5; break;
+		case ThreadPriority::High: nice = -5; break;
+		case ThreadPriority::Critical: nice = -10; break;
+		default: break;
+		}
+		return ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), nice) == 0;
+#endif
+	}
+}
 
 ThreadManager::ThreadManager()
 {
@@ -13,12 +107,13 @@ ThreadManager::~ThreadManager()
 	Join();
 }
 
-void ThreadManager::Launch(std::function<void(void)> callback)
+void ThreadManager::Launch(std::function<void(void)> callback, const ThreadOptions& options)
 {
 	std::lock_guard<std::mutex> guard(_lock);
 	_threads.push_back(std::thread([=]()
 		{
 			InitTLS();
+			ApplyThreadOptions(options);
 			callback();
 			DestroyTLS();
 		}));
@@ -42,5 +137,221 @@ void ThreadManager::InitTLS()
 
 void ThreadManager::DestroyTLS()
 {
+	if (GMetrics)
+		GMetrics->ReleaseShard();
+	if (GTracer)
+		GTracer->ReleaseRing();
+	if (GLogger)
+		GLogger->ReleaseQueue();
+}
+
+void ThreadManager::ApplyThreadOptions(const ThreadOptions& options)
+{
+	if (!options.name.empty())
+		SetThreadName(options.name);
+
+	// Explicit CPUs win; a NUMA node alone pins to all of that node's CPUs
+	std::vector<int32> cpus = options.cpus;
+	if (options.numaNode >= 0)
+	{
+		std::vector<int32> nodeCpus = GetNumaNodeCpus(options.numaNode);
+		if (nodeCpus.empty())
+			std::cerr << "[Thread] NUMA node " << options.numaNode << " not found" << std::endl;
+		else if (cpus.empty())
+			cpus = nodeCpus;
+
+		if (!nodeCpus.empty() && !PreferNumaNode(options.numaNode))
+			std::cerr << "[Thread] Cannot set memory policy for NUMA node " << options.numaNode << std::endl;
+	}
+
+	if (!cpus.empty() && !PinToCpus(cpus))
+		std::cerr << "[Thread] Cannot pin thread " << LThreadId << " (" << options.name << ") to its CPU list" << std::endl;
+
+	if (options.priority != ThreadPriority::Normal && !SetPriority(options.priority))
+		std::cerr << "[Thread] Cannot change priority of thread " << LThreadId << " (" << options.name << ")" << std::endl;
+}
+
+void ThreadManager::SetThreadName(const std::string& name)
+{
+	{
+		std::lock_guard<std::mutex> guard(GThreadNameLock);
+		GThreadNames[LThreadId] = name;
+	}
+
+#ifdef _WIN32
+	// SetThreadDescription exists from Windows 10 1607 on, so look it up instead of linking it
+	using SetThreadDescriptionFn = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+	static SetThreadDescriptionFn setDescription = reinterpret_cast<SetThreadDescriptionFn>(
+		::GetProcAddress(::GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+	if (setDescription != nullptr)
+	{
+		std::wstring wide(name.begin(), name.end());
+		setDescription(::GetCurrentThread(), wide.c_str());
+	}
+#else
+	// The kernel keeps 15 characters plus the terminator
+	::pthread_setname_np(::pthread_self(), name.substr(0, 15).c_str());
+#endif
+}
+
+std::string ThreadManager::GetThreadName(uint32 threadId)
+{
+	std::lock_guard<std::mutex> guard(GThreadNameLock);
+	auto it = GThreadNames.find(threadId);
+	if (it == GThreadNames.end())
+		return "Thread " + std::to_string(threadId);
+	return it->second;
+}
+
+bool ThreadManager::ParseCpuList(const std::string& text, std::vector<int32>& cpus)
+{
+	cpus.clear();
+
+	std::stringstream stream(text);
+	std::string range;
+	while (std::getline(stream, range, ','))
+	{
+		if (range.empty())
+			continue;
+
+		size_t dash = range.find('-');
+		try
+		{
+			int32 first = std::stoi(range.substr(0, dash));
+			int32 last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+			if (first < 0 || last < first)
+				return false;
+
+			for (int32 cpu = first; cpu <= last; cpu++)
+				cpus.push_back(cpu);
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	return !cpus.empty();
+}
+
+int32 ThreadManager::GetCpuCount()
+{
+	uint32 count = std::thread::hardware_concurrency();
+	return count > 0 ? static_cast<int32>(count) : 1;
+}
+
+std::vector<int32> ThreadManager::GetNumaNodeCpus(int32 node)
+{
+	std::vector<int32> cpus;
+
+#ifdef _WIN32
+	GROUP_AFFINITY affinity = {};
+	if (!::GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity))
+		return cpus;
+
+	for (int32 bit = 0; bit < 64; bit++)
+	{
+		if (affinity.Mask & (KAFFINITY(1) << bit))
+			cpus.push_back(affinity.Group * 64 + bit);
+	}
+#else
+	std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+	std::string line;
+	if (file && std::getline(file, line))
+		ParseCpuList(line, cpus);
+#endif
+
+	return cpus;
+}
+
+void ThreadManager::RunIoContext(asio::io_context& ioc, const IoLoopOptions& options)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Labeled by thread id so each io thread shows up as its own series
+	std::string thread = std::to_string(LThreadId);
+	Counter* handlers = GMetrics->GetCounter("io_loop_handlers_total", "Handlers run by the io thread", "thread", thread);
+	Counter* busyNs = GMetrics->GetCounter("io_loop_busy_nanoseconds_total", "Time the io thread spent running ready handlers", "thread", thread);
+	Counter* waits = GMetrics->GetCounter("io_loop_waits_total", "Times the io thread blocked waiting for work", "thread", thread);
+	Counter* idleNs = GMetrics->GetCounter("io_loop_idle_nanoseconds_total", "Time the io thread spent blocked waiting for work", "thread", thread);
+	Counter* spinNs = GMetrics->GetCounter("io_loop_spin_nanoseconds_total", "Time the io thread spent busy polling for work", "thread", thread);
+	Counter* spinHits = GMetrics->GetCounter("io_loop_spin_hits_total", "Busy polls that found work before blocking", "thread", thread);
+	Gauge* windowGauge = GMetrics->GetGauge("io_loop_spin_window_microseconds", "Current busy poll window of the io thread", "thread", thread);
+
+	const int64 maxWindowNs = static_cast<int64>(options.busyPollUs) * 1000;
+	int64 windowNs = maxWindowNs;
+	int64 reportedWindowUs = 0;
+	auto reportWindow = [&]()
+		{
+			int64 windowUs = windowNs / 1000;
+			windowGauge->Add(windowUs - reportedWindowUs);
+			reportedWindowUs = windowUs;
+		};
+	reportWindow();
+
+	while (!ioc.stopped())
+	{
+		// Drain every ready handler and time the batch
+		auto start = Clock::now();
+		size_t count = ioc.poll();
+		if (count > 0)
+		{
+			handlers->Inc(count);
+			busyNs->Inc(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+			continue;
+		}
 
-}
\ No newline at end of file
+		// Nothing ready: spin for the window first so a handler arriving soon skips the blocking wake-up
+		if (windowNs > 0)
+		{
+			auto spinStart = Clock::now();
+			auto deadline = spinStart + std::chrono::nanoseconds(windowNs);
+			auto now = spinStart;
+			while (count == 0 && now < deadline && !ioc.stopped())
+			{
+				count = ioc.poll_one();
+				now = Clock::now();
+			}
+			spinNs->Inc(std::chrono::duration_cast<std::chrono::nanoseconds>(now - spinStart).count());
+
+			if (count > 0)
+			{
+				// The handler's run time is counted as spin; the next poll() picks up the rest as busy
+				handlers->Inc(count);
+				spinHits->Inc();
+				if (options.adaptive && windowNs < maxWindowNs)
+				{
+					windowNs = std::min(maxWindowNs, windowNs * 2);
+					reportWindow();
+				}
+				continue;
+			}
+
+			// Quiet for a whole window: halve it so an idle thread stops burning the core
+			if (options.adaptive)
+			{
+				windowNs /= 2;
+				reportWindow();
+			}
+		}
+
+		// Block for the next handler (its run time is counted as idle)
+		waits->Inc();
+		auto blockStart = Clock::now();
+		if (ioc.run_one() == 0)
+			break;
+		handlers->Inc();
+
+		int64 blockedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - blockStart).count();
+		idleNs->Inc(blockedNs);
+
+		// Work came back sooner than the largest window: spinning would have caught it, so widen again
+		if (options.adaptive && blockedNs < maxWindowNs && windowNs < maxWindowNs)
+		{
+			windowNs = std::min(maxWindowNs, std::max<int64>(windowNs * 2, 1000));
+			reportWindow();
+		}
+	}
+
+	windowGauge->Add(-reportedWindowUs);
+}
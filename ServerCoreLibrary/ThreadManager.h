@@ -1,17 +1,54 @@
 #pragma once
 
+enum class ThreadPriority : uint8
+{
+	Low,
+	Normal,
+	High,
+	Critical,
+};
+
+// Placement and identity for a launched thread (every field is optional)
+struct ThreadOptions
+{
+	std::string				name;				// Shown in debuggers, top -H and trace dumps (Linux keeps 15 chars)
+	std::vector<int32>		cpus;				// Logical CPUs the thread may run on (empty: no restriction)
+	int32					numaNode = -1;		// Restrict to this node's CPUs and prefer node-local memory (-1: off)
+	ThreadPriority			priority = ThreadPriority::Normal;
+};
+
+// How RunIoContext waits once the io_context has no ready handlers
+struct IoLoopOptions
+{
+	uint32					busyPollUs = 0;		// Spin on poll() up to this long before blocking (0: block right away)
+	bool					adaptive = true;	// Size the spin window from recent idle gaps instead of always spinning busyPollUs
+};
+
 class ThreadManager
 {
 public:
 	ThreadManager();
 	~ThreadManager();
 
-	void	Launch(std::function<void(void)> callback);
+	void	Launch(std::function<void(void)> callback, const ThreadOptions& options = {});
 	void	Join();
 
 	static void InitTLS();
 	static void DestroyTLS();
 
+	// Applies options to the calling thread; failures are reported and the thread keeps running unpinned
+	static void ApplyThreadOptions(const ThreadOptions& options);
+	static void SetThreadName(const std::string& name);
+	static std::string GetThreadName(uint32 threadId);
+
+	// "0-3,8,10-11" -> { 0, 1, 2, 3, 8, 10, 11 }; returns false on malformed input
+	static bool ParseCpuList(const std::string& text, std::vector<int32>& cpus);
+	static int32 GetCpuCount();
+	static std::vector<int32> GetNumaNodeCpus(int32 node);
+
+	// Runs ioc like io_context::run, recording per-thread busy, spin and idle time
+	static void RunIoContext(asio::io_context& ioc, const IoLoopOptions& options = {});
+
 private:
 	std::mutex					_lock;
 	std::vector<std::thread>	_threads;
@@ -0,0 +1,170 @@
+﻿#include "pch.h"
+#include "Tracer.h"
+#include "ThreadManager.h"
+#include <fstream>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define TRACER_HAS_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace
+{
+    const char* EventName(TraceEventId id)
+    {
+        static const char* names[] =
+        {
+            "SessionRecv",
+            "PacketDispatch",
+            "SendQueue",
+            "SendWrite",
+            "SendComplete",
+            "FileRead",
+            "FileWrite",
+            "WorldTick",
+        };
+        static_assert(std::size(names) == static_cast<size_t>(TraceEventId::Count));
+
+        uint16 index = static_cast<uint16>(id);
+        return index < std::size(names) ? names[index] : "Unknown";
+    }
+}
+
+Tracer::Tracer()
+    : _baseTicks(Now())
+    , _baseTime(std::chrono::steady_clock::now())
+{
+}
+
+Tracer::~Tracer()
+{
+    for (TraceRing* ring : _rings)
+        delete ring;
+}
+
+uint64 Tracer::Now()
+{
+#ifdef TRACER_HAS_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+TraceRing* Tracer::AcquireRing()
+{
+    std::lock_guard<std::mutex> guard(_lock);
+
+    TraceRing* ring = nullptr;
+    if (!_freeRings.empty()) {
+        // 이벤트마다 스레드 ID가 있으므로 끝난 스레드의 링을 이어서 사용해도 구분됨
+        ring = _freeRings.back();
+        _freeRings.pop_back();
+    }
+    else {
+        ring = new TraceRing();
+        _rings.push_back(ring);
+    }
+
+    LTraceRing = ring;
+    return ring;
+}
+
+void Tracer::ReleaseRing()
+{
+    TraceRing* ring = LTraceRing;
+    if (ring == nullptr)
+        return;
+
+    LTraceRing = nullptr;
+
+    std::lock_guard<std::mutex> guard(_lock);
+    _freeRings.push_back(ring);
+}
+
+bool Tracer::DumpChromeTrace(const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[Tracer] Cannot open " << path << std::endl;
+        return false;
+    }
+
+    // 1. 기준점 이후 흐른 시간으로 틱 -> 마이크로초 비율 보정 (TSC 주파수를 따로 알 필요 없음)
+    uint64 nowTicks = Now();
+    auto nowTime = std::chrono::steady_clock::now();
+    double elapsedUs = std::chrono::duration<double, std::micro>(nowTime - _baseTime).count();
+    double usPerTick = nowTicks > _baseTicks && elapsedUs > 0 ? elapsedUs / static_cast<double>(nowTicks - _baseTicks) : 0.001;
+
+    // 2. 링마다 head를 읽고 복사한 뒤 다시 읽어, 복사 중에 덮어쓰였을 수 있는 앞부분은 버림
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        for (TraceRing* ring : _rings)
+        {
+            uint64 head = ring->head.load(std::memory_order_acquire);
+            uint64 first = head > TraceRing::CAPACITY ? head - TraceRing::CAPACITY : 0;
+
+            size_t offset = events.size();
+            for (uint64 i = first; i < head; i++)
+                events.push_back(ring->events[i & (TraceRing::CAPACITY - 1)]);
+
+            uint64 headAfter = ring->head.load(std::memory_order_acquire);
+            uint64 validFirst = headAfter > TraceRing::CAPACITY ? headAfter - TraceRing::CAPACITY : 0;
+            if (validFirst > first) {
+                size_t torn = static_cast<size_t>(std::min(validFirst, head) - first);
+                events.erase(events.begin() + offset, events.begin() + offset + torn);
+            }
+        }
+    }
+
+    // 3. trace_event JSON (구간은 "X", 즉시 이벤트는 "i")
+    std::set<uint16> threads;
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    char line[320];
+    for (const TraceEvent& event : events)
+    {
+        threads.insert(event.threadId);
+
+        double ts = static_cast<double>(event.begin - _baseTicks) * usPerTick;
+        int len = 0;
+        if (event.end != event.begin) {
+            double dur = static_cast<double>(event.end - event.begin) * usPerTick;
+            len = snprintf(line, sizeof(line),
+                "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"session\":%u,\"arg\":%llu}}",
+                first ? "" : ",\n", EventName(event.id), ts, dur, event.threadId, event.sessionId, static_cast<unsigned long long>(event.arg));
+        }
+        else {
+            len = snprintf(line, sizeof(line),
+                "%s{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"session\":%u,\"arg\":%llu}}",
+                first ? "" : ",\n", EventName(event.id), ts, event.threadId, event.sessionId, static_cast<unsigned long long>(event.arg));
+        }
+        file.write(line, len);
+        first = false;
+    }
+
+    for (uint16 threadId : threads)
+    {
+        // ThreadManager::SetThreadName으로 붙인 이름 (없으면 "Thread N")
+        std::string name = ThreadManager::GetThreadName(threadId);
+        int len = snprintf(line, sizeof(line),
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", threadId, name.c_str());
+        file.write(line, len);
+        first = false;
+    }
+    file << "\n]}\n";
+
+    if (!file.good()) {
+        std::cerr << "[Tracer] Failed to write " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "[Tracer] Wrote " << events.size() << " events to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,142 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// 0으로 정의하면 계측 매크로가 빈 문장이 되어 인자도 평가하지 않음
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+enum class TraceEventId : uint16
+{
+    SessionRecv,        // 수신 완료 후 패킷 처리까지 (arg: 받은 바이트)
+    PacketDispatch,     // OnRecvPacket 한 번 (arg: 패킷 ID)
+    SendQueue,          // Send로 큐에 추가 (arg: 버퍼 크기)
+    SendWrite,          // async_write 등록 (arg: 모아 보낸 버퍼 수)
+    SendComplete,       // 전송 완료 처리 (arg: 보낸 바이트)
+    FileRead,           // 파일 데이터 읽기 (arg: 바이트)
+    FileWrite,          // 파일 데이터 쓰기 (arg: 바이트)
+    WorldTick,          // 월드 한 틱 (arg: 틱 번호)
+    Count,
+};
+
+// 32바이트 고정 크기 이벤트 (시간은 Tracer::Now의 틱 단위)
+struct TraceEvent
+{
+    uint64 begin;
+    uint64 end;         // 즉시 이벤트는 begin과 같음
+    uint64 arg;
+    uint32 sessionId;
+    TraceEventId id;
+    uint16 threadId;
+};
+
+/*----------------
+    TraceRing
+-----------------*/
+// 스레드 하나가 기록하는 링 버퍼 (가득 차면 가장 오래된 이벤트를 덮어씀)
+// 쓰는 쪽은 주인 스레드 하나뿐이라 head만 release로 올리고, 덤프는 head를 앞뒤로 읽어 덮어쓰인 구간을 버림
+struct TraceRing
+{
+    enum { CAPACITY = 1 << 14 };
+
+    std::atomic<uint64> head = 0;
+    std::array<TraceEvent, CAPACITY> events;
+
+    void Push(const TraceEvent& event)
+    {
+        uint64 index = head.load(std::memory_order_relaxed);
+        events[index & (CAPACITY - 1)] = event;
+        head.store(index + 1, std::memory_order_release);
+    }
+};
+
+/*----------------
+    Tracer
+-----------------*/
+// 스레드별 링 버퍼에 이벤트를 모아 두었다가 Chrome trace_event JSON으로 덤프
+// 기록 비용은 TSC 읽기와 링 버퍼 쓰기 한 번, 꺼져 있으면 플래그 확인 한 번
+class Tracer
+{
+public:
+    Tracer();
+    ~Tracer();
+
+    void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    // x64는 TSC, 그 외에는 steady_clock 나노초
+    static uint64 Now();
+
+    static void Record(TraceEventId id, uint32 sessionId, uint64 arg, uint64 begin, uint64 end)
+    {
+        LocalRing()->Push({ begin, end, arg, sessionId, id, static_cast<uint16>(LThreadId) });
+    }
+
+    void RecordInstant(TraceEventId id, uint32 sessionId, uint64 arg)
+    {
+        uint64 now = Now();
+        Record(id, sessionId, arg, now, now);
+    }
+
+    // 지금까지 링에 남아 있는 이벤트를 파일로 (기록 중에도 호출 가능)
+    bool DumpChromeTrace(const std::string& path);
+
+    // 스레드 종료 시 호출 (ThreadManager::DestroyTLS)
+    void ReleaseRing();
+
+private:
+    static TraceRing* LocalRing()
+    {
+        TraceRing* ring = LTraceRing;
+        return ring != nullptr ? ring : GTracer->AcquireRing();
+    }
+
+    TraceRing* AcquireRing();
+
+    std::atomic<bool> _enabled = false;
+
+    std::mutex _lock;
+    std::vector<TraceRing*> _rings;             // 만든 모든 링 (반납된 링 포함, 덤프 대상)
+    std::vector<TraceRing*> _freeRings;
+
+    // 틱을 시간으로 바꾸기 위한 기준점
+    uint64 _baseTicks;
+    std::chrono::steady_clock::time_point _baseTime;
+};
+
+/*----------------
+    TraceScope
+-----------------*/
+// 생성부터 소멸까지를 하나의 구간 이벤트로 기록
+class TraceScope
+{
+public:
+    TraceScope(TraceEventId id, uint32 sessionId, uint64 arg)
+        : _begin(GTracer->IsEnabled() ? Tracer::Now() : 0), _arg(arg), _sessionId(sessionId), _id(id)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (_begin != 0)
+            Tracer::Record(_id, _sessionId, _arg, _begin, Tracer::Now());
+    }
+
+private:
+    uint64 _begin;
+    uint64 _arg;
+    uint32 _sessionId;
+    TraceEventId _id;
+};
+
+#if TRACE_ENABLED
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(id, sessionId, arg) TraceScope TRACE_CONCAT(traceScope, __LINE__)(TraceEventId::id, sessionId, arg)
+#define TRACE_INSTANT(id, sessionId, arg) do { if (GTracer->IsEnabled()) GTracer->RecordInstant(TraceEventId::id, sessionId, arg); } while (0)
+#else
+#define TRACE_SCOPE(id, sessionId, arg) ((void)0)
+#define TRACE_INSTANT(id, sessionId, arg) ((void)0)
+#endif
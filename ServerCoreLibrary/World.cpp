@@ -0,0 +1,246 @@
+﻿#include "pch.h"
+#include "World.h"
+#include "Metrics.h"
+#include "Tracer.h"
+#include <algorithm>
+
+/*----------------
+    World
+-----------------*/
+World::World(const std::string& name) : _name(name)
+{
+    _droppedMetric = GMetrics->GetCounter("world_inbox_dropped_total", "Packets dropped because a world inbox was full", "world", name);
+    _drainedMetric = GMetrics->GetHistogram("world_inbox_batch_messages", "Inbox messages handled per tick", "world", name);
+}
+
+World::~World()
+{
+    // 처리하지 못한 메시지 정리
+    WorldMessage* message = _inbox.exchange(nullptr, std::memory_order_acquire);
+    while (message != nullptr)
+    {
+        WorldMessage* next = message->next;
+        DestroyMessage(message);
+        message = next;
+    }
+}
+
+void World::PostJoin(const SessionRef& session)
+{
+    Post(WorldMessage::Type::Join, session, nullptr, 0);
+}
+
+void World::PostLeave(const SessionRef& session)
+{
+    Post(WorldMessage::Type::Leave, session, nullptr, 0);
+}
+
+void World::PostPacket(const SessionRef& session, const BYTE* packet, int32 len)
+{
+    Post(WorldMessage::Type::Packet, session, packet, len);
+}
+
+void World::Post(WorldMessage::Type type, const SessionRef& session, const BYTE* packet, int32 len)
+{
+    // 틱 스레드가 밀리면 패킷만 버림 (입장/퇴장을 버리면 월드 상태가 어긋남)
+    if (type == WorldMessage::Type::Packet && _pendingPackets.fetch_add(1, std::memory_order_relaxed) >= MAX_PENDING_PACKETS)
+    {
+        _pendingPackets.fetch_sub(1, std::memory_order_relaxed);
+        _droppedPackets.fetch_add(1, std::memory_order_relaxed);
+        _droppedMetric->Inc();
+        return;
+    }
+
+    void* memory = GMemoryManager->Allocate(static_cast<uint32>(sizeof(WorldMessage) + len));
+    WorldMessage* message = new(memory)WorldMessage{ nullptr, session, type, len }; // placement new
+    if (len > 0)
+        ::memcpy(message->Data(), packet, len);
+
+    // 락 없는 스택에 추가 (틱 스레드는 exchange로 통째로 가져감)
+    WorldMessage* head = _inbox.load(std::memory_order_relaxed);
+    do
+    {
+        message->next = head;
+    } while (!_inbox.compare_exchange_weak(head, message, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void World::Tick(uint64 tick, float deltaSeconds)
+{
+    TRACE_SCOPE(WorldTick, 0, tick);
+    _currentTick = tick;
+
+    // 1. 인박스를 한 번에 떼어 와 도착 순서로 뒤집음
+    WorldMessage* message = _inbox.exchange(nullptr, std::memory_order_acquire);
+    WorldMessage* ordered = nullptr;
+    while (message != nullptr)
+    {
+        WorldMessage* next = message->next;
+        message->next = ordered;
+        ordered = message;
+        message = next;
+    }
+
+    // 2. 입력 처리
+    uint64 drained = 0;
+    int32 packets = 0;
+    for (message = ordered; message != nullptr; )
+    {
+        WorldMessage* next = message->next;
+        switch (message->type)
+        {
+        case WorldMessage::Type::Join:
+            OnJoin(message->session);
+            break;
+        case WorldMessage::Type::Leave:
+            OnLeave(message->session);
+            break;
+        case WorldMessage::Type::Packet:
+            OnPacket(message->session, message->Data(), message->len);
+            packets++;
+            break;
+        }
+
+        DestroyMessage(message);
+        message = next;
+        drained++;
+    }
+    _pendingPackets.fetch_sub(packets, std::memory_order_relaxed);
+    _drainedMetric->Record(drained);
+
+    // 3. 시뮬레이션
+    OnTick(deltaSeconds);
+
+    // 4. 이번 틱 출력을 세션별로 한 번에 전송
+    FlushOutput();
+    _tickCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void World::Send(const SessionRef& session, SendBufferRef sendBuffer)
+{
+    _output.emplace_back(session, std::move(sendBuffer));
+}
+
+void World::FlushOutput()
+{
+    if (_output.empty())
+        return;
+
+    // 세션별로 모으되 같은 세션 안에서는 보낸 순서 유지
+    std::stable_sort(_output.begin(), _output.end(),
+        [](const auto& a, const auto& b) { return a.first.get() < b.first.get(); });
+
+    for (size_t begin = 0; begin < _output.size(); )
+    {
+        Session* session = _output[begin].first.get();
+        size_t end = begin;
+        _batch.clear();
+        while (end < _output.size() && _output[end].first.get() == session)
+            _batch.push_back(std::move(_output[end++].second));
+
+        _output[begin].first->SendBatch(_batch.data(), _batch.size());
+        begin = end;
+    }
+
+    _batch.clear();
+    _output.clear();
+}
+
+void World::DestroyMessage(WorldMessage* message)
+{
+    message->~WorldMessage();
+    GMemoryManager->Release(message);
+}
+
+/*----------------
+    TickScheduler
+-----------------*/
+TickScheduler::TickScheduler(uint32 tickRate, uint32 threadCount)
+    : _tickRate(std::max(1u, tickRate))
+    , _interval(std::chrono::nanoseconds(1000000000) / _tickRate)
+    , _worlds(std::max(1u, threadCount))
+{
+    _tickDurationMetric = GMetrics->GetHistogram("world_tick_duration_microseconds", "Time spent ticking the worlds of one tick thread");
+    _overrunMetric = GMetrics->GetCounter("world_tick_overruns_total", "Ticks that finished after the next tick was due");
+    _skippedMetric = GMetrics->GetCounter("world_ticks_skipped_total", "Ticks dropped after falling too far behind");
+}
+
+TickScheduler::~TickScheduler()
+{
+    Stop();
+}
+
+void TickScheduler::AddWorld(std::shared_ptr<World> world)
+{
+    _worlds[_nextThread++ % _worlds.size()].push_back(std::move(world));
+}
+
+void TickScheduler::Start(const ThreadOptions& options)
+{
+    if (_running.exchange(true))
+        return;
+
+    for (uint32 i = 0; i < _worlds.size(); i++)
+    {
+        ThreadOptions threadOptions = options;
+        threadOptions.name = (options.name.empty() ? "tick" : options.name) + "-" + std::to_string(i);
+        if (!options.cpus.empty())
+            threadOptions.cpus = { options.cpus[i % options.cpus.size()] };
+
+        _threads.emplace_back([this, i, threadOptions]()
+            {
+                ThreadManager::InitTLS();
+                ThreadManager::ApplyThreadOptions(threadOptions);
+                Run(i);
+                ThreadManager::DestroyTLS();
+            });
+    }
+}
+
+void TickScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(_stopLock);
+        if (!_running.exchange(false))
+            return;
+    }
+    _stopCv.notify_all();
+
+    for (std::thread& thread : _threads)
+        thread.join();
+    _threads.clear();
+}
+
+void TickScheduler::Run(uint32 threadIndex)
+{
+    const std::vector<std::shared_ptr<World>>& worlds = _worlds[threadIndex];
+    const float deltaSeconds = 1.0f / _tickRate;
+
+    uint64 tick = 0;
+    auto next = std::chrono::steady_clock::now();
+    while (_running.load())
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const std::shared_ptr<World>& world : worlds)
+            world->Tick(tick, deltaSeconds);
+        tick++;
+
+        auto end = std::chrono::steady_clock::now();
+        _tickDurationMetric->Record(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+
+        // 다음 틱 시각은 시작 시각이 아니라 기준 시각에서 주기만큼 (틱 길이가 달라도 주기가 흔들리지 않음)
+        next += _interval;
+        if (end >= next)
+        {
+            _overrunMetric->Inc();
+            if (end - next > _interval * MAX_CATCH_UP_TICKS)
+            {
+                _skippedMetric->Inc((end - next) / _interval);
+                next = end;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_stopLock);
+        _stopCv.wait_until(lock, next, [this]() { return !_running.load(); });
+    }
+}
@@ -0,0 +1,142 @@
+﻿#pragma once
+#include "CorePch.h"
+#include "ThreadManager.h"
+#include <condition_variable>
+
+class Session;
+class SendBuffer;
+class Counter;
+class MetricHistogram;
+using SessionRef = std::shared_ptr<Session>;
+using SendBufferRef = std::shared_ptr<SendBuffer>;
+
+// 인박스 메시지 (GMemoryManager에서 [WorldMessage][패킷] 크기로 할당)
+struct WorldMessage
+{
+    enum class Type : uint8
+    {
+        Join,
+        Leave,
+        Packet,
+    };
+
+    WorldMessage* next;
+    SessionRef session;
+    Type type;
+    int32 len;
+
+    BYTE* Data() { return reinterpret_cast<BYTE*>(this + 1); }
+};
+
+/*----------------
+    World
+-----------------*/
+// 고정 주기로 시뮬레이션하는 게임 월드 (상속해서 OnJoin/OnLeave/OnPacket/OnTick 구현)
+// io 스레드는 받은 패킷을 복사해 인박스에 넣기만 하고 (락 없는 스택에 CAS 한 번), 처리는 TickScheduler의 틱 스레드가 함
+// 틱마다 인박스를 한 번에 떼어 와 도착 순서대로 처리하고, 그 틱에 보낸 패킷은 틱 끝에 세션별로 모아 한 번에 전송
+// On* 콜백과 Send는 틱 스레드에서만 호출됨 (월드 상태에 락이 필요 없음)
+class World : public std::enable_shared_from_this<World>
+{
+    friend class TickScheduler;
+
+public:
+    enum
+    {
+        MAX_PENDING_PACKETS = 65536,    // 틱 스레드가 밀려 쌓일 수 있는 최대 패킷 수 (넘으면 버림, Join/Leave는 버리지 않음)
+    };
+
+    World(const std::string& name);
+    virtual ~World();
+
+    /* io 스레드에서 호출 */
+    void PostJoin(const SessionRef& session);
+    void PostLeave(const SessionRef& session);
+    // packet은 PacketHeader로 시작하는 완전한 패킷 (OnRecvPacket의 버퍼를 그대로 넘김)
+    void PostPacket(const SessionRef& session, const BYTE* packet, int32 len);
+
+    const std::string& GetName() const { return _name; }
+    uint64 GetTickCount() const { return _tickCount.load(std::memory_order_relaxed); }
+    uint64 GetDroppedPackets() const { return _droppedPackets.load(std::memory_order_relaxed); }
+
+protected:
+    /* 틱 스레드에서 호출 */
+    virtual void OnJoin(const SessionRef& session) {}
+    virtual void OnLeave(const SessionRef& session) {}
+    virtual void OnPacket(const SessionRef& session, BYTE* packet, int32 len) = 0;
+    virtual void OnTick(float deltaSeconds) = 0;
+
+    // 이번 틱 출력에 추가 (틱 끝에 세션별로 모아 Session::SendBatch)
+    void Send(const SessionRef& session, SendBufferRef sendBuffer);
+    // 모아 둔 출력을 지금 보냄 (틱 중간에 직접 보내는 출력보다 먼저 나가야 할 때)
+    void FlushOutput();
+
+    uint64 GetCurrentTick() const { return _currentTick; }
+
+private:
+    void Post(WorldMessage::Type type, const SessionRef& session, const BYTE* packet, int32 len);
+    void Tick(uint64 tick, float deltaSeconds);
+    static void DestroyMessage(WorldMessage* message);
+
+private:
+    std::string _name;
+
+    alignas(64) std::atomic<WorldMessage*> _inbox = nullptr;   // 최근에 넣은 메시지가 앞 (틱에서 뒤집음)
+    std::atomic<int32> _pendingPackets = 0;
+    std::atomic<uint64> _droppedPackets = 0;
+    std::atomic<uint64> _tickCount = 0;
+
+    // 틱 스레드 전용
+    uint64 _currentTick = 0;
+    std::vector<std::pair<SessionRef, SendBufferRef>> _output;
+    std::vector<SendBufferRef> _batch;
+
+    Counter* _droppedMetric = nullptr;
+    MetricHistogram* _drainedMetric = nullptr;
+};
+
+/*----------------
+    TickScheduler
+-----------------*/
+// 월드를 고정 주기(tickRate Hz)로 돌리는 틱 스레드 풀
+// 월드는 등록 순서대로 스레드에 하나씩 배정되고 한 월드는 항상 같은 스레드에서만 틱이 돔
+// 틱이 주기보다 오래 걸리면 밀린 만큼 바로 다음 틱을 돌리되, MAX_CATCH_UP_TICKS를 넘게 밀리면 따라잡기를 포기하고 기준 시각을 옮김
+class TickScheduler
+{
+public:
+    enum
+    {
+        MAX_CATCH_UP_TICKS = 5,
+    };
+
+    TickScheduler(uint32 tickRate, uint32 threadCount = 1);
+    ~TickScheduler();
+
+    // Start 전에 등록
+    void AddWorld(std::shared_ptr<World> world);
+
+    // options.name 뒤에 스레드 번호를 붙임 (비어 있으면 "tick-N"), cpus는 스레드마다 차례로 하나씩 배정
+    void Start(const ThreadOptions& options = {});
+    // 돌던 틱을 마치고 스레드 종료
+    void Stop();
+
+    uint32 GetTickRate() const { return _tickRate; }
+    std::chrono::nanoseconds GetTickInterval() const { return _interval; }
+
+private:
+    void Run(uint32 threadIndex);
+
+private:
+    uint32 _tickRate;
+    std::chrono::nanoseconds _interval;
+    std::vector<std::vector<std::shared_ptr<World>>> _worlds;  // 스레드별 월드
+    uint32 _nextThread = 0;
+
+    std::vector<std::thread> _threads;
+    std::atomic<bool> _running = false;
+    std::mutex _stopLock;
+    std::condition_variable _stopCv;
+
+    MetricHistogram* _tickDurationMetric = nullptr;
+    Counter* _overrunMetric = nullptr;
+    Counter* _skippedMetric = nullptr;
+};
@@ -0,0 +1,105 @@
+﻿#include "CorePch.h"
+#include "Snapshot.h"
+
+CoreGlobal Core;
+
+static int32 GFailures = 0;
+
+#define CHECK(expr) \
+    do { if (!(expr)) { std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr ") failed" << std::endl; GFailures++; } } while (0)
+
+enum : uint32
+{
+    FIELD_COUNT = 2,
+    MAX_ENTITIES = 2000,   // 전체 상태가 패킷 여러 개로 나뉠 만큼
+};
+
+static bool ApplyPacket(SnapshotReceiver& receiver, const SendBufferRef& packet)
+{
+    return receiver.Apply(packet->Buffer() + sizeof(PacketHeader), static_cast<int32>(packet->WriteSize() - sizeof(PacketHeader)));
+}
+
+static void SetAll(SnapshotRing& ring, uint32 value)
+{
+    for (uint32 slot = 0; slot < MAX_ENTITIES; slot++)
+    {
+        ring.Set(slot, 0, value + slot);
+        ring.Set(slot, 1, value);
+    }
+}
+
+static bool MatchesAll(const SnapshotReceiver& receiver, uint32 value)
+{
+    for (uint32 slot = 0; slot < MAX_ENTITIES; slot++)
+    {
+        if (!receiver.IsAlive(slot) || receiver.Get(slot, 0) != value + slot || receiver.Get(slot, 1) != value)
+            return false;
+    }
+    return true;
+}
+
+static bool ApplyFrame(SnapshotReceiver& receiver, const std::vector<SendBufferRef>& packets)
+{
+    bool completed = false;
+    for (const SendBufferRef& packet : packets)
+        completed = ApplyPacket(receiver, packet);
+    return completed;
+}
+
+/*
+    새 프레임이 마지막으로 완성된 프레임과 같은 기록 칸을 쓰면서 패킷 여러 개로 나뉘어 오다 끝나지 않은 경우
+    그 사이 Get은 마지막으로 완성된 프레임을 읽고, 그 프레임은 다음 델타의 기준으로도 쓸 수 있어야 함
+*/
+static void TestGetDuringUnfinishedSplitFrame()
+{
+    SnapshotRing ring(FIELD_COUNT, MAX_ENTITIES);
+    SnapshotReceiver receiver(FIELD_COUNT, MAX_ENTITIES, 2);
+
+    // 1. 프레임 1, 2를 끝까지 받음
+    SetAll(ring, 100);
+    uint32 frame1 = ring.Commit();
+    CHECK(ring.EncodeDelta(0, 1).size() > 1);
+    CHECK(ApplyFrame(receiver, ring.EncodeDelta(0, 1)));
+
+    SetAll(ring, 200);
+    uint32 frame2 = ring.Commit();
+    CHECK(ApplyFrame(receiver, ring.EncodeDelta(frame1, 1)));
+    CHECK(receiver.GetFrame() == frame2);
+    CHECK(MatchesAll(receiver, 200));
+
+    // 2. 프레임 3은 건너뛰고, 프레임 1 기준의 프레임 4(프레임 2와 같은 칸)는 마지막 패킷을 받지 못함
+    SetAll(ring, 300);
+    ring.Commit();
+    SetAll(ring, 400);
+    uint32 frame4 = ring.Commit();
+    CHECK(frame4 % 2 == frame2 % 2);
+
+    const std::vector<SendBufferRef>& split = ring.EncodeDelta(frame1, 1);
+    CHECK(split.size() > 1);
+    for (size_t i = 0; i + 1 < split.size(); i++)
+    {
+        CHECK(ApplyPacket(receiver, split[i]) == false);
+        CHECK(receiver.GetFrame() == frame2);
+        CHECK(MatchesAll(receiver, 200));
+    }
+
+    // 3. 프레임 2 기준의 다음 프레임은 그대로 받을 수 있음
+    SetAll(ring, 500);
+    uint32 frame5 = ring.Commit();
+    CHECK(ApplyFrame(receiver, ring.EncodeDelta(frame2, 1)));
+    CHECK(receiver.GetFrame() == frame5);
+    CHECK(MatchesAll(receiver, 500));
+}
+
+int main()
+{
+    TestGetDuringUnfinishedSplitFrame();
+
+    if (GFailures > 0)
+    {
+        std::cerr << GFailures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "SnapshotTest passed" << std::endl;
+    return 0;
+}